@@ -12,8 +12,10 @@
 
 #include "buffer/buffer_pool_manager.h"
 
+#include <algorithm>
 #include <list>
 #include <unordered_map>
+#include <vector>
 
 namespace bustub {
 
@@ -42,31 +44,27 @@ Page *BufferPoolManager::FetchPageImpl(page_id_t page_id) {
   // 2.     If R is dirty, write it back to the disk.
   // 3.     Delete R from the page table and insert P.
   // 4.     Update P's metadata, read in the page content from disk, and then return a pointer to P.
-  std::lock_guard<std::mutex> guard(latch_);
-  // Step 1
+  std::unique_lock<std::mutex> guard(latch_);
   frame_id_t frame_id;
-  auto it = page_table_.find(page_id);
-  if (it != page_table_.end()) {
-    pages_[it->second].pin_count_++;
-    replacer_->Pin(it->second);
-    return &pages_[it->second];
-  }
-  // 1.2
-  if (!free_list_.empty()) {
-    frame_id = free_list_.front();
-    free_list_.pop_front();
-  } else {
-    if (!replacer_->Victim(&frame_id)) {
-      return nullptr;
+  do {
+    // Step 1, again after latch_ was released to write a victim, as P may have been read in meanwhile
+    auto it = page_table_.find(page_id);
+    if (it != page_table_.end()) {
+      if (pages_[it->second].pin_count_ == 0 && !pages_[it->second].is_dirty_) {
+        // The page is the same as on disk, so every change from now on is newer than the next LSN.
+        pages_[it->second].rec_lsn_ = NextLSN();
+      }
+      pages_[it->second].pin_count_++;
+      replacer_->Pin(it->second);
+      return &pages_[it->second];
     }
-    // 2.0 write it back to the disk;
-    if (pages_[frame_id].is_dirty_) {
-      disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
+    // 1.2 and 2, 3
+    if (!FindFrame(&guard, &frame_id)) {
+      return nullptr;
     }
-    // delete and insert P
-    page_table_.erase(pages_[frame_id].GetPageId());
-  }
+  } while (frame_id == RETRY_FRAME_ID);
   // 4 read in the page content
+  pages_[frame_id].rec_lsn_ = NextLSN();
   pages_[frame_id].ResetMemory();
   disk_manager_->ReadPage(page_id, pages_[frame_id].GetData());
 
@@ -98,13 +96,23 @@ bool BufferPoolManager::UnpinPageImpl(page_id_t page_id, bool is_dirty) {
 
 bool BufferPoolManager::FlushPageImpl(page_id_t page_id) {
   // Make sure you call DiskManager::WritePage!
-  std::lock_guard<std::mutex> guard(latch_);
+  std::unique_lock<std::mutex> guard(latch_);
   auto it = page_table_.find(page_id);
   if (it == page_table_.end()) {
     return false;
   }
-  if (pages_[it->second].is_dirty_) {
-    disk_manager_->WritePage(page_id, pages_[it->second].GetData());
+  frame_id_t frame_id = it->second;
+  Page *page = &pages_[frame_id];
+  // A pinned page may have been modified without being marked dirty yet.
+  if (!page->is_dirty_ && page->pin_count_ == 0) {
+    return true;
+  }
+  page->pin_count_++;
+  replacer_->Pin(frame_id);
+  WritePageUnlatched(&guard, page);
+  page->pin_count_--;
+  if (page->pin_count_ == 0) {
+    replacer_->Unpin(frame_id);
   }
   return true;
 }
@@ -115,31 +123,68 @@ Page *BufferPoolManager::NewPageImpl(page_id_t *page_id) {
   // 2.   Pick a victim page P from either the free list or the replacer. Always pick from the free list first.
   // 3.   Update P's metadata, zero out memory and add P to the page table.
   // 4.   Set the page ID output parameter. Return a pointer to P.
-  std::lock_guard<std::mutex> guard(latch_);
+  std::unique_lock<std::mutex> guard(latch_);
   frame_id_t frame_id;
-  if (!free_list_.empty()) {
-    frame_id = free_list_.front();
-    free_list_.pop_front();
-  } else {
-    if (!replacer_->Victim(&frame_id)) {
+  do {
+    if (!FindFrame(&guard, &frame_id)) {
       return nullptr;
     }
-  }
-  if (pages_[frame_id].is_dirty_) {
-    disk_manager_->WritePage(pages_[frame_id].GetPageId(), pages_[frame_id].GetData());
-  }
-  page_table_.erase(pages_[frame_id].GetPageId());
+  } while (frame_id == RETRY_FRAME_ID);
   // update P's metadata
   *page_id = disk_manager_->AllocatePage();
   page_table_[*page_id] = frame_id;
   pages_[frame_id].ResetMemory();
   pages_[frame_id].page_id_ = *page_id;
+  pages_[frame_id].rec_lsn_ = NextLSN();
   pages_[frame_id].pin_count_++;
   pages_[frame_id].is_dirty_ = false;
   replacer_->Pin(frame_id);
   return &pages_[frame_id];
 }
 
+bool BufferPoolManager::FindFrame(std::unique_lock<std::mutex> *guard, frame_id_t *frame_id) {
+  if (!free_list_.empty()) {
+    *frame_id = free_list_.front();
+    free_list_.pop_front();
+    return true;
+  }
+  if (!replacer_->Victim(frame_id)) {
+    return false;
+  }
+  Page *victim = &pages_[*frame_id];
+  if (victim->is_dirty_) {
+    // Keep the victim pinned while it is written, so that no one else evicts it.
+    victim->pin_count_++;
+    WritePageUnlatched(guard, victim);
+    victim->pin_count_--;
+    if (victim->pin_count_ > 0 || victim->is_dirty_) {
+      // The victim was fetched or changed meanwhile, so it stays.
+      if (victim->pin_count_ == 0) {
+        replacer_->Unpin(*frame_id);
+      }
+      *frame_id = RETRY_FRAME_ID;
+      return true;
+    }
+  }
+  page_table_.erase(victim->GetPageId());
+  return true;
+}
+
+void BufferPoolManager::WritePageUnlatched(std::unique_lock<std::mutex> *guard, Page *page) {
+  // Writers may be changing the page, so its image is written under the page latch. Writers take latch_ while they
+  // hold page latches, so wait for the page latch without latch_. Forcing the log and writing the page do not hold
+  // latch_ either, so that other fetches and unpins do not wait for them.
+  guard->unlock();
+  page->RLatch();
+  lsn_t lsn = WritePageToDisk(page);
+  guard->lock();
+  page->is_dirty_ = false;
+  // The changes that are not in the written image are logged after the last change that is.
+  lsn_t next_lsn = NextLSN();
+  page->rec_lsn_ = lsn == INVALID_LSN ? next_lsn : std::min(lsn + 1, next_lsn);
+  page->RUnlatch();
+}
+
 bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
   // 0.   Make sure you call DiskManager::DeallocatePage!
   // 1.   Search the page table for the requested page (P).
@@ -166,9 +211,38 @@ bool BufferPoolManager::DeletePageImpl(page_id_t page_id) {
   return true;
 }
 
+lsn_t BufferPoolManager::WritePageToDisk(Page *page) {
+  lsn_t lsn = page->GetLSN();
+  // Recovery writes compensation log records while logging is disabled, so this does not check enable_logging.
+  if (log_manager_ != nullptr && lsn > log_manager_->GetPersistentLSN()) {
+    log_manager_->Flush(lsn);
+  }
+  disk_manager_->WritePage(page->GetPageId(), page->GetData());
+  return lsn;
+}
+
+std::unordered_map<page_id_t, lsn_t> BufferPoolManager::GetDirtyPageTable() {
+  std::lock_guard<std::mutex> guard(latch_);
+  std::unordered_map<page_id_t, lsn_t> dirty_page_table;
+  for (size_t i = 0; i < pool_size_; i++) {
+    if (pages_[i].page_id_ != INVALID_PAGE_ID && (pages_[i].is_dirty_ || pages_[i].pin_count_ > 0)) {
+      dirty_page_table[pages_[i].page_id_] = pages_[i].rec_lsn_;
+    }
+  }
+  return dirty_page_table;
+}
+
 void BufferPoolManager::FlushAllPagesImpl() {
-  for (auto it : page_table_) {
-    FlushPageImpl(it.first);
+  std::vector<page_id_t> page_ids;
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    page_ids.reserve(page_table_.size());
+    for (const auto &entry : page_table_) {
+      page_ids.push_back(entry.first);
+    }
+  }
+  for (auto page_id : page_ids) {
+    FlushPageImpl(page_id);
   }
 }
 
@@ -0,0 +1,252 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_stats.cpp
+//
+// Identification: src/catalog/table_stats.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "catalog/table_stats.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <random>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "common/util/hash_util.h"
+#include "common/util/hyperloglog.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return a numeric value as a double, NaN for the types that cannot be interpolated */
+double ToDouble(const Value &value) {
+  switch (value.GetTypeId()) {
+    case TypeId::TINYINT:
+      return value.GetAs<int8_t>();
+    case TypeId::SMALLINT:
+      return value.GetAs<int16_t>();
+    case TypeId::INTEGER:
+      return value.GetAs<int32_t>();
+    case TypeId::BIGINT:
+      return static_cast<double>(value.GetAs<int64_t>());
+    case TypeId::DECIMAL:
+      return value.GetAs<double>();
+    case TypeId::TIMESTAMP:
+      return static_cast<double>(value.GetAs<uint64_t>());
+    default:
+      return std::numeric_limits<double>::quiet_NaN();
+  }
+}
+
+/**
+ * @return the hash of a non-NULL value, to count the distinct values. HashUtil::HashValue() folds the bytes of
+ * integers onto one another, which makes many of them collide, so integers and decimals are hashed by their bits.
+ */
+hash_t HashForDistinct(const Value &value) {
+  switch (value.GetTypeId()) {
+    case TypeId::TINYINT:
+      return static_cast<hash_t>(value.GetAs<int8_t>());
+    case TypeId::SMALLINT:
+      return static_cast<hash_t>(value.GetAs<int16_t>());
+    case TypeId::INTEGER:
+      return static_cast<hash_t>(value.GetAs<int32_t>());
+    case TypeId::BIGINT:
+      return static_cast<hash_t>(value.GetAs<int64_t>());
+    case TypeId::TIMESTAMP:
+      return static_cast<hash_t>(value.GetAs<uint64_t>());
+    case TypeId::DECIMAL: {
+      double decimal = value.GetAs<double>();
+      hash_t bits;
+      memcpy(&bits, &decimal, sizeof(bits));
+      return bits;
+    }
+    default:
+      return HashUtil::HashValue(&value);
+  }
+}
+
+bool LessThan(const Value &lhs, const Value &rhs) { return lhs.CompareLessThan(rhs) == CmpBool::CmpTrue; }
+
+bool Equals(const Value &lhs, const Value &rhs) { return lhs.CompareEquals(rhs) == CmpBool::CmpTrue; }
+
+}  // namespace
+
+ColumnStats::ColumnStats(TypeId type, std::vector<Value> &&values, size_t num_nulls, double scale) : type_(type) {
+  double sampled_rows = values.size() + num_nulls;
+  null_fraction_ = sampled_rows == 0 ? 0 : num_nulls / sampled_rows;
+  if (values.empty()) {
+    return;
+  }
+
+  HyperLogLog distinct;
+  for (const auto &value : values) {
+    distinct.Add(HashForDistinct(value));
+  }
+  std::sort(values.begin(), values.end(), LessThan);
+  // The values seen exactly once tell how many distinct values the sample likely missed.
+  double singletons = 0;
+  for (size_t i = 0, run = 1; i < values.size(); i++, run++) {
+    if (i + 1 == values.size() || !Equals(values[i], values[i + 1])) {
+      singletons += static_cast<double>(run == 1);
+      run = 0;
+    }
+  }
+  // The Duj1 estimator of Haas et al.: the sample's distinct count, scaled up the more its values are singletons.
+  double sample_size = values.size();
+  double table_size = sample_size * scale;
+  double sample_distinct = std::clamp(distinct.Estimate(), std::max(1.0, singletons), sample_size);
+  num_distinct_ = sample_size * sample_distinct / (sample_size - singletons + singletons * sample_size / table_size);
+
+  histogram_.reserve(HISTOGRAM_BUCKETS + 1);
+  for (size_t i = 0; i <= HISTOGRAM_BUCKETS; i++) {
+    histogram_.push_back(values[i * (values.size() - 1) / HISTOGRAM_BUCKETS]);
+  }
+}
+
+double ColumnStats::EstimateSelectivity(ComparisonType comparison, const Value &constant) const {
+  if (IsEmpty() || constant.IsNull()) {
+    return 0;
+  }
+  double equal = EqualFraction(constant);
+  double less_or_equal = LessOrEqualFraction(constant);
+  double fraction;
+  switch (comparison) {
+    case ComparisonType::Equal:
+      fraction = equal;
+      break;
+    case ComparisonType::NotEqual:
+      fraction = 1 - equal;
+      break;
+    case ComparisonType::LessThan:
+      fraction = less_or_equal - equal;
+      break;
+    case ComparisonType::LessThanOrEqual:
+      fraction = less_or_equal;
+      break;
+    case ComparisonType::GreaterThan:
+      fraction = 1 - less_or_equal;
+      break;
+    case ComparisonType::GreaterThanOrEqual:
+      fraction = 1 - less_or_equal + equal;
+      break;
+    default:
+      UNREACHABLE("Unsupported comparison type.");
+  }
+  // NULLs compare to nothing.
+  return std::clamp(fraction, 0.0, 1.0) * (1 - null_fraction_);
+}
+
+double ColumnStats::EqualFraction(const Value &value) const {
+  if (LessThan(value, GetMin()) || LessThan(GetMax(), value)) {
+    return 0;
+  }
+  // A value that bounds several buckets fills about as many.
+  size_t buckets = 0;
+  for (size_t i = 1; i < histogram_.size(); i++) {
+    buckets += static_cast<size_t>(Equals(histogram_[i], value));
+  }
+  return std::max(1 / num_distinct_, static_cast<double>(buckets) / HISTOGRAM_BUCKETS);
+}
+
+double ColumnStats::LessOrEqualFraction(const Value &value) const {
+  if (LessThan(value, GetMin())) {
+    return 0;
+  }
+  if (!LessThan(value, GetMax())) {
+    return 1;
+  }
+  // Bucket i holds the values in (histogram_[i], histogram_[i + 1]], and the first one the minimum too.
+  double buckets = 0;
+  for (size_t i = 0; i + 1 < histogram_.size(); i++) {
+    const Value &lower = histogram_[i];
+    const Value &upper = histogram_[i + 1];
+    if (!LessThan(value, upper)) {
+      buckets += 1;
+    } else if (LessThan(lower, value)) {
+      // Values are assumed to be spread evenly within a bucket, or around its middle if they are not numbers.
+      double position = (ToDouble(value) - ToDouble(lower)) / (ToDouble(upper) - ToDouble(lower));
+      buckets += std::isnan(position) ? 0.5 : position;
+    }
+  }
+  // The values equal to the minimum are in the first bucket without being above its lower bound.
+  return std::max(buckets / HISTOGRAM_BUCKETS, EqualFraction(value));
+}
+
+std::unique_ptr<TableStats> TableStats::Analyze(TableHeap *table, const Schema &schema, BufferPoolManager *bpm,
+                                                Transaction *txn, size_t sample_pages) {
+  std::unique_ptr<TableStats> stats(new TableStats());
+
+  // Draw the pages with Algorithm R: the n-th page replaces a random one of the sample with probability k / n.
+  std::mt19937_64 random(15445);
+  std::vector<page_id_t> sample;
+  page_id_t page_id = table->GetFirstPageId();
+  while (page_id != INVALID_PAGE_ID) {
+    auto *page = static_cast<TablePage *>(bpm->FetchPage(page_id));
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no free buffer pool frame to analyze a table");
+    }
+    page->RLatch();
+    page_id_t next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    bpm->UnpinPage(page_id, false);
+
+    stats->num_pages_++;
+    if (sample.size() < sample_pages) {
+      sample.push_back(page_id);
+    } else {
+      std::uniform_int_distribution<size_t> pick(0, stats->num_pages_ - 1);
+      size_t slot = pick(random);
+      if (slot < sample_pages) {
+        sample[slot] = page_id;
+      }
+    }
+    page_id = next_page_id;
+  }
+
+  std::vector<std::vector<Value>> values(schema.GetColumnCount());
+  std::vector<size_t> num_nulls(schema.GetColumnCount(), 0);
+  std::vector<Tuple> tuples;
+  for (page_id_t sampled_page_id : sample) {
+    auto *page = static_cast<TablePage *>(bpm->FetchPage(sampled_page_id));
+    if (page == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no free buffer pool frame to analyze a table");
+    }
+    tuples.clear();
+    table->ReadPage(page, txn, &tuples);
+    bpm->UnpinPage(sampled_page_id, false);
+    for (const auto &tuple : tuples) {
+      for (uint32_t col_idx = 0; col_idx < schema.GetColumnCount(); col_idx++) {
+        Value value = tuple.GetValue(&schema, col_idx);
+        if (value.IsNull()) {
+          num_nulls[col_idx]++;
+        } else {
+          values[col_idx].emplace_back(std::move(value));
+        }
+      }
+    }
+    stats->num_sampled_rows_ += tuples.size();
+  }
+  stats->num_sampled_pages_ = sample.size();
+
+  double scale = sample.empty() ? 1 : static_cast<double>(stats->num_pages_) / sample.size();
+  stats->row_count_ = stats->num_sampled_rows_ * scale;
+  stats->columns_.reserve(schema.GetColumnCount());
+  for (uint32_t col_idx = 0; col_idx < schema.GetColumnCount(); col_idx++) {
+    stats->columns_.emplace_back(schema.GetColumn(col_idx).GetType(), std::move(values[col_idx]), num_nulls[col_idx],
+                                 scale);
+  }
+  return stats;
+}
+
+}  // namespace bustub
@@ -12,12 +12,41 @@
 
 #include "common/config.h"
 
+#include <algorithm>
+#include <thread>  // NOLINT
+
 namespace bustub {
 
 std::atomic<bool> enable_logging(false);
 
 std::chrono::duration<int64_t> log_timeout = std::chrono::seconds(1);
 
+bool enable_log_compression = false;
+
+int log_segment_size = 16 * 1024 * 1024;
+
+bool enable_double_write = true;
+
+bool enable_vectorized_execution = true;
+
+bool enable_compiled_expressions = true;
+
+bool enable_optimizer = true;
+
+size_t execution_threads = std::max(1U, std::thread::hardware_concurrency());
+
+size_t hash_join_memory_budget = 16 * 1024 * 1024;
+
+size_t sort_memory_budget = 16 * 1024 * 1024;
+
+size_t analyze_sample_pages = 64;
+
+size_t plan_cache_size = 256;
+
 std::chrono::milliseconds cycle_detection_interval = std::chrono::milliseconds(50);
 
+size_t lock_escalation_threshold = 1000;
+
+std::chrono::milliseconds gc_interval = std::chrono::milliseconds(100);
+
 }  // namespace bustub
@@ -12,48 +12,718 @@
 
 #include "concurrency/lock_manager.h"
 
+#include <algorithm>
+#include <functional>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
+#include "concurrency/transaction_manager.h"
+
 namespace bustub {
 
+namespace {
+
+/** @return true if a lock held in mode held on an ancestor implicitly grants mode requested on all its descendants */
+bool CoversDescendants(LockMode held, LockMode requested) {
+  switch (held) {
+    case LockMode::EXCLUSIVE:
+      return true;
+    case LockMode::SHARED:
+    case LockMode::SHARED_INTENTION_EXCLUSIVE:
+      return requested == LockMode::SHARED || requested == LockMode::INTENTION_SHARED;
+    default:
+      return false;
+  }
+}
+
+/** @return the intention mode that must be held on the ancestors of a resource locked in mode lock_mode */
+LockMode IntentionFor(LockMode lock_mode) {
+  return lock_mode == LockMode::SHARED || lock_mode == LockMode::INTENTION_SHARED ? LockMode::INTENTION_SHARED
+                                                                                 : LockMode::INTENTION_EXCLUSIVE;
+}
+
+}  // namespace
+
+bool LockManager::AreCompatible(LockMode held, LockMode requested) {
+  switch (held) {
+    case LockMode::INTENTION_SHARED:
+      return requested != LockMode::EXCLUSIVE;
+    case LockMode::INTENTION_EXCLUSIVE:
+      return requested == LockMode::INTENTION_SHARED || requested == LockMode::INTENTION_EXCLUSIVE;
+    case LockMode::SHARED:
+      return requested == LockMode::INTENTION_SHARED || requested == LockMode::SHARED;
+    case LockMode::SHARED_INTENTION_EXCLUSIVE:
+      return requested == LockMode::INTENTION_SHARED;
+    case LockMode::EXCLUSIVE:
+      return false;
+  }
+  return false;
+}
+
+bool LockManager::Covers(LockMode held, LockMode requested) {
+  if (held == requested || held == LockMode::EXCLUSIVE) {
+    return true;
+  }
+  switch (held) {
+    case LockMode::INTENTION_EXCLUSIVE:
+    case LockMode::SHARED:
+      return requested == LockMode::INTENTION_SHARED;
+    case LockMode::SHARED_INTENTION_EXCLUSIVE:
+      return requested != LockMode::EXCLUSIVE;
+    default:
+      return false;
+  }
+}
+
+LockMode LockManager::Combine(LockMode a, LockMode b) {
+  if (Covers(a, b)) {
+    return a;
+  }
+  if (Covers(b, a)) {
+    return b;
+  }
+  // The only incomparable pair is {SHARED, INTENTION_EXCLUSIVE}, whose least upper bound is SIX.
+  return LockMode::SHARED_INTENTION_EXCLUSIVE;
+}
+
+bool LockManager::IsRowLocked(Transaction *txn, LockMode lock_mode, table_oid_t oid, const RID &rid) {
+  LockMode held;
+  if (txn->IsTableLocked(oid, &held) && CoversDescendants(held, lock_mode)) {
+    return true;
+  }
+  auto pages = txn->GetPageLockSet()->find(oid);
+  if (pages != txn->GetPageLockSet()->end()) {
+    auto page = pages->second.find(rid.GetPageId());
+    if (page != pages->second.end() && CoversDescendants(page->second, lock_mode)) {
+      return true;
+    }
+  }
+  auto rows = txn->GetRowLockSet()->find(oid);
+  if (rows != txn->GetRowLockSet()->end()) {
+    auto row = rows->second.find(rid);
+    if (row != rows->second.end() && Covers(row->second, lock_mode)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 bool LockManager::LockShared(Transaction *txn, const RID &rid) {
+  std::unique_lock<std::mutex> guard(latch_);
+  if (!CheckLockPreconditions(txn, LockMode::SHARED)) {
+    return false;
+  }
+  if (txn->IsSharedLocked(rid) || txn->IsExclusiveLocked(rid)) {
+    return true;
+  }
+  if (!AcquireLock(txn, &lock_table_[rid], LockMode::SHARED, &guard)) {
+    return false;
+  }
   txn->GetSharedLockSet()->emplace(rid);
   return true;
 }
 
 bool LockManager::LockExclusive(Transaction *txn, const RID &rid) {
+  std::unique_lock<std::mutex> guard(latch_);
+  if (!CheckLockPreconditions(txn, LockMode::EXCLUSIVE)) {
+    return false;
+  }
+  if (txn->IsExclusiveLocked(rid)) {
+    return true;
+  }
+  if (txn->IsSharedLocked(rid)) {
+    txn->GetSharedLockSet()->erase(rid);
+    if (!UpgradeLock(txn, &lock_table_[rid], LockMode::EXCLUSIVE, &guard)) {
+      return false;
+    }
+  } else if (!AcquireLock(txn, &lock_table_[rid], LockMode::EXCLUSIVE, &guard)) {
+    return false;
+  }
   txn->GetExclusiveLockSet()->emplace(rid);
   return true;
 }
 
 bool LockManager::LockUpgrade(Transaction *txn, const RID &rid) {
+  std::unique_lock<std::mutex> guard(latch_);
+  if (!CheckLockPreconditions(txn, LockMode::EXCLUSIVE) || !txn->IsSharedLocked(rid)) {
+    return false;
+  }
   txn->GetSharedLockSet()->erase(rid);
+  if (!UpgradeLock(txn, &lock_table_[rid], LockMode::EXCLUSIVE, &guard)) {
+    return false;
+  }
   txn->GetExclusiveLockSet()->emplace(rid);
   return true;
 }
 
 bool LockManager::Unlock(Transaction *txn, const RID &rid) {
+  std::unique_lock<std::mutex> guard(latch_);
   txn->GetSharedLockSet()->erase(rid);
   txn->GetExclusiveLockSet()->erase(rid);
+  auto it = lock_table_.find(rid);
+  LockMode lock_mode;
+  if (it == lock_table_.end() || !ReleaseLock(txn, &it->second, &lock_mode)) {
+    return false;
+  }
+  if (it->second.request_queue_.empty()) {
+    lock_table_.erase(it);
+  }
+  TransitionOnUnlock(txn, lock_mode);
+  return true;
+}
+
+bool LockManager::LockTable(Transaction *txn, LockMode lock_mode, table_oid_t oid) {
+  std::unique_lock<std::mutex> guard(latch_);
+  if (!CheckLockPreconditions(txn, lock_mode)) {
+    return false;
+  }
+  return LockTableLocked(txn, lock_mode, oid, &guard);
+}
+
+bool LockManager::LockPage(Transaction *txn, LockMode lock_mode, table_oid_t oid, page_id_t page_id) {
+  std::unique_lock<std::mutex> guard(latch_);
+  if (!CheckLockPreconditions(txn, lock_mode)) {
+    return false;
+  }
+  return LockPageLocked(txn, lock_mode, oid, page_id, &guard);
+}
+
+bool LockManager::LockRow(Transaction *txn, LockMode lock_mode, table_oid_t oid, const RID &rid) {
+  BUSTUB_ASSERT(lock_mode == LockMode::SHARED || lock_mode == LockMode::EXCLUSIVE, "Rows take S or X locks only.");
+  std::unique_lock<std::mutex> guard(latch_);
+  if (!CheckLockPreconditions(txn, lock_mode)) {
+    return false;
+  }
+  // The table or page lock may already grant this row, e.g. after an escalation.
+  if (IsRowLocked(txn, lock_mode, oid, rid)) {
+    return true;
+  }
+  auto &rows = (*txn->GetRowLockSet())[oid];
+  auto row = rows.find(rid);
+
+  // Announce the row lock on its ancestors first.
+  LockMode intention = IntentionFor(lock_mode);
+  if (!LockTableLocked(txn, intention, oid, &guard) ||
+      !LockPageLocked(txn, intention, oid, rid.GetPageId(), &guard)) {
+    return false;
+  }
+  if (row != rows.end()) {
+    rows.erase(row);
+    if (!UpgradeLock(txn, &lock_table_[rid], lock_mode, &guard)) {
+      return false;
+    }
+  } else if (!AcquireLock(txn, &lock_table_[rid], lock_mode, &guard)) {
+    return false;
+  }
+  rows[rid] = lock_mode;
+
+  if (rows.size() > lock_escalation_threshold) {
+    // The row lock is granted either way; a failed escalation is tried again at the next row lock.
+    Escalate(txn, oid, &guard);
+  }
+  return true;
+}
+
+bool LockManager::UnlockTable(Transaction *txn, table_oid_t oid) {
+  std::unique_lock<std::mutex> guard(latch_);
+  auto table_locks = txn->GetTableLockSet();
+  if (table_locks->count(oid) == 0) {
+    return false;
+  }
+  // Locks on the descendants must go first, otherwise they would be left without their intention lock.
+  auto rows = txn->GetRowLockSet()->find(oid);
+  auto pages = txn->GetPageLockSet()->find(oid);
+  if ((rows != txn->GetRowLockSet()->end() && !rows->second.empty()) ||
+      (pages != txn->GetPageLockSet()->end() && !pages->second.empty())) {
+    return false;
+  }
+  table_locks->erase(oid);
+  auto it = table_lock_table_.find(oid);
+  LockMode lock_mode;
+  if (it == table_lock_table_.end() || !ReleaseLock(txn, &it->second, &lock_mode)) {
+    return false;
+  }
+  if (it->second.request_queue_.empty()) {
+    table_lock_table_.erase(it);
+  }
+  TransitionOnUnlock(txn, lock_mode);
+  return true;
+}
+
+bool LockManager::UnlockPage(Transaction *txn, table_oid_t oid, page_id_t page_id) {
+  std::unique_lock<std::mutex> guard(latch_);
+  auto pages = txn->GetPageLockSet()->find(oid);
+  if (pages == txn->GetPageLockSet()->end() || pages->second.erase(page_id) == 0) {
+    return false;
+  }
+  auto it = page_lock_table_.find(page_id);
+  LockMode lock_mode;
+  if (it == page_lock_table_.end() || !ReleaseLock(txn, &it->second, &lock_mode)) {
+    return false;
+  }
+  if (it->second.request_queue_.empty()) {
+    page_lock_table_.erase(it);
+  }
+  TransitionOnUnlock(txn, lock_mode);
+  return true;
+}
+
+bool LockManager::UnlockRow(Transaction *txn, table_oid_t oid, const RID &rid) {
+  std::unique_lock<std::mutex> guard(latch_);
+  auto rows = txn->GetRowLockSet()->find(oid);
+  if (rows == txn->GetRowLockSet()->end() || rows->second.erase(rid) == 0) {
+    return false;
+  }
+  auto it = lock_table_.find(rid);
+  LockMode lock_mode;
+  if (it == lock_table_.end() || !ReleaseLock(txn, &it->second, &lock_mode)) {
+    return false;
+  }
+  if (it->second.request_queue_.empty()) {
+    lock_table_.erase(it);
+  }
+  TransitionOnUnlock(txn, lock_mode);
+  return true;
+}
+
+void LockManager::UnlockAll(Transaction *txn) {
+  std::unique_lock<std::mutex> guard(latch_);
+  LockMode lock_mode;
+  auto release_row = [&](const RID &rid) {
+    auto it = lock_table_.find(rid);
+    if (it != lock_table_.end() && ReleaseLock(txn, &it->second, &lock_mode) && it->second.request_queue_.empty()) {
+      lock_table_.erase(it);
+    }
+  };
+  for (const auto &rid : *txn->GetSharedLockSet()) {
+    release_row(rid);
+  }
+  for (const auto &rid : *txn->GetExclusiveLockSet()) {
+    release_row(rid);
+  }
+  for (const auto &table_rows : *txn->GetRowLockSet()) {
+    for (const auto &row : table_rows.second) {
+      release_row(row.first);
+    }
+  }
+  for (const auto &table_pages : *txn->GetPageLockSet()) {
+    for (const auto &page : table_pages.second) {
+      auto it = page_lock_table_.find(page.first);
+      if (it != page_lock_table_.end() && ReleaseLock(txn, &it->second, &lock_mode) &&
+          it->second.request_queue_.empty()) {
+        page_lock_table_.erase(it);
+      }
+    }
+  }
+  for (const auto &table : *txn->GetTableLockSet()) {
+    auto it = table_lock_table_.find(table.first);
+    if (it != table_lock_table_.end() && ReleaseLock(txn, &it->second, &lock_mode) &&
+        it->second.request_queue_.empty()) {
+      table_lock_table_.erase(it);
+    }
+  }
+  wounded_.erase(txn->GetTransactionId());
+  txn->GetSharedLockSet()->clear();
+  txn->GetExclusiveLockSet()->clear();
+  txn->GetRowLockSet()->clear();
+  txn->GetPageLockSet()->clear();
+  txn->GetTableLockSet()->clear();
+}
+
+bool LockManager::LockTableLocked(Transaction *txn, LockMode lock_mode, table_oid_t oid,
+                                  std::unique_lock<std::mutex> *guard) {
+  auto table_locks = txn->GetTableLockSet();
+  auto it = table_locks->find(oid);
+  if (it == table_locks->end()) {
+    if (!AcquireLock(txn, &table_lock_table_[oid], lock_mode, guard)) {
+      return false;
+    }
+    (*table_locks)[oid] = lock_mode;
+    return true;
+  }
+  if (Covers(it->second, lock_mode)) {
+    return true;
+  }
+  LockMode target = Combine(it->second, lock_mode);
+  table_locks->erase(it);
+  if (!UpgradeLock(txn, &table_lock_table_[oid], target, guard)) {
+    return false;
+  }
+  (*table_locks)[oid] = target;
+  return true;
+}
+
+bool LockManager::LockPageLocked(Transaction *txn, LockMode lock_mode, table_oid_t oid, page_id_t page_id,
+                                 std::unique_lock<std::mutex> *guard) {
+  LockMode held;
+  if (txn->IsTableLocked(oid, &held) && CoversDescendants(held, lock_mode)) {
+    return true;
+  }
+  if (!LockTableLocked(txn, IntentionFor(lock_mode), oid, guard)) {
+    return false;
+  }
+  auto &pages = (*txn->GetPageLockSet())[oid];
+  auto it = pages.find(page_id);
+  if (it == pages.end()) {
+    if (!AcquireLock(txn, &page_lock_table_[page_id], lock_mode, guard)) {
+      return false;
+    }
+    pages[page_id] = lock_mode;
+    return true;
+  }
+  if (Covers(it->second, lock_mode)) {
+    return true;
+  }
+  LockMode target = Combine(it->second, lock_mode);
+  pages.erase(it);
+  if (!UpgradeLock(txn, &page_lock_table_[page_id], target, guard)) {
+    return false;
+  }
+  pages[page_id] = target;
+  return true;
+}
+
+bool LockManager::Escalate(Transaction *txn, table_oid_t oid, std::unique_lock<std::mutex> *guard) {
+  // The caller may hold a page latch, so the table lock is only taken if it is granted at once.
+  if (!IsTableLockGrantable(txn, LockMode::SHARED, oid)) {
+    return false;
+  }
+  auto &rows = (*txn->GetRowLockSet())[oid];
+  bool exclusive = false;
+  for (const auto &row : rows) {
+    exclusive = exclusive || row.second == LockMode::EXCLUSIVE;
+  }
+  LockMode lock_mode = exclusive ? LockMode::EXCLUSIVE : LockMode::SHARED;
+  if (exclusive && !IsTableLockGrantable(txn, lock_mode, oid)) {
+    return false;
+  }
+  // Take the covering table lock before giving up the finer grained ones.
+  if (!LockTableLocked(txn, lock_mode, oid, guard)) {
+    return false;
+  }
+  LockMode released;
+  for (const auto &row : rows) {
+    auto it = lock_table_.find(row.first);
+    if (it != lock_table_.end() && ReleaseLock(txn, &it->second, &released) && it->second.request_queue_.empty()) {
+      lock_table_.erase(it);
+    }
+  }
+  txn->GetRowLockSet()->erase(oid);
+  auto pages = txn->GetPageLockSet()->find(oid);
+  if (pages != txn->GetPageLockSet()->end()) {
+    for (const auto &page : pages->second) {
+      auto it = page_lock_table_.find(page.first);
+      if (it != page_lock_table_.end() && ReleaseLock(txn, &it->second, &released) &&
+          it->second.request_queue_.empty()) {
+        page_lock_table_.erase(it);
+      }
+    }
+    txn->GetPageLockSet()->erase(pages);
+  }
+  return true;
+}
+
+bool LockManager::IsTableLockGrantable(Transaction *txn, LockMode lock_mode, table_oid_t oid) {
+  LockMode held;
+  bool upgrade = txn->IsTableLocked(oid, &held);
+  if (upgrade) {
+    if (Covers(held, lock_mode)) {
+      return true;
+    }
+    lock_mode = Combine(held, lock_mode);
+  }
+  auto it = table_lock_table_.find(oid);
+  if (it == table_lock_table_.end()) {
+    return true;
+  }
+  // A new request queues behind every request, an upgrade only behind the granted ones, and only one at a time.
+  if (upgrade && it->second.upgrading_) {
+    return false;
+  }
+  txn_id_t txn_id = txn->GetTransactionId();
+  return std::all_of(it->second.request_queue_.begin(), it->second.request_queue_.end(),
+                     [&](const LockRequest &request) {
+                       return request.txn_id_ == txn_id || (upgrade && !request.granted_) ||
+                              AreCompatible(request.lock_mode_, lock_mode);
+                     });
+}
+
+bool LockManager::CheckLockPreconditions(Transaction *txn, LockMode lock_mode) {
+  if (txn->GetState() == TransactionState::ABORTED) {
+    // A transaction wounded while it was running learns about it here and must roll back to release its locks.
+    if (wounded_.erase(txn->GetTransactionId()) != 0) {
+      throw TransactionAbortException(txn->GetTransactionId(), AbortReason::DEADLOCK);
+    }
+    return false;
+  }
+  bool reads = lock_mode == LockMode::SHARED || lock_mode == LockMode::INTENTION_SHARED ||
+               lock_mode == LockMode::SHARED_INTENTION_EXCLUSIVE;
+  if (reads && txn->GetIsolationLevel() == IsolationLevel::READ_UNCOMMITTED) {
+    txn->SetState(TransactionState::ABORTED);
+    throw TransactionAbortException(txn->GetTransactionId(), AbortReason::LOCKSHARED_ON_READ_UNCOMMITTED);
+  }
+  if (txn->GetState() == TransactionState::SHRINKING) {
+    // READ_COMMITTED releases its shared locks early, so it may keep taking them.
+    bool shared = lock_mode == LockMode::SHARED || lock_mode == LockMode::INTENTION_SHARED;
+    if (!shared || txn->GetIsolationLevel() != IsolationLevel::READ_COMMITTED) {
+      txn->SetState(TransactionState::ABORTED);
+      throw TransactionAbortException(txn->GetTransactionId(), AbortReason::LOCK_ON_SHRINKING);
+    }
+  }
+  return true;
+}
+
+void LockManager::TransitionOnUnlock(Transaction *txn, LockMode lock_mode) {
+  if (txn->GetState() != TransactionState::GROWING) {
+    return;
+  }
+  // Intention locks only protect the locks below them, releasing them does not end the growing phase.
+  if (lock_mode == LockMode::INTENTION_SHARED || lock_mode == LockMode::INTENTION_EXCLUSIVE) {
+    return;
+  }
+  if (lock_mode != LockMode::EXCLUSIVE && txn->GetIsolationLevel() == IsolationLevel::READ_COMMITTED) {
+    return;
+  }
+  txn->SetState(TransactionState::SHRINKING);
+}
+
+std::vector<txn_id_t> LockManager::GetBlockers(const LockRequestQueue &queue, txn_id_t txn_id) {
+  auto self = std::find_if(queue.request_queue_.begin(), queue.request_queue_.end(),
+                           [txn_id](const LockRequest &request) { return request.txn_id_ == txn_id; });
+  BUSTUB_ASSERT(self != queue.request_queue_.end(), "The request must be enqueued.");
+  // FIFO: the request must be compatible with every request ahead of it, granted or not.
+  std::vector<txn_id_t> blockers;
+  for (auto it = queue.request_queue_.begin(); it != self; ++it) {
+    if (it->txn_id_ != txn_id && !AreCompatible(it->lock_mode_, self->lock_mode_)) {
+      blockers.push_back(it->txn_id_);
+    }
+  }
+  return blockers;
+}
+
+bool LockManager::WaitForGrant(Transaction *txn, LockRequestQueue *queue, std::unique_lock<std::mutex> *guard) {
+  txn_id_t txn_id = txn->GetTransactionId();
+  std::vector<txn_id_t> blockers = GetBlockers(*queue, txn_id);
+  while (!blockers.empty()) {
+    switch (policy_) {
+      case DeadlockPolicy::NO_WAIT:
+        AbortVictim(txn);
+        return false;
+      case DeadlockPolicy::WAIT_DIE:
+        // Only older transactions may wait for younger ones.
+        if (*std::min_element(blockers.begin(), blockers.end()) < txn_id) {
+          AbortVictim(txn);
+          return false;
+        }
+        break;
+      case DeadlockPolicy::WOUND_WAIT:
+        // Younger transactions in the way are aborted, their locks are released once they roll back. One that is not
+        // waiting for a lock is told at its next lock request.
+        for (txn_id_t blocker : blockers) {
+          if (blocker > txn_id) {
+            Transaction *victim = TransactionManager::GetTransaction(blocker);
+            if (victim->GetState() != TransactionState::ABORTED) {
+              AbortVictim(victim);
+              if (waiting_.count(blocker) == 0) {
+                wounded_.insert(blocker);
+              }
+            }
+          }
+        }
+        break;
+      case DeadlockPolicy::DETECTION:
+        RemoveEdges(txn_id);
+        for (txn_id_t blocker : blockers) {
+          AddEdge(txn_id, blocker);
+        }
+        break;
+    }
+
+    waiting_[txn_id] = {txn, queue};
+    queue->cv_.wait(*guard);
+    waiting_.erase(txn_id);
+    if (txn->GetState() == TransactionState::ABORTED) {
+      RemoveEdges(txn_id);
+      return false;
+    }
+    blockers = GetBlockers(*queue, txn_id);
+  }
+  if (policy_ == DeadlockPolicy::DETECTION) {
+    RemoveEdges(txn_id);
+  }
+  return true;
+}
+
+void LockManager::AbortVictim(Transaction *victim) {
+  victim->SetState(TransactionState::ABORTED);
+  stats_.victims_++;
+  stats_.last_victim_ = victim->GetTransactionId();
+  LOG_DEBUG("Aborting transaction %d to resolve a deadlock", victim->GetTransactionId());
+  auto it = waiting_.find(victim->GetTransactionId());
+  if (it != waiting_.end()) {
+    it->second.second->cv_.notify_all();
+  }
+}
+
+bool LockManager::AcquireLock(Transaction *txn, LockRequestQueue *queue, LockMode lock_mode,
+                              std::unique_lock<std::mutex> *guard) {
+  txn_id_t txn_id = txn->GetTransactionId();
+  auto self = queue->request_queue_.emplace(queue->request_queue_.end(), txn_id, lock_mode);
+  if (!WaitForGrant(txn, queue, guard)) {
+    LockMode removed;
+    ReleaseLock(txn, queue, &removed);
+    throw TransactionAbortException(txn_id, AbortReason::DEADLOCK);
+  }
+  self->granted_ = true;
+  return true;
+}
+
+bool LockManager::UpgradeLock(Transaction *txn, LockRequestQueue *queue, LockMode lock_mode,
+                              std::unique_lock<std::mutex> *guard) {
+  txn_id_t txn_id = txn->GetTransactionId();
+  if (queue->upgrading_) {
+    LockMode removed;
+    ReleaseLock(txn, queue, &removed);
+    txn->SetState(TransactionState::ABORTED);
+    throw TransactionAbortException(txn_id, AbortReason::UPGRADE_CONFLICT);
+  }
+  // Replace the granted request with one that waits ahead of every request that is not granted yet.
+  auto &requests = queue->request_queue_;
+  requests.remove_if([txn_id](const LockRequest &request) { return request.txn_id_ == txn_id; });
+  auto pos =
+      std::find_if(requests.begin(), requests.end(), [](const LockRequest &request) { return !request.granted_; });
+  auto self = requests.emplace(pos, txn_id, lock_mode);
+  queue->upgrading_ = true;
+  bool granted = WaitForGrant(txn, queue, guard);
+  queue->upgrading_ = false;
+  if (!granted) {
+    LockMode removed;
+    ReleaseLock(txn, queue, &removed);
+    throw TransactionAbortException(txn_id, AbortReason::DEADLOCK);
+  }
+  self->granted_ = true;
   return true;
 }
 
-void LockManager::AddEdge(txn_id_t t1, txn_id_t t2) {}
+bool LockManager::ReleaseLock(Transaction *txn, LockRequestQueue *queue, LockMode *lock_mode) {
+  txn_id_t txn_id = txn->GetTransactionId();
+  auto &requests = queue->request_queue_;
+  auto it = std::find_if(requests.begin(), requests.end(),
+                         [txn_id](const LockRequest &request) { return request.txn_id_ == txn_id; });
+  if (it == requests.end()) {
+    return false;
+  }
+  *lock_mode = it->lock_mode_;
+  requests.erase(it);
+  queue->cv_.notify_all();
+  return true;
+}
+
+void LockManager::AddEdge(txn_id_t t1, txn_id_t t2) {
+  std::lock_guard<std::mutex> graph_guard(graph_latch_);
+  auto &edges = waits_for_[t1];
+  if (std::find(edges.begin(), edges.end(), t2) == edges.end()) {
+    edges.push_back(t2);
+  }
+}
+
+void LockManager::RemoveEdge(txn_id_t t1, txn_id_t t2) {
+  std::lock_guard<std::mutex> graph_guard(graph_latch_);
+  auto it = waits_for_.find(t1);
+  if (it == waits_for_.end()) {
+    return;
+  }
+  it->second.erase(std::remove(it->second.begin(), it->second.end(), t2), it->second.end());
+  if (it->second.empty()) {
+    waits_for_.erase(it);
+  }
+}
+
+void LockManager::RemoveEdges(txn_id_t txn_id) {
+  std::lock_guard<std::mutex> graph_guard(graph_latch_);
+  waits_for_.erase(txn_id);
+}
 
-void LockManager::RemoveEdge(txn_id_t t1, txn_id_t t2) {}
+bool LockManager::HasCycle(txn_id_t *txn_id) {
+  std::lock_guard<std::mutex> graph_guard(graph_latch_);
+  // Depth first search in ascending txn id order, so that the victim does not depend on the hash map layout.
+  std::vector<txn_id_t> sources;
+  sources.reserve(waits_for_.size());
+  for (const auto &node : waits_for_) {
+    sources.push_back(node.first);
+  }
+  std::sort(sources.begin(), sources.end());
 
-bool LockManager::HasCycle(txn_id_t *txn_id) { return false; }
+  std::unordered_set<txn_id_t> visited;
+  std::vector<txn_id_t> path;
+  std::unordered_set<txn_id_t> on_path;
+  std::function<bool(txn_id_t)> dfs = [&](txn_id_t node) {
+    visited.insert(node);
+    path.push_back(node);
+    on_path.insert(node);
+    auto it = waits_for_.find(node);
+    if (it != waits_for_.end()) {
+      std::vector<txn_id_t> successors = it->second;
+      std::sort(successors.begin(), successors.end());
+      for (txn_id_t next : successors) {
+        if (on_path.count(next) != 0) {
+          // The cycle is the suffix of the path starting at next, its newest transaction is the victim.
+          *txn_id = *std::max_element(std::find(path.begin(), path.end(), next), path.end());
+          return true;
+        }
+        if (visited.count(next) == 0 && dfs(next)) {
+          return true;
+        }
+      }
+    }
+    path.pop_back();
+    on_path.erase(node);
+    return false;
+  };
+  for (txn_id_t source : sources) {
+    if (visited.count(source) == 0 && dfs(source)) {
+      return true;
+    }
+  }
+  return false;
+}
 
-std::vector<std::pair<txn_id_t, txn_id_t>> LockManager::GetEdgeList() { return {}; }
+std::vector<std::pair<txn_id_t, txn_id_t>> LockManager::GetEdgeList() {
+  std::lock_guard<std::mutex> graph_guard(graph_latch_);
+  std::vector<std::pair<txn_id_t, txn_id_t>> edges;
+  for (const auto &node : waits_for_) {
+    for (txn_id_t next : node.second) {
+      edges.emplace_back(node.first, next);
+    }
+  }
+  return edges;
+}
+
+DeadlockStats LockManager::GetDeadlockStats() {
+  std::unique_lock<std::mutex> guard(latch_);
+  return stats_;
+}
 
 void LockManager::RunCycleDetection() {
   while (enable_cycle_detection_) {
     std::this_thread::sleep_for(cycle_detection_interval);
     {
       std::unique_lock<std::mutex> l(latch_);
-      // TODO(student): remove the continue and add your cycle detection and abort code here
-      continue;
+      auto start = std::chrono::steady_clock::now();
+      // Dropping the outgoing edges of the victim breaks its cycle, so this ends once the graph has no cycle left.
+      // The edges of a transaction that is not waiting here are stale and dropped without aborting it.
+      txn_id_t victim;
+      while (HasCycle(&victim)) {
+        auto it = waiting_.find(victim);
+        if (it != waiting_.end()) {
+          AbortVictim(it->second.first);
+        }
+        RemoveEdges(victim);
+      }
+      stats_.detector_runs_++;
+      stats_.detector_time_ +=
+          std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
     }
   }
 }
@@ -23,6 +23,10 @@ namespace bustub {
 std::unordered_map<txn_id_t, Transaction *> TransactionManager::txn_map = {};
 
 Transaction *TransactionManager::Begin(Transaction *txn, IsolationLevel isolation_level) {
+  if (!enable_snapshot_isolation_ &&
+      (txn == nullptr ? isolation_level : txn->GetIsolationLevel()) == IsolationLevel::SNAPSHOT_ISOLATION) {
+    throw Exception("snapshot isolation is not enabled in this transaction manager");
+  }
   // Acquire the global transaction latch in shared mode.
   global_txn_latch_.RLock();
 
@@ -31,14 +35,55 @@ Transaction *TransactionManager::Begin(Transaction *txn, IsolationLevel isolatio
   }
 
   txn_map[txn->GetTransactionId()] = txn;
+  txn->SetKeepsVersions(enable_snapshot_isolation_);
+
+  {
+    // A checkpoint must not see the BEGIN record without the running transaction, the log may be truncated up to it.
+    std::lock_guard<std::mutex> guard(running_latch_);
+    if (enable_logging) {
+      LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::BEGIN);
+      txn->SetPrevLSN(log_manager_->AppendLogRecord(&log_record));
+      txn->SetBeginLSN(txn->GetPrevLSN());
+    }
+    running_txns_[txn->GetTransactionId()] = txn;
+  }
+
+  // Take the snapshot of the latest commit.
+  std::lock_guard<std::mutex> guard(timestamp_latch_);
+  txn->SetReadTs(last_commit_ts_);
+  if (txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION) {
+    active_snapshots_.insert(txn->GetReadTs());
+  }
   return txn;
 }
 
 void TransactionManager::Commit(Transaction *txn) {
+  if (txn->GetState() == TransactionState::ABORTED) {
+    throw TransactionAbortException(txn->GetTransactionId(), AbortReason::DEADLOCK);
+  }
   txn->SetState(TransactionState::COMMITTED);
+  RegisterVersionStores(txn);
 
-  // Perform all deletes before we commit.
   auto write_set = txn->GetWriteSet();
+  {
+    // Stamp the versions written by the transaction. They become visible to the snapshots taken from now on.
+    std::lock_guard<std::mutex> guard(timestamp_latch_);
+    if (!write_set->empty()) {
+      timestamp_t commit_ts = last_commit_ts_ + 1;
+      if (txn->KeepsVersions()) {
+        for (const auto &item : *write_set) {
+          item.table_->GetVersionStore()->Commit(item.rid_, txn, commit_ts);
+        }
+      }
+      txn->SetCommitTs(commit_ts);
+      last_commit_ts_ = commit_ts;
+    }
+    if (txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION) {
+      active_snapshots_.erase(active_snapshots_.find(txn->GetReadTs()));
+    }
+  }
+
+  // Perform all deletes before we commit.
   while (!write_set->empty()) {
     auto &item = write_set->back();
     auto table = item.table_;
@@ -50,6 +95,18 @@ void TransactionManager::Commit(Transaction *txn) {
   }
   write_set->clear();
 
+  if (enable_logging) {
+    // Wait until the commit record is durable. Commits that reach the log buffer together are flushed together.
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::COMMIT);
+    lsn_t lsn = log_manager_->AppendLogRecord(&log_record);
+    txn->SetPrevLSN(lsn);
+    log_manager_->Flush(lsn);
+  }
+  {
+    std::lock_guard<std::mutex> guard(running_latch_);
+    running_txns_.erase(txn->GetTransactionId());
+  }
+
   // Release all the locks.
   ReleaseLocks(txn);
   // Release the global transaction latch.
@@ -58,6 +115,7 @@ void TransactionManager::Commit(Transaction *txn) {
 
 void TransactionManager::Abort(Transaction *txn) {
   txn->SetState(TransactionState::ABORTED);
+  RegisterVersionStores(txn);
   // Rollback before releasing the lock.
   auto table_write_set = txn->GetWriteSet();
   while (!table_write_set->empty()) {
@@ -100,12 +158,94 @@ void TransactionManager::Abort(Transaction *txn) {
   table_write_set->clear();
   index_write_set->clear();
 
+  if (enable_logging) {
+    LogRecord log_record(txn->GetTransactionId(), txn->GetPrevLSN(), LogRecordType::ABORT);
+    txn->SetPrevLSN(log_manager_->AppendLogRecord(&log_record));
+  }
+  {
+    std::lock_guard<std::mutex> guard(running_latch_);
+    running_txns_.erase(txn->GetTransactionId());
+  }
+
+  if (txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION) {
+    std::lock_guard<std::mutex> guard(timestamp_latch_);
+    active_snapshots_.erase(active_snapshots_.find(txn->GetReadTs()));
+  }
+
   // Release all the locks.
   ReleaseLocks(txn);
   // Release the global transaction latch.
   global_txn_latch_.RUnlock();
 }
 
+timestamp_t TransactionManager::GetWatermark() {
+  std::lock_guard<std::mutex> guard(timestamp_latch_);
+  return active_snapshots_.empty() ? last_commit_ts_ : *active_snapshots_.begin();
+}
+
+size_t TransactionManager::GarbageCollect() {
+  timestamp_t watermark = GetWatermark();
+  std::lock_guard<std::mutex> guard(version_store_latch_);
+  size_t reclaimed = 0;
+  for (auto *store : version_stores_) {
+    reclaimed += store->GarbageCollect(watermark);
+  }
+  return reclaimed;
+}
+
+void TransactionManager::RegisterVersionStores(Transaction *txn) {
+  if (!txn->KeepsVersions()) {
+    return;
+  }
+  for (const auto &item : *txn->GetWriteSet()) {
+    auto *store = item.table_->GetVersionStore();
+    if (store->GetOwner() == this) {
+      continue;
+    }
+    std::lock_guard<std::mutex> guard(version_store_latch_);
+    if (store->GetOwner() == nullptr) {
+      store->SetOwner(this);
+      version_stores_.insert(store);
+    }
+  }
+}
+
+void TransactionManager::UnregisterVersionStore(VersionStore *store) {
+  std::lock_guard<std::mutex> guard(version_store_latch_);
+  version_stores_.erase(store);
+}
+
+void TransactionManager::RunGarbageCollection() {
+  while (enable_gc_) {
+    std::this_thread::sleep_for(gc_interval);
+    GarbageCollect();
+  }
+}
+
+std::unordered_map<txn_id_t, lsn_t> TransactionManager::GetActiveTransactionTable() {
+  std::lock_guard<std::mutex> guard(running_latch_);
+  std::unordered_map<txn_id_t, lsn_t> active_txn_table;
+  for (const auto &entry : running_txns_) {
+    lsn_t last_lsn = entry.second->GetPrevLSN();
+    if (last_lsn != INVALID_LSN) {
+      active_txn_table[entry.first] = last_lsn;
+    }
+  }
+  return active_txn_table;
+}
+
+lsn_t TransactionManager::GetOldestBeginLSN() {
+  std::lock_guard<std::mutex> guard(running_latch_);
+  lsn_t oldest = INVALID_LSN;
+  for (const auto &entry : running_txns_) {
+    lsn_t begin_lsn = entry.second->GetBeginLSN();
+    if (begin_lsn != INVALID_LSN && (oldest == INVALID_LSN || begin_lsn < oldest)) {
+      oldest = begin_lsn;
+    }
+  }
+  return oldest;
+}
+
 void TransactionManager::BlockAllTransactions() { global_txn_latch_.WLock(); }
 
 void TransactionManager::ResumeTransactions() { global_txn_latch_.WUnlock(); }
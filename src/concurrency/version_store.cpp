@@ -0,0 +1,142 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// version_store.cpp
+//
+// Identification: src/concurrency/version_store.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "concurrency/version_store.h"
+
+#include <algorithm>
+#include <iterator>
+
+#include "concurrency/transaction_manager.h"
+
+namespace bustub {
+
+VersionStore::~VersionStore() {
+  auto *owner = owner_.load();
+  if (owner != nullptr) {
+    owner->UnregisterVersionStore(this);
+  }
+}
+
+bool VersionStore::CanWrite(const RID &rid, Transaction *txn) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = chains_.find(rid);
+  if (it == chains_.end() || it->second.writer_ == txn->GetTransactionId()) {
+    return true;
+  }
+  return it->second.writer_ == INVALID_TXN_ID && it->second.ts_ <= txn->GetReadTs();
+}
+
+void VersionStore::RecordWrite(const RID &rid, Transaction *txn, const Tuple *old_tuple, bool deleted) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = chains_.find(rid);
+  if (it == chains_.end()) {
+    // The tuple was never versioned, so its previous version is visible to every snapshot.
+    it = chains_.emplace(rid, VersionChain{}).first;
+    it->second.ts_ = 0;
+  }
+  auto &chain = it->second;
+  if (chain.writer_ != txn->GetTransactionId()) {
+    // Later writes of the same transaction are never visible to others, only its first write saves a version.
+    chain.undo_.push_front({old_tuple == nullptr ? Tuple{} : *old_tuple, old_tuple == nullptr, chain.ts_});
+    chain.writer_ = txn->GetTransactionId();
+    chain.writes_ = 0;
+    chain.ts_ = INVALID_TS;
+  }
+  chain.writes_++;
+  chain.deleted_ = deleted;
+}
+
+void VersionStore::Commit(const RID &rid, Transaction *txn, timestamp_t commit_ts) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = chains_.find(rid);
+  if (it == chains_.end() || it->second.writer_ != txn->GetTransactionId()) {
+    return;
+  }
+  it->second.writer_ = INVALID_TXN_ID;
+  it->second.writes_ = 0;
+  it->second.ts_ = commit_ts;
+}
+
+void VersionStore::Rollback(const RID &rid, Transaction *txn) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = chains_.find(rid);
+  if (it == chains_.end() || it->second.writer_ != txn->GetTransactionId()) {
+    return;
+  }
+  auto &chain = it->second;
+  if (--chain.writes_ > 0) {
+    return;
+  }
+  // The page holds the previous version again.
+  chain.writer_ = INVALID_TXN_ID;
+  chain.deleted_ = chain.undo_.front().deleted_;
+  chain.ts_ = chain.undo_.front().ts_;
+  chain.undo_.pop_front();
+}
+
+VersionStore::Visibility VersionStore::GetVisibleVersion(const RID &rid, Transaction *txn, Tuple *tuple) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = chains_.find(rid);
+  if (it == chains_.end()) {
+    return Visibility::IN_PLACE;
+  }
+  const auto &chain = it->second;
+  if (chain.writer_ == txn->GetTransactionId() ||
+      (chain.writer_ == INVALID_TXN_ID && chain.ts_ <= txn->GetReadTs())) {
+    return chain.deleted_ ? Visibility::NONE : Visibility::IN_PLACE;
+  }
+  for (const auto &version : chain.undo_) {
+    if (version.ts_ <= txn->GetReadTs()) {
+      if (version.deleted_) {
+        return Visibility::NONE;
+      }
+      *tuple = version.tuple_;
+      return Visibility::UNDO;
+    }
+  }
+  return Visibility::NONE;
+}
+
+size_t VersionStore::GarbageCollect(timestamp_t watermark) {
+  std::lock_guard<std::mutex> guard(latch_);
+  size_t reclaimed = 0;
+  for (auto it = chains_.begin(); it != chains_.end();) {
+    auto &chain = it->second;
+    if (chain.writer_ == INVALID_TXN_ID && chain.ts_ <= watermark) {
+      // Every snapshot sees the in-place version.
+      reclaimed += chain.undo_.size();
+      it = chains_.erase(it);
+      continue;
+    }
+    // Keep the versions down to the first one that every snapshot can see.
+    auto oldest = std::find_if(chain.undo_.begin(), chain.undo_.end(),
+                               [watermark](const UndoVersion &version) { return version.ts_ <= watermark; });
+    if (oldest != chain.undo_.end()) {
+      ++oldest;
+      reclaimed += std::distance(oldest, chain.undo_.end());
+      chain.undo_.erase(oldest, chain.undo_.end());
+    }
+    ++it;
+  }
+  return reclaimed;
+}
+
+size_t VersionStore::GetVersionCount() {
+  std::lock_guard<std::mutex> guard(latch_);
+  size_t count = 0;
+  for (const auto &chain : chains_) {
+    count += chain.second.undo_.size();
+  }
+  return count;
+}
+
+}  // namespace bustub
@@ -0,0 +1,339 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// batch_aggregation_executor.cpp
+//
+// Identification: src/execution/batch_aggregation_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/batch_aggregation_executor.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/abstract_expression.h"
+#include "execution/worker_pool.h"
+
+namespace bustub {
+
+BatchAggregationTable::BatchAggregationTable(const AggregationPlanNode *plan) : plan_(plan) {
+  for (const auto *group_by : plan_->GetGroupBys()) {
+    group_keys_.emplace_back(group_by->GetReturnType());
+  }
+  for (uint32_t i = 0; i < plan_->GetAggregates().size(); i++) {
+    bool is_count = plan_->GetAggregateTypes()[i] == AggregationType::CountAggregate;
+    aggregates_.emplace_back(is_count ? TypeId::INTEGER : plan_->GetAggregateAt(i)->GetReturnType());
+  }
+}
+
+void BatchAggregationTable::Aggregate(const std::vector<const ColumnVector *> &keys,
+                                      const std::vector<const ColumnVector *> &values,
+                                      const std::vector<hash_t> &hashes, const std::vector<uint32_t> &rows) {
+  if (rows.empty()) {
+    return;
+  }
+  row_groups_.resize(std::max<size_t>(row_groups_.size(), rows.back() + 1));
+  for (uint32_t row : rows) {
+    row_groups_[row] = FindGroup(keys, row, hashes[row]);
+  }
+  for (uint32_t i = 0; i < aggregates_.size(); i++) {
+    Combine(plan_->GetAggregateTypes()[i], *values[i], rows, &aggregates_[i]);
+  }
+}
+
+void BatchAggregationTable::Merge(const BatchAggregationTable &other) {
+  std::vector<const ColumnVector *> keys;
+  for (const auto &key : other.group_keys_) {
+    keys.push_back(&key);
+  }
+  std::vector<uint32_t> groups(other.num_groups_);
+  for (uint32_t group = 0; group < other.num_groups_; group++) {
+    groups[group] = group;
+  }
+  if (groups.empty()) {
+    return;
+  }
+  row_groups_.resize(std::max<size_t>(row_groups_.size(), other.num_groups_));
+  for (uint32_t group : groups) {
+    row_groups_[group] = FindGroup(keys, group, other.group_hashes_[group]);
+  }
+  for (uint32_t i = 0; i < aggregates_.size(); i++) {
+    // Partial counts add up.
+    AggregationType agg_type = plan_->GetAggregateTypes()[i];
+    Combine(agg_type == AggregationType::CountAggregate ? AggregationType::SumAggregate : agg_type,
+            other.aggregates_[i], groups, &aggregates_[i]);
+  }
+}
+
+void BatchAggregationTable::GetGroup(uint32_t group, std::vector<Value> *group_bys,
+                                     std::vector<Value> *aggregates) const {
+  group_bys->resize(group_keys_.size());
+  for (uint32_t i = 0; i < group_keys_.size(); i++) {
+    (*group_bys)[i] = group_keys_[i].GetValue(group);
+  }
+  aggregates->resize(aggregates_.size());
+  for (uint32_t i = 0; i < aggregates_.size(); i++) {
+    (*aggregates)[i] = aggregates_[i].GetValue(group);
+  }
+}
+
+uint32_t BatchAggregationTable::FindGroup(const std::vector<const ColumnVector *> &keys, uint32_t row, hash_t hash) {
+  auto range = group_index_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    bool equal = true;
+    for (uint32_t i = 0; equal && i < keys.size(); i++) {
+      equal = group_keys_[i].RowEquals(it->second, *keys[i], row);
+    }
+    if (equal) {
+      return it->second;
+    }
+  }
+
+  uint32_t group = num_groups_++;
+  for (uint32_t i = 0; i < keys.size(); i++) {
+    group_keys_[i].Resize(num_groups_);
+    group_keys_[i].CopyRow(group, *keys[i], row);
+  }
+  for (uint32_t i = 0; i < aggregates_.size(); i++) {
+    aggregates_[i].Resize(num_groups_);
+    if (plan_->GetAggregateTypes()[i] == AggregationType::CountAggregate) {
+      aggregates_[i].SetInteger(group, 0);
+    } else {
+      aggregates_[i].SetNull(group);
+    }
+  }
+  group_hashes_.push_back(hash);
+  group_index_.emplace(hash, group);
+  return group;
+}
+
+void BatchAggregationTable::Combine(AggregationType agg_type, const ColumnVector &values,
+                                    const std::vector<uint32_t> &rows, ColumnVector *aggregate) {
+  if (agg_type == AggregationType::CountAggregate) {
+    for (uint32_t row : rows) {
+      uint32_t group = row_groups_[row];
+      aggregate->SetInteger(group, aggregate->GetInteger(group) + 1);
+    }
+    return;
+  }
+
+  // Folds the non-NULL values into the groups, where fold(group, row) combines the value of row into the non-NULL
+  // aggregate of group.
+  auto fold_rows = [&](auto set_first, auto fold) {
+    for (uint32_t row : rows) {
+      if (values.IsNull(row)) {
+        continue;
+      }
+      uint32_t group = row_groups_[row];
+      if (aggregate->IsNull(group)) {
+        set_first(group, row);
+      } else {
+        fold(group, row);
+      }
+    }
+  };
+  auto copy_first = [&](uint32_t group, uint32_t row) { aggregate->CopyRow(group, values, row); };
+
+  if (ColumnVector::IsIntegral(aggregate->GetType()) && ColumnVector::IsIntegral(values.GetType())) {
+    switch (agg_type) {
+      case AggregationType::SumAggregate:
+        return fold_rows(copy_first, [&](uint32_t group, uint32_t row) {
+          aggregate->SetInteger(group, aggregate->GetInteger(group) + values.GetInteger(row));
+        });
+      case AggregationType::MinAggregate:
+        return fold_rows(copy_first, [&](uint32_t group, uint32_t row) {
+          aggregate->SetInteger(group, std::min(aggregate->GetInteger(group), values.GetInteger(row)));
+        });
+      case AggregationType::MaxAggregate:
+        return fold_rows(copy_first, [&](uint32_t group, uint32_t row) {
+          aggregate->SetInteger(group, std::max(aggregate->GetInteger(group), values.GetInteger(row)));
+        });
+      default:
+        break;
+    }
+  } else if (aggregate->GetType() == TypeId::DECIMAL && values.GetType() != TypeId::VARCHAR) {
+    auto set_first = [&](uint32_t group, uint32_t row) { aggregate->SetDecimal(group, values.GetNumeric(row)); };
+    switch (agg_type) {
+      case AggregationType::SumAggregate:
+        return fold_rows(set_first, [&](uint32_t group, uint32_t row) {
+          aggregate->SetDecimal(group, aggregate->GetDecimal(group) + values.GetNumeric(row));
+        });
+      case AggregationType::MinAggregate:
+        return fold_rows(set_first, [&](uint32_t group, uint32_t row) {
+          aggregate->SetDecimal(group, std::min(aggregate->GetDecimal(group), values.GetNumeric(row)));
+        });
+      case AggregationType::MaxAggregate:
+        return fold_rows(set_first, [&](uint32_t group, uint32_t row) {
+          aggregate->SetDecimal(group, std::max(aggregate->GetDecimal(group), values.GetNumeric(row)));
+        });
+      default:
+        break;
+    }
+  }
+
+  // Anything else, such as MIN and MAX of VARCHARs, goes through Value.
+  fold_rows(copy_first, [&](uint32_t group, uint32_t row) {
+    Value current = aggregate->GetValue(group);
+    Value value = values.GetValue(row);
+    switch (agg_type) {
+      case AggregationType::SumAggregate:
+        aggregate->SetValue(group, current.Add(value));
+        break;
+      case AggregationType::MinAggregate:
+        aggregate->SetValue(group, current.Min(value));
+        break;
+      case AggregationType::MaxAggregate:
+        aggregate->SetValue(group, current.Max(value));
+        break;
+      default:
+        break;
+    }
+  });
+}
+
+BatchAggregationExecutor::BatchAggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
+                                                   std::unique_ptr<AbstractExecutor> &&child)
+    : AbstractBatchExecutor(exec_ctx), plan_(plan), child_(std::move(child)) {}
+
+void BatchAggregationExecutor::Init() {
+  AbstractBatchExecutor::Init();
+  child_->Init();
+  for (size_t partition = 0; partition < NUM_PARTITIONS; partition++) {
+    partials_[partition].clear();
+    results_[partition].reset();
+  }
+  next_merge_ = 0;
+  next_partition_ = 0;
+  next_group_ = 0;
+
+  RunInParallel([this](size_t) { PreAggregate(); });
+  RunInParallel([this](size_t) { MergePartitions(); });
+}
+
+void BatchAggregationExecutor::RunInParallel(const std::function<void(size_t)> &f) {
+  WorkerPool *pool = exec_ctx_->GetWorkerPool();
+  // The instances of a parallel plan fragment are already running in parallel.
+  if (pool == nullptr || exec_ctx_->GetParallelContext() != nullptr) {
+    f(0);
+    return;
+  }
+  pool->RunInParallel(execution_threads, f);
+}
+
+void BatchAggregationExecutor::PreAggregate() {
+  std::array<std::unique_ptr<BatchAggregationTable>, NUM_PARTITIONS> tables;
+  std::array<std::vector<uint32_t>, NUM_PARTITIONS> partition_rows;
+  TupleBatch input;
+  std::vector<ColumnVector> key_scratch(plan_->GetGroupBys().size());
+  std::vector<ColumnVector> value_scratch(plan_->GetAggregates().size());
+  std::vector<const ColumnVector *> keys(key_scratch.size());
+  std::vector<const ColumnVector *> values(value_scratch.size());
+  std::vector<hash_t> hashes;
+
+  while (true) {
+    {
+      std::lock_guard<std::mutex> guard(child_latch_);
+      if (!child_->NextBatch(&input)) {
+        break;
+      }
+    }
+    const auto &rows = input.GetSelection();
+    for (uint32_t i = 0; i < keys.size(); i++) {
+      keys[i] = &plan_->GetGroupByAt(i)->EvaluateBatch(input, &key_scratch[i]);
+    }
+    for (uint32_t i = 0; i < values.size(); i++) {
+      values[i] = &plan_->GetAggregateAt(i)->EvaluateBatch(input, &value_scratch[i]);
+    }
+
+    // Hash the group-by values column by column, then route every row to the partition of its hash.
+    hashes.assign(input.NumRows(), 0);
+    for (const auto *key : keys) {
+      for (uint32_t row : rows) {
+        hashes[row] = HashUtil::CombineHashes(hashes[row], key->HashRow(row));
+      }
+    }
+    for (auto &partition : partition_rows) {
+      partition.clear();
+    }
+    for (uint32_t row : rows) {
+      partition_rows[HashUtil::MixHash(hashes[row]) % NUM_PARTITIONS].push_back(row);
+    }
+
+    for (size_t partition = 0; partition < NUM_PARTITIONS; partition++) {
+      if (partition_rows[partition].empty()) {
+        continue;
+      }
+      if (tables[partition] == nullptr) {
+        tables[partition] = std::make_unique<BatchAggregationTable>(plan_);
+      }
+      tables[partition]->Aggregate(keys, values, hashes, partition_rows[partition]);
+      if (tables[partition]->NumGroups() >= PREAGGREGATION_GROUPS) {
+        std::lock_guard<std::mutex> guard(partitions_latch_);
+        partials_[partition].emplace_back(std::move(tables[partition]));
+      }
+    }
+  }
+
+  std::lock_guard<std::mutex> guard(partitions_latch_);
+  for (size_t partition = 0; partition < NUM_PARTITIONS; partition++) {
+    if (tables[partition] != nullptr) {
+      partials_[partition].emplace_back(std::move(tables[partition]));
+    }
+  }
+}
+
+void BatchAggregationExecutor::MergePartitions() {
+  for (size_t partition = next_merge_++; partition < NUM_PARTITIONS; partition = next_merge_++) {
+    auto &partials = partials_[partition];
+    if (partials.empty()) {
+      continue;
+    }
+    // Merge into the largest table, which has the most groups already in place.
+    auto largest = std::max_element(partials.begin(), partials.end(), [](const auto &a, const auto &b) {
+      return a->NumGroups() < b->NumGroups();
+    });
+    std::swap(*largest, partials.front());
+    for (size_t i = 1; i < partials.size(); i++) {
+      partials.front()->Merge(*partials[i]);
+      partials[i].reset();
+    }
+    results_[partition] = std::move(partials.front());
+    partials.clear();
+  }
+}
+
+bool BatchAggregationExecutor::NextBatch(TupleBatch *batch) {
+  batch->Reset(GetOutputSchema());
+  const Schema *output_schema = GetOutputSchema();
+  std::vector<Value> group_bys;
+  std::vector<Value> aggregates;
+  while (!batch->IsFull() && next_partition_ < NUM_PARTITIONS) {
+    const BatchAggregationTable *table = results_[next_partition_].get();
+    if (table == nullptr || next_group_ >= table->NumGroups()) {
+      next_partition_++;
+      next_group_ = 0;
+      continue;
+    }
+    table->GetGroup(next_group_++, &group_bys, &aggregates);
+    if (plan_->GetHaving() != nullptr) {
+      Value having = plan_->GetHaving()->EvaluateAggregate(group_bys, aggregates);
+      if (having.IsNull() || !having.GetAs<bool>()) {
+        continue;
+      }
+    }
+    uint32_t row = batch->AppendRow();
+    for (uint32_t i = 0; i < output_schema->GetColumnCount(); i++) {
+      const AbstractExpression *expr = output_schema->GetColumn(i).GetExpr();
+      batch->GetMutableColumn(i)->SetValue(row, expr->EvaluateAggregate(group_bys, aggregates));
+    }
+  }
+  return batch->NumRows() > 0;
+}
+
+}  // namespace bustub
@@ -0,0 +1,49 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// batch_filter_executor.cpp
+//
+// Identification: src/execution/batch_filter_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/batch_filter_executor.h"
+
+#include <memory>
+#include <utility>
+
+namespace bustub {
+
+BatchFilterExecutor::BatchFilterExecutor(ExecutorContext *exec_ctx, const AbstractExpression *predicate,
+                                         std::unique_ptr<AbstractExecutor> &&child)
+    : AbstractBatchExecutor(exec_ctx), predicate_(predicate), child_(std::move(child)) {}
+
+void BatchFilterExecutor::Init() {
+  AbstractBatchExecutor::Init();
+  child_->Init();
+  if (program_ == nullptr && enable_compiled_expressions) {
+    program_ = ExpressionProgram::Compile(predicate_, child_->GetOutputSchema());
+  } else if (program_ != nullptr) {
+    program_->LoadParameters();
+  }
+}
+
+bool BatchFilterExecutor::NextBatch(TupleBatch *batch) {
+  // Batches whose rows are all filtered out are skipped.
+  while (child_->NextBatch(batch)) {
+    if (program_ != nullptr) {
+      program_->Filter(batch);
+    } else {
+      batch->Select(predicate_->EvaluateBatch(*batch, &result_));
+    }
+    if (batch->NumSelected() > 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace bustub
@@ -0,0 +1,137 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// batch_nested_loop_join_executor.cpp
+//
+// Identification: src/execution/batch_nested_loop_join_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/batch_nested_loop_join_executor.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/abstract_expression.h"
+
+namespace bustub {
+
+BatchNestedLoopJoinExecutor::BatchNestedLoopJoinExecutor(ExecutorContext *exec_ctx,
+                                                         const NestedLoopJoinPlanNode *plan,
+                                                         std::unique_ptr<AbstractExecutor> &&left_executor,
+                                                         std::unique_ptr<AbstractExecutor> &&right_executor)
+    : AbstractBatchExecutor(exec_ctx),
+      plan_(plan),
+      left_executor_(std::move(left_executor)),
+      right_executor_(std::move(right_executor)) {}
+
+void BatchNestedLoopJoinExecutor::Init() {
+  AbstractBatchExecutor::Init();
+  left_executor_->Init();
+  right_executor_->Init();
+
+  // The schema and the program built by an earlier Init() are kept; the program only reloads the parameters.
+  if (joined_schema_ == nullptr) {
+    std::vector<Column> columns = left_executor_->GetOutputSchema()->GetColumns();
+    const auto &right_columns = right_executor_->GetOutputSchema()->GetColumns();
+    columns.insert(columns.end(), right_columns.begin(), right_columns.end());
+    joined_schema_ = std::make_unique<Schema>(columns);
+  }
+  if (program_ == nullptr && plan_->Predicate() != nullptr && enable_compiled_expressions) {
+    program_ = ExpressionProgram::Compile(plan_->Predicate(), left_executor_->GetOutputSchema(),
+                                          right_executor_->GetOutputSchema());
+  } else if (program_ != nullptr) {
+    program_->LoadParameters();
+  }
+
+  right_batches_.clear();
+  right_batches_.emplace_back();
+  while (right_executor_->NextBatch(&right_batches_.back())) {
+    right_batches_.emplace_back();
+  }
+  right_batches_.pop_back();
+
+  left_batch_.Reset(nullptr);
+  left_position_ = 0;
+  right_position_ = 0;
+}
+
+bool BatchNestedLoopJoinExecutor::NextBatch(TupleBatch *batch) {
+  batch->Reset(GetOutputSchema());
+  if (right_batches_.empty()) {
+    return false;
+  }
+  while (true) {
+    if (left_position_ >= left_batch_.NumSelected()) {
+      if (!left_executor_->NextBatch(&left_batch_)) {
+        break;
+      }
+      left_position_ = 0;
+      right_position_ = 0;
+    } else if (right_position_ >= right_batches_.size()) {
+      left_position_++;
+      right_position_ = 0;
+    } else {
+      const TupleBatch &right = right_batches_[right_position_];
+      // Stop before a right batch could overflow the output.
+      if (batch->NumRows() + right.NumSelected() > static_cast<uint32_t>(BATCH_SIZE)) {
+        break;
+      }
+      JoinRow(left_batch_.GetSelection()[left_position_], right, batch);
+      right_position_++;
+    }
+  }
+  return batch->NumRows() > 0;
+}
+
+void BatchNestedLoopJoinExecutor::JoinRow(uint32_t left_row, const TupleBatch &right, TupleBatch *batch) {
+  uint32_t left_column_count = left_batch_.NumColumns();
+  uint32_t num_pairs = right.NumSelected();
+  joined_.Reset(joined_schema_.get());
+  for (uint32_t i = 0; i < num_pairs; i++) {
+    joined_.AppendRow();
+  }
+  for (uint32_t col = 0; col < left_column_count; col++) {
+    ColumnVector *column = joined_.GetMutableColumn(col);
+    for (uint32_t i = 0; i < num_pairs; i++) {
+      column->CopyRow(i, left_batch_.GetColumn(col), left_row);
+    }
+  }
+  for (uint32_t col = 0; col < right.NumColumns(); col++) {
+    ColumnVector *column = joined_.GetMutableColumn(left_column_count + col);
+    for (uint32_t i = 0; i < num_pairs; i++) {
+      column->CopyRow(i, right.GetColumn(col), right.GetSelection()[i]);
+    }
+  }
+
+  if (program_ != nullptr) {
+    program_->Filter(&joined_);
+  } else if (plan_->Predicate() != nullptr) {
+    joined_.Select(plan_->Predicate()->EvaluateJoinBatch(joined_, left_column_count, &predicate_scratch_));
+  }
+  const auto &pairs = joined_.GetSelection();
+  if (pairs.empty()) {
+    return;
+  }
+  uint32_t first_row = batch->NumRows();
+  for (size_t i = 0; i < pairs.size(); i++) {
+    batch->AppendRow();
+  }
+  const Schema *output_schema = GetOutputSchema();
+  for (uint32_t col = 0; col < output_schema->GetColumnCount(); col++) {
+    const Column &column = output_schema->GetColumn(col);
+    const ColumnVector &values = column.GetExpr() != nullptr
+                                     ? column.GetExpr()->EvaluateJoinBatch(joined_, left_column_count, &scratch_)
+                                     : joined_.GetColumn(joined_schema_->GetColIdx(column.GetName()));
+    ColumnVector *output = batch->GetMutableColumn(col);
+    for (size_t i = 0; i < pairs.size(); i++) {
+      output->CopyRow(first_row + i, values, pairs[i]);
+    }
+  }
+}
+
+}  // namespace bustub
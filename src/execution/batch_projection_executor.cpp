@@ -0,0 +1,55 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// batch_projection_executor.cpp
+//
+// Identification: src/execution/batch_projection_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/batch_projection_executor.h"
+
+#include <memory>
+#include <utility>
+
+#include "execution/expressions/abstract_expression.h"
+
+namespace bustub {
+
+BatchProjectionExecutor::BatchProjectionExecutor(ExecutorContext *exec_ctx, const Schema *output_schema,
+                                                 std::unique_ptr<AbstractExecutor> &&child)
+    : AbstractBatchExecutor(exec_ctx), output_schema_(output_schema), child_(std::move(child)) {}
+
+void BatchProjectionExecutor::Init() {
+  AbstractBatchExecutor::Init();
+  child_->Init();
+}
+
+bool BatchProjectionExecutor::NextBatch(TupleBatch *batch) {
+  if (!child_->NextBatch(&input_)) {
+    return false;
+  }
+  batch->Reset(output_schema_);
+  batch->CopySelection(input_);
+  const Schema *input_schema = child_->GetOutputSchema();
+  for (uint32_t i = 0; i < output_schema_->GetColumnCount(); i++) {
+    const Column &column = output_schema_->GetColumn(i);
+    const ColumnVector &values = column.GetExpr() != nullptr
+                                     ? column.GetExpr()->EvaluateBatch(input_, &scratch_)
+                                     : input_.GetColumn(input_schema->GetColIdx(column.GetName()));
+    ColumnVector *output = batch->GetMutableColumn(i);
+    if (values.GetType() == output->GetType()) {
+      *output = values;
+    } else {
+      for (uint32_t row : input_.GetSelection()) {
+        output->CopyRow(row, values, row);
+      }
+    }
+  }
+  return true;
+}
+
+}  // namespace bustub
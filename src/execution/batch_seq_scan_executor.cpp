@@ -0,0 +1,87 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// batch_seq_scan_executor.cpp
+//
+// Identification: src/execution/batch_seq_scan_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/batch_seq_scan_executor.h"
+
+#include <memory>
+#include <vector>
+
+#include "common/exception.h"
+
+namespace bustub {
+
+BatchSeqScanExecutor::BatchSeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan)
+    : AbstractBatchExecutor(exec_ctx),
+      plan_(plan),
+      table_info_(exec_ctx->GetCatalog()->GetTable(plan->GetTableOid())) {}
+
+void BatchSeqScanExecutor::Init() {
+  AbstractBatchExecutor::Init();
+  ZoneMap *zone_map = table_info_->table_->GetZoneMap();
+  bounds_ = zone_map == nullptr ? std::vector<ZoneBound>() : zone_map->GetBounds(plan_->GetPredicate());
+  if (!bounds_.empty()) {
+    next_zone_ = 0;
+    tuples_.clear();
+    position_ = 0;
+    return;
+  }
+  iterator_ = std::make_unique<TableIterator>(table_info_->table_->Begin(exec_ctx_->GetTransaction()));
+}
+
+bool BatchSeqScanExecutor::NextBatch(TupleBatch *batch) {
+  batch->Reset(GetOutputSchema());
+  if (!bounds_.empty()) {
+    while (!batch->IsFull()) {
+      if (position_ == tuples_.size()) {
+        if (!ReadNextPage()) {
+          break;
+        }
+        continue;
+      }
+      const Tuple &tuple = tuples_[position_++];
+      batch->AppendTuple(tuple, tuple.GetRid());
+    }
+  } else {
+    // The iterator takes care of locking and of picking the visible version of each tuple.
+    const TableIterator end = table_info_->table_->End();
+    for (; !batch->IsFull() && *iterator_ != end; ++(*iterator_)) {
+      const Tuple &tuple = **iterator_;
+      batch->AppendTuple(tuple, tuple.GetRid());
+    }
+  }
+  if (filter_probe_ != nullptr) {
+    filter_probe_->Apply(batch);
+  }
+  return batch->NumRows() > 0;
+}
+
+bool BatchSeqScanExecutor::ReadNextPage() {
+  tuples_.clear();
+  position_ = 0;
+  size_t num_skipped = 0;
+  page_id_t page_id = table_info_->table_->GetZoneMap()->NextPage(&next_zone_, bounds_, &num_skipped);
+  exec_ctx_->AddSkippedPages(num_skipped);
+  if (page_id == INVALID_PAGE_ID) {
+    return false;
+  }
+  BufferPoolManager *bpm = exec_ctx_->GetBufferPoolManager();
+  auto *page = static_cast<TablePage *>(bpm->FetchPage(page_id));
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no free buffer pool frame for a sequential scan");
+  }
+  // Reading the page takes care of locking and of picking the visible version of each tuple, as the iterator does.
+  table_info_->table_->ReadPage(page, exec_ctx_->GetTransaction(), &tuples_);
+  bpm->UnpinPage(page_id, false);
+  return true;
+}
+
+}  // namespace bustub
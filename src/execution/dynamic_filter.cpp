@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// dynamic_filter.cpp
+//
+// Identification: src/execution/dynamic_filter.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/dynamic_filter.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/column_value_expression.h"
+
+namespace bustub {
+
+std::unique_ptr<DynamicFilter> DynamicFilter::ForScan(
+    const std::vector<std::pair<OrderByType, const AbstractExpression *>> &order_bys, const Schema *scan_schema) {
+  // A key on an output column is the expression that the scan projects into that column, on the table row. It must
+  // produce the type of the column, or the two would not encode alike.
+  std::vector<std::pair<OrderByType, const AbstractExpression *>> table_order_bys;
+  for (const auto &[direction, expr] : order_bys) {
+    auto *column_value = dynamic_cast<const ColumnValueExpression *>(expr);
+    if (column_value == nullptr || column_value->GetColIdx() >= scan_schema->GetColumnCount()) {
+      return nullptr;
+    }
+    const Column &column = scan_schema->GetColumn(column_value->GetColIdx());
+    if (column.GetExpr() == nullptr || column.GetExpr()->GetReturnType() != column.GetType()) {
+      return nullptr;
+    }
+    table_order_bys.emplace_back(direction, column.GetExpr());
+  }
+  return std::make_unique<DynamicFilter>(std::move(table_order_bys));
+}
+
+void DynamicFilter::Probe::Apply(TupleBatch *batch) {
+  uint64_t version = filter_->version_.load(std::memory_order_acquire);
+  if (version != version_) {
+    std::lock_guard<std::mutex> guard(filter_->latch_);
+    bound_ = filter_->bound_;
+    has_bound_ = filter_->has_bound_;
+    version_ = version;
+  }
+  if (!has_bound_ || batch->NumSelected() == 0) {
+    return;
+  }
+
+  encoder_.Evaluate(*batch);
+  std::vector<uint32_t> *selection = batch->GetMutableSelection();
+  size_t selected = 0;
+  for (uint32_t row : *selection) {
+    key_.clear();
+    encoder_.Encode(row, &key_);
+    if (key_ < bound_) {
+      (*selection)[selected++] = row;
+    }
+  }
+  filter_->num_filtered_.fetch_add(selection->size() - selected, std::memory_order_relaxed);
+  selection->resize(selected);
+}
+
+}  // namespace bustub
@@ -0,0 +1,113 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// exchange_executor.cpp
+//
+// Identification: src/execution/exchange_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/exchange_executor.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "common/util/hash_util.h"
+#include "execution/parallel_context.h"
+
+namespace bustub {
+
+ExchangeState::ExchangeState(const ExchangePlanNode *plan, size_t degree) : plan_(plan), producing_(degree) {
+  for (size_t i = 0; i < degree; i++) {
+    queues_.emplace_back(std::make_unique<TupleBatchQueue>(2 * degree));
+  }
+}
+
+void ExchangeState::Produce(size_t producer) {
+  try {
+    AbstractExecutor *child = producers_[producer].get();
+    child->Init();
+    const auto &keys = plan_->GetPartitionKeys();
+    size_t degree = queues_.size();
+    std::vector<TupleBatch> outputs(degree);
+    for (auto &output : outputs) {
+      output.Reset(plan_->OutputSchema());
+    }
+    std::vector<ColumnVector> scratch(keys.size());
+    std::vector<const ColumnVector *> key_columns(keys.size());
+    // Producers start dealing at different consumers.
+    size_t next_consumer = producer;
+
+    TupleBatch input;
+    bool open = true;
+    while (open && child->NextBatch(&input)) {
+      if (keys.empty()) {
+        open = queues_[next_consumer++ % degree]->Push(std::move(input));
+        continue;
+      }
+      for (size_t i = 0; i < keys.size(); i++) {
+        key_columns[i] = &keys[i]->EvaluateBatch(input, &scratch[i]);
+      }
+      for (uint32_t row : input.GetSelection()) {
+        hash_t hash = 0;
+        for (const auto *column : key_columns) {
+          hash = HashUtil::CombineHashes(hash, column->HashRow(row));
+        }
+        size_t consumer = HashUtil::MixHash(hash) % degree;
+        TupleBatch *output = &outputs[consumer];
+        uint32_t output_row = output->AppendRow(input.GetRID(row));
+        for (uint32_t col_idx = 0; col_idx < output->NumColumns(); col_idx++) {
+          output->GetMutableColumn(col_idx)->CopyRow(output_row, input.GetColumn(col_idx), row);
+        }
+        if (output->IsFull() && !Send(consumer, output)) {
+          open = false;
+          break;
+        }
+      }
+    }
+    for (size_t consumer = 0; open && consumer < degree; consumer++) {
+      if (outputs[consumer].NumRows() > 0) {
+        open = Send(consumer, &outputs[consumer]);
+      }
+    }
+  } catch (...) {
+    // The consumers stop at once; the exception reaches the Gather through the task.
+    Close();
+    throw;
+  }
+  if (--producing_ == 0) {
+    Close();
+  }
+}
+
+bool ExchangeState::Send(size_t consumer, TupleBatch *batch) {
+  bool sent = queues_[consumer]->Push(std::move(*batch));
+  batch->Reset(plan_->OutputSchema());
+  return sent;
+}
+
+void ExchangeState::Close() {
+  for (auto &queue : queues_) {
+    queue->Close();
+  }
+}
+
+void ExchangeExecutor::Init() {
+  AbstractBatchExecutor::Init();
+  ParallelContext *parallel_ctx = exec_ctx_->GetParallelContext();
+  queue_ = parallel_ctx->GetExchange(plan_, exec_ctx_)->GetQueue(exec_ctx_->GetInstance());
+}
+
+bool ExchangeExecutor::NextBatch(TupleBatch *batch) {
+  if (queue_->Pop(batch)) {
+    return true;
+  }
+  batch->Reset(GetOutputSchema());
+  return false;
+}
+
+}  // namespace bustub
@@ -16,24 +16,77 @@
 #include <utility>
 #include "execution/executors/abstract_executor.h"
 #include "execution/executors/aggregation_executor.h"
+#include "execution/executors/batch_aggregation_executor.h"
+#include "execution/executors/batch_filter_executor.h"
+#include "execution/executors/batch_nested_loop_join_executor.h"
+#include "execution/executors/batch_projection_executor.h"
+#include "execution/executors/batch_seq_scan_executor.h"
 #include "execution/executors/delete_executor.h"
+#include "execution/executors/exchange_executor.h"
+#include "execution/executors/gather_executor.h"
+#include "execution/executors/hash_join_executor.h"
 #include "execution/executors/index_scan_executor.h"
 #include "execution/executors/insert_executor.h"
 #include "execution/executors/limit_executor.h"
+#include "execution/executors/merge_join_executor.h"
 #include "execution/executors/nested_index_join_executor.h"
 #include "execution/executors/nested_loop_join_executor.h"
+#include "execution/executors/parallel_seq_scan_executor.h"
 #include "execution/executors/seq_scan_executor.h"
+#include "execution/executors/sort_executor.h"
+#include "execution/executors/topn_executor.h"
 #include "execution/executors/update_executor.h"
+#include "execution/parallel_context.h"
 #include "storage/index/generic_key.h"
 
 namespace bustub {
 
+namespace {
+
+/** Create the executor of a sequential scan whose batches a dynamic filter, if not nullptr, is applied to. */
+std::unique_ptr<AbstractExecutor> CreateSeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *seq_scan_plan,
+                                                        DynamicFilter *filter) {
+  if (!enable_vectorized_execution) {
+    return std::make_unique<SeqScanExecutor>(exec_ctx, seq_scan_plan);
+  }
+  ParallelContext *parallel_ctx = exec_ctx->GetParallelContext();
+  if (parallel_ctx == nullptr && exec_ctx->GetWorkerPool() != nullptr && execution_threads > 1 &&
+      ParallelSeqScanExecutor::CanRunInParallel(exec_ctx->GetTransaction())) {
+    return std::make_unique<ParallelSeqScanExecutor>(exec_ctx, seq_scan_plan, filter);
+  }
+  // The vectorized scan is split into a scan, a filter and a projection.
+  std::unique_ptr<AbstractExecutor> executor;
+  if (parallel_ctx != nullptr) {
+    // The instances of a parallel plan fragment split the pages of the table between them.
+    auto *table_info = exec_ctx->GetCatalog()->GetTable(seq_scan_plan->GetTableOid());
+    auto *cursor =
+        parallel_ctx->GetMorselCursor(seq_scan_plan, exec_ctx->GetBufferPoolManager(), table_info->table_.get());
+    auto scan = std::make_unique<MorselScanExecutor>(exec_ctx, table_info, cursor);
+    if (filter != nullptr) {
+      scan->SetDynamicFilter(filter);
+    }
+    executor = std::move(scan);
+  } else {
+    auto scan = std::make_unique<BatchSeqScanExecutor>(exec_ctx, seq_scan_plan);
+    if (filter != nullptr) {
+      scan->SetDynamicFilter(filter);
+    }
+    executor = std::move(scan);
+  }
+  if (seq_scan_plan->GetPredicate() != nullptr) {
+    executor = std::make_unique<BatchFilterExecutor>(exec_ctx, seq_scan_plan->GetPredicate(), std::move(executor));
+  }
+  return std::make_unique<BatchProjectionExecutor>(exec_ctx, seq_scan_plan->OutputSchema(), std::move(executor));
+}
+
+}  // namespace
+
 std::unique_ptr<AbstractExecutor> ExecutorFactory::CreateExecutor(ExecutorContext *exec_ctx,
                                                                   const AbstractPlanNode *plan) {
   switch (plan->GetType()) {
     // Create a new sequential scan executor.
     case PlanType::SeqScan: {
-      return std::make_unique<SeqScanExecutor>(exec_ctx, dynamic_cast<const SeqScanPlanNode *>(plan));
+      return CreateSeqScanExecutor(exec_ctx, dynamic_cast<const SeqScanPlanNode *>(plan), nullptr);
     }
 
     case PlanType::IndexScan: {
@@ -70,6 +123,9 @@ std::unique_ptr<AbstractExecutor> ExecutorFactory::CreateExecutor(ExecutorContex
     case PlanType::Aggregation: {
       auto agg_plan = dynamic_cast<const AggregationPlanNode *>(plan);
       auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, agg_plan->GetChildPlan());
+      if (enable_vectorized_execution) {
+        return std::make_unique<BatchAggregationExecutor>(exec_ctx, agg_plan, std::move(child_executor));
+      }
       return std::make_unique<AggregationExecutor>(exec_ctx, agg_plan, std::move(child_executor));
     }
 
@@ -77,16 +133,76 @@ std::unique_ptr<AbstractExecutor> ExecutorFactory::CreateExecutor(ExecutorContex
       auto nested_loop_join_plan = dynamic_cast<const NestedLoopJoinPlanNode *>(plan);
       auto left = ExecutorFactory::CreateExecutor(exec_ctx, nested_loop_join_plan->GetLeftPlan());
       auto right = ExecutorFactory::CreateExecutor(exec_ctx, nested_loop_join_plan->GetRightPlan());
+      if (enable_vectorized_execution) {
+        return std::make_unique<BatchNestedLoopJoinExecutor>(exec_ctx, nested_loop_join_plan, std::move(left),
+                                                             std::move(right));
+      }
       return std::make_unique<NestedLoopJoinExecutor>(exec_ctx, nested_loop_join_plan, std::move(left),
                                                       std::move(right));
     }
 
+    case PlanType::HashJoin: {
+      auto hash_join_plan = dynamic_cast<const HashJoinPlanNode *>(plan);
+      auto left = ExecutorFactory::CreateExecutor(exec_ctx, hash_join_plan->GetLeftPlan());
+      auto right = ExecutorFactory::CreateExecutor(exec_ctx, hash_join_plan->GetRightPlan());
+      return std::make_unique<HashJoinExecutor>(exec_ctx, hash_join_plan, std::move(left), std::move(right));
+    }
+
+    case PlanType::MergeJoin: {
+      auto merge_join_plan = dynamic_cast<const MergeJoinPlanNode *>(plan);
+      auto left = ExecutorFactory::CreateExecutor(exec_ctx, merge_join_plan->GetLeftPlan());
+      auto right = ExecutorFactory::CreateExecutor(exec_ctx, merge_join_plan->GetRightPlan());
+      return std::make_unique<MergeJoinExecutor>(exec_ctx, merge_join_plan, std::move(left), std::move(right));
+    }
+
     case PlanType::NestedIndexJoin: {
       auto nested_index_join_plan = dynamic_cast<const NestedIndexJoinPlanNode *>(plan);
       auto left = ExecutorFactory::CreateExecutor(exec_ctx, nested_index_join_plan->GetChildPlan());
       return std::make_unique<NestIndexJoinExecutor>(exec_ctx, nested_index_join_plan, std::move(left));
     }
 
+    case PlanType::Gather: {
+      auto gather_plan = dynamic_cast<const GatherPlanNode *>(plan);
+      // Without worker threads, or inside the fragment of another gather, the fragment runs as a serial plan.
+      if (!enable_vectorized_execution || exec_ctx->GetWorkerPool() == nullptr ||
+          exec_ctx->GetParallelContext() != nullptr ||
+          !ParallelSeqScanExecutor::CanRunInParallel(exec_ctx->GetTransaction())) {
+        return ExecutorFactory::CreateExecutor(exec_ctx, gather_plan->GetChildPlan());
+      }
+      return std::make_unique<GatherExecutor>(exec_ctx, gather_plan);
+    }
+
+    case PlanType::Exchange: {
+      auto exchange_plan = dynamic_cast<const ExchangePlanNode *>(plan);
+      // Outside a parallel plan fragment there is a single consumer, which gets everything.
+      if (exec_ctx->GetParallelContext() == nullptr) {
+        return ExecutorFactory::CreateExecutor(exec_ctx, exchange_plan->GetChildPlan());
+      }
+      return std::make_unique<ExchangeExecutor>(exec_ctx, exchange_plan);
+    }
+
+    case PlanType::Sort: {
+      auto sort_plan = dynamic_cast<const SortPlanNode *>(plan);
+      auto child_executor = ExecutorFactory::CreateExecutor(exec_ctx, sort_plan->GetChildPlan());
+      return std::make_unique<SortExecutor>(exec_ctx, sort_plan, std::move(child_executor));
+    }
+
+    case PlanType::TopN: {
+      auto topn_plan = dynamic_cast<const TopNPlanNode *>(plan);
+      // Over a vectorized scan, the bound of the heap is pushed down into the scan as a dynamic filter.
+      std::unique_ptr<DynamicFilter> filter;
+      if (enable_vectorized_execution && topn_plan->GetChildPlan()->GetType() == PlanType::SeqScan) {
+        auto seq_scan_plan = dynamic_cast<const SeqScanPlanNode *>(topn_plan->GetChildPlan());
+        filter = DynamicFilter::ForScan(topn_plan->GetOrderBys(), seq_scan_plan->OutputSchema());
+      }
+      auto child_executor =
+          filter != nullptr
+              ? CreateSeqScanExecutor(exec_ctx, dynamic_cast<const SeqScanPlanNode *>(topn_plan->GetChildPlan()),
+                                      filter.get())
+              : ExecutorFactory::CreateExecutor(exec_ctx, topn_plan->GetChildPlan());
+      return std::make_unique<TopNExecutor>(exec_ctx, topn_plan, std::move(child_executor), std::move(filter));
+    }
+
     default: {
       BUSTUB_ASSERT(false, "Unsupported plan type.");
     }
@@ -0,0 +1,535 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// expression_program.cpp
+//
+// Identification: src/execution/expression_program.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/expression_program.h"
+
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/parameter_value_expression.h"
+#include "type/limits.h"
+
+namespace bustub {
+
+namespace {
+
+const char *const OPCODE_NAMES[] = {
+    "LoadTinyInt", "LoadSmallInt", "LoadInteger", "LoadBigInt", "LoadTimestamp", "LoadDecimal", "LoadVarchar",
+    "IntegerToDecimal", "EqInteger", "NeInteger", "LtInteger", "LeInteger", "GtInteger", "GeInteger",
+    "EqDecimal", "NeDecimal", "LtDecimal", "LeDecimal", "GtDecimal", "GeDecimal",
+    "EqVarchar", "NeVarchar", "LtVarchar", "LeVarchar", "GtVarchar", "GeVarchar",
+};
+
+/** @return the value of type T at storage, which may be unaligned */
+template <typename T>
+inline T Read(const char *storage) {
+  T value;
+  memcpy(&value, storage, sizeof(T));
+  return value;
+}
+
+/** The values of the registers and columns of a kind, as the comparisons read them. */
+struct IntegerValues {
+  static int64_t Get(const ColumnVector &column, uint32_t row) { return column.GetInteger(row); }
+  template <typename R>
+  static int64_t Get(const R &reg) {
+    return reg.integer_;
+  }
+};
+
+struct DecimalValues {
+  // An integral column converted to decimal keeps its own values; see IntegerToDecimal.
+  static double Get(const ColumnVector &column, uint32_t row) { return column.GetNumeric(row); }
+  template <typename R>
+  static double Get(const R &reg) {
+    return reg.decimal_;
+  }
+};
+
+struct VarcharValues {
+  static std::string_view Get(const ColumnVector &column, uint32_t row) { return column.GetVarchar(row); }
+  template <typename R>
+  static std::string_view Get(const R &reg) {
+    return reg.varchar_;
+  }
+};
+
+/** An operand that is a column of a batch. */
+template <typename Values>
+struct ColumnOperand {
+  const ColumnVector *column_;
+  bool IsNull(uint32_t row) const { return column_->IsNull(row); }
+  auto Get(uint32_t row) const { return Values::Get(*column_, row); }
+};
+
+/** An operand that is the same non-NULL value for every row. */
+template <typename Values, typename T>
+struct ConstantOperand {
+  T value_;
+  bool IsNull(uint32_t row) const { return false; }
+  T Get(uint32_t row) const { return value_; }
+};
+
+/** Compare the selected rows of two operands, into the selection vector if filter is set and into result otherwise. */
+template <typename Lhs, typename Rhs, typename Compare>
+void CompareRows(const Lhs &lhs, const Rhs &rhs, Compare compare, TupleBatch *batch, bool filter,
+                 ColumnVector *result) {
+  std::vector<uint32_t> *selection = batch->GetMutableSelection();
+  if (filter) {
+    // Branch-free: every row is written, and kept by moving past it only if it passes.
+    size_t selected = 0;
+    for (uint32_t row : *selection) {
+      (*selection)[selected] = row;
+      selected += static_cast<size_t>(!lhs.IsNull(row) && !rhs.IsNull(row) && compare(lhs.Get(row), rhs.Get(row)));
+    }
+    selection->resize(selected);
+    return;
+  }
+  result->Reset(TypeId::BOOLEAN, batch->NumRows());
+  for (uint32_t row : *selection) {
+    if (lhs.IsNull(row) || rhs.IsNull(row)) {
+      result->SetNull(row);
+    } else {
+      result->SetInteger(row, compare(lhs.Get(row), rhs.Get(row)) ? 1 : 0);
+    }
+  }
+}
+
+}  // namespace
+
+std::unique_ptr<ExpressionProgram> ExpressionProgram::Compile(const AbstractExpression *predicate,
+                                                              const Schema *left_schema, const Schema *right_schema) {
+  if (dynamic_cast<const ComparisonExpression *>(predicate) == nullptr) {
+    return nullptr;
+  }
+  std::unique_ptr<ExpressionProgram> program(new ExpressionProgram(left_schema, right_schema));
+  if (program->CompileExpression(predicate) < 0) {
+    return nullptr;
+  }
+  // The registers do not move anymore, so varchar constants can point to their text.
+  for (auto &reg : program->registers_) {
+    if (reg.constant_ && reg.kind_ == Kind::Varchar) {
+      reg.varchar_ = reg.text_;
+    }
+  }
+  return program;
+}
+
+uint8_t ExpressionProgram::NewRegister(Kind kind) {
+  registers_.emplace_back();
+  registers_.back().kind_ = kind;
+  return static_cast<uint8_t>(registers_.size() - 1);
+}
+
+void ExpressionProgram::LoadConstant(Register *reg, const Value &value) {
+  reg->null_ = value.IsNull();
+  if (reg->null_) {
+    return;
+  }
+  // Going through a column gives constants the representation of the values they are compared with.
+  ColumnVector column(value.GetTypeId());
+  column.Resize(1);
+  column.SetValue(0, value);
+  if (reg->kind_ == Kind::Integer) {
+    reg->integer_ = column.GetInteger(0);
+  } else if (reg->kind_ == Kind::Decimal) {
+    reg->decimal_ = column.GetDecimal(0);
+  } else {
+    reg->text_ = column.GetVarchar(0);
+    reg->varchar_ = reg->text_;
+  }
+}
+
+void ExpressionProgram::LoadParameters() {
+  for (const auto &[index, parameter] : parameters_) {
+    LoadConstant(&registers_[index], parameter->GetValue());
+  }
+}
+
+int ExpressionProgram::CompileExpression(const AbstractExpression *expr) {
+  if (registers_.size() + 2 > MAX_REGISTERS) {
+    return -1;
+  }
+
+  if (auto *column_value = dynamic_cast<const ColumnValueExpression *>(expr)) {
+    bool right = right_schema_ != nullptr && column_value->GetTupleIdx() == 1;
+    const Schema *schema = right ? right_schema_ : left_schema_;
+    if (column_value->GetColIdx() >= schema->GetColumnCount()) {
+      return -1;
+    }
+    const Column &column = schema->GetColumn(column_value->GetColIdx());
+    Instruction instruction{};
+    instruction.tuple_idx_ = right ? 1 : 0;
+    instruction.offset_ = column.GetOffset();
+    instruction.col_idx_ = column_value->GetColIdx() + (right ? left_schema_->GetColumnCount() : 0);
+    Kind kind = Kind::Integer;
+    switch (column.GetType()) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+        instruction.opcode_ = OpCode::LoadTinyInt;
+        break;
+      case TypeId::SMALLINT:
+        instruction.opcode_ = OpCode::LoadSmallInt;
+        break;
+      case TypeId::INTEGER:
+        instruction.opcode_ = OpCode::LoadInteger;
+        break;
+      case TypeId::BIGINT:
+        instruction.opcode_ = OpCode::LoadBigInt;
+        break;
+      case TypeId::TIMESTAMP:
+        instruction.opcode_ = OpCode::LoadTimestamp;
+        break;
+      case TypeId::DECIMAL:
+        instruction.opcode_ = OpCode::LoadDecimal;
+        kind = Kind::Decimal;
+        break;
+      case TypeId::VARCHAR:
+        instruction.opcode_ = OpCode::LoadVarchar;
+        kind = Kind::Varchar;
+        break;
+      default:
+        return -1;
+    }
+    instruction.dst_ = NewRegister(kind);
+    code_.push_back(instruction);
+    return instruction.dst_;
+  }
+
+  auto *constant = dynamic_cast<const ConstantValueExpression *>(expr);
+  auto *parameter = dynamic_cast<const ParameterValueExpression *>(expr);
+  if (constant != nullptr || parameter != nullptr) {
+    TypeId type = constant != nullptr ? constant->GetValue().GetTypeId() : parameter->GetReturnType();
+    Kind kind;
+    switch (type) {
+      case TypeId::BOOLEAN:
+      case TypeId::TINYINT:
+      case TypeId::SMALLINT:
+      case TypeId::INTEGER:
+      case TypeId::BIGINT:
+      case TypeId::TIMESTAMP:
+        kind = Kind::Integer;
+        break;
+      case TypeId::DECIMAL:
+        kind = Kind::Decimal;
+        break;
+      case TypeId::VARCHAR:
+        kind = Kind::Varchar;
+        break;
+      default:
+        return -1;
+    }
+    uint8_t index = NewRegister(kind);
+    registers_[index].constant_ = true;
+    if (parameter != nullptr) {
+      parameters_.emplace_back(index, parameter);
+      LoadConstant(&registers_[index], parameter->GetValue());
+    } else {
+      LoadConstant(&registers_[index], constant->GetValue());
+    }
+    return index;
+  }
+
+  if (auto *comparison = dynamic_cast<const ComparisonExpression *>(expr)) {
+    int lhs = CompileExpression(comparison->GetChildAt(0));
+    if (lhs < 0) {
+      return -1;
+    }
+    int rhs = CompileExpression(comparison->GetChildAt(1));
+    if (rhs < 0) {
+      return -1;
+    }
+    Kind lhs_kind = registers_[lhs].kind_;
+    Kind rhs_kind = registers_[rhs].kind_;
+    if ((lhs_kind == Kind::Varchar) != (rhs_kind == Kind::Varchar)) {
+      // Comparing a varchar with a number casts one of them, which is left to Value.
+      return -1;
+    }
+    OpCode base = OpCode::EqVarchar;
+    if (lhs_kind == Kind::Integer && rhs_kind == Kind::Integer) {
+      base = OpCode::EqInteger;
+    } else if (lhs_kind != Kind::Varchar) {
+      base = OpCode::EqDecimal;
+      // Mixed numbers are compared as decimals.
+      for (int *operand : {&lhs, &rhs}) {
+        if (registers_[*operand].kind_ == Kind::Integer) {
+          Instruction instruction{};
+          instruction.opcode_ = OpCode::IntegerToDecimal;
+          instruction.lhs_ = static_cast<uint8_t>(*operand);
+          instruction.dst_ = NewRegister(Kind::Decimal);
+          code_.push_back(instruction);
+          *operand = instruction.dst_;
+        }
+      }
+    }
+    Instruction instruction{};
+    instruction.opcode_ =
+        static_cast<OpCode>(static_cast<int>(base) + static_cast<int>(comparison->GetComparisonType()));
+    instruction.lhs_ = static_cast<uint8_t>(lhs);
+    instruction.rhs_ = static_cast<uint8_t>(rhs);
+    instruction.dst_ = NewRegister(Kind::Integer);
+    code_.push_back(instruction);
+    return instruction.dst_;
+  }
+
+  return -1;
+}
+
+bool ExpressionProgram::EvaluateJoin(const Tuple &left, const Tuple &right) {
+  const char *const data[] = {left.GetData(), right.GetData()};
+  for (const Instruction &instruction : code_) {
+    Register &dst = registers_[instruction.dst_];
+    const Register &lhs = registers_[instruction.lhs_];
+    const Register &rhs = registers_[instruction.rhs_];
+    const char *storage = data[instruction.tuple_idx_] + instruction.offset_;
+    switch (instruction.opcode_) {
+      case OpCode::LoadTinyInt:
+        dst.integer_ = Read<int8_t>(storage);
+        dst.null_ = dst.integer_ == BUSTUB_INT8_NULL;
+        break;
+      case OpCode::LoadSmallInt:
+        dst.integer_ = Read<int16_t>(storage);
+        dst.null_ = dst.integer_ == BUSTUB_INT16_NULL;
+        break;
+      case OpCode::LoadInteger:
+        dst.integer_ = Read<int32_t>(storage);
+        dst.null_ = dst.integer_ == BUSTUB_INT32_NULL;
+        break;
+      case OpCode::LoadBigInt:
+        dst.integer_ = Read<int64_t>(storage);
+        dst.null_ = dst.integer_ == BUSTUB_INT64_NULL;
+        break;
+      case OpCode::LoadTimestamp: {
+        auto value = Read<uint64_t>(storage);
+        dst.integer_ = static_cast<int64_t>(value);
+        dst.null_ = value == BUSTUB_TIMESTAMP_NULL;
+        break;
+      }
+      case OpCode::LoadDecimal:
+        dst.decimal_ = Read<double>(storage);
+        dst.null_ = dst.decimal_ == BUSTUB_DECIMAL_NULL;
+        break;
+      case OpCode::LoadVarchar: {
+        // The column holds the offset of the value in the tuple, which starts with its length.
+        const char *value = data[instruction.tuple_idx_] + Read<uint32_t>(storage);
+        auto length = Read<uint32_t>(value);
+        dst.null_ = length == BUSTUB_VALUE_NULL;
+        dst.varchar_ = dst.null_ ? std::string_view() : std::string_view(value + sizeof(uint32_t), length);
+        break;
+      }
+      case OpCode::IntegerToDecimal:
+        dst.decimal_ = static_cast<double>(lhs.integer_);
+        dst.null_ = lhs.null_;
+        break;
+      default: {
+        dst.null_ = lhs.null_ || rhs.null_;
+        bool result;
+        switch (instruction.opcode_) {
+          case OpCode::EqInteger:
+            result = lhs.integer_ == rhs.integer_;
+            break;
+          case OpCode::NeInteger:
+            result = lhs.integer_ != rhs.integer_;
+            break;
+          case OpCode::LtInteger:
+            result = lhs.integer_ < rhs.integer_;
+            break;
+          case OpCode::LeInteger:
+            result = lhs.integer_ <= rhs.integer_;
+            break;
+          case OpCode::GtInteger:
+            result = lhs.integer_ > rhs.integer_;
+            break;
+          case OpCode::GeInteger:
+            result = lhs.integer_ >= rhs.integer_;
+            break;
+          case OpCode::EqDecimal:
+            result = lhs.decimal_ == rhs.decimal_;
+            break;
+          case OpCode::NeDecimal:
+            result = lhs.decimal_ != rhs.decimal_;
+            break;
+          case OpCode::LtDecimal:
+            result = lhs.decimal_ < rhs.decimal_;
+            break;
+          case OpCode::LeDecimal:
+            result = lhs.decimal_ <= rhs.decimal_;
+            break;
+          case OpCode::GtDecimal:
+            result = lhs.decimal_ > rhs.decimal_;
+            break;
+          case OpCode::GeDecimal:
+            result = lhs.decimal_ >= rhs.decimal_;
+            break;
+          case OpCode::EqVarchar:
+            result = lhs.varchar_ == rhs.varchar_;
+            break;
+          case OpCode::NeVarchar:
+            result = lhs.varchar_ != rhs.varchar_;
+            break;
+          case OpCode::LtVarchar:
+            result = lhs.varchar_ < rhs.varchar_;
+            break;
+          case OpCode::LeVarchar:
+            result = lhs.varchar_ <= rhs.varchar_;
+            break;
+          case OpCode::GtVarchar:
+            result = lhs.varchar_ > rhs.varchar_;
+            break;
+          case OpCode::GeVarchar:
+            result = lhs.varchar_ >= rhs.varchar_;
+            break;
+          default:
+            UNREACHABLE("Unknown opcode.");
+        }
+        dst.integer_ = result ? 1 : 0;
+        break;
+      }
+    }
+  }
+  const Register &result = registers_[code_.back().dst_];
+  return !result.null_ && result.integer_ != 0;
+}
+
+void ExpressionProgram::Filter(TupleBatch *batch) {
+  for (size_t pc = 0; pc < code_.size(); pc++) {
+    const Instruction &instruction = code_[pc];
+    Register &dst = registers_[instruction.dst_];
+    switch (instruction.opcode_) {
+      case OpCode::LoadTinyInt:
+      case OpCode::LoadSmallInt:
+      case OpCode::LoadInteger:
+      case OpCode::LoadBigInt:
+      case OpCode::LoadTimestamp:
+      case OpCode::LoadDecimal:
+      case OpCode::LoadVarchar:
+        dst.column_ = &batch->GetColumn(instruction.col_idx_);
+        break;
+      case OpCode::IntegerToDecimal: {
+        // Decimal comparisons read columns as numbers, so an integral column needs no conversion.
+        const Register &lhs = registers_[instruction.lhs_];
+        dst.column_ = lhs.column_;
+        dst.decimal_ = static_cast<double>(lhs.integer_);
+        dst.null_ = lhs.null_;
+        break;
+      }
+      default:
+        CompareBatch(instruction, batch, pc + 1 == code_.size());
+        break;
+    }
+  }
+}
+
+void ExpressionProgram::CompareBatch(const Instruction &instruction, TupleBatch *batch, bool filter) {
+  Register &dst = registers_[instruction.dst_];
+  const Register &lhs = registers_[instruction.lhs_];
+  const Register &rhs = registers_[instruction.rhs_];
+  dst.column_ = &dst.values_;
+
+  if ((lhs.column_ == nullptr && lhs.null_) || (rhs.column_ == nullptr && rhs.null_)) {
+    // Comparing with a NULL constant is NULL for every row.
+    if (filter) {
+      batch->GetMutableSelection()->clear();
+    } else {
+      dst.values_.Reset(TypeId::BOOLEAN, batch->NumRows());
+      for (uint32_t row : batch->GetSelection()) {
+        dst.values_.SetNull(row);
+      }
+    }
+    return;
+  }
+
+  // Picks the loop for the operands being columns or constants.
+  auto run = [&](auto values, auto compare) {
+    using Values = decltype(values);
+    using T = decltype(Values::Get(lhs));
+    if (lhs.column_ != nullptr && rhs.column_ != nullptr) {
+      CompareRows(ColumnOperand<Values>{lhs.column_}, ColumnOperand<Values>{rhs.column_}, compare, batch, filter,
+                  &dst.values_);
+    } else if (lhs.column_ != nullptr) {
+      CompareRows(ColumnOperand<Values>{lhs.column_}, ConstantOperand<Values, T>{Values::Get(rhs)}, compare, batch,
+                  filter, &dst.values_);
+    } else if (rhs.column_ != nullptr) {
+      CompareRows(ConstantOperand<Values, T>{Values::Get(lhs)}, ColumnOperand<Values>{rhs.column_}, compare, batch,
+                  filter, &dst.values_);
+    } else {
+      CompareRows(ConstantOperand<Values, T>{Values::Get(lhs)}, ConstantOperand<Values, T>{Values::Get(rhs)}, compare,
+                  batch, filter, &dst.values_);
+    }
+  };
+
+  switch (instruction.opcode_) {
+    case OpCode::EqInteger:
+      return run(IntegerValues(), std::equal_to<>());
+    case OpCode::NeInteger:
+      return run(IntegerValues(), std::not_equal_to<>());
+    case OpCode::LtInteger:
+      return run(IntegerValues(), std::less<>());
+    case OpCode::LeInteger:
+      return run(IntegerValues(), std::less_equal<>());
+    case OpCode::GtInteger:
+      return run(IntegerValues(), std::greater<>());
+    case OpCode::GeInteger:
+      return run(IntegerValues(), std::greater_equal<>());
+    case OpCode::EqDecimal:
+      return run(DecimalValues(), std::equal_to<>());
+    case OpCode::NeDecimal:
+      return run(DecimalValues(), std::not_equal_to<>());
+    case OpCode::LtDecimal:
+      return run(DecimalValues(), std::less<>());
+    case OpCode::LeDecimal:
+      return run(DecimalValues(), std::less_equal<>());
+    case OpCode::GtDecimal:
+      return run(DecimalValues(), std::greater<>());
+    case OpCode::GeDecimal:
+      return run(DecimalValues(), std::greater_equal<>());
+    case OpCode::EqVarchar:
+      return run(VarcharValues(), std::equal_to<>());
+    case OpCode::NeVarchar:
+      return run(VarcharValues(), std::not_equal_to<>());
+    case OpCode::LtVarchar:
+      return run(VarcharValues(), std::less<>());
+    case OpCode::LeVarchar:
+      return run(VarcharValues(), std::less_equal<>());
+    case OpCode::GtVarchar:
+      return run(VarcharValues(), std::greater<>());
+    case OpCode::GeVarchar:
+      return run(VarcharValues(), std::greater_equal<>());
+    default:
+      UNREACHABLE("Not a comparison.");
+  }
+}
+
+std::string ExpressionProgram::ToString() const {
+  std::ostringstream os;
+  for (const Instruction &instruction : code_) {
+    os << OPCODE_NAMES[static_cast<int>(instruction.opcode_)] << " r" << static_cast<int>(instruction.dst_);
+    if (instruction.opcode_ < OpCode::IntegerToDecimal) {
+      os << ", tuple " << instruction.tuple_idx_ << " column " << instruction.col_idx_;
+    } else if (instruction.opcode_ == OpCode::IntegerToDecimal) {
+      os << ", r" << static_cast<int>(instruction.lhs_);
+    } else {
+      os << ", r" << static_cast<int>(instruction.lhs_) << ", r" << static_cast<int>(instruction.rhs_);
+    }
+    os << "\n";
+  }
+  return os.str();
+}
+
+}  // namespace bustub
@@ -0,0 +1,80 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// gather_executor.cpp
+//
+// Identification: src/execution/gather_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/gather_executor.h"
+
+#include <memory>
+#include <utility>
+
+#include "execution/executor_factory.h"
+
+namespace bustub {
+
+void GatherExecutor::Init() {
+  AbstractBatchExecutor::Init();
+  Stop();
+  size_t degree = plan_->GetNumInstances() == 0 ? execution_threads : plan_->GetNumInstances();
+  parallel_ctx_ = std::make_unique<ParallelContext>(exec_ctx_->GetWorkerPool(), degree);
+  queue_ = std::make_unique<TupleBatchQueue>(2 * degree);
+  for (size_t i = 0; i < degree; i++) {
+    instances_.emplace_back(
+        ExecutorFactory::CreateExecutor(parallel_ctx_->MakeInstanceContext(exec_ctx_, i), plan_->GetChildPlan()));
+  }
+  producing_ = degree;
+  for (auto &instance : instances_) {
+    parallel_ctx_->Submit([this, executor = instance.get()] { Produce(executor); });
+  }
+}
+
+void GatherExecutor::Produce(AbstractExecutor *instance) {
+  try {
+    // Instances are initialized on their own threads, since that is where blocking operators do their work.
+    instance->Init();
+    TupleBatch batch;
+    while (instance->NextBatch(&batch) && queue_->Push(std::move(batch))) {
+    }
+  } catch (...) {
+    // Stop the other instances; the exception is rethrown by NextBatch().
+    queue_->Close();
+    parallel_ctx_->Cancel();
+    throw;
+  }
+  if (--producing_ == 0) {
+    queue_->Close();
+  }
+}
+
+bool GatherExecutor::NextBatch(TupleBatch *batch) {
+  if (queue_->Pop(batch)) {
+    return true;
+  }
+  std::exception_ptr error = Stop();
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+  batch->Reset(GetOutputSchema());
+  return false;
+}
+
+std::exception_ptr GatherExecutor::Stop() {
+  if (parallel_ctx_ == nullptr) {
+    return nullptr;
+  }
+  queue_->Close();
+  parallel_ctx_->Cancel();
+  std::exception_ptr error = parallel_ctx_->Wait();
+  instances_.clear();
+  parallel_ctx_.reset();
+  return error;
+}
+
+}  // namespace bustub
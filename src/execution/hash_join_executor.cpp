@@ -0,0 +1,286 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_join_executor.cpp
+//
+// Identification: src/execution/hash_join_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/hash_join_executor.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/abstract_expression.h"
+
+namespace bustub {
+
+HashJoinExecutor::HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
+                                   std::unique_ptr<AbstractExecutor> &&left_executor,
+                                   std::unique_ptr<AbstractExecutor> &&right_executor)
+    : AbstractExecutor(exec_ctx), plan_(plan), children_{std::move(left_executor), std::move(right_executor)} {}
+
+void HashJoinExecutor::Init() {
+  children_[LEFT]->Init();
+  children_[RIGHT]->Init();
+  // A program compiled by an earlier Init() only needs the values of the parameters of a prepared plan.
+  if (program_ == nullptr && plan_->Predicate() != nullptr && enable_compiled_expressions) {
+    program_ = ExpressionProgram::Compile(plan_->Predicate(), children_[LEFT]->GetOutputSchema(),
+                                          children_[RIGHT]->GetOutputSchema());
+  } else if (program_ != nullptr) {
+    program_->LoadParameters();
+  }
+  build_side_ = LEFT;
+  build_tuples_.clear();
+  build_keys_.clear();
+  hash_table_.clear();
+  probe_buffer_.clear();
+  probe_position_ = 0;
+  probe_child_ = nullptr;
+  probe_list_ = nullptr;
+  matches_.clear();
+  match_position_ = 0;
+  current_ = Partition();
+  pending_.clear();
+  num_spilled_partitions_ = 0;
+
+  // Read both children in turns until one of them is known to fit in memory, or both are known not to.
+  std::array<std::vector<Tuple>, 2> buffers;
+  std::array<size_t, 2> footprints{0, 0};
+  std::array<bool, 2> exhausted{false, false};
+  auto fits = [&](size_t side) { return exhausted[side] && footprints[side] <= hash_join_memory_budget; };
+  while (!fits(LEFT) && !fits(RIGHT) &&
+         (footprints[LEFT] <= hash_join_memory_budget || footprints[RIGHT] <= hash_join_memory_budget)) {
+    for (size_t side : {LEFT, RIGHT}) {
+      Tuple tuple;
+      RID rid;
+      if (exhausted[side]) {
+        continue;
+      }
+      if (children_[side]->Next(&tuple, &rid)) {
+        footprints[side] += TupleFootprint(tuple);
+        buffers[side].push_back(tuple);
+      } else {
+        exhausted[side] = true;
+      }
+    }
+  }
+
+  if (fits(LEFT) || fits(RIGHT)) {
+    build_side_ = fits(LEFT) && (!fits(RIGHT) || footprints[LEFT] <= footprints[RIGHT]) ? LEFT : RIGHT;
+    for (const auto &tuple : buffers[build_side_]) {
+      Build(tuple);
+    }
+    size_t probe_side = 1 - build_side_;
+    probe_buffer_ = std::move(buffers[probe_side]);
+    probe_child_ = exhausted[probe_side] ? nullptr : children_[probe_side].get();
+    return;
+  }
+
+  // Neither child fits: partition both of them, one after the other so that only one side's pages are pinned.
+  auto partitions = MakePartitions(1);
+  for (size_t side : {LEFT, RIGHT}) {
+    for (const auto &tuple : buffers[side]) {
+      Spill(side, tuple, &partitions);
+    }
+    buffers[side].clear();
+    Tuple tuple;
+    RID rid;
+    while (!exhausted[side] && children_[side]->Next(&tuple, &rid)) {
+      Spill(side, tuple, &partitions);
+    }
+    for (auto &partition : partitions) {
+      partition.inputs_[side]->Rewind();
+    }
+  }
+  QueuePartitions(&partitions);
+}
+
+bool HashJoinExecutor::Next(Tuple *tuple, RID *rid) {
+  const Schema *left_schema = children_[LEFT]->GetOutputSchema();
+  const Schema *right_schema = children_[RIGHT]->GetOutputSchema();
+  while (true) {
+    while (match_position_ < matches_.size()) {
+      const Tuple &build_tuple = build_tuples_[matches_[match_position_++]];
+      const Tuple &left = build_side_ == LEFT ? build_tuple : probe_tuple_;
+      const Tuple &right = build_side_ == LEFT ? probe_tuple_ : build_tuple;
+      if (program_ != nullptr) {
+        if (!program_->EvaluateJoin(left, right)) {
+          continue;
+        }
+      } else if (plan_->Predicate() != nullptr) {
+        Value matched = plan_->Predicate()->EvaluateJoin(&left, left_schema, &right, right_schema);
+        if (matched.IsNull() || !matched.GetAs<bool>()) {
+          continue;
+        }
+      }
+      std::vector<Value> values;
+      values.reserve(GetOutputSchema()->GetColumnCount());
+      for (const auto &column : GetOutputSchema()->GetColumns()) {
+        values.emplace_back(column.GetExpr()->EvaluateJoin(&left, left_schema, &right, right_schema));
+      }
+      *tuple = Tuple(values, GetOutputSchema());
+      return true;
+    }
+    if (NextProbeTuple()) {
+      Probe();
+    } else if (!LoadNextPartition()) {
+      return false;
+    }
+  }
+}
+
+bool HashJoinExecutor::EvaluateKeys(size_t side, const Tuple &tuple, std::vector<Value> *keys, hash_t *hash) const {
+  const auto &exprs = side == LEFT ? plan_->GetLeftKeys() : plan_->GetRightKeys();
+  const Schema *schema = children_[side]->GetOutputSchema();
+  keys->clear();
+  *hash = 0;
+  for (const auto *expr : exprs) {
+    Value key = expr->Evaluate(&tuple, schema);
+    if (key.IsNull()) {
+      return false;
+    }
+    *hash = HashUtil::CombineHashes(*hash, HashUtil::HashValue(&key));
+    keys->emplace_back(std::move(key));
+  }
+  return true;
+}
+
+size_t HashJoinExecutor::PartitionOf(hash_t hash, uint32_t depth) {
+  // The low bits of the key hashes are too weak to split on directly.
+  return HashUtil::MixHash(hash ^ (depth * 0x9E3779B97F4A7C15ULL)) % PARTITION_FANOUT;
+}
+
+void HashJoinExecutor::Build(const Tuple &tuple) {
+  std::vector<Value> keys;
+  hash_t hash;
+  if (!EvaluateKeys(build_side_, tuple, &keys, &hash)) {
+    return;
+  }
+  hash_table_.emplace(hash, build_tuples_.size());
+  build_tuples_.push_back(tuple);
+  build_keys_.emplace_back(std::move(keys));
+}
+
+void HashJoinExecutor::Probe() {
+  matches_.clear();
+  match_position_ = 0;
+  std::vector<Value> keys;
+  hash_t hash;
+  if (!EvaluateKeys(1 - build_side_, probe_tuple_, &keys, &hash)) {
+    return;
+  }
+  auto range = hash_table_.equal_range(hash);
+  for (auto it = range.first; it != range.second; ++it) {
+    const auto &build_keys = build_keys_[it->second];
+    bool equal = true;
+    for (size_t i = 0; equal && i < keys.size(); i++) {
+      equal = keys[i].CompareEquals(build_keys[i]) == CmpBool::CmpTrue;
+    }
+    if (equal) {
+      matches_.push_back(it->second);
+    }
+  }
+}
+
+bool HashJoinExecutor::NextProbeTuple() {
+  if (probe_position_ < probe_buffer_.size()) {
+    probe_tuple_ = probe_buffer_[probe_position_++];
+    return true;
+  }
+  if (!probe_buffer_.empty()) {
+    probe_buffer_.clear();
+    probe_buffer_.shrink_to_fit();
+    probe_position_ = 0;
+  }
+  RID rid;
+  if (probe_child_ != nullptr) {
+    if (probe_child_->Next(&probe_tuple_, &rid)) {
+      return true;
+    }
+    probe_child_ = nullptr;
+  }
+  return probe_list_ != nullptr && probe_list_->Next(&probe_tuple_);
+}
+
+std::vector<HashJoinExecutor::Partition> HashJoinExecutor::MakePartitions(uint32_t depth) {
+  std::vector<Partition> partitions(PARTITION_FANOUT);
+  for (auto &partition : partitions) {
+    for (auto &input : partition.inputs_) {
+      input = std::make_unique<TmpTupleList>(exec_ctx_->GetBufferPoolManager());
+    }
+    partition.depth_ = depth;
+  }
+  return partitions;
+}
+
+void HashJoinExecutor::Spill(size_t side, const Tuple &tuple, std::vector<Partition> *partitions) {
+  std::vector<Value> keys;
+  hash_t hash;
+  if (EvaluateKeys(side, tuple, &keys, &hash)) {
+    (*partitions)[PartitionOf(hash, (*partitions)[0].depth_)].inputs_[side]->Append(tuple);
+  }
+}
+
+void HashJoinExecutor::QueuePartitions(std::vector<Partition> *partitions) {
+  for (auto &partition : *partitions) {
+    // An inner join of a partition with an empty one is empty.
+    if (partition.inputs_[LEFT]->Size() > 0 && partition.inputs_[RIGHT]->Size() > 0) {
+      num_spilled_partitions_++;
+      pending_.emplace_back(std::move(partition));
+    }
+  }
+  partitions->clear();
+}
+
+bool HashJoinExecutor::LoadNextPartition() {
+  build_tuples_.clear();
+  build_keys_.clear();
+  hash_table_.clear();
+  probe_list_ = nullptr;
+  current_ = Partition();
+
+  while (!pending_.empty()) {
+    Partition partition = std::move(pending_.back());
+    pending_.pop_back();
+    size_t smaller =
+        partition.inputs_[LEFT]->GetDataSize() <= partition.inputs_[RIGHT]->GetDataSize() ? LEFT : RIGHT;
+    TmpTupleList *build = partition.inputs_[smaller].get();
+    size_t footprint = build->GetDataSize() + build->Size() * sizeof(Tuple);
+
+    if (footprint > hash_join_memory_budget && partition.depth_ < MAX_PARTITION_DEPTH) {
+      auto partitions = MakePartitions(partition.depth_ + 1);
+      for (size_t side : {LEFT, RIGHT}) {
+        TmpTupleList *input = partition.inputs_[side].get();
+        Tuple tuple;
+        while (input->Next(&tuple)) {
+          Spill(side, tuple, &partitions);
+        }
+        input->Clear();
+        for (auto &sub_partition : partitions) {
+          sub_partition.inputs_[side]->Rewind();
+        }
+      }
+      QueuePartitions(&partitions);
+      continue;
+    }
+
+    current_ = std::move(partition);
+    build_side_ = smaller;
+    Tuple tuple;
+    while (build->Next(&tuple)) {
+      Build(tuple);
+    }
+    build->Clear();
+    probe_list_ = current_.inputs_[1 - smaller].get();
+    return true;
+  }
+  return false;
+}
+
+}  // namespace bustub
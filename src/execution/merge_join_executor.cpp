@@ -0,0 +1,145 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// merge_join_executor.cpp
+//
+// Identification: src/execution/merge_join_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/merge_join_executor.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "execution/expressions/abstract_expression.h"
+
+namespace bustub {
+
+MergeJoinExecutor::MergeJoinExecutor(ExecutorContext *exec_ctx, const MergeJoinPlanNode *plan,
+                                     std::unique_ptr<AbstractExecutor> &&left_executor,
+                                     std::unique_ptr<AbstractExecutor> &&right_executor)
+    : AbstractExecutor(exec_ctx), plan_(plan), children_{std::move(left_executor), std::move(right_executor)} {}
+
+void MergeJoinExecutor::Init() {
+  children_[LEFT]->Init();
+  children_[RIGHT]->Init();
+  // A program compiled by an earlier Init() only needs the values of the parameters of a prepared plan.
+  if (program_ == nullptr && plan_->Predicate() != nullptr && enable_compiled_expressions) {
+    program_ = ExpressionProgram::Compile(plan_->Predicate(), children_[LEFT]->GetOutputSchema(),
+                                          children_[RIGHT]->GetOutputSchema());
+  } else if (program_ != nullptr) {
+    program_->LoadParameters();
+  }
+  cursors_[LEFT] = Cursor();
+  cursors_[RIGHT] = Cursor();
+  run_.clear();
+  run_keys_.clear();
+  run_position_ = 0;
+  max_run_size_ = 0;
+  Advance(RIGHT);
+}
+
+bool MergeJoinExecutor::Next(Tuple *tuple, RID *rid) {
+  const Schema *left_schema = children_[LEFT]->GetOutputSchema();
+  const Schema *right_schema = children_[RIGHT]->GetOutputSchema();
+  Cursor &left = cursors_[LEFT];
+  Cursor &right = cursors_[RIGHT];
+  while (true) {
+    while (run_position_ < run_.size()) {
+      const Tuple &right_tuple = run_[run_position_++];
+      if (program_ != nullptr) {
+        if (!program_->EvaluateJoin(left.tuple_, right_tuple)) {
+          continue;
+        }
+      } else if (plan_->Predicate() != nullptr) {
+        Value matched = plan_->Predicate()->EvaluateJoin(&left.tuple_, left_schema, &right_tuple, right_schema);
+        if (matched.IsNull() || !matched.GetAs<bool>()) {
+          continue;
+        }
+      }
+      std::vector<Value> values;
+      values.reserve(GetOutputSchema()->GetColumnCount());
+      for (const auto &column : GetOutputSchema()->GetColumns()) {
+        values.emplace_back(column.GetExpr()->EvaluateJoin(&left.tuple_, left_schema, &right_tuple, right_schema));
+      }
+      *tuple = Tuple(values, GetOutputSchema());
+      return true;
+    }
+
+    if (!Advance(LEFT)) {
+      return false;
+    }
+    // A left tuple with the keys of the previous one rewinds the buffer.
+    if (!run_.empty() && CompareKeys(left.keys_, run_keys_) == 0) {
+      run_position_ = 0;
+      continue;
+    }
+
+    run_.clear();
+    run_position_ = 0;
+    while (right.valid_ && CompareKeys(right.keys_, left.keys_) < 0) {
+      Advance(RIGHT);
+    }
+    if (!right.valid_) {
+      // The remaining left tuples have keys above every right tuple.
+      return false;
+    }
+    if (CompareKeys(right.keys_, left.keys_) > 0) {
+      continue;
+    }
+    run_keys_ = right.keys_;
+    while (right.valid_ && CompareKeys(right.keys_, run_keys_) == 0) {
+      run_.push_back(right.tuple_);
+      Advance(RIGHT);
+    }
+    max_run_size_ = std::max(max_run_size_, run_.size());
+  }
+}
+
+bool MergeJoinExecutor::Advance(size_t side) {
+  Cursor &cursor = cursors_[side];
+  const auto &exprs = side == LEFT ? plan_->GetLeftKeys() : plan_->GetRightKeys();
+  const Schema *schema = children_[side]->GetOutputSchema();
+  RID rid;
+  std::vector<Value> keys;
+  while (children_[side]->Next(&cursor.tuple_, &rid)) {
+    keys.clear();
+    bool null = false;
+    for (const auto *expr : exprs) {
+      keys.emplace_back(expr->Evaluate(&cursor.tuple_, schema));
+      null = null || keys.back().IsNull();
+    }
+    if (null) {
+      continue;
+    }
+    if (cursor.valid_ && CompareKeys(keys, cursor.keys_) < 0) {
+      throw Exception(ExceptionType::INVALID, "Merge join input is not sorted on its keys.");
+    }
+    cursor.keys_ = std::move(keys);
+    cursor.valid_ = true;
+    return true;
+  }
+  cursor.valid_ = false;
+  return false;
+}
+
+int MergeJoinExecutor::CompareKeys(const std::vector<Value> &lhs, const std::vector<Value> &rhs) {
+  for (size_t i = 0; i < lhs.size(); i++) {
+    if (lhs[i].CompareLessThan(rhs[i]) == CmpBool::CmpTrue) {
+      return -1;
+    }
+    if (lhs[i].CompareGreaterThan(rhs[i]) == CmpBool::CmpTrue) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+}  // namespace bustub
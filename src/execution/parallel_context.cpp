@@ -0,0 +1,104 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_context.cpp
+//
+// Identification: src/execution/parallel_context.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/parallel_context.h"
+
+#include <utility>
+
+#include "execution/executor_factory.h"
+
+namespace bustub {
+
+ExecutorContext *ParallelContext::MakeInstanceContext(ExecutorContext *parent, size_t instance) {
+  auto exec_ctx =
+      std::make_unique<ExecutorContext>(parent->GetTransaction(), parent->GetCatalog(), parent->GetBufferPoolManager(),
+                                        parent->GetTransactionManager(), parent->GetLockManager());
+  exec_ctx->SetWorkerPool(worker_pool_);
+  exec_ctx->SetParallelContext(this, instance, parent);
+  std::lock_guard<std::mutex> guard(latch_);
+  contexts_.emplace_back(std::move(exec_ctx));
+  return contexts_.back().get();
+}
+
+MorselCursor *ParallelContext::GetMorselCursor(const SeqScanPlanNode *plan, BufferPoolManager *bpm,
+                                               TableHeap *table) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto &cursor = cursors_[plan];
+  if (cursor == nullptr) {
+    cursor = std::make_unique<MorselCursor>(bpm, table, plan->GetPredicate());
+  }
+  return cursor.get();
+}
+
+ExchangeState *ParallelContext::GetExchange(const ExchangePlanNode *plan, ExecutorContext *exec_ctx) {
+  ExchangeState *exchange;
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    auto &state = exchanges_[plan];
+    if (state != nullptr) {
+      return state.get();
+    }
+    state = std::make_unique<ExchangeState>(plan, degree_);
+    exchange = state.get();
+    if (cancelled_) {
+      exchange->Close();
+      return exchange;
+    }
+  }
+
+  // The executors are created without the latch, which the scans of the child take for their cursors.
+  for (size_t i = 0; i < degree_; i++) {
+    exchange->AddProducer(ExecutorFactory::CreateExecutor(MakeInstanceContext(exec_ctx, i), plan->GetChildPlan()));
+  }
+  for (size_t i = 0; i < degree_; i++) {
+    Submit([exchange, i] { exchange->Produce(i); });
+  }
+  return exchange;
+}
+
+void ParallelContext::Submit(std::function<void()> task) {
+  std::future<void> done = worker_pool_->Submit(std::move(task));
+  std::lock_guard<std::mutex> guard(latch_);
+  tasks_.emplace_back(std::move(done));
+}
+
+void ParallelContext::Cancel() {
+  std::lock_guard<std::mutex> guard(latch_);
+  cancelled_ = true;
+  for (auto &exchange : exchanges_) {
+    exchange.second->Close();
+  }
+}
+
+std::exception_ptr ParallelContext::Wait() {
+  std::exception_ptr error;
+  while (true) {
+    std::future<void> task;
+    {
+      std::lock_guard<std::mutex> guard(latch_);
+      if (tasks_.empty()) {
+        return error;
+      }
+      task = std::move(tasks_.front());
+      tasks_.pop_front();
+    }
+    try {
+      task.get();
+    } catch (...) {
+      if (error == nullptr) {
+        error = std::current_exception();
+      }
+    }
+  }
+}
+
+}  // namespace bustub
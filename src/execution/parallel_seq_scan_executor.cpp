@@ -0,0 +1,198 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_seq_scan_executor.cpp
+//
+// Identification: src/execution/parallel_seq_scan_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/parallel_seq_scan_executor.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "common/exception.h"
+#include "execution/executors/batch_filter_executor.h"
+#include "execution/executors/batch_projection_executor.h"
+#include "execution/worker_pool.h"
+
+namespace bustub {
+
+MorselCursor::MorselCursor(BufferPoolManager *bpm, TableHeap *table, const AbstractExpression *predicate)
+    : bpm_(bpm), next_page_id_(table->GetFirstPageId()), zone_map_(table->GetZoneMap()) {
+  if (zone_map_ != nullptr) {
+    bounds_ = zone_map_->GetBounds(predicate);
+    if (bounds_.empty()) {
+      zone_map_ = nullptr;
+    }
+  }
+}
+
+bool MorselCursor::Claim(std::vector<TablePage *> *pages, size_t *num_skipped) {
+  pages->clear();
+  std::unique_lock<std::mutex> guard(latch_);
+  while (pages->size() < MORSEL_PAGES && next_page_id_ != INVALID_PAGE_ID) {
+    page_id_t page_id = next_page_id_;
+    if (zone_map_ != nullptr) {
+      page_id = zone_map_->NextPage(&next_zone_, bounds_, num_skipped);
+      if (page_id == INVALID_PAGE_ID) {
+        next_page_id_ = INVALID_PAGE_ID;
+        break;
+      }
+    }
+    auto *page = static_cast<TablePage *>(bpm_->FetchPage(page_id));
+    if (page == nullptr) {
+      if (zone_map_ != nullptr) {
+        // The page goes to the next morsel.
+        next_zone_--;
+      }
+      if (!pages->empty()) {
+        break;
+      }
+      if (pages_in_flight_ == 0) {
+        throw Exception(ExceptionType::OUT_OF_MEMORY, "no free buffer pool frame for a parallel scan");
+      }
+      // The frames are short: wait for another thread to be done with its morsel, then try again.
+      size_t num_released = num_released_;
+      released_.wait(guard, [&] { return num_released_ != num_released; });
+      continue;
+    }
+    page->RLatch();
+    next_page_id_ = page->GetNextPageId();
+    page->RUnlatch();
+    pages->push_back(page);
+  }
+  pages_in_flight_ += pages->size();
+  return !pages->empty();
+}
+
+void MorselCursor::Release(const std::vector<TablePage *> &pages) {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    pages_in_flight_ -= pages.size();
+    num_released_++;
+  }
+  released_.notify_all();
+}
+
+void MorselScanExecutor::Init() {
+  AbstractBatchExecutor::Init();
+  tuples_.clear();
+  position_ = 0;
+}
+
+bool MorselScanExecutor::NextBatch(TupleBatch *batch) {
+  batch->Reset(GetOutputSchema());
+  while (!batch->IsFull()) {
+    if (position_ == tuples_.size()) {
+      if (!ReadMorsel()) {
+        break;
+      }
+      continue;
+    }
+    const Tuple &tuple = tuples_[position_++];
+    batch->AppendTuple(tuple, tuple.GetRid());
+  }
+  if (filter_probe_ != nullptr) {
+    filter_probe_->Apply(batch);
+  }
+  return batch->NumRows() > 0;
+}
+
+bool MorselScanExecutor::ReadMorsel() {
+  tuples_.clear();
+  position_ = 0;
+  size_t num_skipped = 0;
+  bool claimed = cursor_->Claim(&pages_, &num_skipped);
+  exec_ctx_->AddSkippedPages(num_skipped);
+  if (!claimed) {
+    return false;
+  }
+  BufferPoolManager *bpm = exec_ctx_->GetBufferPoolManager();
+  for (auto *page : pages_) {
+    table_info_->table_->ReadPage(page, exec_ctx_->GetTransaction(), &tuples_);
+    bpm->UnpinPage(page->GetTablePageId(), false);
+  }
+  cursor_->Release(pages_);
+  return true;
+}
+
+ParallelSeqScanExecutor::ParallelSeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan,
+                                                 DynamicFilter *filter)
+    : AbstractBatchExecutor(exec_ctx),
+      plan_(plan),
+      table_info_(exec_ctx->GetCatalog()->GetTable(plan->GetTableOid())),
+      filter_(filter),
+      queue_(2 * execution_threads) {}
+
+void ParallelSeqScanExecutor::Init() {
+  AbstractBatchExecutor::Init();
+  Stop();
+  queue_.Reset();
+  error_ = nullptr;
+  cursor_ = std::make_unique<MorselCursor>(exec_ctx_->GetBufferPoolManager(), table_info_->table_.get(),
+                                           plan_->GetPredicate());
+
+  // Every thread gets the pipeline of a serial vectorized scan, over its morsels.
+  pipelines_.clear();
+  for (size_t i = 0; i < execution_threads; i++) {
+    auto scan = std::make_unique<MorselScanExecutor>(exec_ctx_, table_info_, cursor_.get());
+    if (filter_ != nullptr) {
+      scan->SetDynamicFilter(filter_);
+    }
+    std::unique_ptr<AbstractExecutor> pipeline = std::move(scan);
+    if (plan_->GetPredicate() != nullptr) {
+      pipeline = std::make_unique<BatchFilterExecutor>(exec_ctx_, plan_->GetPredicate(), std::move(pipeline));
+    }
+    pipeline = std::make_unique<BatchProjectionExecutor>(exec_ctx_, plan_->OutputSchema(), std::move(pipeline));
+    pipeline->Init();
+    pipelines_.emplace_back(std::move(pipeline));
+  }
+  producing_ = pipelines_.size();
+  for (auto &pipeline : pipelines_) {
+    tasks_.emplace_back(exec_ctx_->GetWorkerPool()->Submit([this, executor = pipeline.get()] { Produce(executor); }));
+  }
+}
+
+void ParallelSeqScanExecutor::Produce(AbstractExecutor *pipeline) {
+  try {
+    TupleBatch batch;
+    while (pipeline->NextBatch(&batch) && queue_.Push(std::move(batch))) {
+    }
+  } catch (...) {
+    std::lock_guard<std::mutex> guard(error_latch_);
+    if (error_ == nullptr) {
+      error_ = std::current_exception();
+    }
+  }
+  if (--producing_ == 0) {
+    queue_.Close();
+  }
+}
+
+bool ParallelSeqScanExecutor::NextBatch(TupleBatch *batch) {
+  if (queue_.Pop(batch)) {
+    return true;
+  }
+  Stop();
+  if (error_ != nullptr) {
+    std::rethrow_exception(error_);
+  }
+  batch->Reset(GetOutputSchema());
+  return false;
+}
+
+void ParallelSeqScanExecutor::Stop() {
+  queue_.Close();
+  for (auto &task : tasks_) {
+    task.wait();
+  }
+  tasks_.clear();
+}
+
+}  // namespace bustub
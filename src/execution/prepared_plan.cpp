@@ -0,0 +1,101 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// prepared_plan.cpp
+//
+// Identification: src/execution/prepared_plan.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/prepared_plan.h"
+
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "common/config.h"
+#include "common/exception.h"
+#include "execution/executor_factory.h"
+#include "execution/executors/parallel_seq_scan_executor.h"
+#include "execution/expressions/parameter_value_expression.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+const AbstractExpression *PreparedPlan::MakeParameter(TypeId type) {
+  BUSTUB_ASSERT(plan_ == nullptr, "Parameters are made before the plan is prepared.");
+  auto param_idx = static_cast<uint32_t>(parameter_types_.size());
+  parameter_types_.push_back(type);
+  return Own(std::make_unique<ParameterValueExpression>(param_idx, type));
+}
+
+void PreparedPlan::Prepare(const AbstractPlanNode *plan, ExecutorContext *exec_ctx, bool optimize) {
+  // a catalog that changes while the plan is optimized makes it stale
+  catalog_version_ = exec_ctx->GetCatalog()->GetVersion();
+  optimizer_ = std::make_unique<Optimizer>(exec_ctx->GetCatalog());
+  plan_ = optimize ? optimizer_->Optimize(plan) : plan;
+  catalog_ = exec_ctx->GetCatalog();
+  bpm_ = exec_ctx->GetBufferPoolManager();
+  txn_mgr_ = exec_ctx->GetTransactionManager();
+  lock_mgr_ = exec_ctx->GetLockManager();
+  worker_pool_ = exec_ctx->GetWorkerPool();
+  std::vector<Value> values;
+  for (auto type : parameter_types_) {
+    values.push_back(ValueFactory::GetNullValueByType(type));
+  }
+  Release(Acquire(values, exec_ctx));
+}
+
+std::unique_ptr<PreparedPlan::Execution> PreparedPlan::Acquire(const std::vector<Value> &values,
+                                                               ExecutorContext *query_ctx) {
+  if (values.size() != parameter_types_.size()) {
+    throw Exception(ExceptionType::MISMATCH_TYPE, "Wrong number of values bound to a prepared plan.");
+  }
+  std::unique_ptr<Execution> execution;
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (!free_executions_.empty()) {
+      execution = std::move(free_executions_.back());
+      free_executions_.pop_back();
+    }
+  }
+  Transaction *txn = query_ctx->GetTransaction();
+  if (execution == nullptr) {
+    execution = std::make_unique<Execution>();
+    execution->exec_ctx_ = std::make_unique<ExecutorContext>(txn, catalog_, bpm_, txn_mgr_, lock_mgr_);
+    execution->exec_ctx_->SetWorkerPool(worker_pool_);
+  }
+
+  execution->parameters_.clear();
+  for (size_t i = 0; i < values.size(); i++) {
+    const Value &value = values[i];
+    execution->parameters_.push_back(value.GetTypeId() == parameter_types_[i] ? value
+                                                                              : value.CastAs(parameter_types_[i]));
+  }
+  execution->exec_ctx_->SetTransaction(txn);
+  execution->exec_ctx_->SetQueryContext(query_ctx);
+  if (execution->executor_ == nullptr || execution->vectorized_ != enable_vectorized_execution ||
+      execution->parallel_ != IsParallel(txn)) {
+    execution->executor_ = ExecutorFactory::CreateExecutor(execution->exec_ctx_.get(), plan_);
+    execution->vectorized_ = enable_vectorized_execution;
+    execution->parallel_ = IsParallel(txn);
+  }
+  return execution;
+}
+
+void PreparedPlan::Release(std::unique_ptr<Execution> &&execution) {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (free_executions_.size() < MAX_FREE_EXECUTIONS) {
+    free_executions_.emplace_back(std::move(execution));
+  }
+}
+
+bool PreparedPlan::IsParallel(Transaction *txn) const {
+  return worker_pool_ != nullptr && execution_threads > 1 &&
+         ParallelSeqScanExecutor::CanRunInParallel(txn);
+}
+
+}  // namespace bustub
@@ -0,0 +1,190 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_executor.cpp
+//
+// Identification: src/execution/sort_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/sort_executor.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace bustub {
+
+Tuple SortRecord::Make(const Tuple &tuple, std::string_view key) {
+  auto key_size = static_cast<uint32_t>(key.size());
+  uint32_t size = tuple.GetLength() + key_size + sizeof(uint32_t);
+  std::vector<char> storage(sizeof(uint32_t) + size);
+  char *pos = storage.data();
+  memcpy(pos, &size, sizeof(uint32_t));
+  pos += sizeof(uint32_t);
+  memcpy(pos, tuple.GetData(), tuple.GetLength());
+  pos += tuple.GetLength();
+  memcpy(pos, key.data(), key_size);
+  memcpy(pos + key_size, &key_size, sizeof(uint32_t));
+  Tuple record;
+  record.DeserializeFrom(storage.data());
+  return record;
+}
+
+std::string_view SortRecord::Key(const Tuple &record) {
+  const char *end = record.GetData() + record.GetLength() - sizeof(uint32_t);
+  uint32_t key_size;
+  memcpy(&key_size, end, sizeof(uint32_t));
+  return std::string_view(end - key_size, key_size);
+}
+
+RunMerger::RunMerger(const std::vector<TmpTupleList *> &runs) {
+  // The keys point into the records, which must not move.
+  inputs_.resize(runs.size());
+  for (size_t i = 0; i < runs.size(); i++) {
+    inputs_[i].run_ = runs[i];
+    runs[i]->Rewind();
+    Advance(&inputs_[i]);
+  }
+  tree_ = std::make_unique<LoserTree<Less>>(inputs_.size(), Less{&inputs_});
+}
+
+const Tuple *RunMerger::Peek() const {
+  const Input &winner = inputs_[tree_->Winner()];
+  return winner.valid_ ? &winner.record_ : nullptr;
+}
+
+void RunMerger::Pop() {
+  Advance(&inputs_[tree_->Winner()]);
+  tree_->Replay();
+}
+
+void RunMerger::Advance(Input *input) {
+  input->valid_ = input->run_->Next(&input->record_);
+  input->key_ = input->valid_ ? SortRecord::Key(input->record_) : std::string_view();
+}
+
+void SortExecutor::Init() {
+  AbstractBatchExecutor::Init();
+  child_->Init();
+  records_.clear();
+  entries_.clear();
+  memory_used_ = 0;
+  next_entry_ = 0;
+  merger_.reset();
+  runs_.clear();
+  num_runs_ = 0;
+  num_intermediate_merges_ = 0;
+
+  SortKeyEncoder encoder(plan_->GetOrderBys());
+  TupleBatch batch;
+  std::string key;
+  while (child_->NextBatch(&batch)) {
+    encoder.Evaluate(batch);
+    for (uint32_t row : batch.GetSelection()) {
+      key.clear();
+      encoder.Encode(row, &key);
+      entries_.push_back({SortKeyEncoder::Prefix(key), static_cast<uint32_t>(records_.size())});
+      records_.emplace_back(SortRecord::Make(batch.GetTuple(row), key));
+      memory_used_ += records_.back().GetLength() + sizeof(Tuple) + sizeof(Entry);
+      if (memory_used_ > sort_memory_budget) {
+        SpillRun();
+      }
+    }
+  }
+
+  if (runs_.empty()) {
+    SortRecords();
+    return;
+  }
+  if (!records_.empty()) {
+    SpillRun();
+  }
+  while (runs_.size() > MAX_MERGE_FANIN) {
+    MergePass();
+  }
+  std::vector<TmpTupleList *> runs;
+  for (auto &run : runs_) {
+    runs.push_back(run.get());
+  }
+  merger_ = std::make_unique<RunMerger>(runs);
+}
+
+bool SortExecutor::NextBatch(TupleBatch *batch) {
+  batch->Reset(GetOutputSchema());
+  if (merger_ != nullptr) {
+    for (const Tuple *record = merger_->Peek(); record != nullptr && !batch->IsFull(); record = merger_->Peek()) {
+      batch->AppendTuple(*record, RID());
+      merger_->Pop();
+    }
+  } else {
+    for (; next_entry_ < entries_.size() && !batch->IsFull(); next_entry_++) {
+      batch->AppendTuple(records_[entries_[next_entry_].index_], RID());
+    }
+  }
+  return batch->NumRows() > 0;
+}
+
+void SortExecutor::SortRecords() {
+  std::sort(entries_.begin(), entries_.end(), [this](const Entry &a, const Entry &b) {
+    if (a.prefix_ != b.prefix_) {
+      return a.prefix_ < b.prefix_;
+    }
+    int cmp = SortRecord::Key(records_[a.index_]).compare(SortRecord::Key(records_[b.index_]));
+    return cmp < 0 || (cmp == 0 && a.index_ < b.index_);
+  });
+}
+
+void SortExecutor::SpillRun() {
+  SortRecords();
+  auto run = std::make_unique<TmpTupleList>(exec_ctx_->GetBufferPoolManager());
+  for (const Entry &entry : entries_) {
+    run->Append(records_[entry.index_]);
+  }
+  // Unpin the last page of the run until it is merged.
+  run->Rewind();
+  runs_.emplace_back(std::move(run));
+  num_runs_++;
+  records_.clear();
+  entries_.clear();
+  memory_used_ = 0;
+}
+
+void SortExecutor::MergePass() {
+  // Runs are merged with their neighbours, and ties go to the earlier run, so equal keys stay in arrival order.
+  std::deque<std::unique_ptr<TmpTupleList>> merged_runs;
+  for (size_t first = 0; first < runs_.size(); first += MAX_MERGE_FANIN) {
+    size_t last = std::min(first + MAX_MERGE_FANIN, runs_.size());
+    if (last - first == 1) {
+      merged_runs.emplace_back(std::move(runs_[first]));
+      continue;
+    }
+    std::vector<TmpTupleList *> inputs;
+    for (size_t i = first; i < last; i++) {
+      inputs.push_back(runs_[i].get());
+    }
+    auto merged = std::make_unique<TmpTupleList>(exec_ctx_->GetBufferPoolManager());
+    {
+      RunMerger merger(inputs);
+      for (const Tuple *record = merger.Peek(); record != nullptr; record = merger.Peek()) {
+        merged->Append(*record);
+        merger.Pop();
+      }
+    }
+    merged->Rewind();
+    for (size_t i = first; i < last; i++) {
+      runs_[i].reset();
+    }
+    merged_runs.emplace_back(std::move(merged));
+    num_intermediate_merges_++;
+  }
+  runs_ = std::move(merged_runs);
+}
+
+}  // namespace bustub
@@ -0,0 +1,68 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_key.cpp
+//
+// Identification: src/execution/sort_key.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/sort_key.h"
+
+#include <cstring>
+
+namespace bustub {
+
+namespace {
+
+inline void AppendBigEndian(uint64_t value, std::string *key) {
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    key->push_back(static_cast<char>((value >> shift) & 0xFF));
+  }
+}
+
+}  // namespace
+
+void SortKeyEncoder::EncodeValue(const ColumnVector &column, uint32_t row, bool descending, std::string *key) {
+  size_t start = key->size();
+  if (column.IsNull(row)) {
+    key->push_back('\0');
+  } else {
+    key->push_back('\1');
+    if (ColumnVector::IsIntegral(column.GetType())) {
+      AppendBigEndian(static_cast<uint64_t>(column.GetInteger(row)) ^ (1ULL << 63), key);
+    } else if (column.GetType() == TypeId::DECIMAL) {
+      // Adding zero turns -0.0 into 0.0, which must compare equal.
+      double value = column.GetDecimal(row) + 0.0;
+      uint64_t bits;
+      memcpy(&bits, &value, sizeof(bits));
+      AppendBigEndian((bits & (1ULL << 63)) != 0 ? ~bits : bits ^ (1ULL << 63), key);
+    } else {
+      for (char c : column.GetVarchar(row)) {
+        key->push_back(c);
+        if (c == '\0') {
+          key->push_back('\xFF');
+        }
+      }
+      key->append(2, '\0');
+    }
+  }
+  if (descending) {
+    for (size_t i = start; i < key->size(); i++) {
+      (*key)[i] = static_cast<char>(~(*key)[i]);
+    }
+  }
+}
+
+uint64_t SortKeyEncoder::Prefix(std::string_view key) {
+  uint64_t prefix = 0;
+  for (size_t i = 0; i < sizeof(prefix); i++) {
+    prefix = (prefix << 8) | (i < key.size() ? static_cast<uint8_t>(key[i]) : 0);
+  }
+  return prefix;
+}
+
+}  // namespace bustub
@@ -0,0 +1,78 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// topn_executor.cpp
+//
+// Identification: src/execution/topn_executor.cpp
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/executors/topn_executor.h"
+
+#include <algorithm>
+#include <string>
+
+namespace bustub {
+
+void TopNExecutor::Init() {
+  AbstractBatchExecutor::Init();
+  if (filter_ != nullptr) {
+    filter_->Reset();
+  }
+  child_->Init();
+  heap_.clear();
+  next_entry_ = plan_->GetOffset();
+
+  size_t capacity = plan_->GetLimit() + plan_->GetOffset();
+  if (capacity == 0) {
+    return;
+  }
+  heap_.reserve(capacity);
+  SortKeyEncoder encoder(plan_->GetOrderBys());
+  TupleBatch batch;
+  std::string key;
+  size_t sequence = 0;
+  while (child_->NextBatch(&batch)) {
+    encoder.Evaluate(batch);
+    bool bound_changed = false;
+    for (uint32_t row : batch.GetSelection()) {
+      key.clear();
+      encoder.Encode(row, &key);
+      if (heap_.size() < capacity) {
+        heap_.push_back({key, sequence++, batch.GetTuple(row)});
+        std::push_heap(heap_.begin(), heap_.end(), Less);
+        bound_changed = heap_.size() == capacity;
+        continue;
+      }
+      // A later tuple with the key of the top sorts after it, so only a smaller key gets in.
+      if (key < heap_.front().key_) {
+        std::pop_heap(heap_.begin(), heap_.end(), Less);
+        Entry &entry = heap_.back();
+        entry.key_.swap(key);
+        entry.sequence_ = sequence;
+        entry.tuple_ = batch.GetTuple(row);
+        std::push_heap(heap_.begin(), heap_.end(), Less);
+        bound_changed = true;
+      }
+      sequence++;
+    }
+    // The bound is published once per batch, to keep the latch of the filter out of the loop.
+    if (bound_changed && filter_ != nullptr) {
+      filter_->SetBound(heap_.front().key_);
+    }
+  }
+  std::sort_heap(heap_.begin(), heap_.end(), Less);
+}
+
+bool TopNExecutor::NextBatch(TupleBatch *batch) {
+  batch->Reset(GetOutputSchema());
+  for (; next_entry_ < heap_.size() && !batch->IsFull(); next_entry_++) {
+    batch->AppendTuple(heap_[next_entry_].tuple_, RID());
+  }
+  return batch->NumRows() > 0;
+}
+
+}  // namespace bustub
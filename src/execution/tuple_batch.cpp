@@ -0,0 +1,266 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.cpp
+//
+// Identification: src/execution/tuple_batch.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/tuple_batch.h"
+
+#include <cstring>
+
+#include "type/value_factory.h"
+
+namespace bustub {
+
+void ColumnVector::Resize(uint32_t size) {
+  if (IsIntegral(type_)) {
+    integers_.resize(size);
+  } else if (type_ == TypeId::DECIMAL) {
+    decimals_.resize(size);
+  } else {
+    varchars_.resize(size);
+  }
+  nulls_.resize(size);
+  size_ = size;
+}
+
+Value ColumnVector::GetValue(uint32_t row) const {
+  if (IsNull(row)) {
+    return ValueFactory::GetNullValueByType(type_);
+  }
+  switch (type_) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      return Value(type_, static_cast<int8_t>(integers_[row]));
+    case TypeId::SMALLINT:
+      return Value(type_, static_cast<int16_t>(integers_[row]));
+    case TypeId::INTEGER:
+      return Value(type_, static_cast<int32_t>(integers_[row]));
+    case TypeId::BIGINT:
+      return Value(type_, integers_[row]);
+    case TypeId::TIMESTAMP:
+      return Value(type_, static_cast<uint64_t>(integers_[row]));
+    case TypeId::DECIMAL:
+      return Value(type_, decimals_[row]);
+    case TypeId::VARCHAR:
+      return Value(type_, varchars_[row].data(), static_cast<uint32_t>(varchars_[row].size()), true);
+    default:
+      UNREACHABLE("Unsupported column type.");
+  }
+}
+
+void ColumnVector::SetValue(uint32_t row, const Value &value) {
+  if (value.IsNull()) {
+    SetNull(row);
+    return;
+  }
+  switch (value.GetTypeId()) {
+    case TypeId::VARCHAR:
+      if (type_ == TypeId::VARCHAR) {
+        SetVarchar(row, value.GetData(), value.GetLength());
+      } else {
+        SetValue(row, value.CastAs(type_));
+      }
+      return;
+    case TypeId::DECIMAL:
+      if (type_ == TypeId::DECIMAL) {
+        SetDecimal(row, value.GetAs<double>());
+      } else if (type_ == TypeId::VARCHAR) {
+        SetValue(row, value.CastAs(type_));
+      } else {
+        SetInteger(row, static_cast<int64_t>(value.GetAs<double>()));
+      }
+      return;
+    default:
+      break;
+  }
+
+  int64_t integer;
+  switch (value.GetTypeId()) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT:
+      integer = value.GetAs<int8_t>();
+      break;
+    case TypeId::SMALLINT:
+      integer = value.GetAs<int16_t>();
+      break;
+    case TypeId::INTEGER:
+      integer = value.GetAs<int32_t>();
+      break;
+    case TypeId::BIGINT:
+      integer = value.GetAs<int64_t>();
+      break;
+    case TypeId::TIMESTAMP:
+      integer = static_cast<int64_t>(value.GetAs<uint64_t>());
+      break;
+    default:
+      UNREACHABLE("Unsupported value type.");
+  }
+  if (IsIntegral(type_)) {
+    SetInteger(row, integer);
+  } else if (type_ == TypeId::DECIMAL) {
+    SetDecimal(row, static_cast<double>(integer));
+  } else {
+    SetValue(row, value.CastAs(type_));
+  }
+}
+
+void ColumnVector::SetFromStorage(uint32_t row, const char *storage) {
+  // Each type has its own NULL sentinel.
+  switch (type_) {
+    case TypeId::BOOLEAN:
+    case TypeId::TINYINT: {
+      int8_t value;
+      memcpy(&value, storage, sizeof(value));
+      value == BUSTUB_INT8_NULL ? SetNull(row) : SetInteger(row, value);
+      return;
+    }
+    case TypeId::SMALLINT: {
+      int16_t value;
+      memcpy(&value, storage, sizeof(value));
+      value == BUSTUB_INT16_NULL ? SetNull(row) : SetInteger(row, value);
+      return;
+    }
+    case TypeId::INTEGER: {
+      int32_t value;
+      memcpy(&value, storage, sizeof(value));
+      value == BUSTUB_INT32_NULL ? SetNull(row) : SetInteger(row, value);
+      return;
+    }
+    case TypeId::BIGINT: {
+      int64_t value;
+      memcpy(&value, storage, sizeof(value));
+      value == BUSTUB_INT64_NULL ? SetNull(row) : SetInteger(row, value);
+      return;
+    }
+    case TypeId::TIMESTAMP: {
+      uint64_t value;
+      memcpy(&value, storage, sizeof(value));
+      value == BUSTUB_TIMESTAMP_NULL ? SetNull(row) : SetInteger(row, static_cast<int64_t>(value));
+      return;
+    }
+    case TypeId::DECIMAL: {
+      double value;
+      memcpy(&value, storage, sizeof(value));
+      value == BUSTUB_DECIMAL_NULL ? SetNull(row) : SetDecimal(row, value);
+      return;
+    }
+    default:
+      UNREACHABLE("Only inlined columns can be read from storage.");
+  }
+}
+
+void ColumnVector::CopyRow(uint32_t row, const ColumnVector &src, uint32_t src_row) {
+  if (src.IsNull(src_row)) {
+    SetNull(row);
+  } else if (IsIntegral(type_) && IsIntegral(src.type_)) {
+    SetInteger(row, src.integers_[src_row]);
+  } else if (type_ == TypeId::DECIMAL && src.type_ == TypeId::DECIMAL) {
+    SetDecimal(row, src.decimals_[src_row]);
+  } else if (type_ == TypeId::VARCHAR && src.type_ == TypeId::VARCHAR) {
+    varchars_[row] = src.varchars_[src_row];
+    nulls_[row] = 0;
+  } else {
+    SetValue(row, src.GetValue(src_row));
+  }
+}
+
+void ColumnVector::Fill(const Value &value, const std::vector<uint32_t> &rows) {
+  if (rows.empty()) {
+    return;
+  }
+  SetValue(rows[0], value);
+  for (size_t i = 1; i < rows.size(); i++) {
+    CopyRow(rows[i], *this, rows[0]);
+  }
+}
+
+bool ColumnVector::RowEquals(uint32_t row, const ColumnVector &other, uint32_t other_row) const {
+  if (IsNull(row) || other.IsNull(other_row)) {
+    return IsNull(row) && other.IsNull(other_row);
+  }
+  if (IsIntegral(type_)) {
+    return integers_[row] == other.integers_[other_row];
+  }
+  if (type_ == TypeId::DECIMAL) {
+    return decimals_[row] == other.decimals_[other_row];
+  }
+  return varchars_[row] == other.varchars_[other_row];
+}
+
+hash_t ColumnVector::HashRow(uint32_t row) const {
+  if (IsNull(row)) {
+    return 0;
+  }
+  if (IsIntegral(type_)) {
+    return HashUtil::Hash(&integers_[row]);
+  }
+  if (type_ == TypeId::DECIMAL) {
+    return HashUtil::Hash(&decimals_[row]);
+  }
+  return HashUtil::HashBytes(varchars_[row].data(), varchars_[row].size());
+}
+
+void TupleBatch::Reset(const Schema *schema) {
+  schema_ = schema;
+  num_rows_ = 0;
+  selection_.clear();
+  uint32_t column_count = schema == nullptr ? 0 : schema->GetColumnCount();
+  columns_.resize(column_count);
+  for (uint32_t i = 0; i < column_count; i++) {
+    columns_[i].Reset(schema->GetColumn(i).GetType(), BATCH_SIZE);
+  }
+  rids_.resize(BATCH_SIZE);
+}
+
+uint32_t TupleBatch::AppendRow(const RID &rid) {
+  BUSTUB_ASSERT(!IsFull(), "Tuple batch is full.");
+  rids_[num_rows_] = rid;
+  selection_.push_back(num_rows_);
+  return num_rows_++;
+}
+
+void TupleBatch::AppendTuple(const Tuple &tuple, const RID &rid) {
+  uint32_t row = AppendRow(rid);
+  for (uint32_t i = 0; i < NumColumns(); i++) {
+    const Column &column = schema_->GetColumn(i);
+    if (column.IsInlined()) {
+      columns_[i].SetFromStorage(row, tuple.GetData() + column.GetOffset());
+    } else {
+      columns_[i].SetValue(row, tuple.GetValue(schema_, i));
+    }
+  }
+}
+
+void TupleBatch::Select(const ColumnVector &matches) {
+  size_t selected = 0;
+  for (uint32_t row : selection_) {
+    if (!matches.IsNull(row) && matches.GetInteger(row) != 0) {
+      selection_[selected++] = row;
+    }
+  }
+  selection_.resize(selected);
+}
+
+void TupleBatch::CopySelection(const TupleBatch &other) {
+  num_rows_ = other.num_rows_;
+  selection_ = other.selection_;
+  rids_ = other.rids_;
+}
+
+Tuple TupleBatch::GetTuple(uint32_t row) const {
+  std::vector<Value> values;
+  values.reserve(NumColumns());
+  for (const auto &column : columns_) {
+    values.emplace_back(column.GetValue(row));
+  }
+  return Tuple(values, schema_);
+}
+
+}  // namespace bustub
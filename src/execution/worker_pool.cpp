@@ -0,0 +1,99 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// worker_pool.cpp
+//
+// Identification: src/execution/worker_pool.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "execution/worker_pool.h"
+
+#include <exception>
+#include <utility>
+
+#include "execution/expressions/parameter_value_expression.h"
+
+namespace bustub {
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    stopped_ = true;
+  }
+  has_task_.notify_all();
+  for (auto &thread : threads_) {
+    thread.join();
+  }
+}
+
+std::future<void> WorkerPool::Submit(std::function<void()> task) {
+  // The task belongs to the execution of the submitting thread, and evaluates the parameters bound to it.
+  std::packaged_task<void()> packaged(
+      [task = std::move(task), parameters = ParameterValueExpression::GetBoundParameters()] {
+        ParameterValueExpression::Binding binding(parameters);
+        task();
+      });
+  std::future<void> done = packaged.get_future();
+  std::lock_guard<std::mutex> guard(latch_);
+  tasks_.emplace_back(std::move(packaged));
+  if (tasks_.size() > idle_) {
+    threads_.emplace_back(&WorkerPool::Work, this);
+  } else {
+    has_task_.notify_one();
+  }
+  return done;
+}
+
+void WorkerPool::RunInParallel(size_t n, const std::function<void(size_t)> &f) {
+  std::vector<std::future<void>> done;
+  for (size_t i = 1; i < n; i++) {
+    done.emplace_back(Submit([&f, i] { f(i); }));
+  }
+  std::exception_ptr error;
+  try {
+    f(0);
+  } catch (...) {
+    error = std::current_exception();
+  }
+  // The other tasks reference f, so they must be waited for even if f(0) threw.
+  for (auto &task : done) {
+    try {
+      task.get();
+    } catch (...) {
+      if (error == nullptr) {
+        error = std::current_exception();
+      }
+    }
+  }
+  if (error != nullptr) {
+    std::rethrow_exception(error);
+  }
+}
+
+size_t WorkerPool::NumThreads() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return threads_.size();
+}
+
+void WorkerPool::Work() {
+  std::unique_lock<std::mutex> guard(latch_);
+  while (true) {
+    idle_++;
+    has_task_.wait(guard, [this] { return stopped_ || !tasks_.empty(); });
+    idle_--;
+    if (tasks_.empty()) {
+      return;
+    }
+    std::packaged_task<void()> task = std::move(tasks_.front());
+    tasks_.pop_front();
+    guard.unlock();
+    task();
+    guard.lock();
+  }
+}
+
+}  // namespace bustub
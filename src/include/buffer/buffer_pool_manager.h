@@ -97,6 +97,13 @@ class BufferPoolManager {
   /** @return size of the buffer pool */
   size_t GetPoolSize() { return pool_size_; }
 
+  /**
+   * Take the dirty page table for a fuzzy checkpoint. Pinned pages are included, as they may have been modified
+   * without being marked dirty yet.
+   * @return the recLSN of every page that is dirty or pinned
+   */
+  std::unordered_map<page_id_t, lsn_t> GetDirtyPageTable();
+
  protected:
   /**
    * Grading function. Do not modify!
@@ -127,7 +134,8 @@ class BufferPoolManager {
   bool UnpinPageImpl(page_id_t page_id, bool is_dirty);
 
   /**
-   * Flushes the target page to disk.
+   * Flushes the target page to disk. The page may be pinned and written concurrently, its image is written under its
+   * read latch, which the caller must not hold.
    * @param page_id id of page to be flushed, cannot be INVALID_PAGE_ID
    * @return false if the page could not be found in the page table, true otherwise
    */
@@ -152,6 +160,34 @@ class BufferPoolManager {
    */
   void FlushAllPagesImpl();
 
+  /**
+   * Find a frame for a page that is not in the buffer pool, writing back the victim first if it is dirty. The victim is
+   * written without latch_, so it may be fetched or changed meanwhile, in which case it stays and no frame is found.
+   * @param guard the lock on latch_, which is released while the victim is written
+   * @param[out] frame_id a frame out of the page table and the replacer, RETRY_FRAME_ID if the caller must look again
+   * @return false if all the pages in the buffer pool are pinned
+   */
+  bool FindFrame(std::unique_lock<std::mutex> *guard, frame_id_t *frame_id);
+
+  /**
+   * Write back a page that the caller pinned, under the page read latch and without latch_, then mark it clean. The
+   * recLSN of the page becomes the LSN after the page LSN of the written image.
+   * @param guard the lock on latch_, which is released while the page is written and held again on return
+   * @param page the page to write
+   */
+  void WritePageUnlatched(std::unique_lock<std::mutex> *guard, Page *page);
+
+  /**
+   * Writes a page back to disk. Under logging, the log is forced up to the page LSN first (write-ahead logging).
+   * No writer may change the page.
+   * @param page the page to write
+   * @return the page LSN of the written image
+   */
+  lsn_t WritePageToDisk(Page *page);
+
+  /** @return the LSN of the next log record, a lower bound for the recLSN of a page that is modified from now on */
+  lsn_t NextLSN() { return log_manager_ == nullptr ? INVALID_LSN : log_manager_->GetNextLSN(); }
+
   /** Number of pages in the buffer pool. */
   size_t pool_size_;
   /** Array of buffer pool pages. */
@@ -159,14 +195,19 @@ class BufferPoolManager {
   /** Pointer to the disk manager. */
   DiskManager *disk_manager_ __attribute__((__unused__));
   /** Pointer to the log manager. */
-  LogManager *log_manager_ __attribute__((__unused__));
+  LogManager *log_manager_;
   /** Page table for keeping track of buffer pool pages. */
   std::unordered_map<page_id_t, frame_id_t> page_table_;
   /** Replacer to find unpinned pages for replacement. */
   Replacer *replacer_;
   /** List of free pages. */
   std::list<frame_id_t> free_list_;
-  /** This latch protects shared data structures. We recommend updating this comment to describe what it protects. */
+  /**
+   * This latch protects the page table, the replacer, the free list and the metadata of the pages. It is not held
+   * while pages are written back or the log is forced for them.
+   */
   std::mutex latch_;
+  /** The frame FindFrame() finds when it released latch_ and the caller must look again. */
+  static constexpr frame_id_t RETRY_FRAME_ID = -1;
 };
 }  // namespace bustub
@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <string>
 #include <unordered_map>
@@ -8,6 +9,8 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/schema.h"
+#include "catalog/table_stats.h"
+#include "common/config.h"
 #include "storage/index/b_plus_tree_index.h"
 #include "storage/index/index.h"
 #include "storage/table/table_heap.h"
@@ -31,6 +34,14 @@ struct TableMetadata {
   std::string name_;
   std::unique_ptr<TableHeap> table_;
   table_oid_t oid_;
+  /**
+   * The statistics gathered by the last Catalog::Analyze() of the table, nullptr if it has never been analyzed. An
+   * analyze publishes new ones atomically, so they are read through GetStats() while queries run.
+   */
+  std::shared_ptr<const TableStats> stats_;
+
+  /** @return the current statistics of the table, which stay alive as long as the caller holds them */
+  std::shared_ptr<const TableStats> GetStats() const { return std::atomic_load(&stats_); }
 };
 
 /**
@@ -77,14 +88,54 @@ class Catalog {
    */
   TableMetadata *CreateTable(Transaction *txn, const std::string &table_name, const Schema &schema) {
     BUSTUB_ASSERT(names_.count(table_name) == 0, "Table names should be unique!");
-    return nullptr;
+    table_oid_t table_oid = next_table_oid_++;
+    auto table = std::make_unique<TableHeap>(bpm_, lock_manager_, log_manager_, txn, table_oid);
+    names_[table_name] = table_oid;
+    tables_[table_oid] = std::make_unique<TableMetadata>(schema, table_name, std::move(table), table_oid);
+    version_++;
+    return tables_[table_oid].get();
   }
 
-  /** @return table metadata by name */
-  TableMetadata *GetTable(const std::string &table_name) { return nullptr; }
+  /** @return table metadata by name, throws std::out_of_range if there is no such table */
+  TableMetadata *GetTable(const std::string &table_name) { return GetTable(names_.at(table_name)); }
 
-  /** @return table metadata by oid */
-  TableMetadata *GetTable(table_oid_t table_oid) { return nullptr; }
+  /** @return table metadata by oid, throws std::out_of_range if there is no such table */
+  TableMetadata *GetTable(table_oid_t table_oid) { return tables_.at(table_oid).get(); }
+
+  /**
+   * Gather the statistics of a table from a sample of at most analyze_sample_pages of its pages, replacing the ones
+   * gathered before, as ANALYZE does.
+   * @param txn the transaction reading the table
+   * @param table_name the name of the table, which must exist
+   * @return the statistics of the table
+   */
+  std::shared_ptr<const TableStats> Analyze(Transaction *txn, const std::string &table_name) {
+    TableMetadata *table_info = GetTable(table_name);
+    std::shared_ptr<const TableStats> stats =
+        TableStats::Analyze(table_info->table_.get(), table_info->schema_, bpm_, txn, analyze_sample_pages);
+    // The optimizers of running queries may still hold the statistics this replaces.
+    std::atomic_store(&table_info->stats_, stats);
+    version_++;
+    return stats;
+  }
+
+  /**
+   * @return the version of the catalog, which changes whenever a table is created or analyzed, so that the plans made
+   * for an older version may be made again
+   */
+  uint64_t GetVersion() const { return version_; }
+
+  /**
+   * Keep per-page bounds of some columns of a table, which sequential scans use to skip pages.
+   * @param txn the transaction reading the table
+   * @param table_name the name of the table, which must exist
+   * @param col_idxs the columns to keep the bounds of, inlined and not VARCHAR
+   * @return the zone map of the table
+   */
+  ZoneMap *CreateZoneMap(Transaction *txn, const std::string &table_name, const std::vector<uint32_t> &col_idxs) {
+    TableMetadata *table_info = GetTable(table_name);
+    return table_info->table_->CreateZoneMap(&table_info->schema_, col_idxs, txn);
+  }
 
   /**
    * Create a new index, populate existing data of the table and return its metadata.
@@ -127,5 +178,7 @@ class Catalog {
   std::unordered_map<std::string, std::unordered_map<std::string, index_oid_t>> index_names_;
   /** The next index identifier to be used */
   std::atomic<index_oid_t> next_index_oid_{0};
+  /** The version of the tables and their statistics. */
+  std::atomic<uint64_t> version_{0};
 };
 }  // namespace bustub
@@ -0,0 +1,139 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_stats.h
+//
+// Identification: src/include/catalog/table_stats.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/schema.h"
+#include "concurrency/transaction.h"
+#include "execution/expressions/comparison_expression.h"
+#include "storage/table/table_heap.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * ColumnStats describes the distribution of the values of a column, as seen in a sample of its rows: the smallest and
+ * the largest value, the number of distinct values, the fraction of NULLs and an equi-depth histogram.
+ *
+ * The histogram has HISTOGRAM_BUCKETS buckets holding as many non-NULL values each, and is stored as the values that
+ * bound them, from the smallest value to the largest. A value that fills several buckets, such as a frequent one,
+ * bounds several of them, which is how its frequency is estimated.
+ */
+class ColumnStats {
+ public:
+  /** The number of buckets of a histogram. */
+  static constexpr size_t HISTOGRAM_BUCKETS = 32;
+
+  /**
+   * Build the statistics of a column from a sample of its values.
+   * @param type the type of the column
+   * @param values the non-NULL values of the sample
+   * @param num_nulls the number of NULLs in the sample
+   * @param scale the number of rows of the table per row of the sample, 1 if the sample is the whole table
+   */
+  ColumnStats(TypeId type, std::vector<Value> &&values, size_t num_nulls, double scale);
+
+  /** @return the type of the column */
+  TypeId GetType() const { return type_; }
+
+  /** @return true if the sample holds no value but NULLs, in which case there is no minimum, maximum or histogram */
+  bool IsEmpty() const { return histogram_.empty(); }
+
+  /** @return the smallest value */
+  const Value &GetMin() const { return histogram_.front(); }
+
+  /** @return the largest value */
+  const Value &GetMax() const { return histogram_.back(); }
+
+  /** @return the estimated number of distinct non-NULL values in the table */
+  double GetNumDistinct() const { return num_distinct_; }
+
+  /** @return the estimated fraction of rows whose value is NULL */
+  double GetNullFraction() const { return null_fraction_; }
+
+  /** @return the HISTOGRAM_BUCKETS + 1 values that bound the buckets of the histogram, in ascending order */
+  const std::vector<Value> &GetHistogram() const { return histogram_; }
+
+  /**
+   * Estimate the selectivity of a comparison of the column with a constant.
+   * @param comparison the comparison, with the column on its left
+   * @param constant the constant on its right
+   * @return the estimated fraction of rows for which the comparison is true
+   */
+  double EstimateSelectivity(ComparisonType comparison, const Value &constant) const;
+
+ private:
+  /** @return the estimated fraction of the non-NULL values that are equal to value */
+  double EqualFraction(const Value &value) const;
+
+  /** @return the estimated fraction of the non-NULL values that are less than or equal to value */
+  double LessOrEqualFraction(const Value &value) const;
+
+  TypeId type_;
+  double num_distinct_{0};
+  double null_fraction_{0};
+  std::vector<Value> histogram_;
+};
+
+/**
+ * TableStats holds the statistics of a table, gathered by Analyze() from a sample of its pages.
+ */
+class TableStats {
+ public:
+  /**
+   * Gather the statistics of a table by reading a reservoir sample of its pages.
+   *
+   * The page list is walked once to count the pages and draw up to sample_pages of them uniformly, without reading
+   * their tuples; only the tuples of the drawn pages are read. Tables that have no more pages than that are read
+   * whole, which makes the row count exact.
+   *
+   * @param table the table
+   * @param schema the schema of the table
+   * @param bpm the buffer pool manager of the table
+   * @param txn the transaction reading the table, which decides which tuples are visible
+   * @param sample_pages the largest number of pages to read
+   * @return the statistics of the table
+   */
+  static std::unique_ptr<TableStats> Analyze(TableHeap *table, const Schema &schema, BufferPoolManager *bpm,
+                                             Transaction *txn, size_t sample_pages);
+
+  /** @return the estimated number of rows of the table */
+  double GetRowCount() const { return row_count_; }
+
+  /** @return the number of pages of the table */
+  size_t GetNumPages() const { return num_pages_; }
+
+  /** @return the number of pages that were read */
+  size_t GetNumSampledPages() const { return num_sampled_pages_; }
+
+  /** @return the number of rows that were read */
+  size_t GetNumSampledRows() const { return num_sampled_rows_; }
+
+  /** @return the statistics of a column, by its index in the schema of the table */
+  const ColumnStats &GetColumnStats(uint32_t col_idx) const { return columns_[col_idx]; }
+
+ private:
+  TableStats() = default;
+
+  double row_count_{0};
+  size_t num_pages_{0};
+  size_t num_sampled_pages_{0};
+  size_t num_sampled_rows_{0};
+  std::vector<ColumnStats> columns_;
+};
+
+}  // namespace bustub
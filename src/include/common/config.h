@@ -14,6 +14,7 @@
 
 #include <atomic>
 #include <chrono>  // NOLINT
+#include <cstddef>
 #include <cstdint>
 
 namespace bustub {
@@ -21,25 +22,67 @@ namespace bustub {
 /** Cycle detection is performed every CYCLE_DETECTION_INTERVAL milliseconds. */
 extern std::chrono::milliseconds cycle_detection_interval;
 
+/** A transaction holding more than LOCK_ESCALATION_THRESHOLD row locks in one table escalates to a table lock. */
+extern size_t lock_escalation_threshold;
+
+/** The garbage collector reclaims old tuple versions every GC_INTERVAL milliseconds. */
+extern std::chrono::milliseconds gc_interval;
+
 /** True if logging should be enabled, false otherwise. */
 extern std::atomic<bool> enable_logging;
 
 /** If ENABLE_LOGGING is true, the log should be flushed to disk every LOG_TIMEOUT. */
 extern std::chrono::duration<int64_t> log_timeout;
 
+/** True if the log buffers should be compressed before they are written to disk. */
+extern bool enable_log_compression;
+
+/** The disk manager starts a new log segment file once the last one holds LOG_SEGMENT_SIZE bytes. */
+extern int log_segment_size;
+
+/** Pages are written to a double-write buffer before they are written in place, so that torn pages can be repaired. */
+extern bool enable_double_write;
+
+/** Sequential scans, aggregations and joins run on batch-at-a-time executors instead of the tuple-at-a-time ones. */
+extern bool enable_vectorized_execution;
+
+/** Predicates are compiled into bytecode (see ExpressionProgram) instead of being evaluated as expression trees. */
+extern bool enable_compiled_expressions;
+
+/** Plans are rewritten by the Optimizer before they are executed. */
+extern bool enable_optimizer;
+
+/** The number of threads a query may run on. With 1, every operator runs on the thread that executes the query. */
+extern size_t execution_threads;
+
+/** A hash join whose smaller input has more bytes of tuples than this spills both inputs to temporary pages. */
+extern size_t hash_join_memory_budget;
+
+/** A sort whose input has more bytes of tuples and keys than this sorts it in runs of that size spilled to disk. */
+extern size_t sort_memory_budget;
+
+/** The largest number of pages of a table that Catalog::Analyze() reads to gather its statistics. */
+extern size_t analyze_sample_pages;
+
+/** The largest number of prepared plans an ExecutionEngine caches. The least recently used ones are evicted first. */
+extern size_t plan_cache_size;
+
 static constexpr int INVALID_PAGE_ID = -1;                                    // invalid page id
 static constexpr int INVALID_TXN_ID = -1;                                     // invalid transaction id
 static constexpr int INVALID_LSN = -1;                                        // invalid log sequence number
+static constexpr int INVALID_TS = -1;                                         // invalid timestamp
 static constexpr int HEADER_PAGE_ID = 0;                                      // the header page id
 static constexpr int PAGE_SIZE = 4096;                                        // size of a data page in byte
 static constexpr int BUFFER_POOL_SIZE = 10;                                   // size of buffer pool
 static constexpr int LOG_BUFFER_SIZE = ((BUFFER_POOL_SIZE + 1) * PAGE_SIZE);  // size of a log buffer in byte
 static constexpr int BUCKET_SIZE = 50;                                        // size of extendible hash bucket
+static constexpr int BATCH_SIZE = 1024;                                       // rows in a vectorized tuple batch
 
 using frame_id_t = int32_t;    // frame id type
 using page_id_t = int32_t;     // page id type
 using txn_id_t = int32_t;      // transaction id type
 using lsn_t = int32_t;         // log sequence number type
+using timestamp_t = int64_t;   // commit timestamp type
 using slot_offset_t = size_t;  // slot offset type
 using oid_t = uint16_t;
 
@@ -0,0 +1,124 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lock_free_queue.h
+//
+// Identification: src/include/common/lock_free_queue.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * LockFreeQueue is a bounded multi-producer multi-consumer FIFO queue that never blocks: TryPush() fails when the
+ * queue is full and TryPop() when it is empty.
+ *
+ * It is a ring of cells, each tagged with a sequence number that tells whether the cell is ready to be written or
+ * read at a given position. Producers and consumers claim positions with a compare-and-swap on their own counter, so
+ * they only contend with their own kind, and hand the cell over with a release store of its sequence number.
+ */
+template <typename T>
+class LockFreeQueue {
+ public:
+  /** @param capacity the number of values the queue holds at most, rounded up to a power of two */
+  explicit LockFreeQueue(size_t capacity) {
+    size_t size = 2;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    mask_ = size - 1;
+    cells_ = std::make_unique<Cell[]>(size);
+    for (size_t i = 0; i < size; i++) {
+      cells_[i].sequence_.store(i, std::memory_order_relaxed);
+    }
+  }
+
+  DISALLOW_COPY_AND_MOVE(LockFreeQueue);
+
+  /** @return the number of values the queue holds at most */
+  size_t Capacity() const { return mask_ + 1; }
+
+  /**
+   * Push a value at the tail of the queue.
+   * @return false if the queue is full, in which case value is left untouched
+   */
+  bool TryPush(T &&value) {
+    size_t position = push_position_.load(std::memory_order_relaxed);
+    Cell *cell;
+    while (true) {
+      cell = &cells_[position & mask_];
+      size_t sequence = cell->sequence_.load(std::memory_order_acquire);
+      auto lag = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+      if (lag == 0) {
+        if (push_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (lag < 0) {
+        // The cell still holds the value pushed one lap ago.
+        return false;
+      } else {
+        position = push_position_.load(std::memory_order_relaxed);
+      }
+    }
+    cell->value_ = std::move(value);
+    cell->sequence_.store(position + 1, std::memory_order_release);
+    return true;
+  }
+
+  /**
+   * Pop the value at the head of the queue.
+   * @return false if the queue is empty
+   */
+  bool TryPop(T *value) {
+    size_t position = pop_position_.load(std::memory_order_relaxed);
+    Cell *cell;
+    while (true) {
+      cell = &cells_[position & mask_];
+      size_t sequence = cell->sequence_.load(std::memory_order_acquire);
+      auto lag = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position + 1);
+      if (lag == 0) {
+        if (pop_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (lag < 0) {
+        // No value has been pushed at this position yet.
+        return false;
+      } else {
+        position = pop_position_.load(std::memory_order_relaxed);
+      }
+    }
+    *value = std::move(cell->value_);
+    // The cell is writable again at the same index of the next lap.
+    cell->sequence_.store(position + mask_ + 1, std::memory_order_release);
+    return true;
+  }
+
+ private:
+  /** The size of a cache line, to keep the two counters from sharing one. */
+  static constexpr size_t CACHE_LINE_SIZE = 64;
+
+  struct Cell {
+    std::atomic<size_t> sequence_;
+    T value_;
+  };
+
+  std::unique_ptr<Cell[]> cells_;
+  size_t mask_;
+  alignas(CACHE_LINE_SIZE) std::atomic<size_t> push_position_{0};
+  alignas(CACHE_LINE_SIZE) std::atomic<size_t> pop_position_{0};
+};
+
+}  // namespace bustub
@@ -0,0 +1,171 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// compression_util.h
+//
+// Identification: src/include/common/util/compression_util.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace bustub {
+
+/**
+ * A small LZ77 block compressor in the spirit of LZ4, used to compress log buffers before they are written.
+ *
+ * The compressed block is a sequence of
+ *-----------------------------------------------------------------------------------------
+ * | token | literal_length... | literals | match_offset (2 bytes) | match_length... |
+ *-----------------------------------------------------------------------------------------
+ * where the high nibble of the token is the number of literals and the low nibble the match length minus
+ * MIN_MATCH. A nibble of 15 continues in the following bytes, each adding up to 255. The last sequence has literals
+ * only and ends the block.
+ */
+class CompressionUtil {
+ public:
+  /** @return an upper bound of the compressed size of size bytes */
+  static inline size_t MaxCompressedLength(size_t size) { return size + size / 255 + 16; }
+
+  /**
+   * Compress a block.
+   * @param src the data to compress
+   * @param size the size of the data
+   * @param[out] dst room for at least MaxCompressedLength(size) bytes
+   * @return the compressed size
+   */
+  static inline size_t Compress(const char *src, size_t size, char *dst) {
+    const auto *in = reinterpret_cast<const uint8_t *>(src);
+    auto *out = reinterpret_cast<uint8_t *>(dst);
+    // The last position at which each hashed 4-byte sequence was seen, plus one.
+    uint32_t table[1 << HASH_BITS] = {0};
+    size_t anchor = 0;
+    size_t pos = 0;
+    while (pos + MIN_MATCH <= size) {
+      uint32_t sequence;
+      memcpy(&sequence, in + pos, sizeof(sequence));
+      uint32_t hash = (sequence * 2654435761U) >> (32 - HASH_BITS);
+      size_t candidate = table[hash];
+      table[hash] = static_cast<uint32_t>(pos + 1);
+      if (candidate == 0 || pos + 1 - candidate > MAX_OFFSET || memcmp(in + candidate - 1, in + pos, MIN_MATCH) != 0) {
+        pos++;
+        continue;
+      }
+      candidate--;
+      size_t length = MIN_MATCH;
+      while (pos + length < size && in[candidate + length] == in[pos + length]) {
+        length++;
+      }
+      out = WriteSequence(out, in + anchor, pos - anchor, pos - candidate, length);
+      pos += length;
+      anchor = pos;
+    }
+    out = WriteSequence(out, in + anchor, size - anchor, 0, 0);
+    return out - reinterpret_cast<uint8_t *>(dst);
+  }
+
+  /**
+   * Decompress a block.
+   * @param src the compressed block
+   * @param size the size of the compressed block
+   * @param[out] dst room for raw_size bytes
+   * @param raw_size the size of the data before compression
+   * @return false if the block is corrupt
+   */
+  static inline bool Decompress(const char *src, size_t size, char *dst, size_t raw_size) {
+    const auto *in = reinterpret_cast<const uint8_t *>(src);
+    auto *out = reinterpret_cast<uint8_t *>(dst);
+    size_t ip = 0;
+    size_t op = 0;
+    while (ip < size) {
+      uint8_t token = in[ip++];
+      size_t literals = token >> 4;
+      if (!ReadLength(in, size, &ip, &literals) || ip + literals > size || op + literals > raw_size) {
+        return false;
+      }
+      memcpy(out + op, in + ip, literals);
+      ip += literals;
+      op += literals;
+      if (ip == size) {
+        break;
+      }
+      if (ip + 2 > size) {
+        return false;
+      }
+      size_t offset = in[ip] | (static_cast<size_t>(in[ip + 1]) << 8);
+      ip += 2;
+      size_t length = token & 0x0F;
+      if (!ReadLength(in, size, &ip, &length)) {
+        return false;
+      }
+      length += MIN_MATCH;
+      if (offset == 0 || offset > op || op + length > raw_size) {
+        return false;
+      }
+      // The match may overlap the bytes it produces, so copy byte by byte.
+      for (size_t i = 0; i < length; i++, op++) {
+        out[op] = out[op - offset];
+      }
+    }
+    return op == raw_size;
+  }
+
+ private:
+  static constexpr size_t MIN_MATCH = 4;
+  static constexpr size_t MAX_OFFSET = 0xFFFF;
+  static constexpr int HASH_BITS = 12;
+
+  static inline uint8_t *WriteLength(uint8_t *out, size_t length) {
+    for (length -= 15; length >= 255; length -= 255) {
+      *out++ = 255;
+    }
+    *out++ = static_cast<uint8_t>(length);
+    return out;
+  }
+
+  static inline bool ReadLength(const uint8_t *in, size_t size, size_t *ip, size_t *length) {
+    if (*length != 15) {
+      return true;
+    }
+    uint8_t byte;
+    do {
+      if (*ip >= size) {
+        return false;
+      }
+      byte = in[(*ip)++];
+      *length += byte;
+    } while (byte == 255);
+    return true;
+  }
+
+  /** Write literals followed by a match, or the last sequence if match_length is 0. */
+  static inline uint8_t *WriteSequence(uint8_t *out, const uint8_t *literals, size_t literal_length,
+                                       size_t match_offset, size_t match_length) {
+    size_t match_code = match_length == 0 ? 0 : match_length - MIN_MATCH;
+    *out++ = static_cast<uint8_t>((std::min<size_t>(literal_length, 15) << 4) | std::min<size_t>(match_code, 15));
+    if (literal_length >= 15) {
+      out = WriteLength(out, literal_length);
+    }
+    memcpy(out, literals, literal_length);
+    out += literal_length;
+    if (match_length == 0) {
+      return out;
+    }
+    *out++ = static_cast<uint8_t>(match_offset & 0xFF);
+    *out++ = static_cast<uint8_t>(match_offset >> 8);
+    if (match_code >= 15) {
+      out = WriteLength(out, match_code);
+    }
+    return out;
+  }
+};
+
+}  // namespace bustub
@@ -0,0 +1,92 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// crc32c_util.h
+//
+// Identification: src/include/common/util/crc32c_util.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace bustub {
+
+/**
+ * CRC32C (Castagnoli) checksums, computed with the SSE4.2 crc32 instruction if the CPU has it and with a lookup table
+ * otherwise.
+ */
+class Crc32cUtil {
+ public:
+  /** @return the CRC32C of size bytes at data */
+  static inline uint32_t Crc32c(const char *data, size_t size) {
+    static const bool hardware = HasHardwareSupport();
+    return hardware ? Crc32cHardware(data, size) : Crc32cSoftware(data, size);
+  }
+
+  /** @return true if the CPU has the crc32 instruction */
+  static inline bool HasHardwareSupport() {
+#if defined(__x86_64__)
+    return __builtin_cpu_supports("sse4.2");
+#else
+    return false;
+#endif
+  }
+
+  /** @return the CRC32C of size bytes at data, computed with a lookup table */
+  static inline uint32_t Crc32cSoftware(const char *data, size_t size) {
+    static const std::array<uint32_t, 256> table = [] {
+      std::array<uint32_t, 256> table{};
+      for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+          crc = (crc >> 1) ^ ((crc & 1) != 0 ? POLYNOMIAL : 0);
+        }
+        table[i] = crc;
+      }
+      return table;
+    }();
+    uint32_t crc = ~0U;
+    for (size_t i = 0; i < size; i++) {
+      crc = table[(crc ^ static_cast<uint8_t>(data[i])) & 0xFF] ^ (crc >> 8);
+    }
+    return ~crc;
+  }
+
+#if defined(__x86_64__)
+  /** @return the CRC32C of size bytes at data, computed with the crc32 instruction, which the CPU must have */
+  __attribute__((target("sse4.2"))) static inline uint32_t Crc32cHardware(const char *data, size_t size) {
+    uint64_t crc = ~0U;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= size; i += sizeof(uint64_t)) {
+      uint64_t word;
+      memcpy(&word, data + i, sizeof(word));
+      crc = _mm_crc32_u64(crc, word);
+    }
+    auto crc32 = static_cast<uint32_t>(crc);
+    for (; i < size; i++) {
+      crc32 = _mm_crc32_u8(crc32, static_cast<uint8_t>(data[i]));
+    }
+    return ~crc32;
+  }
+#else
+  static inline uint32_t Crc32cHardware(const char *data, size_t size) { return Crc32cSoftware(data, size); }
+#endif
+
+ private:
+  /** The reversed Castagnoli polynomial. */
+  static constexpr uint32_t POLYNOMIAL = 0x82F63B78;
+};
+
+}  // namespace bustub
@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// varint_util.h
+//
+// Identification: src/include/common/util/varint_util.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace bustub {
+
+/**
+ * Variable-length encoding of unsigned integers, 7 bits per byte, least significant group first. The high bit of a
+ * byte is set if more bytes follow. Values below 128 take one byte, a uint32_t takes at most MAX_LENGTH bytes.
+ */
+class VarintUtil {
+ public:
+  static constexpr size_t MAX_LENGTH = 5;
+
+  /** @return the number of bytes value takes encoded */
+  static inline size_t Length(uint32_t value) {
+    size_t length = 1;
+    while (value >= 0x80) {
+      value >>= 7;
+      length++;
+    }
+    return length;
+  }
+
+  /**
+   * Encode value into storage.
+   * @return the position after the encoded value
+   */
+  static inline char *Encode(uint32_t value, char *storage) {
+    auto *pos = reinterpret_cast<uint8_t *>(storage);
+    while (value >= 0x80) {
+      *pos++ = static_cast<uint8_t>(value | 0x80);
+      value >>= 7;
+    }
+    *pos++ = static_cast<uint8_t>(value);
+    return reinterpret_cast<char *>(pos);
+  }
+
+  /**
+   * Decode a value from storage, reading no more than MAX_LENGTH bytes.
+   * @param[out] value the decoded value
+   * @return the position after the encoded value, nullptr if the encoding is longer than MAX_LENGTH bytes
+   */
+  static inline const char *Decode(const char *storage, uint32_t *value) {
+    const auto *pos = reinterpret_cast<const uint8_t *>(storage);
+    uint32_t result = 0;
+    for (size_t i = 0; i < MAX_LENGTH; i++) {
+      uint8_t byte = *pos++;
+      result |= static_cast<uint32_t>(byte & 0x7F) << (7 * i);
+      if ((byte & 0x80) == 0) {
+        *value = result;
+        return reinterpret_cast<const char *>(pos);
+      }
+    }
+    return nullptr;
+  }
+};
+
+}  // namespace bustub
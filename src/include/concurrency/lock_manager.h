@@ -13,11 +13,13 @@
 #pragma once
 
 #include <algorithm>
+#include <chrono>  // NOLINT
 #include <condition_variable>  // NOLINT
 #include <list>
 #include <memory>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -28,12 +30,40 @@ namespace bustub {
 
 class TransactionManager;
 
+/**
+ * How the lock manager deals with deadlocks. Transaction ids double as timestamps: a smaller id is an older
+ * transaction.
+ * DETECTION:  requests wait, a background thread aborts the youngest transaction of every cycle in the waits-for graph.
+ * WOUND_WAIT: an older requester aborts the younger transactions it conflicts with, a younger requester waits.
+ * WAIT_DIE:   an older requester waits, a younger requester aborts itself.
+ * NO_WAIT:    a requester that would have to wait aborts itself.
+ */
+enum class DeadlockPolicy { DETECTION, WOUND_WAIT, WAIT_DIE, NO_WAIT };
+
+/** Counters describing the work spent on deadlocks. */
+struct DeadlockStats {
+  /** Number of runs of the cycle detector. */
+  size_t detector_runs_{0};
+  /** Total time spent in the cycle detector. */
+  std::chrono::microseconds detector_time_{0};
+  /** Number of transactions aborted by the detector or by the prevention policy. */
+  size_t victims_{0};
+  /** The most recently aborted transaction. */
+  txn_id_t last_victim_{INVALID_TXN_ID};
+};
+
 /**
  * LockManager handles transactions asking for locks on records.
+ *
+ * Besides flat per-RID locks, the lock manager supports multi-granularity locking over the hierarchy
+ * table -> page -> row, which the table pages use for the rows they read and write. Locking a row through LockRow()
+ * takes the matching intention locks on its table and page first, so that a table lock conflicts with the row locks
+ * of other transactions in the table. Once a transaction holds more than lock_escalation_threshold row locks in one
+ * table, its row and page locks in that table are replaced by a single table lock, so that bulk operations take O(1)
+ * locks. Row locks are taken under page latches, which the waits-for graph does not see, so escalation never waits:
+ * it only happens when the table lock can be granted at once, and is tried again at the next row lock otherwise.
  */
 class LockManager {
-  enum class LockMode { SHARED, EXCLUSIVE };
-
   class LockRequest {
    public:
     LockRequest(txn_id_t txn_id, LockMode lock_mode) : txn_id_(txn_id), lock_mode_(lock_mode), granted_(false) {}
@@ -46,32 +76,40 @@ class LockManager {
   class LockRequestQueue {
    public:
     std::list<LockRequest> request_queue_;
-    std::condition_variable cv_;  // for notifying blocked transactions on this rid
+    std::condition_variable cv_;  // for notifying blocked transactions on this resource
     bool upgrading_ = false;
   };
 
  public:
   /**
-   * Creates a new lock manager configured for the deadlock detection policy.
+   * Creates a new lock manager configured for the given deadlock policy.
+   * The cycle detection thread only runs under DeadlockPolicy::DETECTION.
    */
-  LockManager() {
-    enable_cycle_detection_ = true;
-    cycle_detection_thread_ = new std::thread(&LockManager::RunCycleDetection, this);
-    LOG_INFO("Cycle detection thread launched");
+  explicit LockManager(DeadlockPolicy policy = DeadlockPolicy::DETECTION) : policy_(policy) {
+    enable_cycle_detection_ = policy == DeadlockPolicy::DETECTION;
+    if (enable_cycle_detection_) {
+      cycle_detection_thread_ = new std::thread(&LockManager::RunCycleDetection, this);
+      LOG_INFO("Cycle detection thread launched");
+    }
   }
 
   ~LockManager() {
-    enable_cycle_detection_ = false;
-    cycle_detection_thread_->join();
-    delete cycle_detection_thread_;
-    LOG_INFO("Cycle detection thread stopped");
+    if (enable_cycle_detection_) {
+      enable_cycle_detection_ = false;
+      cycle_detection_thread_->join();
+      delete cycle_detection_thread_;
+      LOG_INFO("Cycle detection thread stopped");
+    }
   }
 
   /*
    * [LOCK_NOTE]: For all locking functions, we:
    * 1. return false if the transaction is aborted; and
    * 2. block on wait, return true when the lock request is granted; and
-   * 3. it is undefined behavior to try locking an already locked RID in the same transaction, i.e. the transaction
+   * 3. throw TransactionAbortException with AbortReason::DEADLOCK if the transaction is chosen as a deadlock victim
+   *    while waiting, must not wait under the configured DeadlockPolicy, or was wounded under
+   *    DeadlockPolicy::WOUND_WAIT since its previous request; and
+   * 4. it is undefined behavior to try locking an already locked RID in the same transaction, i.e. the transaction
    *    is responsible for keeping track of its current locks.
    */
 
@@ -107,6 +145,91 @@ class LockManager {
    */
   bool Unlock(Transaction *txn, const RID &rid);
 
+  /*
+   * [HIERARCHY_NOTE]: The hierarchical locking functions follow [LOCK_NOTE], except that re-locking a resource that
+   * is already locked is allowed: the lock is upgraded to the weakest mode that covers both the held and the
+   * requested mode, and nothing happens if the held mode already covers the request.
+   */
+
+  /**
+   * Acquire a lock on a table. See [HIERARCHY_NOTE] in header file.
+   * @param txn the transaction requesting the lock
+   * @param lock_mode the requested lock mode
+   * @param oid the table to be locked
+   * @return true if the lock is granted, false otherwise
+   */
+  bool LockTable(Transaction *txn, LockMode lock_mode, table_oid_t oid);
+
+  /**
+   * Acquire a lock on a page of a table, taking the matching intention lock on the table first.
+   * See [HIERARCHY_NOTE] in header file.
+   * @param txn the transaction requesting the lock
+   * @param lock_mode the requested lock mode
+   * @param oid the table that the page belongs to
+   * @param page_id the page to be locked
+   * @return true if the lock is granted, false otherwise
+   */
+  bool LockPage(Transaction *txn, LockMode lock_mode, table_oid_t oid, page_id_t page_id);
+
+  /**
+   * Acquire a SHARED or EXCLUSIVE lock on a row, taking the matching intention locks on its table and page first.
+   * Returns immediately if the transaction's table lock already covers the row. May escalate to a table lock, if it
+   * can be granted without waiting.
+   * See [HIERARCHY_NOTE] in header file.
+   * @param txn the transaction requesting the lock
+   * @param lock_mode the requested lock mode, either SHARED or EXCLUSIVE
+   * @param oid the table that the row belongs to
+   * @param rid the row to be locked
+   * @return true if the lock is granted, false otherwise
+   */
+  bool LockRow(Transaction *txn, LockMode lock_mode, table_oid_t oid, const RID &rid);
+
+  /**
+   * Release a table lock. All page and row locks of the transaction in this table must have been released.
+   * @param txn the transaction releasing the lock
+   * @param oid the table that is locked by the transaction
+   * @return true if the unlock is successful, false otherwise
+   */
+  bool UnlockTable(Transaction *txn, table_oid_t oid);
+
+  /**
+   * Release a page lock.
+   * @param txn the transaction releasing the lock
+   * @param oid the table that the page belongs to
+   * @param page_id the page that is locked by the transaction
+   * @return true if the unlock is successful, false otherwise
+   */
+  bool UnlockPage(Transaction *txn, table_oid_t oid, page_id_t page_id);
+
+  /**
+   * Release a row lock taken through LockRow().
+   * @param txn the transaction releasing the lock
+   * @param oid the table that the row belongs to
+   * @param rid the row that is locked by the transaction
+   * @return true if the unlock is successful, false otherwise
+   */
+  bool UnlockRow(Transaction *txn, table_oid_t oid, const RID &rid);
+
+  /**
+   * Release every lock held by the transaction, finest granularity first. Called on commit and abort.
+   * @param txn the transaction releasing its locks
+   */
+  void UnlockAll(Transaction *txn);
+
+  /** @return true if a lock held in mode held is compatible with a lock requested in mode requested */
+  static bool AreCompatible(LockMode held, LockMode requested);
+
+  /** @return true if holding a lock in mode held grants everything that mode requested grants */
+  static bool Covers(LockMode held, LockMode requested);
+
+  /** @return the weakest lock mode that covers both a and b */
+  static LockMode Combine(LockMode a, LockMode b);
+
+  /**
+   * @return true if the row, page or table locks that txn holds through the hierarchical API grant lock_mode on a row
+   */
+  static bool IsRowLocked(Transaction *txn, LockMode lock_mode, table_oid_t oid, const RID &rid);
+
   /*** Graph API ***/
   /**
    * Adds edge t1->t2
@@ -131,13 +254,97 @@ class LockManager {
   /** Runs cycle detection in the background. */
   void RunCycleDetection();
 
+  /** @return the deadlock policy of this lock manager */
+  DeadlockPolicy GetDeadlockPolicy() const { return policy_; }
+
+  /** @return a snapshot of the deadlock counters */
+  DeadlockStats GetDeadlockStats();
+
  private:
+  /**
+   * Enqueue a request and block until it is granted. The caller must hold latch_.
+   * Throws TransactionAbortException if the transaction is aborted instead of being granted the lock.
+   * @return true if the lock is granted
+   */
+  bool AcquireLock(Transaction *txn, LockRequestQueue *queue, LockMode lock_mode, std::unique_lock<std::mutex> *guard);
+
+  /**
+   * Upgrade the granted request of txn in the queue to lock_mode and block until it is granted. The caller must hold
+   * latch_. Aborts the transaction if another transaction is already upgrading on this queue, or if it is aborted
+   * instead of being granted the upgrade. The held lock is lost in both cases.
+   * @return true if the upgrade is granted
+   */
+  bool UpgradeLock(Transaction *txn, LockRequestQueue *queue, LockMode lock_mode, std::unique_lock<std::mutex> *guard);
+
+  /**
+   * Remove the request of txn from the queue and wake up the waiters. The caller must hold latch_.
+   * @param[out] lock_mode the mode of the removed request
+   * @return false if txn had no request in the queue
+   */
+  bool ReleaseLock(Transaction *txn, LockRequestQueue *queue, LockMode *lock_mode);
+
+  /**
+   * Block until the request of txn in the queue can be granted, applying the deadlock policy whenever it has to wait.
+   * Keeps the outgoing edges of txn in the waits-for graph up to date while it waits. The caller must hold latch_.
+   * @return true if the request can be granted, false if the transaction was aborted
+   */
+  bool WaitForGrant(Transaction *txn, LockRequestQueue *queue, std::unique_lock<std::mutex> *guard);
+
+  /** @return the other transactions whose requests ahead of txn_id's request conflict with it */
+  std::vector<txn_id_t> GetBlockers(const LockRequestQueue &queue, txn_id_t txn_id);
+
+  /** Abort a deadlock victim and wake it up if it is waiting for a lock. The caller must hold latch_. */
+  void AbortVictim(Transaction *victim);
+
+  /** Remove all outgoing edges of txn_id from the waits-for graph. */
+  void RemoveEdges(txn_id_t txn_id);
+
+  /**
+   * Check the isolation level and the 2PL state before taking a lock, aborting the transaction on a violation.
+   * @return false if the transaction is already aborted
+   */
+  bool CheckLockPreconditions(Transaction *txn, LockMode lock_mode);
+
+  /** Move the transaction to the shrinking phase after it released a lock in the given mode. */
+  void TransitionOnUnlock(Transaction *txn, LockMode lock_mode);
+
+  /** Lock a table in the given mode, combining it with the mode that txn may already hold. */
+  bool LockTableLocked(Transaction *txn, LockMode lock_mode, table_oid_t oid, std::unique_lock<std::mutex> *guard);
+
+  /** Lock a page in the given mode, combining it with the mode that txn may already hold. */
+  bool LockPageLocked(Transaction *txn, LockMode lock_mode, table_oid_t oid, page_id_t page_id,
+                      std::unique_lock<std::mutex> *guard);
+
+  /**
+   * Replace all page and row locks of txn in table oid with a single table lock, unless that lock cannot be granted
+   * without waiting.
+   * @return true if the locks were escalated
+   */
+  bool Escalate(Transaction *txn, table_oid_t oid, std::unique_lock<std::mutex> *guard);
+
+  /** @return true if txn could be granted a table lock in the given mode without waiting */
+  bool IsTableLockGrantable(Transaction *txn, LockMode lock_mode, table_oid_t oid);
+
   std::mutex latch_;
+  DeadlockPolicy policy_;
   std::atomic<bool> enable_cycle_detection_;
-  std::thread *cycle_detection_thread_;
+  std::thread *cycle_detection_thread_{nullptr};
 
-  /** Lock table for lock requests. */
+  /** Lock table for row lock requests, shared by the flat and the hierarchical API. */
   std::unordered_map<RID, LockRequestQueue> lock_table_;
+  /** Lock table for hierarchical table lock requests. */
+  std::unordered_map<table_oid_t, LockRequestQueue> table_lock_table_;
+  /** Lock table for hierarchical page lock requests. */
+  std::unordered_map<page_id_t, LockRequestQueue> page_lock_table_;
+  /** Waiting transactions and the queue they wait in, used to wake up deadlock victims. */
+  std::unordered_map<txn_id_t, std::pair<Transaction *, LockRequestQueue *>> waiting_;
+  /** Transactions wounded while they were not waiting, which have not been told at a lock request yet. */
+  std::unordered_set<txn_id_t> wounded_;
+  /** Deadlock counters, protected by latch_. */
+  DeadlockStats stats_;
+
+  /** Protects waits_for_, which may also be used without holding latch_. */
+  std::mutex graph_latch_;
   /** Waits-for graph representation. */
   std::unordered_map<txn_id_t, std::vector<txn_id_t>> waits_for_;
 };
@@ -17,6 +17,7 @@
 #include <memory>
 #include <string>
 #include <thread>  // NOLINT
+#include <unordered_map>
 #include <unordered_set>
 
 #include "common/config.h"
@@ -44,15 +45,22 @@ namespace bustub {
 enum class TransactionState { GROWING, SHRINKING, COMMITTED, ABORTED };
 
 /**
- * Transaction isolation level.
+ * Transaction isolation level. SNAPSHOT_ISOLATION transactions read the tuple versions that were committed when they
+ * began without taking shared locks, and abort when they write a tuple that was changed after they began.
  */
-enum class IsolationLevel { READ_UNCOMMITTED, REPEATABLE_READ, READ_COMMITTED };
+enum class IsolationLevel { READ_UNCOMMITTED, REPEATABLE_READ, READ_COMMITTED, SNAPSHOT_ISOLATION };
 
 /**
  * Type of write operation.
  */
 enum class WType { INSERT = 0, DELETE, UPDATE };
 
+/**
+ * Lock modes for multi-granularity locking. Tables and pages may be locked in any mode, rows only in SHARED or
+ * EXCLUSIVE mode. The intention modes announce that finer grained locks are held below the locked resource.
+ */
+enum class LockMode { SHARED, EXCLUSIVE, INTENTION_SHARED, INTENTION_EXCLUSIVE, SHARED_INTENTION_EXCLUSIVE };
+
 class TableHeap;
 class Catalog;
 using table_oid_t = uint32_t;
@@ -155,7 +163,10 @@ class Transaction {
         txn_id_(txn_id),
         prev_lsn_(INVALID_LSN),
         shared_lock_set_{new std::unordered_set<RID>},
-        exclusive_lock_set_{new std::unordered_set<RID>} {
+        exclusive_lock_set_{new std::unordered_set<RID>},
+        table_lock_set_{new std::unordered_map<table_oid_t, LockMode>},
+        page_lock_set_{new std::unordered_map<table_oid_t, std::unordered_map<page_id_t, LockMode>>},
+        row_lock_set_{new std::unordered_map<table_oid_t, std::unordered_map<RID, LockMode>>} {
     // Initialize the sets that will be tracked.
     table_write_set_ = std::make_shared<std::deque<TableWriteRecord>>();
     index_write_set_ = std::make_shared<std::deque<IndexWriteRecord>>();
@@ -228,6 +239,33 @@ class Transaction {
   /** @return true if rid is exclusively locked by this transaction */
   bool IsExclusiveLocked(const RID &rid) { return exclusive_lock_set_->find(rid) != exclusive_lock_set_->end(); }
 
+  /** @return the mode in which each table is locked by this transaction */
+  inline std::shared_ptr<std::unordered_map<table_oid_t, LockMode>> GetTableLockSet() { return table_lock_set_; }
+
+  /** @return the mode in which each page is locked by this transaction, grouped by table */
+  inline std::shared_ptr<std::unordered_map<table_oid_t, std::unordered_map<page_id_t, LockMode>>> GetPageLockSet() {
+    return page_lock_set_;
+  }
+
+  /** @return the mode in which each row is locked by this transaction, grouped by table */
+  inline std::shared_ptr<std::unordered_map<table_oid_t, std::unordered_map<RID, LockMode>>> GetRowLockSet() {
+    return row_lock_set_;
+  }
+
+  /**
+   * @param oid the table to look up
+   * @param[out] mode the mode in which the table is locked, if it is locked
+   * @return true if the table is locked by this transaction
+   */
+  bool IsTableLocked(table_oid_t oid, LockMode *mode) {
+    auto it = table_lock_set_->find(oid);
+    if (it == table_lock_set_->end()) {
+      return false;
+    }
+    *mode = it->second;
+    return true;
+  }
+
   /** @return the current state of the transaction */
   inline TransactionState GetState() { return state_; }
 
@@ -237,6 +275,24 @@ class Transaction {
    */
   inline void SetState(TransactionState state) { state_ = state; }
 
+  /** @return the timestamp of the snapshot read by this transaction */
+  inline timestamp_t GetReadTs() const { return read_ts_; }
+
+  /** @param read_ts the timestamp of the snapshot read by this transaction */
+  inline void SetReadTs(timestamp_t read_ts) { read_ts_ = read_ts; }
+
+  /** @return true if the writes of this transaction save the previous versions of the tuples they overwrite */
+  inline bool KeepsVersions() const { return keeps_versions_; }
+
+  /** @param keeps_versions true if the transaction manager runs snapshot isolation */
+  inline void SetKeepsVersions(bool keeps_versions) { keeps_versions_ = keeps_versions; }
+
+  /** @return the commit timestamp of this transaction, INVALID_TS if it did not commit */
+  inline timestamp_t GetCommitTs() const { return commit_ts_; }
+
+  /** @param commit_ts the commit timestamp of this transaction */
+  inline void SetCommitTs(timestamp_t commit_ts) { commit_ts_ = commit_ts; }
+
   /** @return the previous LSN */
   inline lsn_t GetPrevLSN() { return prev_lsn_; }
 
@@ -246,6 +302,12 @@ class Transaction {
    */
   inline void SetPrevLSN(lsn_t prev_lsn) { prev_lsn_ = prev_lsn; }
 
+  /** @return the LSN of the BEGIN record of the transaction, INVALID_LSN if it was not logged */
+  inline lsn_t GetBeginLSN() { return begin_lsn_; }
+
+  /** @param begin_lsn the LSN of the BEGIN record of the transaction */
+  inline void SetBeginLSN(lsn_t begin_lsn) { begin_lsn_ = begin_lsn; }
+
  private:
   /** The current transaction state. */
   TransactionState state_;
@@ -255,6 +317,12 @@ class Transaction {
   std::thread::id thread_id_;
   /** The ID of this transaction. */
   txn_id_t txn_id_;
+  /** The timestamp of the snapshot read by this transaction. */
+  timestamp_t read_ts_{0};
+  /** The commit timestamp of this transaction. */
+  timestamp_t commit_ts_{INVALID_TS};
+  /** True if the writes of this transaction are versioned for snapshot isolation. */
+  bool keeps_versions_{false};
 
   /** The undo set of table tuples. */
   std::shared_ptr<std::deque<TableWriteRecord>> table_write_set_;
@@ -262,6 +330,8 @@ class Transaction {
   std::shared_ptr<std::deque<IndexWriteRecord>> index_write_set_;
   /** The LSN of the last record written by the transaction. */
   lsn_t prev_lsn_;
+  /** The LSN of the first record written by the transaction, undo may read the log back to it. */
+  lsn_t begin_lsn_{INVALID_LSN};
 
   /** Concurrent index: the pages that were latched during index operation. */
   std::shared_ptr<std::deque<Page *>> page_set_;
@@ -272,6 +342,12 @@ class Transaction {
   std::shared_ptr<std::unordered_set<RID>> shared_lock_set_;
   /** LockManager: the set of exclusive-locked tuples held by this transaction. */
   std::shared_ptr<std::unordered_set<RID>> exclusive_lock_set_;
+  /** LockManager: the tables locked by this transaction and their lock modes. */
+  std::shared_ptr<std::unordered_map<table_oid_t, LockMode>> table_lock_set_;
+  /** LockManager: the pages locked by this transaction and their lock modes, grouped by table. */
+  std::shared_ptr<std::unordered_map<table_oid_t, std::unordered_map<page_id_t, LockMode>>> page_lock_set_;
+  /** LockManager: the rows locked through the table hierarchy and their lock modes, grouped by table. */
+  std::shared_ptr<std::unordered_map<table_oid_t, std::unordered_map<RID, LockMode>>> row_lock_set_;
 };
 
 }  // namespace bustub
@@ -13,12 +13,16 @@
 #pragma once
 
 #include <atomic>
+#include <mutex>  // NOLINT
+#include <set>
+#include <thread>  // NOLINT
 #include <unordered_map>
 #include <unordered_set>
 
 #include "common/config.h"
 #include "concurrency/lock_manager.h"
 #include "concurrency/transaction.h"
+#include "concurrency/version_store.h"
 #include "recovery/log_manager.h"
 
 namespace bustub {
@@ -26,25 +30,55 @@ class LockManager;
 
 /**
  * TransactionManager keeps track of all the transactions running in the system.
+ *
+ * It also hands out the timestamps used for multi-version concurrency control: every transaction reads the snapshot
+ * of the latest commit when it begins, and every committing writer gets the next commit timestamp. When snapshot
+ * isolation is enabled, the writes of all its transactions are versioned in the version stores of the tables they
+ * write, and a background garbage collector drops the versions that are older than the oldest active snapshot.
  */
 class TransactionManager {
  public:
-  explicit TransactionManager(LockManager *lock_manager, LogManager *log_manager = nullptr)
-      : lock_manager_(lock_manager), log_manager_(log_manager) {}
+  /**
+   * Creates a new transaction manager.
+   * @param lock_manager the lock manager
+   * @param log_manager the log manager
+   * @param enable_snapshot_isolation true if transactions may run under snapshot isolation, which versions every write
+   */
+  explicit TransactionManager(LockManager *lock_manager, LogManager *log_manager = nullptr,
+                              bool enable_snapshot_isolation = false)
+      : lock_manager_(lock_manager), log_manager_(log_manager), enable_snapshot_isolation_(enable_snapshot_isolation) {
+    enable_gc_ = enable_snapshot_isolation;
+    if (enable_gc_) {
+      gc_thread_ = new std::thread(&TransactionManager::RunGarbageCollection, this);
+    }
+  }
 
-  ~TransactionManager() = default;
+  ~TransactionManager() {
+    if (enable_gc_) {
+      enable_gc_ = false;
+      gc_thread_->join();
+      delete gc_thread_;
+    }
+    std::lock_guard<std::mutex> guard(version_store_latch_);
+    for (auto *store : version_stores_) {
+      store->SetOwner(nullptr);
+    }
+  }
 
   /**
    * Begins a new transaction.
    * @param txn an optional transaction object to be initialized, otherwise a new transaction is created.
    * @param isolation_level an optional isolation level of the transaction.
    * @return an initialized transaction
+   * @throw Exception if the isolation level is SNAPSHOT_ISOLATION and snapshot isolation is not enabled
    */
   Transaction *Begin(Transaction *txn = nullptr, IsolationLevel isolation_level = IsolationLevel::REPEATABLE_READ);
 
   /**
    * Commits a transaction.
    * @param txn the transaction to commit
+   * @throw TransactionAbortException if the transaction was aborted while it ran, e.g. wounded by an older one under
+   * WOUND_WAIT without requesting a lock since; it is left as is for the caller to Abort()
    */
   void Commit(Transaction *txn);
 
@@ -73,6 +107,31 @@ class TransactionManager {
     return res;
   }
 
+  /** @return the timestamp of the oldest snapshot that may still be read by a running transaction */
+  timestamp_t GetWatermark();
+
+  /**
+   * Reclaim the tuple versions that no running transaction can see anymore, in the version stores written by the
+   * transactions of this manager.
+   * @return the number of versions reclaimed
+   */
+  size_t GarbageCollect();
+
+  /** Forget a version store that is being destroyed. */
+  void UnregisterVersionStore(VersionStore *store);
+
+  /** Runs garbage collection in the background. */
+  void RunGarbageCollection();
+
+  /**
+   * Take the active transaction table for a fuzzy checkpoint.
+   * @return the LSN of the last log record of every running transaction that has written one
+   */
+  std::unordered_map<txn_id_t, lsn_t> GetActiveTransactionTable();
+
+  /** @return the LSN of the oldest BEGIN record of a running transaction, INVALID_LSN if there is none */
+  lsn_t GetOldestBeginLSN();
+
   /** Prevents all transactions from performing operations, used for checkpointing. */
   void BlockAllTransactions();
 
@@ -84,25 +143,39 @@ class TransactionManager {
    * Releases all the locks held by the given transaction.
    * @param txn the transaction whose locks should be released
    */
-  void ReleaseLocks(Transaction *txn) {
-    std::unordered_set<RID> lock_set;
-    for (auto item : *txn->GetExclusiveLockSet()) {
-      lock_set.emplace(item);
-    }
-    for (auto item : *txn->GetSharedLockSet()) {
-      lock_set.emplace(item);
-    }
-    for (auto locked_rid : lock_set) {
-      lock_manager_->Unlock(txn, locked_rid);
-    }
-  }
+  void ReleaseLocks(Transaction *txn) { lock_manager_->UnlockAll(txn); }
+
+  /** Register the version stores of the tables written by txn, so that the garbage collector reaches them. */
+  void RegisterVersionStores(Transaction *txn);
 
   std::atomic<txn_id_t> next_txn_id_{0};
-  LockManager *lock_manager_ __attribute__((__unused__));
-  LogManager *log_manager_ __attribute__((__unused__));
+  LockManager *lock_manager_;
+  LogManager *log_manager_;
 
   /** The global transaction latch is used for checkpointing. */
   ReaderWriterLatch global_txn_latch_;
+
+  /** Protects running_txns_. */
+  std::mutex running_latch_;
+  /** The transactions that began and did not commit or abort yet. */
+  std::unordered_map<txn_id_t, Transaction *> running_txns_;
+
+  /** Protects the timestamps below. */
+  std::mutex timestamp_latch_;
+  /** The commit timestamp of the latest committed writer. */
+  timestamp_t last_commit_ts_{0};
+  /** The read timestamps of the running snapshot isolation transactions. */
+  std::multiset<timestamp_t> active_snapshots_;
+
+  /** True if transactions may run under snapshot isolation. */
+  const bool enable_snapshot_isolation_;
+  /** Protects version_stores_. */
+  std::mutex version_store_latch_;
+  /** The version stores written by the transactions of this manager. */
+  std::unordered_set<VersionStore *> version_stores_;
+
+  std::atomic<bool> enable_gc_;
+  std::thread *gc_thread_{nullptr};
 };
 
 }  // namespace bustub
@@ -0,0 +1,129 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// version_store.h
+//
+// Identification: src/include/concurrency/version_store.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+
+#include "common/config.h"
+#include "common/macros.h"
+#include "common/rid.h"
+#include "concurrency/transaction.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+class TransactionManager;
+
+/**
+ * VersionStore keeps the old versions of the tuples of one TableHeap for multi-version concurrency control.
+ *
+ * The newest version of a tuple always lives in place on its table page. For every RID written since the oldest
+ * active snapshot, the store keeps a version chain: the writer and commit timestamp of the in-place version, followed
+ * by the images the tuple had before, newest first. A RID without a chain has one version, visible to every snapshot.
+ *
+ * RecordWrite() and Rollback() must be called while holding the write latch of the page containing the RID, and
+ * GetVisibleVersion() while holding its read latch, so that a chain is always seen together with its in-place tuple.
+ *
+ * Only the writes of transactions whose transaction manager runs snapshot isolation are versioned. That manager
+ * registers the store once one of its transactions wrote to it, and its garbage collector reclaims the old versions.
+ */
+class VersionStore {
+ public:
+  /** Where the version of a tuple that is visible to a snapshot lives. */
+  enum class Visibility { IN_PLACE, UNDO, NONE };
+
+  VersionStore() = default;
+
+  ~VersionStore();
+
+  DISALLOW_COPY_AND_MOVE(VersionStore);
+
+  /**
+   * First-updater-wins check for snapshot isolation.
+   * @return false if the in-place version of rid was written by another transaction that is still running, or was
+   * committed after the snapshot of txn was taken
+   */
+  bool CanWrite(const RID &rid, Transaction *txn);
+
+  /**
+   * Record that txn overwrote the in-place version of rid, saving the previous version in the chain.
+   * @param rid the written tuple
+   * @param txn the writing transaction
+   * @param old_tuple the in-place tuple before the write, nullptr if the slot held no tuple
+   * @param deleted true if the write deleted the tuple
+   */
+  void RecordWrite(const RID &rid, Transaction *txn, const Tuple *old_tuple, bool deleted);
+
+  /** Stamp the in-place version of rid with the commit timestamp of txn, if txn wrote it. */
+  void Commit(const RID &rid, Transaction *txn, timestamp_t commit_ts);
+
+  /** Undo one write of txn to rid. The previous version is restored once every write of txn is rolled back. */
+  void Rollback(const RID &rid, Transaction *txn);
+
+  /**
+   * Find the version of rid visible to txn.
+   * @param[out] tuple the visible image, only set when the result is Visibility::UNDO
+   * @return IN_PLACE if txn sees the tuple on the table page, UNDO if it sees an old image, NONE if the tuple did not
+   * exist in its snapshot
+   */
+  Visibility GetVisibleVersion(const RID &rid, Transaction *txn, Tuple *tuple);
+
+  /**
+   * Drop the versions that no snapshot taken at or after watermark can see.
+   * @return the number of versions reclaimed
+   */
+  size_t GarbageCollect(timestamp_t watermark);
+
+  /** @return the number of old versions kept in the store */
+  size_t GetVersionCount();
+
+  /** @return the transaction manager that registered this store, nullptr if none did */
+  inline TransactionManager *GetOwner() const { return owner_; }
+
+  /** @param owner the transaction manager that registered this store, nullptr when it forgets the store */
+  inline void SetOwner(TransactionManager *owner) { owner_ = owner; }
+
+ private:
+  /** An old version of a tuple. */
+  struct UndoVersion {
+    /** The image of the tuple, empty if the tuple did not exist in this version. */
+    Tuple tuple_;
+    /** True if the tuple did not exist in this version. */
+    bool deleted_;
+    /** The commit timestamp of the transaction that created this version. */
+    timestamp_t ts_;
+  };
+
+  /** The versions of one RID. */
+  struct VersionChain {
+    /** The transaction that wrote the in-place version and has not committed yet, INVALID_TXN_ID otherwise. */
+    txn_id_t writer_{INVALID_TXN_ID};
+    /** The number of writes of writer_ to the in-place version that were not rolled back. */
+    uint32_t writes_{0};
+    /** True if the in-place version is a deletion. */
+    bool deleted_{false};
+    /** The commit timestamp of the in-place version if it is committed. */
+    timestamp_t ts_{INVALID_TS};
+    /** The old versions, newest first. */
+    std::deque<UndoVersion> undo_;
+  };
+
+  std::mutex latch_;
+  std::unordered_map<RID, VersionChain> chains_;
+  /** The transaction manager whose garbage collector reclaims the versions of this store. */
+  std::atomic<TransactionManager *> owner_{nullptr};
+};
+
+}  // namespace bustub
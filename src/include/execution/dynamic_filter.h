@@ -0,0 +1,103 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// dynamic_filter.h
+//
+// Identification: src/include/execution/dynamic_filter.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/sort_key.h"
+#include "execution/tuple_batch.h"
+
+namespace bustub {
+
+/**
+ * DynamicFilter is a predicate that an operator tightens while its input is still being produced, and that the scan
+ * below it applies to drop rows early. It passes the rows whose normalized sort key (see SortKeyEncoder) is below a
+ * bound: a top-n operator publishes its current n-th key once it holds n rows, since no row that does not sort before
+ * it can make it into the result anymore. Until a bound is published, every row passes.
+ *
+ * The bound may be set from one thread while scans apply the filter on others.
+ */
+class DynamicFilter {
+ public:
+  /** @param order_bys the sort keys, evaluated on the rows being filtered, with their directions */
+  explicit DynamicFilter(std::vector<std::pair<OrderByType, const AbstractExpression *>> &&order_bys)
+      : order_bys_(std::move(order_bys)) {}
+
+  /**
+   * Create a filter on the table rows of a sequential scan from sort keys on its output.
+   * @param order_bys the sort keys, evaluated on the output of the scan
+   * @param scan_schema the output schema of the scan
+   * @return the filter, or nullptr if a key is not an output column computed from the table row
+   */
+  static std::unique_ptr<DynamicFilter> ForScan(
+      const std::vector<std::pair<OrderByType, const AbstractExpression *>> &order_bys, const Schema *scan_schema);
+
+  /** @return the sort keys and their directions */
+  const std::vector<std::pair<OrderByType, const AbstractExpression *>> &GetOrderBys() const { return order_bys_; }
+
+  /** Pass only the rows whose key is below bound from now on. */
+  void SetBound(const std::string &bound) {
+    std::lock_guard<std::mutex> guard(latch_);
+    bound_ = bound;
+    has_bound_ = true;
+    version_.fetch_add(1, std::memory_order_release);
+  }
+
+  /** Pass every row again, for the input to be produced anew. */
+  void Reset() {
+    std::lock_guard<std::mutex> guard(latch_);
+    bound_.clear();
+    has_bound_ = false;
+    version_.fetch_add(1, std::memory_order_release);
+    num_filtered_ = 0;
+  }
+
+  /** @return the number of rows the filter dropped */
+  size_t GetNumFiltered() const { return num_filtered_.load(std::memory_order_relaxed); }
+
+  /** Probe applies a filter to batches, on behalf of one scan. */
+  class Probe {
+   public:
+    explicit Probe(DynamicFilter *filter) : filter_(filter), encoder_(filter->GetOrderBys()) {}
+
+    /** Drop the selected rows of a batch that do not pass the filter. */
+    void Apply(TupleBatch *batch);
+
+   private:
+    DynamicFilter *filter_;
+    SortKeyEncoder encoder_;
+    /** The version of the bound last read, and the bound itself. */
+    uint64_t version_{0};
+    bool has_bound_{false};
+    std::string bound_;
+    std::string key_;
+  };
+
+ private:
+  std::vector<std::pair<OrderByType, const AbstractExpression *>> order_bys_;
+  std::mutex latch_;
+  std::string bound_;
+  bool has_bound_{false};
+  /** The number of bounds set so far, for probes to tell whether theirs is stale without taking the latch. */
+  std::atomic<uint64_t> version_{0};
+  std::atomic<size_t> num_filtered_{0};
+};
+
+}  // namespace bustub
@@ -12,6 +12,13 @@
 
 #pragma once
 
+#include <algorithm>
+#include <list>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <string>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "buffer/buffer_pool_manager.h"
@@ -19,7 +26,13 @@
 #include "concurrency/transaction_manager.h"
 #include "execution/executor_context.h"
 #include "execution/executor_factory.h"
+#include "execution/expressions/parameter_value_expression.h"
 #include "execution/plans/abstract_plan.h"
+#include "execution/prepared_plan.h"
+#include "execution/result_sink.h"
+#include "execution/tuple_batch.h"
+#include "execution/worker_pool.h"
+#include "optimizer/optimizer.h"
 #include "storage/table/tuple.h"
 namespace bustub {
 class ExecutionEngine {
@@ -29,34 +42,174 @@ class ExecutionEngine {
 
   DISALLOW_COPY_AND_MOVE(ExecutionEngine);
 
+  /**
+   * Run a query and collect its result.
+   * @param plan the plan of the query
+   * @param[out] result_set the tuples of the result are appended to it, nullptr to drop them
+   * @param txn the transaction running the query
+   * @param exec_ctx the context of the query
+   * @param[out] error set to the message of the error the query failed with, if it failed; nullptr to drop it
+   * @return true if the query ran to its end, false if it failed
+   */
   bool Execute(const AbstractPlanNode *plan, std::vector<Tuple> *result_set, Transaction *txn,
-               ExecutorContext *exec_ctx) {
+               ExecutorContext *exec_ctx, std::string *error = nullptr) {
+    if (result_set == nullptr) {
+      return Stream(plan, nullptr, txn, exec_ctx, error);
+    }
+    VectorResultSink sink(result_set);
+    return Stream(plan, &sink, txn, exec_ctx, error);
+  }
+
+  /**
+   * Run a query, handing its result to a sink a batch at a time as it is produced. When the sink stops the query,
+   * the executors are closed without running the query to its end.
+   * @param plan the plan of the query
+   * @param sink the sink of the result, nullptr to drop it
+   * @param txn the transaction running the query
+   * @param exec_ctx the context of the query
+   * @param[out] error set to the message of the error the query failed with, if it failed; nullptr to drop it
+   * @return true if the query ran to its end or was stopped by the sink, false if it failed
+   */
+  bool Stream(const AbstractPlanNode *plan, ResultSink *sink, Transaction *txn, ExecutorContext *exec_ctx,
+              std::string *error = nullptr) {
+    // parallel executors run on the threads of the engine
+    exec_ctx->SetWorkerPool(&worker_pool_);
+    exec_ctx->ResetStatistics();
+
+    // rewrite the plan, which must live as long as its executors do
+    Optimizer optimizer(catalog_);
+    if (enable_optimizer) {
+      plan = optimizer.Optimize(plan);
+    }
+
     // construct executor
     auto executor = ExecutorFactory::CreateExecutor(exec_ctx, plan);
 
-    // prepare
-    executor->Init();
+    // prepare and execute
+    return Drain(executor.get(), sink, error);
+  }
+
+  /**
+   * Look up the plan cache. A plan optimized for an older version of the catalog, i.e. before a table was created or
+   * analyzed, is dropped, so that the query is prepared again with the current statistics.
+   * @param shape the text of the query with its parameters in place of its values, as in "SELECT v FROM t WHERE k = ?"
+   * @return the prepared plan cached under the shape, nullptr if the shape has not been prepared or its plan is stale
+   */
+  std::shared_ptr<PreparedPlan> GetPreparedPlan(const std::string &shape) {
+    std::lock_guard<std::mutex> guard(plan_cache_latch_);
+    auto it = plan_cache_index_.find(shape);
+    if (it == plan_cache_index_.end()) {
+      return nullptr;
+    }
+    if (it->second->second->GetCatalogVersion() != catalog_->GetVersion()) {
+      plan_cache_.erase(it->second);
+      plan_cache_index_.erase(it);
+      return nullptr;
+    }
+    plan_cache_.splice(plan_cache_.begin(), plan_cache_, it->second);
+    return plan_cache_.front().second;
+  }
+
+  /**
+   * Prepare a plan and cache it under the shape of its query, evicting the least recently used plans beyond
+   * plan_cache_size. If another plan for the current catalog was cached under the shape in the meantime, that one is
+   * kept and returned instead. An evicted plan lives on as long as its callers hold it.
+   * @param shape the text of the query with its parameters in place of its values
+   * @param prepared the prepared plan, which owns the nodes of the plan
+   * @param plan the root of the plan
+   * @param exec_ctx the context whose catalog, buffer pool and managers the executions use
+   * @return the prepared plan cached under the shape
+   */
+  std::shared_ptr<PreparedPlan> Prepare(const std::string &shape, std::unique_ptr<PreparedPlan> &&prepared,
+                                        const AbstractPlanNode *plan, ExecutorContext *exec_ctx) {
+    exec_ctx->SetWorkerPool(&worker_pool_);
+    prepared->Prepare(plan, exec_ctx, enable_optimizer);
+    std::lock_guard<std::mutex> guard(plan_cache_latch_);
+    auto it = plan_cache_index_.find(shape);
+    if (it != plan_cache_index_.end()) {
+      if (it->second->second->GetCatalogVersion() == catalog_->GetVersion()) {
+        plan_cache_.splice(plan_cache_.begin(), plan_cache_, it->second);
+        return plan_cache_.front().second;
+      }
+      plan_cache_.erase(it->second);
+      plan_cache_index_.erase(it);
+    }
+    plan_cache_.emplace_front(shape, std::move(prepared));
+    plan_cache_index_[shape] = plan_cache_.begin();
+    while (plan_cache_.size() > std::max<size_t>(plan_cache_size, 1)) {
+      plan_cache_index_.erase(plan_cache_.back().first);
+      plan_cache_.pop_back();
+    }
+    return plan_cache_.front().second;
+  }
+
+  /**
+   * Run a prepared plan with values bound to its parameters, reusing the executors of a finished execution, and hand
+   * its result to a sink. Executions of the same prepared plan run concurrently, each on executors of its own.
+   * @param prepared the prepared plan
+   * @param values a value per parameter, cast to the type of the parameter
+   * @param sink the sink of the result, nullptr to drop it
+   * @param exec_ctx the context of the query, whose transaction runs it and which counts its statistics
+   * @param[out] error set to the message of the error the query failed with, if it failed; nullptr to drop it
+   * @return true if the query ran to its end or was stopped by the sink, false if it failed
+   */
+  bool ExecutePrepared(PreparedPlan *prepared, const std::vector<Value> &values, ResultSink *sink,
+                       ExecutorContext *exec_ctx, std::string *error = nullptr) {
+    exec_ctx->ResetStatistics();
+    auto execution = prepared->Acquire(values, exec_ctx);
+    bool done;
+    {
+      ParameterValueExpression::Binding binding(&execution->parameters_);
+      done = Drain(execution->executor_.get(), sink, error);
+    }
+    prepared->Release(std::move(execution));
+    return done;
+  }
+
+  /** @return the pool of threads that run the parallel parts of the queries */
+  WorkerPool *GetWorkerPool() { return &worker_pool_; }
 
-    // execute
+ private:
+  /**
+   * Initialize an executor and hand its batches to a sink, until there are no more or the sink stops the query. An
+   * executor that fails, while initialized or run, is closed, so that no thread keeps running for it; an aborted
+   * transaction is passed on to the caller, which has to roll it back.
+   * @param[out] error set to the message of the error an executor failed with; nullptr to drop it
+   * @return true if the query ran to its end or was stopped by the sink, false if an executor failed
+   */
+  bool Drain(AbstractExecutor *executor, ResultSink *sink, std::string *error) {
     try {
-      Tuple tuple;
-      RID rid;
-      while (executor->Next(&tuple, &rid)) {
-        if (result_set != nullptr) {
-          result_set->push_back(tuple);
+      executor->Init();
+      TupleBatch batch;
+      while (executor->NextBatch(&batch)) {
+        if (sink != nullptr && !sink->Consume(batch)) {
+          executor->Close();
+          break;
         }
       }
     } catch (Exception &e) {
-      // TODO(student): handle exceptions
+      executor->Close();
+      if (error != nullptr) {
+        *error = e.what();
+      }
+      return false;
+    } catch (...) {
+      executor->Close();
+      throw;
     }
-
     return true;
   }
 
- private:
   [[maybe_unused]] BufferPoolManager *bpm_;
   [[maybe_unused]] TransactionManager *txn_mgr_;
-  [[maybe_unused]] Catalog *catalog_;
+  Catalog *catalog_;
+  WorkerPool worker_pool_;
+  /** The plan cache: prepared plans and the shapes of their queries, the most recently used first. */
+  std::list<std::pair<std::string, std::shared_ptr<PreparedPlan>>> plan_cache_;
+  /** plan_cache_index_ : shapes of queries -> their entries in plan_cache_ */
+  std::unordered_map<std::string, std::list<std::pair<std::string, std::shared_ptr<PreparedPlan>>>::iterator>
+      plan_cache_index_;
+  std::mutex plan_cache_latch_;
 };
 
 }  // namespace bustub
@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <atomic>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -21,6 +22,9 @@
 #include "storage/page/tmp_tuple_page.h"
 
 namespace bustub {
+class ParallelContext;
+class WorkerPool;
+
 /**
  * ExecutorContext stores all the context necessary to run an executor.
  */
@@ -45,6 +49,9 @@ class ExecutorContext {
   /** @return the running transaction */
   Transaction *GetTransaction() const { return transaction_; }
 
+  /** Set the transaction running the query, when the context of an execution of a prepared plan is reused. */
+  void SetTransaction(Transaction *transaction) { transaction_ = transaction; }
+
   /** @return the catalog */
   Catalog *GetCatalog() { return catalog_; }
 
@@ -60,12 +67,54 @@ class ExecutorContext {
   /** @return the transaction manager */
   TransactionManager *GetTransactionManager() { return txn_mgr_; }
 
+  /** @return the pool that runs the threads of parallel executors, or nullptr if the query must run serially */
+  WorkerPool *GetWorkerPool() const { return worker_pool_; }
+
+  /** Set the pool that runs the threads of parallel executors. */
+  void SetWorkerPool(WorkerPool *worker_pool) { worker_pool_ = worker_pool; }
+
+  /** @return the state shared by the instances of the parallel plan fragment being run, or nullptr outside one */
+  ParallelContext *GetParallelContext() const { return parallel_ctx_; }
+
+  /** @return the index of the instance of the parallel plan fragment being run */
+  size_t GetInstance() const { return instance_; }
+
+  /** Mark this context as the one of an instance of a parallel plan fragment of the query run in query_ctx. */
+  void SetParallelContext(ParallelContext *parallel_ctx, size_t instance, ExecutorContext *query_ctx) {
+    parallel_ctx_ = parallel_ctx;
+    instance_ = instance;
+    query_ctx_ = query_ctx;
+  }
+
+  /** Count the statistics of this context in the context of the query run in query_ctx too. */
+  void SetQueryContext(ExecutorContext *query_ctx) { query_ctx_ = query_ctx; }
+
+  /** Count pages that a scan skipped without reading them; instances of a parallel fragment count them in the query. */
+  void AddSkippedPages(size_t count) {
+    if (query_ctx_ != nullptr) {
+      query_ctx_->AddSkippedPages(count);
+    } else {
+      num_skipped_pages_ += count;
+    }
+  }
+
+  /** @return the number of pages the scans of the query skipped, thanks to the zone maps of the tables */
+  size_t GetNumSkippedPages() const { return num_skipped_pages_; }
+
+  /** Reset the counters of the query, before it runs. */
+  void ResetStatistics() { num_skipped_pages_ = 0; }
+
  private:
   Transaction *transaction_;
   Catalog *catalog_;
   BufferPoolManager *bpm_;
   TransactionManager *txn_mgr_;
   LockManager *lock_mgr_;
+  WorkerPool *worker_pool_{nullptr};
+  ParallelContext *parallel_ctx_{nullptr};
+  size_t instance_{0};
+  ExecutorContext *query_ctx_{nullptr};
+  std::atomic<size_t> num_skipped_pages_{0};
 };
 
 }  // namespace bustub
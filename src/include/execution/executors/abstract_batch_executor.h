@@ -0,0 +1,58 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// abstract_batch_executor.h
+//
+// Identification: src/include/execution/executors/abstract_batch_executor.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/tuple_batch.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+/**
+ * AbstractBatchExecutor is the base class of the vectorized executors, which produce a batch of tuples in columnar
+ * layout per call of NextBatch(). Next() hands out the tuples of those batches one at a time, so that a vectorized
+ * executor can feed a tuple-at-a-time parent.
+ */
+class AbstractBatchExecutor : public AbstractExecutor {
+ public:
+  explicit AbstractBatchExecutor(ExecutorContext *exec_ctx) : AbstractExecutor(exec_ctx) {}
+
+  /**
+   * Initializes this executor. Executors that override it must call it first.
+   */
+  void Init() override {
+    buffer_.Reset(nullptr);
+    position_ = 0;
+  }
+
+  bool Next(Tuple *tuple, RID *rid) final {
+    while (position_ >= buffer_.NumSelected()) {
+      if (!NextBatch(&buffer_)) {
+        return false;
+      }
+      position_ = 0;
+    }
+    uint32_t row = buffer_.GetSelection()[position_++];
+    *tuple = buffer_.GetTuple(row);
+    *rid = buffer_.GetRID(row);
+    return true;
+  }
+
+  bool NextBatch(TupleBatch *batch) override = 0;
+
+ private:
+  /** The batch that Next() hands out tuples from. */
+  TupleBatch buffer_;
+  uint32_t position_{0};
+};
+}  // namespace bustub
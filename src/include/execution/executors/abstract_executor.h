@@ -13,11 +13,16 @@
 #pragma once
 
 #include "execution/executor_context.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
 /**
  * AbstractExecutor implements the Volcano tuple-at-a-time iterator model.
+ *
+ * Executors can also be pulled a batch at a time with NextBatch(). Tuple-at-a-time executors get it for free: it
+ * collects the tuples of Next() into a batch. Vectorized executors derive from AbstractBatchExecutor instead, which
+ * works the other way round.
  */
 class AbstractExecutor {
  public:
@@ -44,6 +49,27 @@ class AbstractExecutor {
    */
   virtual bool Next(Tuple *tuple, RID *rid) = 0;
 
+  /**
+   * Produces the next batch of tuples from this executor.
+   * @param[out] batch the next batch, with at least one selected row
+   * @return true if a batch was produced, false if there are no more tuples
+   */
+  virtual bool NextBatch(TupleBatch *batch) {
+    batch->Reset(GetOutputSchema());
+    Tuple tuple;
+    RID rid;
+    while (!batch->IsFull() && Next(&tuple, &rid)) {
+      batch->AppendTuple(tuple, rid);
+    }
+    return batch->NumRows() > 0;
+  }
+
+  /**
+   * Stop producing before the end, when the consumer of this executor needs no more tuples: the children are closed
+   * in turn and the threads running for this executor are stopped. Next() must not be called again before Init().
+   */
+  virtual void Close() {}
+
   /** @return the schema of the tuples that this executor produces */
   virtual const Schema *GetOutputSchema() = 0;
 
@@ -0,0 +1,149 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// batch_aggregation_executor.h
+//
+// Identification: src/include/execution/executors/batch_aggregation_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_batch_executor.h"
+#include "execution/plans/aggregation_plan.h"
+
+namespace bustub {
+
+/**
+ * BatchAggregationTable holds groups and their running aggregates in columns with one row per group. Rows of input
+ * batches are folded in by loops specialized for each aggregate function and type. COUNT counts every row, like
+ * SimpleAggregationHashTable; SUM, MIN and MAX skip NULLs and are NULL for a group without values.
+ *
+ * Tables that aggregated different rows of the same input can be merged, which is how the partial aggregates of the
+ * threads of a parallel aggregation are combined.
+ */
+class BatchAggregationTable {
+ public:
+  /** Create an empty table for the aggregates of a plan. */
+  explicit BatchAggregationTable(const AggregationPlanNode *plan);
+
+  /** @return the number of groups */
+  uint32_t NumGroups() const { return num_groups_; }
+
+  /**
+   * Fold rows of a batch into the groups.
+   * @param keys the group-by values of the batch, one column per group-by expression
+   * @param values the inputs of the aggregates, one column per aggregate expression
+   * @param hashes the hashes of the group-by values of the rows
+   * @param rows the rows to fold in, in ascending order
+   */
+  void Aggregate(const std::vector<const ColumnVector *> &keys, const std::vector<const ColumnVector *> &values,
+                 const std::vector<hash_t> &hashes, const std::vector<uint32_t> &rows);
+
+  /** Fold the groups of another table of the same plan, which aggregated other rows, into this one. */
+  void Merge(const BatchAggregationTable &other);
+
+  /** Get the group-by values and the aggregates of a group. */
+  void GetGroup(uint32_t group, std::vector<Value> *group_bys, std::vector<Value> *aggregates) const;
+
+ private:
+  /** @return the group of a row with the given group-by values, which is created if it does not exist yet */
+  uint32_t FindGroup(const std::vector<const ColumnVector *> &keys, uint32_t row, hash_t hash);
+
+  /** Fold the values of an aggregate of the given rows into the groups of the rows. */
+  void Combine(AggregationType agg_type, const ColumnVector &values, const std::vector<uint32_t> &rows,
+               ColumnVector *aggregate);
+
+  const AggregationPlanNode *plan_;
+  /** The group-by values of the groups, one column per group-by expression. */
+  std::vector<ColumnVector> group_keys_;
+  /** The hashes of the group-by values of the groups. */
+  std::vector<hash_t> group_hashes_;
+  /** The groups by the hash of their group-by values. */
+  std::unordered_multimap<hash_t, uint32_t> group_index_;
+  /** The aggregates of the groups, one column per aggregate expression. */
+  std::vector<ColumnVector> aggregates_;
+  uint32_t num_groups_{0};
+  /** The group of each row being folded in. */
+  std::vector<uint32_t> row_groups_;
+};
+
+/**
+ * BatchAggregationExecutor computes the aggregates of a hash aggregation a batch at a time, on execution_threads
+ * threads.
+ *
+ * Each thread takes batches from the child in turn and evaluates the group-by and aggregate expressions on them
+ * column-wise. It then pre-aggregates the rows into thread-local tables, one per partition of the group-by hashes. A
+ * local table that reaches PREAGGREGATION_GROUPS groups is handed over to its partition and replaced with an empty
+ * one, so that the memory of a thread stays bounded when there are many groups. Once the child is drained, the
+ * threads take partitions in turn and merge the tables of each into one. Partitions hold disjoint groups, so they
+ * are output one after the other.
+ */
+class BatchAggregationExecutor : public AbstractBatchExecutor {
+ public:
+  /**
+   * Creates a new vectorized aggregation executor.
+   * @param exec_ctx the executor context
+   * @param plan the aggregation plan node
+   * @param child the child executor
+   */
+  BatchAggregationExecutor(ExecutorContext *exec_ctx, const AggregationPlanNode *plan,
+                           std::unique_ptr<AbstractExecutor> &&child);
+
+  /** Aggregates all the tuples of the child. */
+  void Init() override;
+
+  bool NextBatch(TupleBatch *batch) override;
+
+  void Close() override { child_->Close(); }
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
+
+ private:
+  /** The number of partitions of the group-by hashes. */
+  static constexpr size_t NUM_PARTITIONS = 16;
+  /** The number of groups at which a thread-local table is handed over to its partition. */
+  static constexpr uint32_t PREAGGREGATION_GROUPS = 256;
+
+  /**
+   * Run f(thread) on execution_threads threads of the worker pool, one of them being the calling one, and wait for
+   * them. Inside a parallel plan fragment, or without a worker pool, f(0) runs alone.
+   */
+  void RunInParallel(const std::function<void(size_t)> &f);
+
+  /** Pre-aggregate batches of the child into thread-local tables until it is drained. */
+  void PreAggregate();
+
+  /** Merge the tables of partitions until none is left. */
+  void MergePartitions();
+
+  /** The aggregation plan node. */
+  const AggregationPlanNode *plan_;
+  /** The child executor whose tuples are aggregated. */
+  std::unique_ptr<AbstractExecutor> child_;
+  /** Serializes pulling batches from the child. */
+  std::mutex child_latch_;
+
+  /** The pre-aggregated tables handed over to each partition, then the merged table of each partition. */
+  std::mutex partitions_latch_;
+  std::array<std::vector<std::unique_ptr<BatchAggregationTable>>, NUM_PARTITIONS> partials_;
+  std::array<std::unique_ptr<BatchAggregationTable>, NUM_PARTITIONS> results_;
+  std::atomic<size_t> next_merge_{0};
+
+  /** The next group to output. */
+  size_t next_partition_{0};
+  uint32_t next_group_{0};
+};
+}  // namespace bustub
@@ -0,0 +1,59 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// batch_filter_executor.h
+//
+// Identification: src/include/execution/executors/batch_filter_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <utility>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_batch_executor.h"
+#include "execution/expression_program.h"
+#include "execution/expressions/abstract_expression.h"
+
+namespace bustub {
+
+/**
+ * BatchFilterExecutor drops the tuples of its child that do not satisfy a predicate. It evaluates the predicate on a
+ * whole batch at once and narrows the selection vector of the batch, leaving the column data in place. Predicates that
+ * compile are run as an ExpressionProgram.
+ */
+class BatchFilterExecutor : public AbstractBatchExecutor {
+ public:
+  /**
+   * Creates a new vectorized filter executor.
+   * @param exec_ctx the executor context
+   * @param predicate the predicate that the tuples must satisfy
+   * @param child the child executor
+   */
+  BatchFilterExecutor(ExecutorContext *exec_ctx, const AbstractExpression *predicate,
+                      std::unique_ptr<AbstractExecutor> &&child);
+
+  void Init() override;
+
+  bool NextBatch(TupleBatch *batch) override;
+
+  void Close() override { child_->Close(); }
+
+  const Schema *GetOutputSchema() override { return child_->GetOutputSchema(); }
+
+ private:
+  /** The predicate that the tuples must satisfy. */
+  const AbstractExpression *predicate_;
+  /** The child executor whose tuples are filtered. */
+  std::unique_ptr<AbstractExecutor> child_;
+  /** The compiled predicate, nullptr if it is evaluated as an expression tree. */
+  std::unique_ptr<ExpressionProgram> program_;
+  /** The values of the predicate. */
+  ColumnVector result_;
+};
+}  // namespace bustub
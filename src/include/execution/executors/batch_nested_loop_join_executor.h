@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// batch_nested_loop_join_executor.h
+//
+// Identification: src/include/execution/executors/batch_nested_loop_join_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_batch_executor.h"
+#include "execution/expression_program.h"
+#include "execution/plans/nested_loop_join_plan.h"
+
+namespace bustub {
+
+/**
+ * BatchNestedLoopJoinExecutor joins two children with a block nested loop. The right child is read into batches
+ * once. Every row of the left child is then paired with a whole right batch at a time: the pairs are laid out as a
+ * batch of joined rows, on which the predicate and the output expressions are evaluated column-wise.
+ */
+class BatchNestedLoopJoinExecutor : public AbstractBatchExecutor {
+ public:
+  /**
+   * Creates a new vectorized nested loop join executor.
+   * @param exec_ctx the executor context
+   * @param plan the nested loop join plan to be executed
+   * @param left_executor the child executor that produces tuples for the left side of the join
+   * @param right_executor the child executor that produces tuples for the right side of the join
+   */
+  BatchNestedLoopJoinExecutor(ExecutorContext *exec_ctx, const NestedLoopJoinPlanNode *plan,
+                              std::unique_ptr<AbstractExecutor> &&left_executor,
+                              std::unique_ptr<AbstractExecutor> &&right_executor);
+
+  void Init() override;
+
+  bool NextBatch(TupleBatch *batch) override;
+
+  void Close() override {
+    left_executor_->Close();
+    right_executor_->Close();
+  }
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
+
+ private:
+  /** Join a row of the current left batch with the selected rows of a right batch, appending to the output. */
+  void JoinRow(uint32_t left_row, const TupleBatch &right, TupleBatch *batch);
+
+  /** The nested loop join plan node to be executed. */
+  const NestedLoopJoinPlanNode *plan_;
+  std::unique_ptr<AbstractExecutor> left_executor_;
+  std::unique_ptr<AbstractExecutor> right_executor_;
+  /** All the tuples of the right child. */
+  std::vector<TupleBatch> right_batches_;
+  /** The columns of the left schema followed by those of the right schema. */
+  std::unique_ptr<Schema> joined_schema_;
+  /** The current left batch, its row being joined and the right batch it is joined with next. */
+  TupleBatch left_batch_;
+  uint32_t left_position_{0};
+  size_t right_position_{0};
+  /** Scratch space for joining a row. */
+  TupleBatch joined_;
+  /** The compiled predicate, nullptr if it is evaluated as an expression tree. */
+  std::unique_ptr<ExpressionProgram> program_;
+  ColumnVector predicate_scratch_;
+  ColumnVector scratch_;
+};
+}  // namespace bustub
@@ -0,0 +1,56 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// batch_projection_executor.h
+//
+// Identification: src/include/execution/executors/batch_projection_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <utility>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_batch_executor.h"
+
+namespace bustub {
+
+/**
+ * BatchProjectionExecutor computes the columns of an output schema from the tuples of its child. Every output column
+ * is given by its expression, evaluated on the child's schema; a column without an expression takes the child's column
+ * of the same name.
+ */
+class BatchProjectionExecutor : public AbstractBatchExecutor {
+ public:
+  /**
+   * Creates a new vectorized projection executor.
+   * @param exec_ctx the executor context
+   * @param output_schema the schema of the projected tuples
+   * @param child the child executor
+   */
+  BatchProjectionExecutor(ExecutorContext *exec_ctx, const Schema *output_schema,
+                          std::unique_ptr<AbstractExecutor> &&child);
+
+  void Init() override;
+
+  bool NextBatch(TupleBatch *batch) override;
+
+  void Close() override { child_->Close(); }
+
+  const Schema *GetOutputSchema() override { return output_schema_; }
+
+ private:
+  /** The schema of the projected tuples. */
+  const Schema *output_schema_;
+  /** The child executor whose tuples are projected. */
+  std::unique_ptr<AbstractExecutor> child_;
+  /** The batch of the child. */
+  TupleBatch input_;
+  ColumnVector scratch_;
+};
+}  // namespace bustub
@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// batch_seq_scan_executor.h
+//
+// Identification: src/include/execution/executors/batch_seq_scan_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/dynamic_filter.h"
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_batch_executor.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "storage/table/table_iterator.h"
+
+namespace bustub {
+
+/**
+ * BatchSeqScanExecutor reads the tuples of a table into batches. It produces whole tuples of the table schema; the
+ * predicate and the output schema of the plan are left to a BatchFilterExecutor and a BatchProjectionExecutor on top.
+ * A dynamic filter pushed down by an operator above is applied by the scan itself, before any of them.
+ *
+ * When the zone map of the table bounds columns of the predicate, the scan reads the table a page at a time, walking
+ * the zones and skipping the pages that hold no matching row without fetching them.
+ */
+class BatchSeqScanExecutor : public AbstractBatchExecutor {
+ public:
+  /**
+   * Creates a new vectorized sequential scan executor.
+   * @param exec_ctx the executor context
+   * @param plan the sequential scan plan whose table is scanned
+   */
+  BatchSeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan);
+
+  void Init() override;
+
+  bool NextBatch(TupleBatch *batch) override;
+
+  const Schema *GetOutputSchema() override { return &table_info_->schema_; }
+
+  /** Apply a dynamic filter on the rows of the table to the batches. */
+  void SetDynamicFilter(DynamicFilter *filter) { filter_probe_ = std::make_unique<DynamicFilter::Probe>(filter); }
+
+ private:
+  /** Read the tuples of the next page that the zone map does not skip, false if there is none left. */
+  bool ReadNextPage();
+
+  /** The sequential scan plan node to be executed. */
+  const SeqScanPlanNode *plan_;
+  /** The table being scanned. */
+  TableMetadata *table_info_;
+  /** The position of the scan. */
+  std::unique_ptr<TableIterator> iterator_;
+  /** The dynamic filter applied to the batches, if any. */
+  std::unique_ptr<DynamicFilter::Probe> filter_probe_;
+  /** The bounds of the predicate on the columns of the zone map of the table, empty to scan with the iterator. */
+  std::vector<ZoneBound> bounds_;
+  size_t next_zone_{0};
+  /** The tuples of the current page and the next one to output. */
+  std::vector<Tuple> tuples_;
+  size_t position_{0};
+};
+}  // namespace bustub
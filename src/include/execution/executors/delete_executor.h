@@ -46,6 +46,8 @@ class DeleteExecutor : public AbstractExecutor {
   // Delete from indexes if necessary.
   bool Next([[maybe_unused]] Tuple *tuple, RID *rid) override;
 
+  void Close() override { child_executor_->Close(); }
+
  private:
   /** The delete plan node to be executed. */
   const DeletePlanNode *plan_;
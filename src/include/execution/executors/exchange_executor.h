@@ -0,0 +1,89 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// exchange_executor.h
+//
+// Identification: src/include/execution/executors/exchange_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_batch_executor.h"
+#include "execution/plans/exchange_plan.h"
+#include "execution/tuple_batch_queue.h"
+
+namespace bustub {
+
+/**
+ * ExchangeState is what the instances of an exchange share: the producers, which are the instances of the child
+ * subtree, and a queue of batches per consumer, which is an instance of the exchange.
+ */
+class ExchangeState {
+ public:
+  /**
+   * Creates the state of an exchange.
+   * @param plan the exchange plan node
+   * @param degree the number of producers and of consumers
+   */
+  ExchangeState(const ExchangePlanNode *plan, size_t degree);
+
+  /** Add a producer. All of them must be added before any is run. */
+  void AddProducer(std::unique_ptr<AbstractExecutor> &&producer) { producers_.emplace_back(std::move(producer)); }
+
+  /** Run a producer until it is drained or the queues are closed, sending its batches to the consumers. */
+  void Produce(size_t producer);
+
+  /** @return the queue that a consumer pops its batches from */
+  TupleBatchQueue *GetQueue(size_t consumer) { return queues_[consumer].get(); }
+
+  /** Close the queues of all the consumers. */
+  void Close();
+
+ private:
+  /** Push the batch of a consumer and start a new one, false if the queue was closed. */
+  bool Send(size_t consumer, TupleBatch *batch);
+
+  const ExchangePlanNode *plan_;
+  std::vector<std::unique_ptr<AbstractExecutor>> producers_;
+  std::vector<std::unique_ptr<TupleBatchQueue>> queues_;
+  /** The number of producers still running; the last one to finish closes the queues. */
+  std::atomic<size_t> producing_;
+};
+
+/**
+ * ExchangeExecutor is an instance of an exchange, which outputs the batches that the producers of the exchange sent
+ * to it. The first instance to be initialized starts the producers.
+ */
+class ExchangeExecutor : public AbstractBatchExecutor {
+ public:
+  /**
+   * Creates a new exchange executor.
+   * @param exec_ctx the executor context of an instance of a parallel plan fragment
+   * @param plan the exchange plan to be executed
+   */
+  ExchangeExecutor(ExecutorContext *exec_ctx, const ExchangePlanNode *plan)
+      : AbstractBatchExecutor(exec_ctx), plan_(plan) {}
+
+  void Init() override;
+
+  bool NextBatch(TupleBatch *batch) override;
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
+
+ private:
+  /** The exchange plan node to be executed. */
+  const ExchangePlanNode *plan_;
+  /** The queue of this instance. */
+  TupleBatchQueue *queue_{nullptr};
+};
+}  // namespace bustub
@@ -0,0 +1,71 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// gather_executor.h
+//
+// Identification: src/include/execution/executors/gather_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_batch_executor.h"
+#include "execution/parallel_context.h"
+#include "execution/plans/gather_plan.h"
+#include "execution/tuple_batch_queue.h"
+
+namespace bustub {
+
+/**
+ * GatherExecutor runs the instances of a parallel plan fragment as tasks of the worker pool. Each instance pushes
+ * the batches it produces into a queue that NextBatch() pops from, so the output comes in no particular order.
+ */
+class GatherExecutor : public AbstractBatchExecutor {
+ public:
+  /**
+   * Creates a new gather executor.
+   * @param exec_ctx the executor context, which must have a worker pool
+   * @param plan the gather plan to be executed
+   */
+  GatherExecutor(ExecutorContext *exec_ctx, const GatherPlanNode *plan) : AbstractBatchExecutor(exec_ctx), plan_(plan) {}
+
+  /** Stops the instances if the output was not drained. */
+  ~GatherExecutor() override { Stop(); }
+
+  void Init() override;
+
+  bool NextBatch(TupleBatch *batch) override;
+
+  void Close() override { Stop(); }
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
+
+ private:
+  /** Run an instance until it is drained or the queue is closed. */
+  void Produce(AbstractExecutor *instance);
+
+  /**
+   * Close the queue and the exchanges of the fragment, wait for its tasks and drop the instances.
+   * @return the first exception thrown by a task, or nullptr
+   */
+  std::exception_ptr Stop();
+
+  /** The gather plan node to be executed. */
+  const GatherPlanNode *plan_;
+  std::unique_ptr<ParallelContext> parallel_ctx_;
+  /** The root executors of the instances of the fragment. */
+  std::vector<std::unique_ptr<AbstractExecutor>> instances_;
+  std::unique_ptr<TupleBatchQueue> queue_;
+  /** The number of instances still producing; the last one to finish closes the queue. */
+  std::atomic<size_t> producing_{0};
+};
+}  // namespace bustub
@@ -0,0 +1,148 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// hash_join_executor.h
+//
+// Identification: src/include/execution/executors/hash_join_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "common/util/hash_util.h"
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/expression_program.h"
+#include "execution/plans/hash_join_plan.h"
+#include "storage/table/tmp_tuple_list.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+/**
+ * HashJoinExecutor joins two children on equal keys by building a hash table on the smaller one and probing it with
+ * the tuples of the other.
+ *
+ * Which child is smaller is found out by reading both of them in turns until one runs out. If that one fits in
+ * hash_join_memory_budget, the hash table is built on it and the other child is streamed through. Otherwise the join
+ * goes Grace-style: both children are partitioned by the hash of their keys into TmpTupleLists, and each pair of
+ * partitions is joined on its own, building on the smaller partition. A pair that still does not fit is partitioned
+ * again with another hash, up to MAX_PARTITION_DEPTH levels, after which it is joined in memory regardless.
+ */
+class HashJoinExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new hash join executor.
+   * @param exec_ctx the executor context
+   * @param plan the hash join plan to be executed
+   * @param left_executor the child executor that produces tuples for the left side of the join
+   * @param right_executor the child executor that produces tuples for the right side of the join
+   */
+  HashJoinExecutor(ExecutorContext *exec_ctx, const HashJoinPlanNode *plan,
+                   std::unique_ptr<AbstractExecutor> &&left_executor,
+                   std::unique_ptr<AbstractExecutor> &&right_executor);
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
+
+  void Init() override;
+
+  bool Next(Tuple *tuple, RID *rid) override;
+
+  void Close() override {
+    for (auto &child : children_) {
+      child->Close();
+    }
+  }
+
+  /** @return true if the in-memory join builds on the left child, which is meaningless once the join spilled */
+  bool BuildsOnLeft() const { return build_side_ == LEFT; }
+
+  /** @return the number of partition pairs the join spilled, counting the repartitioned ones */
+  size_t GetNumSpilledPartitions() const { return num_spilled_partitions_; }
+
+ private:
+  static constexpr size_t LEFT = 0;
+  static constexpr size_t RIGHT = 1;
+  /** The number of partitions a spilled input is split into. */
+  static constexpr size_t PARTITION_FANOUT = 8;
+  /** The number of times a partition may be partitioned. */
+  static constexpr uint32_t MAX_PARTITION_DEPTH = 3;
+
+  /** A pair of partitions of the left and the right child that hold the tuples of the same hashes. */
+  struct Partition {
+    std::array<std::unique_ptr<TmpTupleList>, 2> inputs_;
+    uint32_t depth_{0};
+  };
+
+  /**
+   * Evaluate the join keys of a tuple of one side.
+   * @return false if a key is NULL, in which case the tuple matches nothing
+   */
+  bool EvaluateKeys(size_t side, const Tuple &tuple, std::vector<Value> *keys, hash_t *hash) const;
+
+  /** @return the partition of a key hash at a partitioning depth, which is independent of the other depths */
+  static size_t PartitionOf(hash_t hash, uint32_t depth);
+
+  /** @return an estimate of the memory a tuple takes in the hash table */
+  static size_t TupleFootprint(const Tuple &tuple) { return sizeof(Tuple) + tuple.GetLength(); }
+
+  /** Add a tuple of the build side to the hash table. */
+  void Build(const Tuple &tuple);
+
+  /** Look up the build tuples that match the current probe tuple. */
+  void Probe();
+
+  /** @return the next tuple of the probe side, false if there are no more in the current partition */
+  bool NextProbeTuple();
+
+  /** Create PARTITION_FANOUT empty partition pairs at the given depth. */
+  std::vector<Partition> MakePartitions(uint32_t depth);
+
+  /** Route a tuple of one side to its partition, dropping it if it cannot match. */
+  void Spill(size_t side, const Tuple &tuple, std::vector<Partition> *partitions);
+
+  /** Queue the non-empty partition pairs to be joined. */
+  void QueuePartitions(std::vector<Partition> *partitions);
+
+  /** Build the hash table for the next pending partition pair, repartitioning it if it is too large. */
+  bool LoadNextPartition();
+
+  /** The hash join plan node to be executed. */
+  const HashJoinPlanNode *plan_;
+  std::array<std::unique_ptr<AbstractExecutor>, 2> children_;
+  /** The compiled predicate, nullptr if it is evaluated as an expression tree. */
+  std::unique_ptr<ExpressionProgram> program_;
+
+  /** The side the hash table is built on and the hash table, which indexes build_tuples_ by the hash of the keys. */
+  size_t build_side_{LEFT};
+  std::vector<Tuple> build_tuples_;
+  std::vector<std::vector<Value>> build_keys_;
+  std::unordered_multimap<hash_t, size_t> hash_table_;
+
+  /**
+   * The probe tuples still to be read: first the ones buffered while the inputs were sized up, then the rest of the
+   * probe child, or else the probe input of the current partition.
+   */
+  std::vector<Tuple> probe_buffer_;
+  size_t probe_position_{0};
+  AbstractExecutor *probe_child_{nullptr};
+  TmpTupleList *probe_list_{nullptr};
+
+  /** The current probe tuple and the build tuples it matches. */
+  Tuple probe_tuple_;
+  std::vector<size_t> matches_;
+  size_t match_position_{0};
+
+  /** The partition pair being joined and the ones still to be joined. */
+  Partition current_;
+  std::vector<Partition> pending_;
+  size_t num_spilled_partitions_{0};
+};
+}  // namespace bustub
@@ -0,0 +1,100 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// merge_join_executor.h
+//
+// Identification: src/include/execution/executors/merge_join_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/expression_program.h"
+#include "execution/plans/merge_join_plan.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+/**
+ * MergeJoinExecutor joins two children that produce their tuples sorted on the join keys by reading both of them
+ * once, in step, always advancing the side with the smaller key.
+ *
+ * When the keys meet, the run of right tuples with that key is copied into a rewind buffer, and every left tuple with
+ * the same key is paired with each tuple of the buffer. The buffer is the only state the join keeps, so it takes
+ * memory for the largest run of duplicate right keys rather than for a whole input, and produces its output in the
+ * order of the keys.
+ *
+ * A child whose keys go down is not sorted as the plan claims, and makes the join throw.
+ */
+class MergeJoinExecutor : public AbstractExecutor {
+ public:
+  /**
+   * Creates a new merge join executor.
+   * @param exec_ctx the executor context
+   * @param plan the merge join plan to be executed
+   * @param left_executor the child executor that produces tuples for the left side of the join
+   * @param right_executor the child executor that produces tuples for the right side of the join
+   */
+  MergeJoinExecutor(ExecutorContext *exec_ctx, const MergeJoinPlanNode *plan,
+                    std::unique_ptr<AbstractExecutor> &&left_executor,
+                    std::unique_ptr<AbstractExecutor> &&right_executor);
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
+
+  void Init() override;
+
+  bool Next(Tuple *tuple, RID *rid) override;
+
+  void Close() override {
+    for (auto &child : children_) {
+      child->Close();
+    }
+  }
+
+  /** @return the largest number of tuples the rewind buffer held */
+  size_t GetMaxRunSize() const { return max_run_size_; }
+
+ private:
+  static constexpr size_t LEFT = 0;
+  static constexpr size_t RIGHT = 1;
+
+  /** The current tuple of one side and its keys. */
+  struct Cursor {
+    Tuple tuple_;
+    std::vector<Value> keys_;
+    bool valid_{false};
+  };
+
+  /**
+   * Move a side to its next tuple whose keys are not NULL.
+   * @return false if the side is exhausted
+   */
+  bool Advance(size_t side);
+
+  /** @return a negative number, zero or a positive number as the keys lhs are less than, equal to or above rhs */
+  static int CompareKeys(const std::vector<Value> &lhs, const std::vector<Value> &rhs);
+
+  /** The merge join plan node to be executed. */
+  const MergeJoinPlanNode *plan_;
+  std::array<std::unique_ptr<AbstractExecutor>, 2> children_;
+  /** The compiled predicate, nullptr if it is evaluated as an expression tree. */
+  std::unique_ptr<ExpressionProgram> program_;
+
+  /** The current left tuple, and the first right tuple that is not in the rewind buffer. */
+  std::array<Cursor, 2> cursors_;
+
+  /** The rewind buffer: the right tuples whose keys are run_keys_, and the next one to pair with the left tuple. */
+  std::vector<Tuple> run_;
+  std::vector<Value> run_keys_;
+  size_t run_position_{0};
+  size_t max_run_size_{0};
+};
+}  // namespace bustub
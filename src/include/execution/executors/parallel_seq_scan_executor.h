@@ -0,0 +1,178 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_seq_scan_executor.h
+//
+// Identification: src/include/execution/executors/parallel_seq_scan_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>  // NOLINT
+#include <exception>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "execution/dynamic_filter.h"
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_batch_executor.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "execution/tuple_batch_queue.h"
+#include "storage/page/table_page.h"
+#include "storage/table/zone_map.h"
+
+namespace bustub {
+
+/**
+ * MorselCursor walks the page list of a table for the threads of a parallel scan, handing the pages out a morsel of
+ * MORSEL_PAGES at a time. The pages are fetched once, by the cursor, and stay pinned until the thread that claimed
+ * them has read them. When the zone map of the table bounds columns of the predicate of the scan, the cursor walks the
+ * zones instead and leaves out the pages that hold no matching row.
+ *
+ * The morsels in flight are bounded by the free frames of the buffer pool: a thread that finds no free frame for a
+ * morsel waits until another thread releases the pages of its morsel, and only fails if no morsel is in flight.
+ */
+class MorselCursor {
+ public:
+  /** The number of pages in a morsel. */
+  static constexpr size_t MORSEL_PAGES = 4;
+
+  /**
+   * Creates a cursor over the pages of a table.
+   * @param bpm the buffer pool manager
+   * @param table the table
+   * @param predicate the predicate of the scan, nullptr for none
+   */
+  MorselCursor(BufferPoolManager *bpm, TableHeap *table, const AbstractExpression *predicate);
+
+  /**
+   * Claim the next morsel, waiting for a free frame while other morsels are in flight.
+   * @param[out] pages the pinned pages of the morsel, which the caller must unpin and then Release()
+   * @param[out] num_skipped incremented for each page left out by the zone map
+   * @return false if all the pages have been claimed
+   * @throw Exception(OUT_OF_MEMORY) if no frame is free and no morsel of the cursor is in flight
+   */
+  bool Claim(std::vector<TablePage *> *pages, size_t *num_skipped);
+
+  /** Release a claimed morsel, whose pages the caller has unpinned. */
+  void Release(const std::vector<TablePage *> &pages);
+
+ private:
+  BufferPoolManager *bpm_;
+  std::mutex latch_;
+  /** Signaled when the pages of a morsel are released. */
+  std::condition_variable released_;
+  /** The number of pages of the claimed morsels that were not released yet. */
+  size_t pages_in_flight_{0};
+  /** The number of morsels released so far. */
+  size_t num_released_{0};
+  page_id_t next_page_id_;
+  /** The zone map walked instead of the page list, nullptr if it bounds no column of the predicate. */
+  ZoneMap *zone_map_{nullptr};
+  std::vector<ZoneBound> bounds_;
+  size_t next_zone_{0};
+};
+
+/** MorselScanExecutor reads the tuples of the morsels it claims from a cursor shared with other threads. */
+class MorselScanExecutor : public AbstractBatchExecutor {
+ public:
+  /**
+   * Creates a new morsel scan executor.
+   * @param exec_ctx the executor context
+   * @param table_info the table being scanned
+   * @param cursor the cursor over the pages of the table
+   */
+  MorselScanExecutor(ExecutorContext *exec_ctx, TableMetadata *table_info, MorselCursor *cursor)
+      : AbstractBatchExecutor(exec_ctx), table_info_(table_info), cursor_(cursor) {}
+
+  void Init() override;
+
+  bool NextBatch(TupleBatch *batch) override;
+
+  const Schema *GetOutputSchema() override { return &table_info_->schema_; }
+
+  /** Apply a dynamic filter on the rows of the table to the batches. */
+  void SetDynamicFilter(DynamicFilter *filter) { filter_probe_ = std::make_unique<DynamicFilter::Probe>(filter); }
+
+ private:
+  /** Read the tuples of the next morsel, false if there is none left. */
+  bool ReadMorsel();
+
+  TableMetadata *table_info_;
+  MorselCursor *cursor_;
+  std::vector<TablePage *> pages_;
+  /** The tuples of the current morsel and the next one to output. */
+  std::vector<Tuple> tuples_;
+  size_t position_{0};
+  /** The dynamic filter applied to the batches, if any. */
+  std::unique_ptr<DynamicFilter::Probe> filter_probe_;
+};
+
+/**
+ * ParallelSeqScanExecutor runs a sequential scan on execution_threads threads of the worker pool, morsel-driven: every
+ * thread runs its own scan, filter and projection pipeline over the morsels it claims from a shared MorselCursor, and
+ * pushes the batches it produces into a queue that NextBatch() pops from. The order of the output is therefore not the
+ * order of the table.
+ *
+ * Reading a table from several threads is only safe when reads take no tuple locks, because the lock sets of a
+ * transaction are not synchronized; see CanRunInParallel().
+ */
+class ParallelSeqScanExecutor : public AbstractBatchExecutor {
+ public:
+  /**
+   * Creates a new parallel sequential scan executor.
+   * @param exec_ctx the executor context, which must have a worker pool
+   * @param plan the sequential scan plan to be executed
+   * @param filter a dynamic filter on the rows of the table that every thread applies, if not nullptr
+   */
+  ParallelSeqScanExecutor(ExecutorContext *exec_ctx, const SeqScanPlanNode *plan, DynamicFilter *filter = nullptr);
+
+  /** Stops the threads if the scan was not drained. */
+  ~ParallelSeqScanExecutor() override { Stop(); }
+
+  void Init() override;
+
+  bool NextBatch(TupleBatch *batch) override;
+
+  void Close() override { Stop(); }
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
+
+  /** @return true if a scan in txn may read the table from several threads */
+  static bool CanRunInParallel(Transaction *txn) {
+    return txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION || !enable_logging;
+  }
+
+ private:
+  /** Run a pipeline until it is drained or the queue is closed. */
+  void Produce(AbstractExecutor *pipeline);
+
+  /** Close the queue and wait for the pipelines. */
+  void Stop();
+
+  /** The sequential scan plan node to be executed. */
+  const SeqScanPlanNode *plan_;
+  /** The table being scanned. */
+  TableMetadata *table_info_;
+  DynamicFilter *filter_;
+  std::unique_ptr<MorselCursor> cursor_;
+  /** The pipeline of each thread. */
+  std::vector<std::unique_ptr<AbstractExecutor>> pipelines_;
+  /** The tasks running the pipelines. */
+  std::vector<std::future<void>> tasks_;
+  TupleBatchQueue queue_;
+  /** The number of pipelines still producing; the last one to finish closes the queue. */
+  std::atomic<size_t> producing_{0};
+  /** The first exception thrown by a pipeline, which is rethrown to the consumer. */
+  std::mutex error_latch_;
+  std::exception_ptr error_;
+};
+}  // namespace bustub
@@ -0,0 +1,205 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_executor.h
+//
+// Identification: src/include/execution/executors/sort_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_batch_executor.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/sort_key.h"
+#include "storage/table/tmp_tuple_list.h"
+
+namespace bustub {
+
+/**
+ * LoserTree finds the smallest of the current keys of k inputs. It keeps the loser of every match of a tournament
+ * between the inputs, so that once the winner moves on to its next key, the new winner is found by replaying the
+ * log2(k) matches on the path of the winner alone.
+ *
+ * less(i, j) must be a strict order on the current keys of inputs i and j, with ties broken.
+ */
+template <typename Less>
+class LoserTree {
+ public:
+  LoserTree(size_t num_inputs, Less less) : less_(std::move(less)), tree_(num_inputs) {
+    // Nodes 1 to k - 1 are the matches and nodes k to 2k - 1 the inputs, the children of node n being 2n and 2n + 1.
+    size_t k = num_inputs;
+    std::vector<size_t> winners(2 * k);
+    for (size_t i = 0; i < k; i++) {
+      winners[k + i] = i;
+    }
+    for (size_t node = k - 1; node > 0; node--) {
+      size_t left = winners[2 * node];
+      size_t right = winners[2 * node + 1];
+      bool left_wins = less_(left, right);
+      winners[node] = left_wins ? left : right;
+      tree_[node] = left_wins ? right : left;
+    }
+    tree_[0] = winners[1];
+  }
+
+  /** @return the input with the smallest key */
+  size_t Winner() const { return tree_[0]; }
+
+  /** Replay the matches of the winner, after its input moved on to its next key. */
+  void Replay() {
+    size_t k = tree_.size();
+    size_t winner = tree_[0];
+    for (size_t node = (k + winner) / 2; node > 0; node /= 2) {
+      if (less_(tree_[node], winner)) {
+        std::swap(tree_[node], winner);
+      }
+    }
+    tree_[0] = winner;
+  }
+
+ private:
+  Less less_;
+  /** The winner of the tournament, then the loser of every match. */
+  std::vector<size_t> tree_;
+};
+
+/**
+ * SortRecord is the layout of the rows being sorted: a tuple followed by its normalized key and the size of the key,
+ * as a 4-byte integer. The tuple comes first, so that a record reads as the tuple itself.
+ */
+class SortRecord {
+ public:
+  /** @return a record of a tuple and its key */
+  static Tuple Make(const Tuple &tuple, std::string_view key);
+
+  /** @return the normalized key of a record */
+  static std::string_view Key(const Tuple &record);
+};
+
+/** RunMerger merges sorted runs of records with a loser tree. */
+class RunMerger {
+ public:
+  /** @param runs the runs to merge, which are read from their first record */
+  explicit RunMerger(const std::vector<TmpTupleList *> &runs);
+
+  DISALLOW_COPY_AND_MOVE(RunMerger);
+
+  /** @return the smallest record left, or nullptr once the runs are merged */
+  const Tuple *Peek() const;
+
+  /** Move past the record returned by Peek(). */
+  void Pop();
+
+ private:
+  struct Input {
+    TmpTupleList *run_;
+    Tuple record_;
+    std::string_view key_;
+    bool valid_;
+  };
+
+  struct Less {
+    const std::vector<Input> *inputs_;
+
+    bool operator()(size_t i, size_t j) const {
+      const Input &a = (*inputs_)[i];
+      const Input &b = (*inputs_)[j];
+      if (!a.valid_ || !b.valid_) {
+        // Exhausted inputs lose against everything.
+        return a.valid_ || (!b.valid_ && i < j);
+      }
+      int cmp = a.key_.compare(b.key_);
+      return cmp < 0 || (cmp == 0 && i < j);
+    }
+  };
+
+  /** Read the next record of an input. */
+  void Advance(Input *input);
+
+  std::vector<Input> inputs_;
+  std::unique_ptr<LoserTree<Less>> tree_;
+};
+
+/**
+ * SortExecutor sorts the tuples of its child by normalized keys (see SortKeyEncoder), as an external merge sort.
+ *
+ * The tuples are gathered into records in memory until they take sort_memory_budget bytes. A run that fills the
+ * budget is sorted and spilled to temporary pages, and the next run is gathered. If a single run was needed, it is
+ * output from memory; otherwise the runs are merged with a loser tree. Every run being read pins a page, so the runs
+ * are merged MAX_MERGE_FANIN at a time, in passes, until one last merge can output all of them.
+ */
+class SortExecutor : public AbstractBatchExecutor {
+ public:
+  /** The number of runs merged at once. */
+  static constexpr size_t MAX_MERGE_FANIN = 16;
+
+  /**
+   * Creates a new sort executor.
+   * @param exec_ctx the executor context
+   * @param plan the sort plan to be executed
+   * @param child the child executor whose tuples are sorted
+   */
+  SortExecutor(ExecutorContext *exec_ctx, const SortPlanNode *plan, std::unique_ptr<AbstractExecutor> &&child)
+      : AbstractBatchExecutor(exec_ctx), plan_(plan), child_(std::move(child)) {}
+
+  void Init() override;
+
+  bool NextBatch(TupleBatch *batch) override;
+
+  void Close() override { child_->Close(); }
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
+
+  /** @return the number of sorted runs spilled to disk, 0 if the sort ran in memory */
+  size_t GetNumRuns() const { return num_runs_; }
+
+  /** @return the number of merges that spilled their output as a run of a later merge */
+  size_t GetNumIntermediateMerges() const { return num_intermediate_merges_; }
+
+ private:
+  /** A record in memory, with the first bytes of its key to compare without following the record. */
+  struct Entry {
+    uint64_t prefix_;
+    uint32_t index_;
+  };
+
+  /** Sort the records in memory by their keys, and then by their arrival. */
+  void SortRecords();
+
+  /** Sort the records in memory and spill them as a run. */
+  void SpillRun();
+
+  /** Merge every MAX_MERGE_FANIN consecutive runs into one. */
+  void MergePass();
+
+  /** The sort plan node to be executed. */
+  const SortPlanNode *plan_;
+  /** The child executor whose tuples are sorted. */
+  std::unique_ptr<AbstractExecutor> child_;
+
+  /** The records in memory, their order and the bytes they take. */
+  std::vector<Tuple> records_;
+  std::vector<Entry> entries_;
+  size_t memory_used_{0};
+  /** The next entry to output, when sorting in memory. */
+  size_t next_entry_{0};
+
+  /** The runs spilled to disk, and the merger that outputs them in the end. */
+  std::deque<std::unique_ptr<TmpTupleList>> runs_;
+  std::unique_ptr<RunMerger> merger_;
+  size_t num_runs_{0};
+  size_t num_intermediate_merges_{0};
+};
+}  // namespace bustub
@@ -0,0 +1,84 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// topn_executor.h
+//
+// Identification: src/include/execution/executors/topn_executor.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "execution/dynamic_filter.h"
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_batch_executor.h"
+#include "execution/plans/topn_plan.h"
+
+namespace bustub {
+
+/**
+ * TopNExecutor outputs the first limit + offset tuples of its child by the sort keys, without the offset ones, with a
+ * bounded heap of limit + offset tuples: O(limit + offset) memory and O(N log(limit + offset)) time instead of a full
+ * sort. Tuples are compared by normalized keys (see SortKeyEncoder), and equal keys keep the order of the child.
+ *
+ * The heap is a max-heap, its top being the last tuple of the current result. Once it is full, the key of that tuple
+ * is the bound that any later tuple must sort before, which the executor publishes to a dynamic filter that the scan
+ * below it, if any, applies to skip the tuples that cannot qualify.
+ */
+class TopNExecutor : public AbstractBatchExecutor {
+ public:
+  /**
+   * Creates a new top-n executor.
+   * @param exec_ctx the executor context
+   * @param plan the top-n plan to be executed
+   * @param child the child executor whose tuples are sorted
+   * @param filter the dynamic filter applied below the child, or nullptr if there is none
+   */
+  TopNExecutor(ExecutorContext *exec_ctx, const TopNPlanNode *plan, std::unique_ptr<AbstractExecutor> &&child,
+               std::unique_ptr<DynamicFilter> &&filter = nullptr)
+      : AbstractBatchExecutor(exec_ctx), plan_(plan), child_(std::move(child)), filter_(std::move(filter)) {}
+
+  void Init() override;
+
+  bool NextBatch(TupleBatch *batch) override;
+
+  void Close() override { child_->Close(); }
+
+  const Schema *GetOutputSchema() override { return plan_->OutputSchema(); }
+
+  /** @return the number of tuples that the dynamic filter kept from reaching the executor */
+  size_t GetNumFiltered() const { return filter_ == nullptr ? 0 : filter_->GetNumFiltered(); }
+
+ private:
+  /** A tuple of the heap, with its key and its position in the output of the child. */
+  struct Entry {
+    std::string key_;
+    size_t sequence_;
+    Tuple tuple_;
+  };
+
+  /** @return true if a sorts before b */
+  static bool Less(const Entry &a, const Entry &b) {
+    int cmp = a.key_.compare(b.key_);
+    return cmp < 0 || (cmp == 0 && a.sequence_ < b.sequence_);
+  }
+
+  /** The top-n plan node to be executed. */
+  const TopNPlanNode *plan_;
+  /** The child executor whose tuples are sorted. */
+  std::unique_ptr<AbstractExecutor> child_;
+  std::unique_ptr<DynamicFilter> filter_;
+  /** The heap of the best tuples, sorted once the child is drained. */
+  std::vector<Entry> heap_;
+  /** The next entry to output. */
+  size_t next_entry_{0};
+};
+}  // namespace bustub
@@ -0,0 +1,164 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// expression_program.h
+//
+// Identification: src/include/execution/expression_program.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/expressions/parameter_value_expression.h"
+#include "execution/tuple_batch.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * ExpressionProgram is a predicate compiled from an expression tree into a flat, register-based bytecode, so that it
+ * is run by one interpreter loop instead of a virtual call, a Value copy and a type dispatch per node.
+ *
+ * Every node of the tree gets a register. Constants are loaded into theirs once, at compile time, and the parameters
+ * of a prepared plan at compile time and again by every LoadParameters(). Column references become loads specialized
+ * for the storage type of the column, and comparisons become instructions specialized for the type they compare:
+ * integers, decimals or varchars. The instructions are laid out in postfix order, the last one computing the
+ * predicate.
+ *
+ * A program runs either on tuples, reading the columns straight from their storage, or on a batch, where every
+ * instruction is a loop over the selected rows, loads alias the columns of the batch and the last comparison narrows
+ * the selection vector in place.
+ *
+ * Only comparisons of column values, constants and parameters of comparable types are compiled. A program keeps its
+ * registers between runs, so it must not be shared between threads.
+ */
+class ExpressionProgram {
+ public:
+  /**
+   * Compile a predicate.
+   * @param predicate the predicate
+   * @param left_schema the schema of the tuples, or of the left tuples of a join
+   * @param right_schema the schema of the right tuples of a join, nullptr if the predicate is not on a join
+   * @return the program, or nullptr if the predicate cannot be compiled
+   */
+  static std::unique_ptr<ExpressionProgram> Compile(const AbstractExpression *predicate, const Schema *left_schema,
+                                                    const Schema *right_schema = nullptr);
+
+  /** @return true if the predicate is true for a tuple, false if it is false or NULL */
+  bool Evaluate(const Tuple &tuple) { return EvaluateJoin(tuple, tuple); }
+
+  /** @return true if the predicate is true for a pair of tuples of a join, false if it is false or NULL */
+  bool EvaluateJoin(const Tuple &left, const Tuple &right);
+
+  /**
+   * Drop the selected rows of a batch for which the predicate is not true.
+   * @param batch the batch, whose columns are those of the left schema, followed by those of the right one on a join
+   */
+  void Filter(TupleBatch *batch);
+
+  /** Reload the registers of the parameters of the predicate with the values bound to them, before a run. */
+  void LoadParameters();
+
+  /** @return a listing of the instructions, one per line */
+  std::string ToString() const;
+
+ private:
+  enum class OpCode : uint8_t {
+    // dst = the column at offset_ in the storage of tuple tuple_idx_, or column col_idx_ of a batch
+    LoadTinyInt,
+    LoadSmallInt,
+    LoadInteger,
+    LoadBigInt,
+    LoadTimestamp,
+    LoadDecimal,
+    LoadVarchar,
+    // dst = lhs as a decimal
+    IntegerToDecimal,
+    // dst = lhs compared to rhs, as a BOOLEAN; each group follows the order of ComparisonType
+    EqInteger,
+    NeInteger,
+    LtInteger,
+    LeInteger,
+    GtInteger,
+    GeInteger,
+    EqDecimal,
+    NeDecimal,
+    LtDecimal,
+    LeDecimal,
+    GtDecimal,
+    GeDecimal,
+    EqVarchar,
+    NeVarchar,
+    LtVarchar,
+    LeVarchar,
+    GtVarchar,
+    GeVarchar,
+  };
+
+  struct Instruction {
+    OpCode opcode_;
+    uint8_t dst_;
+    uint8_t lhs_;
+    uint8_t rhs_;
+    uint32_t tuple_idx_;
+    uint32_t offset_;
+    uint32_t col_idx_;
+  };
+
+  /** The kinds of values a register holds. */
+  enum class Kind { Integer, Decimal, Varchar };
+
+  struct Register {
+    Kind kind_;
+    bool constant_{false};
+    bool null_{false};
+    int64_t integer_{0};
+    double decimal_{0};
+    std::string_view varchar_;
+    /** The storage of a varchar constant. */
+    std::string text_;
+    /** On a batch, the column of the values of the register, nullptr for a constant. */
+    const ColumnVector *column_{nullptr};
+    /** On a batch, the values computed by the instruction of the register. */
+    ColumnVector values_;
+  };
+
+  ExpressionProgram(const Schema *left_schema, const Schema *right_schema)
+      : left_schema_(left_schema), right_schema_(right_schema) {}
+
+  /** @return the register of the value of an expression, after the instructions computing it, or -1 */
+  int CompileExpression(const AbstractExpression *expr);
+
+  /** Load a constant value into a register of its kind. */
+  static void LoadConstant(Register *reg, const Value &value);
+
+  /** @return a new register of a kind */
+  uint8_t NewRegister(Kind kind);
+
+  /** Run a comparison on the selected rows of a batch, into the selection vector if filter is true. */
+  void CompareBatch(const Instruction &instruction, TupleBatch *batch, bool filter);
+
+  /** The largest number of registers, for their index to fit an instruction. */
+  static constexpr size_t MAX_REGISTERS = 256;
+
+  const Schema *left_schema_;
+  const Schema *right_schema_;
+  std::vector<Instruction> code_;
+  std::vector<Register> registers_;
+  /** The registers of the parameters, with the expressions holding their values. */
+  std::vector<std::pair<uint8_t, const ParameterValueExpression *>> parameters_;
+};
+
+}  // namespace bustub
@@ -16,6 +16,7 @@
 #include <vector>
 
 #include "catalog/schema.h"
+#include "execution/tuple_batch.h"
 #include "storage/table/tuple.h"
 
 namespace bustub {
@@ -58,6 +59,24 @@ class AbstractExpression {
    */
   virtual Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const = 0;
 
+  /**
+   * Evaluates the expression on the selected rows of a batch.
+   * @param batch the batch, whose columns follow the schema the expression refers to
+   * @param[out] scratch a column that the result may be written to
+   * @return the result column, defined for the selected rows of the batch
+   */
+  virtual const ColumnVector &EvaluateBatch(const TupleBatch &batch, ColumnVector *scratch) const = 0;
+
+  /**
+   * Evaluates a join expression on the selected rows of a batch of joined rows.
+   * @param batch the batch, whose columns are those of the left schema followed by those of the right schema
+   * @param left_column_count the number of columns of the left schema
+   * @param[out] scratch a column that the result may be written to
+   * @return the result column, defined for the selected rows of the batch
+   */
+  virtual const ColumnVector &EvaluateJoinBatch(const TupleBatch &batch, uint32_t left_column_count,
+                                                ColumnVector *scratch) const = 0;
+
   /** @return the child_idx'th child of this expression */
   const AbstractExpression *GetChildAt(uint32_t child_idx) const { return children_[child_idx]; }
 
@@ -46,6 +46,15 @@ class AggregateValueExpression : public AbstractExpression {
     return is_group_by_term_ ? group_bys[term_idx_] : aggregates[term_idx_];
   }
 
+  const ColumnVector &EvaluateBatch(const TupleBatch &batch, ColumnVector *scratch) const override {
+    BUSTUB_ASSERT(false, "Aggregation should only refer to group-by and aggregates.");
+  }
+
+  const ColumnVector &EvaluateJoinBatch(const TupleBatch &batch, uint32_t left_column_count,
+                                        ColumnVector *scratch) const override {
+    BUSTUB_ASSERT(false, "Aggregation should only refer to group-by and aggregates.");
+  }
+
  private:
   bool is_group_by_term_;
   uint32_t term_idx_;
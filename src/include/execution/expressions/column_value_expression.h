@@ -45,6 +45,15 @@ class ColumnValueExpression : public AbstractExpression {
     BUSTUB_ASSERT(false, "Aggregation should only refer to group-by and aggregates.");
   }
 
+  const ColumnVector &EvaluateBatch(const TupleBatch &batch, ColumnVector *scratch) const override {
+    return batch.GetColumn(col_idx_);
+  }
+
+  const ColumnVector &EvaluateJoinBatch(const TupleBatch &batch, uint32_t left_column_count,
+                                        ColumnVector *scratch) const override {
+    return batch.GetColumn(tuple_idx_ == 0 ? col_idx_ : left_column_count + col_idx_);
+  }
+
   uint32_t GetTupleIdx() const { return tuple_idx_; }
   uint32_t GetColIdx() const { return col_idx_; }
 
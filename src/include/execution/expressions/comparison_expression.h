@@ -12,6 +12,7 @@
 
 #pragma once
 
+#include <functional>
 #include <utility>
 #include <vector>
 
@@ -53,7 +54,83 @@ class ComparisonExpression : public AbstractExpression {
     return ValueFactory::GetBooleanValue(PerformComparison(lhs, rhs));
   }
 
+  const ColumnVector &EvaluateBatch(const TupleBatch &batch, ColumnVector *scratch) const override {
+    ColumnVector lhs_scratch;
+    ColumnVector rhs_scratch;
+    const ColumnVector &lhs = GetChildAt(0)->EvaluateBatch(batch, &lhs_scratch);
+    const ColumnVector &rhs = GetChildAt(1)->EvaluateBatch(batch, &rhs_scratch);
+    PerformBatchComparison(lhs, rhs, batch, scratch);
+    return *scratch;
+  }
+
+  const ColumnVector &EvaluateJoinBatch(const TupleBatch &batch, uint32_t left_column_count,
+                                        ColumnVector *scratch) const override {
+    ColumnVector lhs_scratch;
+    ColumnVector rhs_scratch;
+    const ColumnVector &lhs = GetChildAt(0)->EvaluateJoinBatch(batch, left_column_count, &lhs_scratch);
+    const ColumnVector &rhs = GetChildAt(1)->EvaluateJoinBatch(batch, left_column_count, &rhs_scratch);
+    PerformBatchComparison(lhs, rhs, batch, scratch);
+    return *scratch;
+  }
+
+  /** @return the type of comparison */
+  ComparisonType GetComparisonType() const { return comp_type_; }
+
  private:
+  /** Compares the selected rows of two columns into a BOOLEAN column, with a loop specialized for their types. */
+  void PerformBatchComparison(const ColumnVector &lhs, const ColumnVector &rhs, const TupleBatch &batch,
+                              ColumnVector *result) const {
+    result->Reset(TypeId::BOOLEAN, batch.NumRows());
+    const auto &rows = batch.GetSelection();
+    if (ColumnVector::IsIntegral(lhs.GetType()) && ColumnVector::IsIntegral(rhs.GetType())) {
+      CompareRows(lhs, rhs, rows, [](const ColumnVector &c, uint32_t row) { return c.GetInteger(row); }, result);
+    } else if (lhs.GetType() != TypeId::VARCHAR && rhs.GetType() != TypeId::VARCHAR) {
+      CompareRows(lhs, rhs, rows, [](const ColumnVector &c, uint32_t row) { return c.GetNumeric(row); }, result);
+    } else if (lhs.GetType() == TypeId::VARCHAR && rhs.GetType() == TypeId::VARCHAR) {
+      CompareRows(
+          lhs, rhs, rows, [](const ColumnVector &c, uint32_t row) -> const std::string & { return c.GetVarchar(row); },
+          result);
+    } else {
+      // Mixed types are left to the casting rules of Value.
+      for (uint32_t row : rows) {
+        result->SetValue(row, ValueFactory::GetBooleanValue(PerformComparison(lhs.GetValue(row), rhs.GetValue(row))));
+      }
+    }
+  }
+
+  template <class Getter>
+  void CompareRows(const ColumnVector &lhs, const ColumnVector &rhs, const std::vector<uint32_t> &rows, Getter get,
+                   ColumnVector *result) const {
+    switch (comp_type_) {
+      case ComparisonType::Equal:
+        return CompareRows(lhs, rhs, rows, get, std::equal_to<>(), result);
+      case ComparisonType::NotEqual:
+        return CompareRows(lhs, rhs, rows, get, std::not_equal_to<>(), result);
+      case ComparisonType::LessThan:
+        return CompareRows(lhs, rhs, rows, get, std::less<>(), result);
+      case ComparisonType::LessThanOrEqual:
+        return CompareRows(lhs, rhs, rows, get, std::less_equal<>(), result);
+      case ComparisonType::GreaterThan:
+        return CompareRows(lhs, rhs, rows, get, std::greater<>(), result);
+      case ComparisonType::GreaterThanOrEqual:
+        return CompareRows(lhs, rhs, rows, get, std::greater_equal<>(), result);
+      default:
+        BUSTUB_ASSERT(false, "Unsupported comparison type.");
+    }
+  }
+
+  template <class Getter, class Compare>
+  static void CompareRows(const ColumnVector &lhs, const ColumnVector &rhs, const std::vector<uint32_t> &rows,
+                          Getter get, Compare compare, ColumnVector *result) {
+    for (uint32_t row : rows) {
+      if (lhs.IsNull(row) || rhs.IsNull(row)) {
+        result->SetNull(row);
+      } else {
+        result->SetInteger(row, compare(get(lhs, row), get(rhs, row)) ? 1 : 0);
+      }
+    }
+  }
+
   CmpBool PerformComparison(const Value &lhs, const Value &rhs) const {
     switch (comp_type_) {
       case ComparisonType::Equal:
@@ -36,6 +36,20 @@ class ConstantValueExpression : public AbstractExpression {
     return val_;
   }
 
+  const ColumnVector &EvaluateBatch(const TupleBatch &batch, ColumnVector *scratch) const override {
+    scratch->Reset(val_.GetTypeId(), batch.NumRows());
+    scratch->Fill(val_, batch.GetSelection());
+    return *scratch;
+  }
+
+  const ColumnVector &EvaluateJoinBatch(const TupleBatch &batch, uint32_t left_column_count,
+                                        ColumnVector *scratch) const override {
+    return EvaluateBatch(batch, scratch);
+  }
+
+  /** @return the constant */
+  const Value &GetValue() const { return val_; }
+
  private:
   Value val_;
 };
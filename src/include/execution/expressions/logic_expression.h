@@ -0,0 +1,121 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// logic_expression.h
+//
+// Identification: src/include/expression/logic_expression.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "catalog/schema.h"
+#include "execution/expressions/abstract_expression.h"
+#include "storage/table/tuple.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+/** LogicType represents the type of logic operation that we want to perform. */
+enum class LogicType { And, Or };
+
+/**
+ * LogicExpression represents two boolean expressions combined with AND or OR, under the three-valued logic of SQL:
+ * FALSE AND NULL is FALSE and TRUE OR NULL is TRUE, anything else with a NULL is NULL.
+ */
+class LogicExpression : public AbstractExpression {
+ public:
+  /** Creates a new logic expression representing (left logic_type right). */
+  LogicExpression(const AbstractExpression *left, const AbstractExpression *right, LogicType logic_type)
+      : AbstractExpression({left, right}, TypeId::BOOLEAN), logic_type_{logic_type} {}
+
+  Value Evaluate(const Tuple *tuple, const Schema *schema) const override {
+    Value lhs = GetChildAt(0)->Evaluate(tuple, schema);
+    Value rhs = GetChildAt(1)->Evaluate(tuple, schema);
+    return ValueFactory::GetBooleanValue(PerformLogic(ToCmpBool(lhs), ToCmpBool(rhs)));
+  }
+
+  Value EvaluateJoin(const Tuple *left_tuple, const Schema *left_schema, const Tuple *right_tuple,
+                     const Schema *right_schema) const override {
+    Value lhs = GetChildAt(0)->EvaluateJoin(left_tuple, left_schema, right_tuple, right_schema);
+    Value rhs = GetChildAt(1)->EvaluateJoin(left_tuple, left_schema, right_tuple, right_schema);
+    return ValueFactory::GetBooleanValue(PerformLogic(ToCmpBool(lhs), ToCmpBool(rhs)));
+  }
+
+  Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const override {
+    Value lhs = GetChildAt(0)->EvaluateAggregate(group_bys, aggregates);
+    Value rhs = GetChildAt(1)->EvaluateAggregate(group_bys, aggregates);
+    return ValueFactory::GetBooleanValue(PerformLogic(ToCmpBool(lhs), ToCmpBool(rhs)));
+  }
+
+  const ColumnVector &EvaluateBatch(const TupleBatch &batch, ColumnVector *scratch) const override {
+    ColumnVector lhs_scratch;
+    ColumnVector rhs_scratch;
+    const ColumnVector &lhs = GetChildAt(0)->EvaluateBatch(batch, &lhs_scratch);
+    const ColumnVector &rhs = GetChildAt(1)->EvaluateBatch(batch, &rhs_scratch);
+    PerformBatchLogic(lhs, rhs, batch, scratch);
+    return *scratch;
+  }
+
+  const ColumnVector &EvaluateJoinBatch(const TupleBatch &batch, uint32_t left_column_count,
+                                        ColumnVector *scratch) const override {
+    ColumnVector lhs_scratch;
+    ColumnVector rhs_scratch;
+    const ColumnVector &lhs = GetChildAt(0)->EvaluateJoinBatch(batch, left_column_count, &lhs_scratch);
+    const ColumnVector &rhs = GetChildAt(1)->EvaluateJoinBatch(batch, left_column_count, &rhs_scratch);
+    PerformBatchLogic(lhs, rhs, batch, scratch);
+    return *scratch;
+  }
+
+  /** @return the type of logic operation */
+  LogicType GetLogicType() const { return logic_type_; }
+
+ private:
+  static CmpBool ToCmpBool(const Value &value) {
+    if (value.IsNull()) {
+      return CmpBool::CmpNull;
+    }
+    return value.GetAs<bool>() ? CmpBool::CmpTrue : CmpBool::CmpFalse;
+  }
+
+  static CmpBool ToCmpBool(const ColumnVector &column, uint32_t row) {
+    if (column.IsNull(row)) {
+      return CmpBool::CmpNull;
+    }
+    return column.GetInteger(row) != 0 ? CmpBool::CmpTrue : CmpBool::CmpFalse;
+  }
+
+  CmpBool PerformLogic(CmpBool lhs, CmpBool rhs) const {
+    // The value that decides the result on its own, whatever the other one is.
+    CmpBool dominant = logic_type_ == LogicType::And ? CmpBool::CmpFalse : CmpBool::CmpTrue;
+    if (lhs == dominant || rhs == dominant) {
+      return dominant;
+    }
+    if (lhs == CmpBool::CmpNull || rhs == CmpBool::CmpNull) {
+      return CmpBool::CmpNull;
+    }
+    return lhs;
+  }
+
+  /** Combines the selected rows of two BOOLEAN columns into a BOOLEAN column. */
+  void PerformBatchLogic(const ColumnVector &lhs, const ColumnVector &rhs, const TupleBatch &batch,
+                         ColumnVector *result) const {
+    result->Reset(TypeId::BOOLEAN, batch.NumRows());
+    for (uint32_t row : batch.GetSelection()) {
+      CmpBool value = PerformLogic(ToCmpBool(lhs, row), ToCmpBool(rhs, row));
+      if (value == CmpBool::CmpNull) {
+        result->SetNull(row);
+      } else {
+        result->SetInteger(row, value == CmpBool::CmpTrue ? 1 : 0);
+      }
+    }
+  }
+
+  LogicType logic_type_;
+};
+}  // namespace bustub
@@ -0,0 +1,97 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parameter_value_expression.h
+//
+// Identification: src/include/expression/parameter_value_expression.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "common/macros.h"
+#include "execution/expressions/abstract_expression.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+/**
+ * ParameterValueExpression represents a placeholder of a prepared plan, which evaluates to the value bound to it for
+ * the current execution. Everything that treats constants specially, such as compiled predicates and zone maps,
+ * reads the bound value when the executors are initialized.
+ *
+ * Concurrent executions of a plan share its expressions, so the values of an execution are bound to the threads that
+ * run it: a Binding installs them on the thread of the query, and the worker pool installs them on the threads that
+ * run the tasks the query submits.
+ */
+class ParameterValueExpression : public AbstractExpression {
+ public:
+  /** Binds values to the parameters for the executions run by the current thread, for as long as it lives. */
+  class Binding {
+   public:
+    explicit Binding(const std::vector<Value> *parameters) : previous_(bound_parameters_) {
+      bound_parameters_ = parameters;
+    }
+
+    ~Binding() { bound_parameters_ = previous_; }
+
+    DISALLOW_COPY_AND_MOVE(Binding);
+
+   private:
+    const std::vector<Value> *previous_;
+  };
+
+  /**
+   * Creates a new parameter value expression.
+   * @param param_idx the index of the parameter among the parameters of the plan
+   * @param ret_type the type of the parameter, which the values bound to it are cast to
+   */
+  ParameterValueExpression(uint32_t param_idx, TypeId ret_type)
+      : AbstractExpression({}, ret_type), param_idx_(param_idx), unbound_(ValueFactory::GetNullValueByType(ret_type)) {}
+
+  Value Evaluate(const Tuple *tuple, const Schema *schema) const override { return GetValue(); }
+
+  Value EvaluateJoin(const Tuple *left_tuple, const Schema *left_schema, const Tuple *right_tuple,
+                     const Schema *right_schema) const override {
+    return GetValue();
+  }
+
+  Value EvaluateAggregate(const std::vector<Value> &group_bys, const std::vector<Value> &aggregates) const override {
+    return GetValue();
+  }
+
+  const ColumnVector &EvaluateBatch(const TupleBatch &batch, ColumnVector *scratch) const override {
+    scratch->Reset(GetReturnType(), batch.NumRows());
+    scratch->Fill(GetValue(), batch.GetSelection());
+    return *scratch;
+  }
+
+  const ColumnVector &EvaluateJoinBatch(const TupleBatch &batch, uint32_t left_column_count,
+                                        ColumnVector *scratch) const override {
+    return EvaluateBatch(batch, scratch);
+  }
+
+  /** @return the value bound to the parameter by the current thread, NULL if none is bound */
+  const Value &GetValue() const {
+    return bound_parameters_ != nullptr ? (*bound_parameters_)[param_idx_] : unbound_;
+  }
+
+  /** @return the index of the parameter */
+  uint32_t GetParamIdx() const { return param_idx_; }
+
+  /** @return the values bound to the parameters by the current thread, nullptr if none are bound */
+  static const std::vector<Value> *GetBoundParameters() { return bound_parameters_; }
+
+ private:
+  /** The values bound to the parameters by the current thread. */
+  static inline thread_local const std::vector<Value> *bound_parameters_ = nullptr;
+
+  uint32_t param_idx_;
+  /** The value of the parameter when none is bound. */
+  Value unbound_;
+};
+}  // namespace bustub
@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// parallel_context.h
+//
+// Identification: src/include/execution/parallel_context.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>  // NOLINT
+#include <memory>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "execution/executor_context.h"
+#include "execution/executors/exchange_executor.h"
+#include "execution/executors/parallel_seq_scan_executor.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/exchange_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "execution/worker_pool.h"
+
+namespace bustub {
+
+/**
+ * ParallelContext holds what the instances of a parallel plan fragment share: the cursors of their sequential scans,
+ * the exchanges between them and the tasks they run on the worker pool. It is owned by the Gather that runs the
+ * fragment, and the shared state of a plan node is created by the first instance that asks for it.
+ */
+class ParallelContext {
+ public:
+  /**
+   * Creates the context of a parallel plan fragment.
+   * @param worker_pool the pool that runs the tasks of the fragment
+   * @param degree the number of instances of the fragment
+   */
+  ParallelContext(WorkerPool *worker_pool, size_t degree) : worker_pool_(worker_pool), degree_(degree) {}
+
+  ~ParallelContext() = default;
+
+  DISALLOW_COPY_AND_MOVE(ParallelContext);
+
+  /** @return the number of instances of the fragment */
+  size_t GetDegree() const { return degree_; }
+
+  /**
+   * Create the executor context of an instance of the fragment, which lives as long as the parallel context.
+   * @param parent the context whose transaction and resources the instance uses
+   * @param instance the index of the instance
+   */
+  ExecutorContext *MakeInstanceContext(ExecutorContext *parent, size_t instance);
+
+  /** @return the cursor over the pages of a table that the instances of a sequential scan share */
+  MorselCursor *GetMorselCursor(const SeqScanPlanNode *plan, BufferPoolManager *bpm, TableHeap *table);
+
+  /**
+   * @return the state that the consumers of an exchange share. The first consumer to ask starts the producers, the
+   * instances of the child of the exchange, on executor contexts derived from exec_ctx.
+   */
+  ExchangeState *GetExchange(const ExchangePlanNode *plan, ExecutorContext *exec_ctx);
+
+  /** Run a task of the fragment on the worker pool. */
+  void Submit(std::function<void()> task);
+
+  /** Close the exchanges, so that their producers stop. */
+  void Cancel();
+
+  /**
+   * Wait for the tasks of the fragment, including the ones they submit while being waited for.
+   * @return the first exception thrown by a task, or nullptr
+   */
+  std::exception_ptr Wait();
+
+ private:
+  WorkerPool *worker_pool_;
+  size_t degree_;
+  std::mutex latch_;
+  /** Declared first so that the executors, owned by the exchanges, are destroyed before their contexts. */
+  std::vector<std::unique_ptr<ExecutorContext>> contexts_;
+  std::unordered_map<const AbstractPlanNode *, std::unique_ptr<MorselCursor>> cursors_;
+  std::unordered_map<const AbstractPlanNode *, std::unique_ptr<ExchangeState>> exchanges_;
+  std::deque<std::future<void>> tasks_;
+  bool cancelled_{false};
+};
+
+}  // namespace bustub
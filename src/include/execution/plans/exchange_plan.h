@@ -0,0 +1,57 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// exchange_plan.h
+//
+// Identification: src/include/execution/plans/exchange_plan.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+/**
+ * Exchange repartitions the output of its child between the instances of the parallel plan fragment it is part of.
+ * The child subtree runs in as many instances of its own, each of which sends every tuple to the instance of the
+ * fragment that owns the hash of its partition keys, so that equal keys meet in the same instance. Without partition
+ * keys, whole batches are dealt out in turn to balance the load.
+ *
+ * The output of an exchange can be read only once. Outside of a Gather, an exchange does nothing.
+ */
+class ExchangePlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new exchange plan node.
+   * @param output_schema the output format of this exchange node, the one of the child
+   * @param child the child plan whose output is repartitioned
+   * @param partition_keys the keys the tuples are partitioned on, evaluated on the tuples of the child
+   */
+  ExchangePlanNode(const Schema *output_schema, const AbstractPlanNode *child,
+                   std::vector<const AbstractExpression *> &&partition_keys = {})
+      : AbstractPlanNode(output_schema, {child}), partition_keys_(std::move(partition_keys)) {}
+
+  PlanType GetType() const override { return PlanType::Exchange; }
+
+  /** @return the keys the tuples are partitioned on, empty to deal out batches in turn */
+  const std::vector<const AbstractExpression *> &GetPartitionKeys() const { return partition_keys_; }
+
+  /** @return the child plan whose output is repartitioned */
+  const AbstractPlanNode *GetChildPlan() const {
+    BUSTUB_ASSERT(GetChildren().size() == 1, "Exchange should have exactly one child plan.");
+    return GetChildAt(0);
+  }
+
+ private:
+  std::vector<const AbstractExpression *> partition_keys_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,52 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// gather_plan.h
+//
+// Identification: src/include/execution/plans/gather_plan.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+/**
+ * Gather runs several instances of its child subtree, the parallel plan fragment, on threads of the worker pool, and
+ * merges their output in no particular order.
+ *
+ * The instances split the sequential scans of the fragment between them, each reading a share of the morsels of the
+ * table. Operators that need all of their input in one instance, such as aggregations and joins, must therefore get
+ * it through an Exchange that partitions it on their keys. A Gather inside the fragment of another one does nothing.
+ */
+class GatherPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new gather plan node.
+   * @param output_schema the output format of this gather node, the one of the child
+   * @param child the root of the parallel plan fragment
+   * @param num_instances the number of instances of the fragment, 0 for execution_threads
+   */
+  GatherPlanNode(const Schema *output_schema, const AbstractPlanNode *child, size_t num_instances = 0)
+      : AbstractPlanNode(output_schema, {child}), num_instances_(num_instances) {}
+
+  PlanType GetType() const override { return PlanType::Gather; }
+
+  /** @return the number of instances of the fragment, 0 for execution_threads */
+  size_t GetNumInstances() const { return num_instances_; }
+
+  /** @return the root of the parallel plan fragment */
+  const AbstractPlanNode *GetChildPlan() const {
+    BUSTUB_ASSERT(GetChildren().size() == 1, "Gather should have exactly one child plan.");
+    return GetChildAt(0);
+  }
+
+ private:
+  size_t num_instances_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,64 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// topn_plan.h
+//
+// Identification: src/include/execution/plans/topn_plan.h
+//
+// Copyright (c) 2015-19, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/plans/sort_plan.h"
+
+namespace bustub {
+
+/**
+ * TopNPlanNode is ORDER BY ... LIMIT ... OFFSET ... as a single operator: it outputs the tuples of its child that a
+ * sort by the keys would output at positions offset to offset + limit - 1, in that order.
+ */
+class TopNPlanNode : public AbstractPlanNode {
+ public:
+  /**
+   * Creates a new top-n plan node.
+   * @param output_schema the output format of this top-n node, the one of the child
+   * @param child the child plan whose tuples are sorted
+   * @param order_bys the sort keys, evaluated on the tuples of the child, with their directions
+   * @param limit the number of output tuples
+   * @param offset the number of sorted tuples to be skipped
+   */
+  TopNPlanNode(const Schema *output_schema, const AbstractPlanNode *child,
+               std::vector<std::pair<OrderByType, const AbstractExpression *>> &&order_bys, size_t limit,
+               size_t offset = 0)
+      : AbstractPlanNode(output_schema, {child}), order_bys_(std::move(order_bys)), limit_(limit), offset_(offset) {}
+
+  PlanType GetType() const override { return PlanType::TopN; }
+
+  /** @return the child plan whose tuples are sorted */
+  const AbstractPlanNode *GetChildPlan() const {
+    BUSTUB_ASSERT(GetChildren().size() == 1, "TopN should have exactly one child plan.");
+    return GetChildAt(0);
+  }
+
+  /** @return the sort keys and their directions */
+  const std::vector<std::pair<OrderByType, const AbstractExpression *>> &GetOrderBys() const { return order_bys_; }
+
+  size_t GetLimit() const { return limit_; }
+
+  size_t GetOffset() const { return offset_; }
+
+ private:
+  std::vector<std::pair<OrderByType, const AbstractExpression *>> order_bys_;
+  size_t limit_;
+  size_t offset_;
+};
+
+}  // namespace bustub
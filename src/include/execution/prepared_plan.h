@@ -0,0 +1,140 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// prepared_plan.h
+//
+// Identification: src/include/execution/prepared_plan.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <memory>
+#include <mutex>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "catalog/schema.h"
+#include "concurrency/transaction.h"
+#include "execution/executor_context.h"
+#include "execution/executors/abstract_executor.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "execution/worker_pool.h"
+#include "optimizer/optimizer.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * PreparedPlan is a plan built once and executed many times with different values bound to its parameters, as a
+ * prepared statement is. It owns the plan nodes, expressions and schemas of the plan, so that they are allocated
+ * once, and ParameterValueExpressions stand for the values that change between executions.
+ *
+ * Once prepared by ExecutionEngine::Prepare(), the plan is optimized once and kept. Every execution runs on an
+ * executor tree of its own, in a context of its own, so that executions of the plan run concurrently. The trees of
+ * finished executions are kept on a free list and reused: an execution binds the values of the parameters and
+ * initializes the executors again, which reset their state, reload the parameters into their compiled predicates and
+ * recompute the bounds of their scans. A tree is only created again when it would differ, because the transaction
+ * running the plan or the configuration decides between parallel and serial executors differently than before.
+ */
+class PreparedPlan {
+ public:
+  /** An execution of the plan: the values bound to the parameters, and the executor tree and the context it runs. */
+  struct Execution {
+    std::vector<Value> parameters_;
+    std::unique_ptr<ExecutorContext> exec_ctx_;
+    std::unique_ptr<AbstractExecutor> executor_;
+    /** The configuration the executor tree was created for. */
+    bool vectorized_{false};
+    bool parallel_{false};
+  };
+
+  /** The number of finished executions kept for reuse. */
+  static constexpr size_t MAX_FREE_EXECUTIONS = 4;
+
+  PreparedPlan() = default;
+
+  DISALLOW_COPY_AND_MOVE(PreparedPlan);
+
+  /** @return a new parameter of a type, whose index is the number of parameters created before it */
+  const AbstractExpression *MakeParameter(TypeId type);
+
+  /** @return an expression of the plan, owned by the prepared plan */
+  const AbstractExpression *Own(std::unique_ptr<AbstractExpression> &&expr) {
+    exprs_.emplace_back(std::move(expr));
+    return exprs_.back().get();
+  }
+
+  /** @return a schema of the plan, owned by the prepared plan */
+  const Schema *Own(std::unique_ptr<Schema> &&schema) {
+    schemas_.emplace_back(std::move(schema));
+    return schemas_.back().get();
+  }
+
+  /** @return a plan node of the plan, owned by the prepared plan */
+  const AbstractPlanNode *Own(std::unique_ptr<AbstractPlanNode> &&plan) {
+    plans_.emplace_back(std::move(plan));
+    return plans_.back().get();
+  }
+
+  /** @return the number of parameters */
+  size_t GetNumParameters() const { return parameter_types_.size(); }
+
+  /** @return the schema of the result of the plan, once prepared */
+  const Schema *GetOutputSchema() const { return plan_->OutputSchema(); }
+
+  /** @return the version of the catalog the plan was optimized for, once prepared */
+  uint64_t GetCatalogVersion() const { return catalog_version_; }
+
+  /**
+   * Optimize the plan and create the executors of its first execution in the context of a query.
+   * @param plan the root of the plan, whose nodes must be owned by the prepared plan
+   * @param exec_ctx the context whose catalog, buffer pool, managers and worker pool the executions use
+   * @param optimize true to optimize the plan
+   */
+  void Prepare(const AbstractPlanNode *plan, ExecutorContext *exec_ctx, bool optimize);
+
+  /**
+   * Start an execution of the plan, reusing the executor tree of a finished one if there is any. Its values are cast
+   * to the types of the parameters, and its executors are set up to be run but not initialized.
+   * @param values a value per parameter
+   * @param query_ctx the context of the query, whose transaction runs the plan and which counts its statistics
+   * @throw Exception(MISMATCH_TYPE) if the number of values is not the number of parameters
+   */
+  std::unique_ptr<Execution> Acquire(const std::vector<Value> &values, ExecutorContext *query_ctx);
+
+  /** Keep a finished execution for reuse, unless MAX_FREE_EXECUTIONS are kept already. */
+  void Release(std::unique_ptr<Execution> &&execution);
+
+ private:
+  /** @return true if the executors created for a transaction would run in parallel */
+  bool IsParallel(Transaction *txn) const;
+
+  std::vector<std::unique_ptr<AbstractExpression>> exprs_;
+  std::vector<std::unique_ptr<Schema>> schemas_;
+  std::vector<std::unique_ptr<AbstractPlanNode>> plans_;
+  std::vector<TypeId> parameter_types_;
+
+  /** The optimizer, which owns the plan nodes it rewrote. */
+  std::unique_ptr<Optimizer> optimizer_;
+  const AbstractPlanNode *plan_{nullptr};
+  uint64_t catalog_version_{0};
+  /** The resources the executions use. */
+  Catalog *catalog_{nullptr};
+  BufferPoolManager *bpm_{nullptr};
+  TransactionManager *txn_mgr_{nullptr};
+  LockManager *lock_mgr_{nullptr};
+  WorkerPool *worker_pool_{nullptr};
+
+  /** Protects free_executions_. */
+  std::mutex latch_;
+  /** The finished executions, whose executor trees are reused. */
+  std::vector<std::unique_ptr<Execution>> free_executions_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,77 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// result_sink.h
+//
+// Identification: src/include/execution/result_sink.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "execution/tuple_batch.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * ResultSink receives the result of a query from ExecutionEngine::Execute() a batch at a time, as soon as the root
+ * executor produces it, so that the caller sees the first rows before the query ends and the result is never held in
+ * full unless the sink keeps it. A sink that needs no more rows stops the query, which closes its executors.
+ */
+class ResultSink {
+ public:
+  virtual ~ResultSink() = default;
+
+  /**
+   * Receive the next batch of the result.
+   * @param batch the batch, whose selected rows are the rows of the result; it is overwritten by the next batch
+   * @return false to stop the query
+   */
+  virtual bool Consume(const TupleBatch &batch) = 0;
+};
+
+/** VectorResultSink materializes the result into a vector, moving the tuples of each batch into it. */
+class VectorResultSink : public ResultSink {
+ public:
+  /** @param result_set the vector the tuples are appended to */
+  explicit VectorResultSink(std::vector<Tuple> *result_set) : result_set_(result_set) {}
+
+  bool Consume(const TupleBatch &batch) override {
+    for (uint32_t row : batch.GetSelection()) {
+      result_set_->emplace_back(batch.GetTuple(row));
+    }
+    return true;
+  }
+
+ private:
+  std::vector<Tuple> *result_set_;
+};
+
+/** TupleResultSink hands the tuples of the result to a callback one at a time, which returns false to stop. */
+class TupleResultSink : public ResultSink {
+ public:
+  /** @param callback the callback, which may keep the tuples it is given */
+  explicit TupleResultSink(std::function<bool(Tuple &&tuple)> callback) : callback_(std::move(callback)) {}
+
+  bool Consume(const TupleBatch &batch) override {
+    for (uint32_t row : batch.GetSelection()) {
+      if (!callback_(batch.GetTuple(row))) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+ private:
+  std::function<bool(Tuple &&tuple)> callback_;
+};
+
+}  // namespace bustub
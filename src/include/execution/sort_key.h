@@ -0,0 +1,67 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// sort_key.h
+//
+// Identification: src/include/execution/sort_key.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "execution/plans/sort_plan.h"
+#include "execution/tuple_batch.h"
+
+namespace bustub {
+
+/**
+ * SortKeyEncoder turns the sort keys of a row into a normalized key: a byte string whose order under memcmp is the
+ * order of the keys, so that rows are compared with one memcmp instead of a Value comparison per key.
+ *
+ * Every key is encoded as a NULL flag followed by its value in a prefix-free, order-preserving form: integers as
+ * big-endian with the sign bit flipped, decimals as the big-endian bits of the double adjusted so that negative ones
+ * come first, and varchars as their bytes with 0x00 escaped as 0x00 0xFF and terminated by 0x00 0x00. The bytes of a
+ * descending key are inverted.
+ */
+class SortKeyEncoder {
+ public:
+  /** @param order_bys the sort keys and their directions */
+  explicit SortKeyEncoder(const std::vector<std::pair<OrderByType, const AbstractExpression *>> &order_bys)
+      : order_bys_(order_bys), scratch_(order_bys.size()), keys_(order_bys.size()) {}
+
+  /** Evaluate the sort keys on the rows of a batch. */
+  void Evaluate(const TupleBatch &batch) {
+    for (size_t i = 0; i < order_bys_.size(); i++) {
+      keys_[i] = &order_bys_[i].second->EvaluateBatch(batch, &scratch_[i]);
+    }
+  }
+
+  /** Append the normalized key of a row of the batch last evaluated to key. */
+  void Encode(uint32_t row, std::string *key) const {
+    for (size_t i = 0; i < order_bys_.size(); i++) {
+      EncodeValue(*keys_[i], row, order_bys_[i].first == OrderByType::Descending, key);
+    }
+  }
+
+  /** Append the normalized encoding of a row of a column to key. */
+  static void EncodeValue(const ColumnVector &column, uint32_t row, bool descending, std::string *key);
+
+  /** @return the first 8 bytes of a normalized key as a big-endian integer, padded with zeros */
+  static uint64_t Prefix(std::string_view key);
+
+ private:
+  const std::vector<std::pair<OrderByType, const AbstractExpression *>> &order_bys_;
+  std::vector<ColumnVector> scratch_;
+  std::vector<const ColumnVector *> keys_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,176 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch.h
+//
+// Identification: src/include/execution/tuple_batch.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "common/rid.h"
+#include "common/util/hash_util.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/**
+ * ColumnVector holds the values of one column for the rows of a batch. Values are stored unboxed: all the integral
+ * types (BOOLEAN, TINYINT, SMALLINT, INTEGER, BIGINT and TIMESTAMP) widened to int64_t, DECIMAL as double and VARCHAR
+ * as std::string. NULL is tracked per row, separately from the value.
+ */
+class ColumnVector {
+ public:
+  explicit ColumnVector(TypeId type = TypeId::INVALID) : type_(type) {}
+
+  /** Set the type of the column and make room for size rows, whose values are undefined. */
+  void Reset(TypeId type, uint32_t size) {
+    type_ = type;
+    size_ = 0;
+    Resize(size);
+  }
+
+  /** Make room for size rows, keeping the values of the existing ones. */
+  void Resize(uint32_t size);
+
+  /** @return the type of the values */
+  TypeId GetType() const { return type_; }
+
+  /** @return the number of rows */
+  uint32_t Size() const { return size_; }
+
+  /** @return true if the values are stored as int64_t */
+  static bool IsIntegral(TypeId type) { return type != TypeId::DECIMAL && type != TypeId::VARCHAR; }
+
+  bool IsNull(uint32_t row) const { return nulls_[row] != 0; }
+  void SetNull(uint32_t row) { nulls_[row] = 1; }
+
+  int64_t GetInteger(uint32_t row) const { return integers_[row]; }
+  void SetInteger(uint32_t row, int64_t value) {
+    integers_[row] = value;
+    nulls_[row] = 0;
+  }
+
+  double GetDecimal(uint32_t row) const { return decimals_[row]; }
+  void SetDecimal(uint32_t row, double value) {
+    decimals_[row] = value;
+    nulls_[row] = 0;
+  }
+
+  const std::string &GetVarchar(uint32_t row) const { return varchars_[row]; }
+  void SetVarchar(uint32_t row, const char *data, uint32_t length) {
+    varchars_[row].assign(data, length);
+    nulls_[row] = 0;
+  }
+
+  /** @return the value of a row of a numeric column as a double */
+  double GetNumeric(uint32_t row) const {
+    return type_ == TypeId::DECIMAL ? decimals_[row] : static_cast<double>(integers_[row]);
+  }
+
+  /** @return the value of a row boxed in a Value of the type of the column */
+  Value GetValue(uint32_t row) const;
+
+  /** Set the value of a row, converting it to the type of the column. */
+  void SetValue(uint32_t row, const Value &value);
+
+  /** Set the value of a row from the serialized value of an inlined column of a tuple. */
+  void SetFromStorage(uint32_t row, const char *storage);
+
+  /** Set the value of a row to the value of a row of another column. */
+  void CopyRow(uint32_t row, const ColumnVector &src, uint32_t src_row);
+
+  /** Set the given rows to value. */
+  void Fill(const Value &value, const std::vector<uint32_t> &rows);
+
+  /** @return true if a row equals a row of another column of the same type, where NULL equals NULL */
+  bool RowEquals(uint32_t row, const ColumnVector &other, uint32_t other_row) const;
+
+  /** @return the hash of the value of a row, the same for equal values */
+  hash_t HashRow(uint32_t row) const;
+
+ private:
+  TypeId type_;
+  uint32_t size_{0};
+  std::vector<int64_t> integers_;
+  std::vector<double> decimals_;
+  std::vector<std::string> varchars_;
+  std::vector<uint8_t> nulls_;
+};
+
+/**
+ * TupleBatch is a batch of up to BATCH_SIZE rows in columnar layout, the unit of work of vectorized execution.
+ *
+ * The selection vector lists the rows of the batch that are live, in order. Operators such as filters drop rows by
+ * shrinking the selection vector instead of moving column data, so the values of the rows that are not selected are
+ * stale and must not be read.
+ */
+class TupleBatch {
+ public:
+  TupleBatch() = default;
+
+  /** Empty the batch and lay out its columns for schema, which may be nullptr for a batch without columns. */
+  void Reset(const Schema *schema);
+
+  /** @return the schema of the rows */
+  const Schema *GetSchema() const { return schema_; }
+
+  /** @return the number of rows in the batch, selected or not */
+  uint32_t NumRows() const { return num_rows_; }
+
+  /** @return true if no more rows can be appended */
+  bool IsFull() const { return num_rows_ >= static_cast<uint32_t>(BATCH_SIZE); }
+
+  /** @return the number of selected rows */
+  uint32_t NumSelected() const { return static_cast<uint32_t>(selection_.size()); }
+
+  /** @return the selected rows, in order */
+  const std::vector<uint32_t> &GetSelection() const { return selection_; }
+  std::vector<uint32_t> *GetMutableSelection() { return &selection_; }
+
+  /** @return the number of columns */
+  uint32_t NumColumns() const { return static_cast<uint32_t>(columns_.size()); }
+
+  const ColumnVector &GetColumn(uint32_t col_idx) const { return columns_[col_idx]; }
+  ColumnVector *GetMutableColumn(uint32_t col_idx) { return &columns_[col_idx]; }
+
+  /** @return the RID of a row, or an invalid RID if the row does not come from a table */
+  const RID &GetRID(uint32_t row) const { return rids_[row]; }
+
+  /**
+   * Append a selected row whose values are to be set by the caller.
+   * @return the index of the row
+   */
+  uint32_t AppendRow(const RID &rid = RID());
+
+  /** Append a tuple of the schema of the batch as a selected row. */
+  void AppendTuple(const Tuple &tuple, const RID &rid);
+
+  /** Drop the selected rows for which a BOOLEAN column is not true. */
+  void Select(const ColumnVector &matches);
+
+  /** Take over the number of rows, the selection vector and the RIDs of another batch, but not its columns. */
+  void CopySelection(const TupleBatch &other);
+
+  /** @return a row as a tuple of the schema of the batch */
+  Tuple GetTuple(uint32_t row) const;
+
+ private:
+  const Schema *schema_{nullptr};
+  uint32_t num_rows_{0};
+  std::vector<ColumnVector> columns_;
+  std::vector<RID> rids_;
+  std::vector<uint32_t> selection_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,93 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tuple_batch_queue.h
+//
+// Identification: src/include/execution/tuple_batch_queue.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <thread>  // NOLINT
+#include <utility>
+
+#include "common/lock_free_queue.h"
+#include "execution/tuple_batch.h"
+
+namespace bustub {
+
+/**
+ * TupleBatchQueue passes batches from the threads that produce them to the threads that consume them. It is a
+ * bounded lock-free queue, so producers wait for the consumers when they run ahead of them, and the other way around.
+ * Waiting threads spin, yielding the processor, and back off to short sleeps if the wait drags on.
+ */
+class TupleBatchQueue {
+ public:
+  /** @param capacity the number of batches the queue holds at most, rounded up to a power of two */
+  explicit TupleBatchQueue(size_t capacity) : batches_(capacity) {}
+
+  /**
+   * Push a batch, waiting while the queue is full.
+   * @return false if the queue was closed, in which case the batch is dropped
+   */
+  bool Push(TupleBatch &&batch) {
+    for (size_t attempt = 0; !closed_.load(); attempt++) {
+      if (batches_.TryPush(std::move(batch))) {
+        return true;
+      }
+      Backoff(attempt);
+    }
+    return false;
+  }
+
+  /**
+   * Pop a batch, waiting while the queue is empty and open.
+   * @return false if the queue is closed and empty
+   */
+  bool Pop(TupleBatch *batch) {
+    for (size_t attempt = 0;; attempt++) {
+      if (batches_.TryPop(batch)) {
+        return true;
+      }
+      if (closed_.load()) {
+        // A batch pushed before the queue was closed may have landed since the failed pop.
+        return batches_.TryPop(batch);
+      }
+      Backoff(attempt);
+    }
+  }
+
+  /** Close the queue: pushes fail from now on, and pops fail once the batches left are popped. */
+  void Close() { closed_.store(true); }
+
+  /** Drop the batches left and reopen the queue. No thread may be pushing or popping. */
+  void Reset() {
+    TupleBatch batch;
+    while (batches_.TryPop(&batch)) {
+    }
+    closed_.store(false);
+  }
+
+ private:
+  /** The number of failed attempts after which a waiting thread sleeps instead of yielding. */
+  static constexpr size_t SPIN_ATTEMPTS = 64;
+
+  static void Backoff(size_t attempt) {
+    if (attempt < SPIN_ATTEMPTS) {
+      std::this_thread::yield();
+    } else {
+      std::this_thread::sleep_for(std::chrono::microseconds(50));
+    }
+  }
+
+  LockFreeQueue<TupleBatch> batches_;
+  std::atomic<bool> closed_{false};
+};
+
+}  // namespace bustub
@@ -0,0 +1,72 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// worker_pool.h
+//
+// Identification: src/include/execution/worker_pool.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <condition_variable>  // NOLINT
+#include <deque>
+#include <functional>
+#include <future>  // NOLINT
+#include <mutex>   // NOLINT
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "common/macros.h"
+
+namespace bustub {
+
+/**
+ * WorkerPool runs the tasks of parallel executors on threads that are kept around between queries.
+ *
+ * The pool never queues a task behind a busy thread: it starts a new thread when none is idle. Parallel operators
+ * wait on each other through bounded queues, so a task that is not running could hold up the tasks that are, and the
+ * number of threads is bounded by the parallelism of the plans instead.
+ */
+class WorkerPool {
+ public:
+  WorkerPool() = default;
+
+  /** Runs the tasks left and joins the threads. */
+  ~WorkerPool();
+
+  DISALLOW_COPY_AND_MOVE(WorkerPool);
+
+  /**
+   * Run a task on a thread of the pool, with the values of the parameters of a prepared plan that the calling thread
+   * has bound.
+   * @return a future that is ready when the task is done, and holds the exception it threw, if any
+   */
+  std::future<void> Submit(std::function<void()> task);
+
+  /**
+   * Run f(0), ..., f(n - 1) in parallel, f(0) on the calling thread, and wait for all of them.
+   * @throws the first exception thrown by one of them
+   */
+  void RunInParallel(size_t n, const std::function<void(size_t)> &f);
+
+  /** @return the number of threads the pool has started */
+  size_t NumThreads();
+
+ private:
+  /** The loop of a thread of the pool. */
+  void Work();
+
+  std::mutex latch_;
+  std::condition_variable has_task_;
+  std::deque<std::packaged_task<void()>> tasks_;
+  std::vector<std::thread> threads_;
+  /** The number of threads waiting for a task. */
+  size_t idle_{0};
+  bool stopped_{false};
+};
+
+}  // namespace bustub
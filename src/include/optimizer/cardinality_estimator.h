@@ -0,0 +1,96 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// cardinality_estimator.h
+//
+// Identification: src/include/optimizer/cardinality_estimator.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <unordered_map>
+
+#include "catalog/catalog.h"
+#include "catalog/table_stats.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/plans/abstract_plan.h"
+
+namespace bustub {
+
+/**
+ * CardinalityEstimator estimates how many rows plans produce and how many rows predicates keep, from the statistics
+ * that Catalog::Analyze() gathered on the tables they read.
+ *
+ * A column is traced back through the output schemas of joins, sorts and limits to the column of the table it comes
+ * from, whose statistics are used as they are: filters are assumed not to change the distribution of the other
+ * columns, and the conjuncts of a predicate to be independent. Comparisons with a constant are estimated from the
+ * histogram of the column, and equalities of two columns as 1 / the larger number of distinct values. What cannot be
+ * traced, or comes from a table that was never analyzed, falls back to fixed defaults.
+ *
+ * The statistics of a table are read once and held by the estimator, so that one optimization sees the same ones
+ * throughout, and an ANALYZE that replaces them meanwhile does not free them under it.
+ */
+class CardinalityEstimator {
+ public:
+  /** The number of rows assumed for a table that was never analyzed. */
+  static constexpr double DEFAULT_ROW_COUNT = 1000;
+  /** The selectivity assumed for an equality without statistics. */
+  static constexpr double DEFAULT_EQUALITY_SELECTIVITY = 0.1;
+  /** The selectivity assumed for any other predicate without statistics. */
+  static constexpr double DEFAULT_SELECTIVITY = 1.0 / 3;
+
+  /** A function returning the statistics of the column that a column value refers to, nullptr if unknown. */
+  using ColumnResolver = std::function<const ColumnStats *(const ColumnValueExpression *)>;
+
+  /** @param catalog the catalog holding the tables and their statistics */
+  explicit CardinalityEstimator(Catalog *catalog) : catalog_(catalog) {}
+
+  /** @return the estimated number of rows that a plan produces */
+  double EstimateCardinality(const AbstractPlanNode *plan) const;
+
+  /**
+   * Estimate the selectivity of a predicate.
+   * @param predicate the predicate, nullptr for none
+   * @param plan the plan that evaluates the predicate: a sequential scan, whose predicate refers to the columns of its
+   * table, or a join, whose predicate refers to the output columns of its children
+   * @return the estimated fraction of the rows for which the predicate is true
+   */
+  double EstimateSelectivity(const AbstractExpression *predicate, const AbstractPlanNode *plan) const;
+
+  /** @return the estimated selectivity of a predicate, whose columns are resolved to their statistics by resolver */
+  double EstimateSelectivity(const AbstractExpression *predicate, const ColumnResolver &resolver) const;
+
+  /** @return the selectivity of an equality of the output columns of two plans, as for the keys of a join */
+  double EstimateEquality(const AbstractPlanNode *left_plan, uint32_t left_col_idx, const AbstractPlanNode *right_plan,
+                          uint32_t right_col_idx) const;
+
+  /** @return the statistics of the table column that an output column of a plan comes from, nullptr if unknown */
+  const ColumnStats *GetOutputColumnStats(const AbstractPlanNode *plan, uint32_t col_idx) const;
+
+  /** @return the statistics of a table, nullptr if it was never analyzed; they live as long as the estimator */
+  const TableStats *GetTableStats(table_oid_t table_oid) const;
+
+ private:
+  /** @return the statistics of a column referred to by a predicate that a plan evaluates, nullptr if unknown */
+  const ColumnStats *GetColumnStats(const ColumnValueExpression *column, const AbstractPlanNode *plan) const;
+
+  /** @return the estimated selectivity of a comparison */
+  double EstimateComparison(const ComparisonExpression *comparison, const ColumnResolver &resolver) const;
+
+  /** @return the selectivity of an equality of two columns, either of whose statistics may be unknown */
+  static double EstimateEquality(const ColumnStats *left, const ColumnStats *right);
+
+  Catalog *catalog_;
+  /** The statistics of the tables read so far. */
+  mutable std::unordered_map<table_oid_t, std::shared_ptr<const TableStats>> table_stats_;
+};
+
+}  // namespace bustub
@@ -0,0 +1,132 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// join_orderer.h
+//
+// Identification: src/include/optimizer/join_orderer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <unordered_map>
+#include <vector>
+
+namespace bustub {
+
+/**
+ * JoinOrderer picks the order and the algorithms of a multi-way inner join, from the estimated cardinalities of its
+ * relations and the selectivities of its predicates.
+ *
+ * The relations are the vertices of a join graph, and the predicates referring to several of them its edges. With up
+ * to MAX_DP_RELATIONS relations, the cheapest bushy tree is found by dynamic programming over the subsets of the
+ * relations, smallest first: the plan of a subset joins the best plans of two complementary connected subsets that
+ * a predicate connects, as DPccp does, and only a subset that cannot be split so joins any two with a cross product.
+ * A subset of k relations has 2^k splits, so with more relations the tree is built greedily instead, by joining the
+ * two trees whose join is the smallest until a single one is left.
+ *
+ * The cost of a plan counts the pages read or written through the buffer pool and the tuples processed. A hash join
+ * processes each input tuple once, and spills both inputs to temporary pages when the smaller one does not fit in
+ * hash_join_memory_budget. A nested loop join materializes its right input and evaluates its predicate on every pair
+ * of tuples. The cardinality of a set of relations does not depend on how they are joined: it is the product of the
+ * cardinalities of the relations and of the selectivities of the predicates among them.
+ */
+class JoinOrderer {
+ public:
+  /** The largest number of relations ordered by dynamic programming. */
+  static constexpr size_t MAX_DP_RELATIONS = 10;
+  /** The cost of reading or writing a page. */
+  static constexpr double PAGE_COST = 1;
+  /** The cost of processing a tuple. */
+  static constexpr double TUPLE_COST = 0.01;
+  /** The index of no node. */
+  static constexpr size_t INVALID_NODE = std::numeric_limits<size_t>::max();
+
+  enum class JoinAlgorithm { None, NestedLoop, Hash };
+
+  /** A node of a join tree: a relation, or a join of two nodes. */
+  struct Node {
+    /** The bit set of the relations under the node. */
+    uint64_t relations_{0};
+    /** The children of a join, INVALID_NODE for a relation. */
+    size_t left_{INVALID_NODE};
+    size_t right_{INVALID_NODE};
+    /** How a join is executed, None for a relation. */
+    JoinAlgorithm algorithm_{JoinAlgorithm::None};
+    /** The estimated number of output rows. */
+    double cardinality_{0};
+    /** The estimated cost of the whole subtree. */
+    double cost_{0};
+    /** The estimated number of bytes of an output row. */
+    double width_{0};
+  };
+
+  /**
+   * Add a relation, whose index is the number of relations added before it.
+   * @param cardinality the estimated number of rows of the relation
+   * @param cost the estimated cost of producing them
+   * @param width the estimated number of bytes of a row
+   * @return the node of the relation, which is its index
+   */
+  size_t AddRelation(double cardinality, double cost, double width);
+
+  /**
+   * Add a predicate.
+   * @param relations the bit set of the relations that the predicate refers to
+   * @param selectivity the estimated fraction of rows for which the predicate is true
+   * @param lhs for an equality that can be a hash join key, the bit set of the relations its left side refers to
+   * @param rhs for an equality that can be a hash join key, the bit set of the relations its right side refers to
+   */
+  void AddPredicate(uint64_t relations, double selectivity, uint64_t lhs = 0, uint64_t rhs = 0);
+
+  /** @return a new node joining two nodes of disjoint relations, with the cheaper algorithm */
+  size_t Join(size_t left, size_t right);
+
+  /** @return the root of the cheapest join tree of all the relations, by dynamic programming or greedily */
+  size_t Order() { return NumRelations() <= MAX_DP_RELATIONS ? OrderExhaustively() : OrderGreedily(); }
+
+  /** @return the root of the cheapest join tree of all the relations, found by dynamic programming */
+  size_t OrderExhaustively();
+
+  /** @return the root of a join tree of all the relations, built greedily */
+  size_t OrderGreedily();
+
+  /** @return a node */
+  const Node &GetNode(size_t node) const { return nodes_[node]; }
+
+  /** @return true if a predicate refers to both a relation of left and a relation of right, and to no other */
+  bool IsConnected(uint64_t left, uint64_t right) const;
+
+ private:
+  struct Predicate {
+    uint64_t relations_;
+    double selectivity_;
+    uint64_t lhs_;
+    uint64_t rhs_;
+  };
+
+  /** @return the number of relations */
+  size_t NumRelations() const { return num_relations_; }
+
+  /** @return the estimated cardinality of the join of a set of relations */
+  double Cardinality(uint64_t relations);
+
+  /** @return a join of two nodes with the cheaper algorithm, not added to the nodes */
+  Node PlanJoin(size_t left, size_t right);
+
+  /** @return true if an equality that can be a hash join key has a side in left and the other in right */
+  bool HasHashKeys(uint64_t left, uint64_t right) const;
+
+  size_t num_relations_{0};
+  std::vector<Node> nodes_;
+  std::vector<Predicate> predicates_;
+  std::unordered_map<uint64_t, double> cardinalities_;
+};
+
+}  // namespace bustub
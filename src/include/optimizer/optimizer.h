@@ -0,0 +1,218 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// optimizer.h
+//
+// Identification: src/include/optimizer/optimizer.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "catalog/catalog.h"
+#include "catalog/schema.h"
+#include "common/macros.h"
+#include "execution/expressions/abstract_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/plans/abstract_plan.h"
+#include "optimizer/cardinality_estimator.h"
+#include "optimizer/join_orderer.h"
+
+namespace bustub {
+
+/**
+ * Optimizer rewrites a plan tree into an equivalent one that is cheaper to execute, by applying a fixed sequence of
+ * rules, each of which walks the whole tree:
+ *
+ * 1. Predicate pushdown. The predicate of a join is split into its conjuncts, and a conjunct that only refers to one
+ *    side is moved into the child on that side: into the predicate of a sequential scan, or of a join, which pushes it
+ *    further down in turn. Rows that cannot match are then dropped before the join instead of after it.
+ * 2. Join selection. A nested loop join whose predicate has conjuncts equating a key of the left side with a key of
+ *    the right side becomes a hash join on those keys, keeping the other conjuncts as its predicate.
+ * 3. Join ordering, given a catalog. A tree of three or more nested loop and hash joins is flattened into the
+ *    relations it joins and the conjuncts of its predicates and keys, whose cheapest order and join algorithms are
+ *    picked by a JoinOrderer from the statistics of the relations (see CardinalityEstimator). The tree is rebuilt in
+ *    that order if it is cheaper than the written one, each conjunct at the lowest join that has all its columns.
+ * 4. Column pruning. Starting from the root, whose output schema is kept as is, the columns of a child that its
+ *    parent join or aggregation never refers to are dropped from the output schema of the child, and the references
+ *    of the parent are renumbered.
+ *
+ * The rules see through limits, sorts and top-Ns, but leave alone the plans they do not know, such as those of
+ * parallel fragments or of modifications. Subtrees that no rule changes are shared with the original plan.
+ *
+ * The optimizer owns the plan nodes, expressions and schemas it creates, so it must outlive the plans it returns.
+ */
+class Optimizer {
+ public:
+  /** @param catalog the catalog of the tables of the plans, whose statistics order joins; nullptr not to order them */
+  explicit Optimizer(Catalog *catalog = nullptr)
+      : estimator_(catalog == nullptr ? nullptr : std::make_unique<CardinalityEstimator>(catalog)) {}
+
+  DISALLOW_COPY_AND_MOVE(Optimizer);
+
+  /**
+   * Optimize a plan.
+   * @param plan the plan, which is left untouched
+   * @return an equivalent plan, whose output schema has the same columns as that of plan
+   */
+  const AbstractPlanNode *Optimize(const AbstractPlanNode *plan);
+
+ private:
+  /** A function rewriting column references, returning nullptr if a reference cannot be rewritten. */
+  using ColumnRewriter = std::function<const AbstractExpression *(const ColumnValueExpression *)>;
+
+  /** A rule, rewriting a plan into an equivalent one. */
+  using Rule = std::function<const AbstractPlanNode *(const AbstractPlanNode *)>;
+
+  /** A tree of joins flattened into the relations it joins and the conjuncts of its predicates and keys. */
+  struct JoinGraph {
+    /** The plans under the joins of the tree. */
+    std::vector<const AbstractPlanNode *> relations_;
+    /** The index of each relation in relations_. */
+    std::unordered_map<const AbstractPlanNode *, uint32_t> indexes_;
+    /** The conjuncts, whose column values refer to the output columns of the relations, by their tuple index. */
+    std::vector<const AbstractExpression *> conjuncts_;
+  };
+
+  /** @return the plan with the predicates of its joins pushed down */
+  const AbstractPlanNode *PushDownPredicates(const AbstractPlanNode *plan);
+
+  /** @return the plan with its nested loop joins on equal keys turned into hash joins */
+  const AbstractPlanNode *SelectJoins(const AbstractPlanNode *plan);
+
+  /** @return the plan with its trees of joins reordered by cost */
+  const AbstractPlanNode *ReorderJoins(const AbstractPlanNode *plan);
+
+  /**
+   * Add the relations and the conjuncts of a tree of joins to a join graph.
+   * @return false if the tree cannot be reordered, as when a join computes an output column
+   */
+  bool FlattenJoins(const AbstractPlanNode *plan, JoinGraph *graph);
+
+  /**
+   * Rewrite an expression evaluated by a join of a join graph into one over the relations of the graph.
+   * @param side the child that all the column values refer to, as for join keys; -1 to follow their tuple index
+   * @return the rewritten expression, nullptr if a column does not come straight from a relation
+   */
+  const AbstractExpression *ToRelations(const AbstractExpression *expr, const AbstractPlanNode *join, int side,
+                                        const JoinGraph &graph);
+
+  /** @return a column value referring to the relation that an output column of a plan of a join graph comes from */
+  const AbstractExpression *ToRelationColumn(const AbstractPlanNode *plan, uint32_t col_idx, TypeId type,
+                                             const JoinGraph &graph);
+
+  /** @return the estimated cost of producing the rows of a relation of a join graph */
+  double RelationCost(const AbstractPlanNode *relation, double cardinality) const;
+
+  /**
+   * Build the plan of a node of a join tree.
+   * @param orderer the orderer of the tree
+   * @param node the node
+   * @param inputs the plans of the relations
+   * @param conjuncts the conjuncts over the relations, each placed at the lowest join that has all its columns
+   * @param output_schema the output schema of the root, whose columns are computed by outputs; nullptr for a join
+   * below it, whose output has all the columns of its relations
+   * @param outputs the expressions over the relations computing the columns of output_schema
+   * @param[out] offsets the index of the first output column of each relation of the node
+   * @return the plan
+   */
+  const AbstractPlanNode *BuildJoin(const JoinOrderer &orderer, size_t node,
+                                    const std::vector<const AbstractPlanNode *> &inputs,
+                                    const std::vector<const AbstractExpression *> &conjuncts,
+                                    const Schema *output_schema, const std::vector<const AbstractExpression *> &outputs,
+                                    std::vector<uint32_t> *offsets);
+
+  /** @return the plan with the columns its nodes do not need dropped from the output schemas of their children */
+  const AbstractPlanNode *PruneColumns(const AbstractPlanNode *plan);
+
+  /**
+   * @return the plan with a rule applied to each of its children, or plan itself if none of them changed or if the
+   * rules do not look into its type of plan
+   */
+  const AbstractPlanNode *RewriteChildren(const AbstractPlanNode *plan, const Rule &rule);
+
+  /** @return a copy of plan with other children */
+  const AbstractPlanNode *WithChildren(const AbstractPlanNode *plan, std::vector<const AbstractPlanNode *> &&children);
+
+  /**
+   * Rewrite a predicate on the output of a plan into one that the plan can evaluate itself.
+   * @return the rewritten predicate, or nullptr if the predicate cannot be pushed into the plan
+   */
+  const AbstractExpression *PushablePredicate(const AbstractPlanNode *plan, const AbstractExpression *predicate);
+
+  /** @return a copy of a sequential scan or a join with additional predicates, which must be pushable into it */
+  const AbstractPlanNode *WithPredicates(const AbstractPlanNode *plan,
+                                         const std::vector<const AbstractExpression *> &predicates);
+
+  /**
+   * Drop the columns of the output schema of a plan that are not used.
+   * @param plan a sequential scan or a join
+   * @param used whether each column of the output schema of plan is used
+   * @param[out] mapping the new index of each used column
+   * @return a copy of plan with the used columns only, or plan itself if all of them are used
+   */
+  const AbstractPlanNode *WithColumns(const AbstractPlanNode *plan, const std::vector<bool> &used,
+                                      std::vector<uint32_t> *mapping);
+
+  /** Split a predicate into the conjuncts that it is the AND of. */
+  static void SplitConjunction(const AbstractExpression *predicate,
+                               std::vector<const AbstractExpression *> *conjuncts);
+
+  /** @return the AND of conjuncts, nullptr if there are none */
+  const AbstractExpression *MakeConjunction(const std::vector<const AbstractExpression *> &conjuncts);
+
+  /** Append the column references of an expression to columns. */
+  static void CollectColumns(const AbstractExpression *expr, std::vector<const ColumnValueExpression *> *columns);
+
+  /** @return a bit set of the tuple indexes that an expression refers to */
+  static uint32_t ReferencedTuples(const AbstractExpression *expr);
+
+  /** @return true if an expression only combines column values, constants and parameters, so that it can be moved */
+  static bool IsScalar(const AbstractExpression *expr);
+
+  /**
+   * Rewrite the column references of a scalar expression.
+   * @return the rewritten expression, expr itself if nothing changed, nullptr if a reference cannot be rewritten
+   */
+  const AbstractExpression *RewriteColumns(const AbstractExpression *expr, const ColumnRewriter &rewriter);
+
+  /** @return a schema made of the columns col_idxs of schema, computed by exprs instead */
+  const Schema *MakeSchema(const Schema *schema, const std::vector<uint32_t> &col_idxs,
+                           const std::vector<const AbstractExpression *> &exprs);
+
+  /** @return a copy of a column, computed by another expression */
+  static Column CopyColumn(const Column &column, const AbstractExpression *expr);
+
+  /** @return a new column value expression */
+  const AbstractExpression *MakeColumnValue(uint32_t tuple_idx, uint32_t col_idx, TypeId type);
+
+  template <class Plan, class = std::enable_if_t<std::is_base_of_v<AbstractPlanNode, Plan>>>
+  const Plan *Own(std::unique_ptr<Plan> &&plan) {
+    const Plan *raw = plan.get();
+    plans_.emplace_back(std::move(plan));
+    return raw;
+  }
+
+  const AbstractExpression *Own(std::unique_ptr<AbstractExpression> &&expr) {
+    exprs_.emplace_back(std::move(expr));
+    return exprs_.back().get();
+  }
+
+  /** The estimator of the cardinalities of plans, nullptr if joins are not ordered. */
+  std::unique_ptr<CardinalityEstimator> estimator_;
+  std::vector<std::unique_ptr<AbstractPlanNode>> plans_;
+  std::vector<std::unique_ptr<AbstractExpression>> exprs_;
+  std::vector<std::unique_ptr<Schema>> schemas_;
+};
+
+}  // namespace bustub
@@ -12,6 +12,10 @@
 
 #pragma once
 
+#include <mutex>  // NOLINT
+#include <thread>  // NOLINT
+#include <unordered_map>
+
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/transaction_manager.h"
 #include "recovery/log_manager.h"
@@ -19,25 +23,48 @@
 namespace bustub {
 
 /**
- * CheckpointManager creates consistent checkpoints by blocking all other transactions temporarily.
+ * CheckpointManager takes fuzzy checkpoints while transactions keep running.
+ *
+ * BeginCheckpoint() logs a BEGIN_CHECKPOINT record and starts writing out, in the background, every page that may
+ * hold changes older than that record. EndCheckpoint() waits for the writes, logs an END_CHECKPOINT record with the
+ * active transaction table and the dirty page table, and points the master record at the BEGIN_CHECKPOINT record once
+ * the END_CHECKPOINT record is durable. Every page dirty at the start of the checkpoint is written before it ends,
+ * which moves its recLSN up to just after the last change in the written image, so that recovery reads the log from
+ * the last complete checkpoint on, from the smallest recLSN in its dirty page table, and from the BEGIN record of the
+ * transactions it undoes. The log segments older than all three are truncated at the end of the checkpoint.
+ *
+ * One checkpoint runs at a time: it must end before the next one begins.
  */
 class CheckpointManager {
  public:
   CheckpointManager(TransactionManager *transaction_manager, LogManager *log_manager,
-                    BufferPoolManager *buffer_pool_manager)
+                    BufferPoolManager *buffer_pool_manager, DiskManager *disk_manager)
       : transaction_manager_(transaction_manager),
         log_manager_(log_manager),
-        buffer_pool_manager_(buffer_pool_manager) {}
+        buffer_pool_manager_(buffer_pool_manager),
+        disk_manager_(disk_manager) {}
+
+  ~CheckpointManager();
 
-  ~CheckpointManager() = default;
+  /** Begin a checkpoint. @return false if a checkpoint is already running */
+  bool BeginCheckpoint();
 
-  void BeginCheckpoint();
-  void EndCheckpoint();
+  /** End the running checkpoint. @return false if no checkpoint is running */
+  bool EndCheckpoint();
 
  private:
-  TransactionManager *transaction_manager_ __attribute__((__unused__));
-  LogManager *log_manager_ __attribute__((__unused__));
-  BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  TransactionManager *transaction_manager_;
+  LogManager *log_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+  DiskManager *disk_manager_;
+
+  /** Protects the running checkpoint. */
+  std::mutex latch_;
+  /** The LSN and the log file offset of the BEGIN_CHECKPOINT record of the running checkpoint. */
+  lsn_t begin_lsn_{INVALID_LSN};
+  int begin_offset_{0};
+  /** Writes out the dirty pages of the running checkpoint, joinable while a checkpoint is running. */
+  std::thread flush_thread_;
 };
 
 }  // namespace bustub
@@ -16,6 +16,7 @@
 #include <condition_variable>  // NOLINT
 #include <future>              // NOLINT
 #include <mutex>               // NOLINT
+#include <thread>              // NOLINT
 
 #include "recovery/log_record.h"
 #include "storage/disk/disk_manager.h"
@@ -25,16 +26,28 @@ namespace bustub {
 /**
  * LogManager maintains a separate thread that is awakened whenever the log buffer is full or whenever a timeout
  * happens. When the thread is awakened, the log buffer's content is written into the disk log file.
+ *
+ * The log is double buffered: records are appended to one buffer while the flush thread writes the other one to disk,
+ * and the buffers change roles at the start of every flush. Committing transactions wait in Flush() until their
+ * commit record is durable; all commits that reached the buffer before a swap are acknowledged by the same disk write
+ * (group commit).
+ *
+ * Appending does not take latch_. The next LSN, the buffer in use and the offset into it are packed into one atomic
+ * word, and a single compare-and-swap on it reserves both the LSN and the space of a record. Appenders then serialize
+ * their records in parallel and add their sizes to the completion counter of the buffer, which tells the flusher
+ * when every reservation in a sealed buffer has been filled in.
  */
 class LogManager {
  public:
-  explicit LogManager(DiskManager *disk_manager)
-      : next_lsn_(0), persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
+  explicit LogManager(DiskManager *disk_manager) : persistent_lsn_(INVALID_LSN), disk_manager_(disk_manager) {
+    // New records are appended to the log of previous runs.
+    buffer_start_[0] = disk_manager->GetLogSize();
     log_buffer_ = new char[LOG_BUFFER_SIZE];
     flush_buffer_ = new char[LOG_BUFFER_SIZE];
   }
 
   ~LogManager() {
+    StopFlushThread();
     delete[] log_buffer_;
     delete[] flush_buffer_;
     log_buffer_ = nullptr;
@@ -44,31 +57,91 @@ class LogManager {
   void RunFlushThread();
   void StopFlushThread();
 
-  lsn_t AppendLogRecord(LogRecord *log_record);
-
-  inline lsn_t GetNextLSN() { return next_lsn_; }
+  /**
+   * Append a log record to the log buffer, setting its LSN.
+   * @param log_record the record to append
+   * @param[out] offset if not nullptr, the offset that the record will have in the log file
+   * @return the LSN of the record
+   */
+  lsn_t AppendLogRecord(LogRecord *log_record, int *offset = nullptr);
+
+  /**
+   * Block until every log record up to and including lsn is on disk, waking up the flush thread if needed. Flushes
+   * in the calling thread if the flush thread is not running.
+   * @param lsn the log record that must become durable
+   */
+  void Flush(lsn_t lsn);
+
+  /**
+   * Continue the log after the records of a previous run, so that recovery can append compensation log records.
+   * The flush thread must not be running and the log buffer must be empty.
+   * @param lsn the LSN of the next record to append
+   */
+  void SetNextLSN(lsn_t lsn);
+
+  inline lsn_t GetNextLSN() { return LsnOf(reservation_); }
   inline lsn_t GetPersistentLSN() { return persistent_lsn_; }
   inline void SetPersistentLSN(lsn_t lsn) { persistent_lsn_ = lsn; }
-  inline char *GetLogBuffer() { return log_buffer_; }
+  inline char *GetLogBuffer() { return Buffer(BufferOf(reservation_)); }
 
  private:
-  // TODO(students): you may add your own member variables
-
-  /** The atomic counter which records the next log sequence number. */
-  std::atomic<lsn_t> next_lsn_;
+  /** Layout of reservation_: | next LSN (32 bits) | buffer in use (1 bit) | offset into that buffer (31 bits) |. */
+  static constexpr int LSN_SHIFT = 32;
+  static constexpr uint64_t BUFFER_BIT = uint64_t{1} << 31;
+  static constexpr uint64_t OFFSET_MASK = BUFFER_BIT - 1;
+
+  static lsn_t LsnOf(uint64_t reservation) { return static_cast<lsn_t>(reservation >> LSN_SHIFT); }
+  static int BufferOf(uint64_t reservation) { return (reservation & BUFFER_BIT) != 0 ? 1 : 0; }
+  static uint32_t OffsetOf(uint64_t reservation) { return static_cast<uint32_t>(reservation & OFFSET_MASK); }
+
+  /** @return log_buffer_ for buffer 0 and flush_buffer_ for buffer 1 */
+  char *Buffer(int buffer) { return buffer == 0 ? log_buffer_ : flush_buffer_; }
+
+  /** Serialize a log record whose LSN is set into storage. */
+  static void SerializeLogRecord(const LogRecord &log_record, char *storage);
+
+  /** Body of the flush thread. */
+  void FlushLoop();
+
+  /**
+   * Seal the buffer in use, switch appenders to the other buffer and write the sealed one to disk once all its
+   * reservations are filled in. The caller must hold latch_ through guard, which is released while writing. Only one
+   * thread flushes at a time.
+   */
+  void FlushBuffer(std::unique_lock<std::mutex> *guard);
+
+  /** Block until the buffer in use is no longer the one of the given reservation, because it is full. */
+  void WaitForSwap(uint64_t reservation);
+
+  /** The next LSN, the buffer in use and the offset into it, see LSN_SHIFT. */
+  std::atomic<uint64_t> reservation_{0};
+  /** The number of bytes serialized into each buffer since it was last written to disk. */
+  std::atomic<uint32_t> completed_[2] = {{0}, {0}};
+  /** The offset in the log file at which the contents of each buffer go, set before a buffer is put in use. */
+  std::atomic<int> buffer_start_[2] = {{0}, {0}};
   /** The log records before and including the persistent lsn have been written to disk. */
   std::atomic<lsn_t> persistent_lsn_;
 
   char *log_buffer_;
   char *flush_buffer_;
 
+  /** Protects the flush state below, appenders only take it when the buffer is full. */
   std::mutex latch_;
 
-  std::thread *flush_thread_ __attribute__((__unused__));
+  std::thread *flush_thread_{nullptr};
+  /** True while the flush thread should keep running. */
+  bool flush_running_{false};
+  /** True if an appender or a committer asked for a flush before the next timeout. */
+  bool flush_requested_{false};
+  /** True while a thread writes a sealed buffer to disk. */
+  bool flushing_{false};
 
+  /** Wakes up the flush thread. */
   std::condition_variable cv_;
+  /** Wakes up the threads waiting for buffer space or for durability after a swap or a write. */
+  std::condition_variable flushed_cv_;
 
-  DiskManager *disk_manager_ __attribute__((__unused__));
+  DiskManager *disk_manager_;
 };
 
 }  // namespace bustub
@@ -12,8 +12,11 @@
 
 #pragma once
 
+#include <algorithm>
 #include <cassert>
 #include <string>
+#include <unordered_map>
+#include <utility>
 
 #include "common/config.h"
 #include "storage/table/tuple.h"
@@ -32,42 +35,68 @@ enum class LogRecordType {
   ABORT,
   /** Creating a new page in the table heap. */
   NEWPAGE,
+  /** Compensating a record that was undone during recovery. */
+  CLR,
+  /** Starting a checkpoint, recovery scans the log from the last complete one on. */
+  BEGIN_CHECKPOINT,
+  /** Completing a checkpoint, with the transactions and pages that were active when it was taken. */
+  END_CHECKPOINT,
 };
 
 /**
  * For every write operation on the table page, you should write ahead a corresponding log record.
  *
- * For EACH log record, HEADER is like (5 fields in common, 20 bytes in total).
- *---------------------------------------------
- * | size | LSN | transID | prevLSN | LogType |
- *---------------------------------------------
- * For insert type log record
+ * Log records are encoded compactly: the integers marked (v) are varints (see VarintUtil), and the ids and LSNs among
+ * them are stored plus one so that the invalid ones take a single byte. The LSN has a fixed width because the size
+ * of a record must be known before the log manager assigns its LSN.
+ *
+ * For EACH log record, HEADER is like (5 fields in common, at most HEADER_SIZE bytes in total).
  *---------------------------------------------------------------
- * | HEADER | tuple_rid | tuple_size | tuple_data(char[] array) |
+ * | size (v) | LogType (1 byte) | LSN | transID (v) | prevLSN (v) |
  *---------------------------------------------------------------
+ * A tuple_rid is | page_id (v) | slot_num (v) |, and a tuple is | tuple_size (v) | tuple_data (char[] array) |.
+ *
+ * For insert type log record
+ *-------------------------------
+ * | HEADER | tuple_rid | tuple |
+ *-------------------------------
  * For delete type (including markdelete, rollbackdelete, applydelete)
- *----------------------------------------------------------------
- * | HEADER | tuple_rid | tuple_size | tuple_data(char[] array) |
- *---------------------------------------------------------------
- * For update type log record
- *-----------------------------------------------------------------------------------
- * | HEADER | tuple_rid | tuple_size | old_tuple_data | tuple_size | new_tuple_data |
- *-----------------------------------------------------------------------------------
+ *-------------------------------
+ * | HEADER | tuple_rid | tuple |
+ *-------------------------------
+ * For update type log record, only the bytes between the common prefix and the common suffix of the old and the new
+ * tuple are logged. Redo rebuilds the new tuple from the old one on the page, undo the old one from the new one.
+ *---------------------------------------------------------------------------------------------
+ * | HEADER | tuple_rid | prefix_size (v) | suffix_size (v) | old_middle_tuple | new_middle_tuple |
+ *---------------------------------------------------------------------------------------------
  * For new page type log record
- *--------------------------
- * | HEADER | prev_page_id |
- *--------------------------
+ *----------------------------------------
+ * | HEADER | prev_page_id (v) | page_id (v) |
+ *----------------------------------------
+ * For compensation log record, the tuple is the image that undoing the record put back, if any
+ *----------------------------------------------------------------------------
+ * | HEADER | undo_next_lsn (v) | undone_type (1 byte) | tuple_rid | tuple |
+ *----------------------------------------------------------------------------
+ * For end checkpoint type log record, with the last LSN of every active transaction and the recLSN of every dirty page
+ *------------------------------------------------------------------------------------------------------
+ * | HEADER | txn_count (v) | (txn_id (v), last_lsn (v)) ... | page_count (v) | (page_id (v), rec_lsn (v)) ... |
+ *------------------------------------------------------------------------------------------------------
  */
 class LogRecord {
   friend class LogManager;
   friend class LogRecovery;
 
  public:
+  /** The maximum size of the header. */
+  static const int HEADER_SIZE = 20;
+
   LogRecord() = default;
 
   // constructor for Transaction type(BEGIN/COMMIT/ABORT)
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type)
-      : size_(HEADER_SIZE), txn_id_(txn_id), prev_lsn_(prev_lsn), log_record_type_(log_record_type) {}
+      : txn_id_(txn_id), prev_lsn_(prev_lsn), log_record_type_(log_record_type) {
+    ComputeSize();
+  }
 
   // constructor for INSERT/DELETE type
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, const RID &rid, const Tuple &tuple)
@@ -81,8 +110,7 @@ class LogRecord {
       delete_rid_ = rid;
       delete_tuple_ = tuple;
     }
-    // calculate log record size
-    size_ = HEADER_SIZE + sizeof(RID) + sizeof(int32_t) + tuple.GetLength();
+    ComputeSize();
   }
 
   // constructor for UPDATE type
@@ -94,20 +122,49 @@ class LogRecord {
         update_rid_(update_rid),
         old_tuple_(old_tuple),
         new_tuple_(new_tuple) {
-    // calculate log record size
-    size_ = HEADER_SIZE + sizeof(RID) + old_tuple.GetLength() + new_tuple.GetLength() + 2 * sizeof(int32_t);
+    // Find the bytes that the update changed.
+    uint32_t length = std::min(old_tuple.GetLength(), new_tuple.GetLength());
+    while (update_prefix_ < length && old_tuple.GetData()[update_prefix_] == new_tuple.GetData()[update_prefix_]) {
+      update_prefix_++;
+    }
+    while (update_prefix_ + update_suffix_ < length &&
+           old_tuple.GetData()[old_tuple.GetLength() - update_suffix_ - 1] ==
+               new_tuple.GetData()[new_tuple.GetLength() - update_suffix_ - 1]) {
+      update_suffix_++;
+    }
+    ComputeSize();
   }
 
   // constructor for NEWPAGE type
   LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, page_id_t prev_page_id, page_id_t page_id)
-      : size_(HEADER_SIZE),
-        txn_id_(txn_id),
+      : txn_id_(txn_id),
         prev_lsn_(prev_lsn),
         log_record_type_(log_record_type),
         prev_page_id_(prev_page_id),
         page_id_(page_id) {
-    // calculate log record size, header size + sizeof(prev_page_id) + sizeof(page_id)
-    size_ = HEADER_SIZE + sizeof(page_id_t) * 2;
+    ComputeSize();
+  }
+
+  // constructor for CLR type
+  LogRecord(txn_id_t txn_id, lsn_t prev_lsn, LogRecordType log_record_type, lsn_t undo_next_lsn,
+            LogRecordType undone_type, const RID &rid, const Tuple &tuple)
+      : txn_id_(txn_id),
+        prev_lsn_(prev_lsn),
+        log_record_type_(log_record_type),
+        undo_next_lsn_(undo_next_lsn),
+        undone_type_(undone_type),
+        clr_rid_(rid),
+        clr_tuple_(tuple) {
+    assert(log_record_type == LogRecordType::CLR);
+    ComputeSize();
+  }
+
+  // constructor for END_CHECKPOINT type
+  LogRecord(LogRecordType log_record_type, std::unordered_map<txn_id_t, lsn_t> active_txns,
+            std::unordered_map<page_id_t, lsn_t> dirty_pages)
+      : log_record_type_(log_record_type), active_txns_(std::move(active_txns)), dirty_pages_(std::move(dirty_pages)) {
+    assert(log_record_type == LogRecordType::END_CHECKPOINT);
+    ComputeSize();
   }
 
   ~LogRecord() = default;
@@ -120,14 +177,37 @@ class LogRecord {
 
   inline RID &GetInsertRID() { return insert_rid_; }
 
+  // A deserialized update record only holds the changed bytes of the tuples, see GetUpdateImage().
   inline Tuple &GetOriginalTuple() { return old_tuple_; }
 
   inline Tuple &GetUpdateTuple() { return new_tuple_; }
 
+  /**
+   * Rebuild a tuple image of a deserialized update record.
+   * @param base the tuple on the page, the old image to rebuild the new one and the new image to rebuild the old one
+   * @param new_image true to rebuild the tuple after the update, false for the one before it
+   * @return the image
+   */
+  Tuple GetUpdateImage(const Tuple &base, bool new_image) const;
+
   inline RID &GetUpdateRID() { return update_rid_; }
 
   inline page_id_t GetNewPageRecord() { return prev_page_id_; }
 
+  inline page_id_t GetNewPageId() { return page_id_; }
+
+  inline lsn_t GetUndoNextLSN() { return undo_next_lsn_; }
+
+  inline LogRecordType GetUndoneType() { return undone_type_; }
+
+  inline RID &GetCompensationRID() { return clr_rid_; }
+
+  inline Tuple &GetCompensationTuple() { return clr_tuple_; }
+
+  inline std::unordered_map<txn_id_t, lsn_t> &GetActiveTransactions() { return active_txns_; }
+
+  inline std::unordered_map<page_id_t, lsn_t> &GetDirtyPages() { return dirty_pages_; }
+
   inline int32_t GetSize() { return size_; }
 
   inline lsn_t GetLSN() { return lsn_; }
@@ -138,6 +218,22 @@ class LogRecord {
 
   inline LogRecordType &GetLogRecordType() { return log_record_type_; }
 
+  /**
+   * Encode the record, whose LSN must be set, into storage.
+   * @param[out] storage room for GetSize() bytes
+   */
+  void SerializeTo(char *storage) const;
+
+  /**
+   * Decode a record from storage.
+   * @param storage the encoded record, holding at least HEADER_SIZE bytes and PeekSize(storage) bytes
+   * @return false if storage does not hold a valid record, e.g. at the zero filled end of the log
+   */
+  bool DeserializeFrom(const char *storage);
+
+  /** @return the size of the record encoded at storage, which holds at least HEADER_SIZE bytes, 0 if invalid */
+  static int32_t PeekSize(const char *storage);
+
   // For debug purpose
   inline std::string ToString() const {
     std::ostringstream os;
@@ -168,15 +264,35 @@ class LogRecord {
   RID insert_rid_;
   Tuple insert_tuple_;
 
-  // case3: for update operation
+  // case3: for update operation, with the sizes of the common prefix and suffix of the old and the new tuple
   RID update_rid_;
   Tuple old_tuple_;
   Tuple new_tuple_;
+  uint32_t update_prefix_{0};
+  uint32_t update_suffix_{0};
 
   // case4: for new page operation
   page_id_t prev_page_id_{INVALID_PAGE_ID};
   page_id_t page_id_{INVALID_PAGE_ID};
-  static const int HEADER_SIZE = 20;
+
+  // case5: for compensation log record, the next record of the transaction to undo
+  lsn_t undo_next_lsn_{INVALID_LSN};
+  LogRecordType undone_type_{LogRecordType::INVALID};
+  RID clr_rid_;
+  Tuple clr_tuple_;
+
+  // case6: for end checkpoint, the active transaction table and the dirty page table
+  std::unordered_map<txn_id_t, lsn_t> active_txns_;
+  std::unordered_map<page_id_t, lsn_t> dirty_pages_;
+
+  /** Set size_ to the encoded size of the record. */
+  void ComputeSize();
+
+  /** Encode the fields after the header into storage. @return the position after them */
+  char *SerializeBody(char *storage) const;
+
+  /** @return the encoded size of the fields after the header */
+  uint32_t GetBodySize() const;
 };  // namespace bustub
 
 }  // namespace bustub
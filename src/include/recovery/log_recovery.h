@@ -13,22 +13,50 @@
 #pragma once
 
 #include <algorithm>
+#include <functional>
 #include <mutex>  // NOLINT
 #include <unordered_map>
+#include <utility>
+#include <vector>
 
 #include "buffer/buffer_pool_manager.h"
 #include "concurrency/lock_manager.h"
+#include "recovery/log_manager.h"
 #include "recovery/log_record.h"
+#include "storage/page/table_page.h"
 
 namespace bustub {
 
 /**
  * Read log file from disk, redo and undo.
+ *
+ * Recovery follows ARIES. Redo() starts with an analysis pass over the log from the last complete checkpoint on,
+ * which rebuilds the active transaction table (the last LSN of every transaction without a COMMIT or ABORT record)
+ * and the dirty page table (the first LSN that may have dirtied each page, its recLSN). It then repeats history from
+ * the smallest recLSN, applying every record that is newer than the page it modifies. Records on different pages
+ * commute, so redo partitions them by page id over a number of threads, each of which applies the records of its
+ * pages in LSN order.
+ *
+ * Undo() rolls back the transactions left in the active transaction table, newest record first. Every undone record
+ * is compensated by a CLR pointing at the next record to undo, so a crash during undo never undoes a record twice.
+ *
+ * Recovery must run with logging disabled and before new transactions start.
  */
 class LogRecovery {
  public:
-  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager)
-      : disk_manager_(disk_manager), buffer_pool_manager_(buffer_pool_manager), offset_(0) {
+  /**
+   * @param disk_manager the disk manager holding the log
+   * @param buffer_pool_manager the buffer pool to recover the pages in
+   * @param log_manager the log manager to append the CLRs to, nullptr to undo without writing CLRs
+   * @param redo_threads the number of threads redoing pages in parallel
+   */
+  LogRecovery(DiskManager *disk_manager, BufferPoolManager *buffer_pool_manager, LogManager *log_manager = nullptr,
+              size_t redo_threads = 1)
+      : disk_manager_(disk_manager),
+        buffer_pool_manager_(buffer_pool_manager),
+        log_manager_(log_manager),
+        redo_threads_(std::max<size_t>(redo_threads, 1)),
+        offset_(0) {
     log_buffer_ = new char[LOG_BUFFER_SIZE];
   }
 
@@ -42,16 +70,61 @@ class LogRecovery {
   bool DeserializeLogRecord(const char *data, LogRecord *log_record);
 
  private:
-  DiskManager *disk_manager_ __attribute__((__unused__));
-  BufferPoolManager *buffer_pool_manager_ __attribute__((__unused__));
+  /** The number of log records redone together, records are partitioned among the threads batch by batch. */
+  static constexpr size_t REDO_BATCH_SIZE = 4096;
+  static constexpr int INVALID_OFFSET = -LOG_BUFFER_SIZE;
+
+  /** Analysis pass: build active_txn_, dirty_page_table_ and lsn_mapping_ from the log after the last checkpoint. */
+  void Analyze();
+
+  /**
+   * Read the log from the given file offset on, calling visit with every record and its offset.
+   * @return the offset of the end of the log
+   */
+  int ScanLog(int offset, const std::function<void(LogRecord *, int)> &visit);
+
+  /** Read the record with the given LSN from the log. @return false if the log has no such record */
+  bool ReadLogRecord(lsn_t lsn, LogRecord *log_record);
+
+  /** Read the record at the given offset of the log file. @return false if there is no record */
+  bool ReadLogRecordAt(int offset, LogRecord *log_record);
+
+  /**
+   * Append the pages that a record modifies to pages. A NEWPAGE record modifies the new page and, when linking it,
+   * the previous page of the table.
+   */
+  static void GetPages(LogRecord *log_record, std::vector<page_id_t> *pages);
+
+  /** Redo the records of one batch, each partition in its own thread. */
+  void RedoBatch(std::vector<LogRecord> *batch, const std::vector<std::vector<std::pair<page_id_t, size_t>>> &parts);
+
+  /** Redo the part of log_record that modifies the given page, if the page is older than the record. */
+  void RedoPage(page_id_t page_id, LogRecord *log_record);
+
+  /** Apply the compensation for undoing a record of type undone_type on the tuple at rid. */
+  static void ApplyCompensation(TablePage *page, LogRecordType undone_type, const RID &rid, const Tuple &tuple);
+
+  DiskManager *disk_manager_;
+  BufferPoolManager *buffer_pool_manager_;
+  LogManager *log_manager_;
+  size_t redo_threads_;
 
   /** Maintain active transactions and its corresponding latest lsn. */
   std::unordered_map<txn_id_t, lsn_t> active_txn_;
+  /** Maintain the pages that may be dirty and the first lsn that may have dirtied them (recLSN). */
+  std::unordered_map<page_id_t, lsn_t> dirty_page_table_;
   /** Mapping the log sequence number to log file offset for undos. */
   std::unordered_map<lsn_t, int> lsn_mapping_;
+  /** The lsn of the last record in the log. */
+  lsn_t last_lsn_{INVALID_LSN};
 
-  int offset_ __attribute__((__unused__));
+  /** The offset of the log from which lsn_mapping_ is complete, the last checkpoint after the analysis pass. */
+  int start_offset_{0};
+  /** The offset of the end of the log. */
+  int offset_;
   char *log_buffer_;
+  /** The file offset of the log that log_buffer_ holds for ReadLogRecord(), INVALID_OFFSET if none. */
+  int buffer_offset_{INVALID_OFFSET};
 };
 
 }  // namespace bustub
@@ -13,9 +13,13 @@
 #pragma once
 
 #include <atomic>
+#include <deque>
 #include <fstream>
 #include <future>  // NOLINT
+#include <mutex>  // NOLINT
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "common/config.h"
 
@@ -24,9 +28,43 @@ namespace bustub {
 /**
  * DiskManager takes care of the allocation and deallocation of pages within a database. It performs the reading and
  * writing of pages to and from disk, providing a logical file layer within the context of a database management system.
+ *
+ * Every log buffer written by WriteLog() becomes one block of the log file
+ *----------------------------------------------
+ * | raw_size | stored_size | data (stored_size) |
+ *----------------------------------------------
+ * whose data is compressed (see CompressionUtil) if enable_log_compression is set and compression saves space, and
+ * stored as is otherwise. Log offsets and sizes are logical, i.e. they count the bytes before compression.
+ *
+ * The log is split into segment files <db>.log, <db>.log.1, <db>.log.2, ... A new segment is started once the last
+ * one holds log_segment_size bytes, and blocks never span segments. Every segment starts with
+ *--------------------------------------
+ * | logical_offset | first_lsn | blocks |
+ *--------------------------------------
+ * so that the segments still needed for recovery can be found by LSN. TruncateLog() drops the older ones.
+ *
+ * Every page is stored in PAGE_SIZE bytes at an offset aligned to PAGE_SIZE, with a CRC32C in its header that is
+ * checked when the page is read back. The layouts of all pages reserve the 4 bytes after the page id and LSN for it:
+ *-------------------------------------------------------------
+ * | page id (4) | LSN (4) | checksum (4) | rest of the page ... |
+ *-------------------------------------------------------------
+ * The checksum covers the whole page and its page id, which stands in for the checksum itself, so that a page written
+ * to the wrong place fails the check as well. The checksum is cleared when the page is read.
+ *
+ * A page whose write was torn by a crash fails the check. To repair it, every page is first written to a double-write
+ * buffer, a small ring of slots in the file <db>.dwb, and only then in place. A torn in-place write leaves an intact
+ * copy in the double-write buffer, and a torn double-write leaves the old page in place. The double-write buffer is
+ * written and flushed once per page: writes are not batched.
  */
 class DiskManager {
  public:
+  /** The offset of the checksum in the header of every page. */
+  static constexpr int PAGE_CHECKSUM_OFFSET = 8;
+  /** The size of the checksum in the header of every page. */
+  static constexpr int PAGE_CHECKSUM_SIZE = sizeof(uint32_t);
+  /** The number of slots in the double-write buffer. */
+  static constexpr int DOUBLE_WRITE_SLOTS = 32;
+
   /**
    * Creates a new disk manager that writes to the specified database file.
    * @param db_file the file name of the database file to write to
@@ -48,28 +86,70 @@ class DiskManager {
   void WritePage(page_id_t page_id, const char *page_data);
 
   /**
-   * Read a page from the database file.
+   * Read a page from the database file. A page that fails its checksum is repaired from the double-write buffer.
    * @param page_id id of the page
    * @param[out] page_data output buffer
+   * @throws Exception if the page is corrupt and cannot be repaired
    */
   void ReadPage(page_id_t page_id, char *page_data);
 
   /**
-   * Flush the entire log buffer into disk.
+   * Flush the entire log buffer into disk, as one block.
    * @param log_data raw log data
    * @param size size of log entry
+   * @param first_lsn the LSN of the first log record in the buffer, INVALID_LSN if unknown
    */
-  void WriteLog(char *log_data, int size);
+  void WriteLog(char *log_data, int size, lsn_t first_lsn = INVALID_LSN);
 
   /**
    * Read a log entry from the log file.
    * @param[out] log_data output buffer
    * @param size size of the log entry
-   * @param offset offset of the log entry in the file
+   * @param offset logical offset of the log entry
    * @return true if the read was successful, false otherwise
    */
   bool ReadLog(char *log_data, int size, int offset);
 
+  /** @return the logical size of the log in bytes */
+  int GetLogSize();
+
+  /** @return the logical offset of the oldest byte of the log that was not truncated */
+  int GetLogStart();
+
+  /**
+   * Drop the log segments that only hold records older than lsn. Their files are moved to the archive directory if
+   * one is set and deleted otherwise. The last segment is always kept.
+   * @param lsn the oldest log record that must be kept
+   */
+  void TruncateLog(lsn_t lsn);
+
+  /** @param archive_dir the directory that truncated log segments are moved to, empty to delete them */
+  void SetLogArchiveDirectory(const std::string &archive_dir);
+
+  /** @return the number of log segment files */
+  size_t GetNumLogSegments();
+
+  /** @return the size of the log segment files in bytes */
+  int64_t GetLogDiskUsage();
+
+  /** @return the number of bytes written to the log file, including block headers */
+  uint64_t GetLogBytesWritten() const { return log_bytes_written_; }
+
+  /**
+   * Write the master record, which points recovery to the last complete checkpoint.
+   * @param lsn the LSN of the BEGIN_CHECKPOINT record of the checkpoint
+   * @param offset the offset of that record in the log file
+   */
+  void WriteMasterRecord(lsn_t lsn, int offset);
+
+  /**
+   * Read the master record.
+   * @param[out] lsn the LSN of the BEGIN_CHECKPOINT record of the last complete checkpoint
+   * @param[out] offset the offset of that record in the log file
+   * @return false if no checkpoint was taken
+   */
+  bool ReadMasterRecord(lsn_t *lsn, int *offset);
+
   /**
    * Allocate a page on disk.
    * @return the id of the allocated page
@@ -91,6 +171,12 @@ class DiskManager {
   /** @return the number of disk writes */
   int GetNumWrites() const;
 
+  /** @return the number of pages read that failed their checksum */
+  uint64_t GetNumChecksumFailures() const { return num_checksum_failures_; }
+
+  /** @return the number of pages repaired from the double-write buffer */
+  uint64_t GetNumRepairedPages() const { return num_repaired_pages_; }
+
   /**
    * Sets the future which is used to check for non-blocking flushes.
    * @param f the non-blocking flush check
@@ -101,18 +187,108 @@ class DiskManager {
   inline bool HasFlushLogFuture() { return flush_log_f_ != nullptr; }
 
  private:
+  /** A log segment file. */
+  struct LogSegment {
+    /** The number in the name of the segment file. */
+    int index_;
+    /** The logical offset of the first byte of the segment. */
+    int logical_offset_;
+    /** The LSN of the first record in the segment, INVALID_LSN if unknown. */
+    lsn_t first_lsn_;
+    /** The size of the segment file. */
+    int64_t file_size_;
+  };
+
+  /** A block of the log. */
+  struct LogBlock {
+    /** The logical offset of the first byte of the block. */
+    int logical_offset_;
+    /** The index of the segment holding the block. */
+    int segment_;
+    /** The offset of the block data in the segment file. */
+    int64_t physical_offset_;
+    int raw_size_;
+    int stored_size_;
+  };
+
   int GetFileSize(const std::string &file_name);
+
+  /** @return the checksum of a page, whatever its checksum field holds */
+  static uint32_t PageChecksum(page_id_t page_id, const char *page_data);
+
+  /** @return true if the checksum of a page as stored on disk matches, or the page was never written */
+  static bool VerifyPage(page_id_t page_id, const char *page_data);
+
+  /** Open or create the double-write buffer and find the slot to write next. */
+  void OpenDoubleWriteBuffer();
+
+  /** Write a page to the next slot of the double-write buffer and flush it. @return false on an I/O error */
+  bool WriteDoubleWrite(page_id_t page_id, const char *page_data);
+
+  /** Find the latest intact copy of a page in the double-write buffer. @return false if there is none */
+  bool ReadDoubleWrite(page_id_t page_id, char *page_data);
+
+  /** @return the file name of a log segment */
+  std::string GetSegmentName(int index) const;
+
+  /** Build the segment and block index of the existing log segment files. */
+  void LoadLogSegments();
+
+  /** Read the blocks of a segment file into the block index. @return false if the segment ends in a torn block */
+  bool LoadLogBlocks(std::ifstream *segment_io, const LogSegment &segment);
+
+  /** Read the data of a block into block_cache_, decompressing it. @return false on an I/O error or corrupt data */
+  bool LoadLogBlock(size_t block);
+
   // stream to write log file
   std::fstream log_io_;
   std::string log_name_;
+  // file holding the master record
+  std::string master_name_;
   // stream to write db file
   std::fstream db_io_;
   std::string file_name_;
+  /** Protects db_io_ and the double-write buffer. */
+  std::mutex db_latch_;
+  /** The double-write buffer file. */
+  std::fstream dwb_io_;
+  std::string dwb_name_;
+  /** The page id and sequence number of every slot of the double-write buffer, as in its header block. */
+  std::vector<std::pair<page_id_t, uint32_t>> dwb_slots_;
+  /** The sequence number of the latest double-write, which tells the newest copy of a page apart. */
+  uint32_t dwb_sequence_{0};
+  int dwb_next_slot_{0};
+  std::atomic<uint64_t> num_checksum_failures_{0};
+  std::atomic<uint64_t> num_repaired_pages_{0};
   std::atomic<page_id_t> next_page_id_;
   int num_flushes_;
   int num_writes_;
   bool flush_log_;
   std::future<void> *flush_log_f_;
+
+  /** Protects the log files and the indexes. */
+  std::mutex log_latch_;
+  /** The log segments, oldest first. */
+  std::deque<LogSegment> log_segments_;
+  /** The blocks of the log segments, in the order of their offsets. */
+  std::deque<LogBlock> log_blocks_;
+  /** The logical size of the log. */
+  int log_size_{0};
+  /** True if the last segment ends in a torn block, so that new blocks go to a new segment. */
+  bool log_tail_torn_{false};
+  /** The segment open in log_io_ and in read_io_, -1 if none. */
+  int write_segment_{-1};
+  int read_segment_{-1};
+  /** Stream to read log segment files. */
+  std::ifstream read_io_;
+  /** The directory that truncated segments are moved to, empty to delete them. */
+  std::string archive_dir_;
+  /** The decompressed data of the block cached_block_, read last. */
+  std::vector<char> block_cache_;
+  int cached_block_{-1};
+  /** Scratch space for compressing and reading blocks. */
+  std::vector<char> scratch_;
+  std::atomic<uint64_t> log_bytes_written_{0};
 };
 
 }  // namespace bustub
@@ -26,9 +26,9 @@ namespace bustub {
  * non-unique keys.
  *
  * Block page format (keys are stored in order):
- *  ----------------------------------------------------------------
- * | KEY(1) + VALUE(1) | KEY(2) + VALUE(2) | ... | KEY(n) + VALUE(n)
- *  ----------------------------------------------------------------
+ *  ------------------------------------------------------------------------------------------------
+ * | HEADER (12) | OCCUPIED | READABLE | KEY(1) + VALUE(1) | KEY(2) + VALUE(2) | ... | KEY(n) + VALUE(n)
+ *  ------------------------------------------------------------------------------------------------
  *
  *  Here '+' means concatenation.
  *
@@ -94,6 +94,8 @@ class HashTableBlockPage {
   bool IsReadable(slot_offset_t bucket_ind) const;
 
  private:
+  // the page id, LSN and checksum that every page starts with
+  __attribute__((unused)) char header_[BLOCK_PAGE_HEADER_SIZE];
   std::atomic_char occupied_[(BLOCK_ARRAY_SIZE - 1) / 8 + 1];
 
   // 0 if tombstone/brand new (never occupied), 1 otherwise.
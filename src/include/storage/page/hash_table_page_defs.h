@@ -18,7 +18,9 @@
  * calculation based on the size of MappingType (which is a std::pair of KeyType and ValueType). For each key/value
  * pair, we need two additional bits for occupied_ and readable_. 4 * PAGE_SIZE / (4 * sizeof (MappingType) + 1) =
  * PAGE_SIZE/(sizeof (MappingType) + 0.25) because 0.25 bytes = 2 bits is the space required to maintain the occupied
- * and readable flags for a key value pair.*/
-#define BLOCK_ARRAY_SIZE (4 * PAGE_SIZE / (4 * sizeof(MappingType) + 1))
+ * and readable flags for a key value pair. The first BLOCK_PAGE_HEADER_SIZE bytes of the page are reserved for the
+ * page id, LSN and checksum that every page starts with.*/
+#define BLOCK_PAGE_HEADER_SIZE 12
+#define BLOCK_ARRAY_SIZE (4 * (PAGE_SIZE - BLOCK_PAGE_HEADER_SIZE) / (4 * sizeof(MappingType) + 1))
 
 #define HASH_TABLE_BLOCK_TYPE HashTableBlockPage<KeyType, ValueType, KeyComparator>
@@ -22,9 +22,9 @@ namespace bustub {
  * 32 bytes) and their corresponding root_id
  *
  * Format (size in byte):
- *  -----------------------------------------------------------------
- * | RecordCount (4) | Entry_1 name (32) | Entry_1 root_id (4) | ... |
- *  -----------------------------------------------------------------
+ *  ------------------------------------------------------------------------------------------------
+ * | RecordCount (4) | LSN (4) | Checksum (4) | Entry_1 name (32) | Entry_1 root_id (4) | ... |
+ *  ------------------------------------------------------------------------------------------------
  */
 class HeaderPage : public Page {
  public:
@@ -47,5 +47,12 @@ class HeaderPage : public Page {
   int FindRecord(const std::string &name);
 
   void SetRecordCount(int record_count);
+
+  /** @return the offset of a record */
+  static int RecordOffset(int index) { return SIZE_HEADER_PAGE_HEADER + index * SIZE_RECORD; }
+
+  static constexpr int SIZE_HEADER_PAGE_HEADER = 12;
+  static constexpr int SIZE_RECORD_NAME = 32;
+  static constexpr int SIZE_RECORD = SIZE_RECORD_NAME + sizeof(page_id_t);
 };
 }  // namespace bustub
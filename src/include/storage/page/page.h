@@ -70,9 +70,11 @@ class Page {
   static_assert(sizeof(page_id_t) == 4);
   static_assert(sizeof(lsn_t) == 4);
 
-  static constexpr size_t SIZE_PAGE_HEADER = 8;
+  /** Every page starts with its page id, its LSN and the checksum that DiskManager stores in it. */
+  static constexpr size_t SIZE_PAGE_HEADER = 12;
   static constexpr size_t OFFSET_PAGE_START = 0;
   static constexpr size_t OFFSET_LSN = 4;
+  static constexpr size_t OFFSET_CHECKSUM = 8;
 
  private:
   /** Zeroes out the data that is held within the page. */
@@ -86,6 +88,8 @@ class Page {
   int pin_count_ = 0;
   /** True if the page is dirty, i.e. it is different from its corresponding page on disk. */
   bool is_dirty_ = false;
+  /** The recLSN of the page, no change to the page that is not on disk yet has a smaller LSN. */
+  lsn_t rec_lsn_ = INVALID_LSN;
   /** Page latch. */
   ReaderWriterLatch rwlatch_;
 };
@@ -33,12 +33,12 @@ namespace bustub {
  *                                free space pointer
  *
  *  Header format (size in bytes):
- *  ----------------------------------------------------------------------------
- *  | PageId (4)| LSN (4)| PrevPageId (4)| NextPageId (4)| FreeSpacePointer(4) |
- *  ----------------------------------------------------------------------------
- *  ----------------------------------------------------------------
- *  | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
- *  ----------------------------------------------------------------
+ *  -----------------------------------------------------------------------------
+ *  | PageId (4)| LSN (4)| Checksum (4)| PrevPageId (4)| NextPageId (4)|
+ *  -----------------------------------------------------------------------------
+ *  ---------------------------------------------------------------------------------------
+ *  | FreeSpacePointer(4) | TupleCount (4) | Tuple_1 offset (4) | Tuple_1 size (4) | ... |
+ *  ---------------------------------------------------------------------------------------
  *
  */
 class TablePage : public Page {
@@ -78,20 +78,24 @@ class TablePage : public Page {
    * @param[out] rid rid of the inserted tuple
    * @param txn transaction performing the insert
    * @param lock_manager the lock manager
+   * @param oid the table that the page belongs to, whose rows the lock manager locks
    * @param log_manager the log manager
    * @return true if the insert is successful (i.e. there is enough space)
    */
-  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
+  bool InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn, LockManager *lock_manager, table_oid_t oid,
+                   LogManager *log_manager);
 
   /**
    * Mark a tuple as deleted. This does not actually delete the tuple.
    * @param rid rid of the tuple to mark as deleted
    * @param txn transaction performing the delete
    * @param lock_manager the lock manager
+   * @param oid the table that the page belongs to
    * @param log_manager the log manager
    * @return true if marking the tuple as deleted is successful (i.e the tuple exists)
    */
-  bool MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_manager, LogManager *log_manager);
+  bool MarkDelete(const RID &rid, Transaction *txn, LockManager *lock_manager, table_oid_t oid,
+                  LogManager *log_manager);
 
   /**
    * Update a tuple.
@@ -100,27 +104,39 @@ class TablePage : public Page {
    * @param rid rid of the tuple
    * @param txn transaction performing the update
    * @param lock_manager the lock manager
+   * @param oid the table that the page belongs to
    * @param log_manager the log manager
    * @return true if updating the tuple succeeded
    */
   bool UpdateTuple(const Tuple &new_tuple, Tuple *old_tuple, const RID &rid, Transaction *txn,
-                   LockManager *lock_manager, LogManager *log_manager);
+                   LockManager *lock_manager, table_oid_t oid, LogManager *log_manager);
 
   /** To be called on commit or abort. Actually perform the delete or rollback an insert. */
-  void ApplyDelete(const RID &rid, Transaction *txn, LogManager *log_manager);
+  void ApplyDelete(const RID &rid, Transaction *txn, table_oid_t oid, LogManager *log_manager);
 
   /** To be called on abort. Rollback a delete, i.e. this reverses a MarkDelete. */
-  void RollbackDelete(const RID &rid, Transaction *txn, LogManager *log_manager);
+  void RollbackDelete(const RID &rid, Transaction *txn, table_oid_t oid, LogManager *log_manager);
+
+  /**
+   * Put a tuple into the given slot without logging, used by recovery to redo an insert or to undo an ApplyDelete.
+   * @param tuple tuple to put back
+   * @param rid rid the tuple had, its slot must be empty or the next unused slot of this page
+   */
+  void InsertTupleAt(const Tuple &tuple, const RID &rid);
 
   /**
    * Read a tuple from a table.
    * @param rid rid of the tuple to read
    * @param[out] tuple the tuple that was read
    * @param txn transaction performing the read
-   * @param lock_manager the lock manager
+   * @param lock_manager the lock manager, nullptr to read without taking a lock or aborting on a missing tuple
+   * @param oid the table that the page belongs to
    * @return true if the read is successful (i.e. the tuple exists)
    */
-  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager);
+  bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn, LockManager *lock_manager, table_oid_t oid);
+
+  /** @return the number of slots in this page, including the slots of deleted tuples */
+  uint32_t GetSlotCount() { return GetTupleCount(); }
 
   /** @return the rid of the first tuple in this page */
 
@@ -140,14 +156,14 @@ class TablePage : public Page {
  private:
   static_assert(sizeof(page_id_t) == 4);
 
-  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 24;
+  static constexpr size_t SIZE_TABLE_PAGE_HEADER = 28;
   static constexpr size_t SIZE_TUPLE = 8;
-  static constexpr size_t OFFSET_PREV_PAGE_ID = 8;
-  static constexpr size_t OFFSET_NEXT_PAGE_ID = 12;
-  static constexpr size_t OFFSET_FREE_SPACE = 16;
-  static constexpr size_t OFFSET_TUPLE_COUNT = 20;
-  static constexpr size_t OFFSET_TUPLE_OFFSET = 24;  // Naming things is hard.
-  static constexpr size_t OFFSET_TUPLE_SIZE = 28;
+  static constexpr size_t OFFSET_PREV_PAGE_ID = 12;
+  static constexpr size_t OFFSET_NEXT_PAGE_ID = 16;
+  static constexpr size_t OFFSET_FREE_SPACE = 20;
+  static constexpr size_t OFFSET_TUPLE_COUNT = 24;
+  static constexpr size_t OFFSET_TUPLE_OFFSET = 28;  // Naming things is hard.
+  static constexpr size_t OFFSET_TUPLE_SIZE = 32;
 
   /** @return pointer to the end of the current free space, see header comment */
   uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
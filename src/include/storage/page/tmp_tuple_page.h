@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstring>
+
 #include "storage/page/page.h"
 #include "storage/table/tmp_tuple.h"
 #include "storage/table/tuple.h"
@@ -14,20 +16,72 @@ namespace bustub {
  * TmpTuplePage format:
  *
  * Sizes are in bytes.
- * | PageId (4) | LSN (4) | FreeSpace (4) | (free space) | TupleSize2 | TupleData2 | TupleSize1 | TupleData1 |
+ * | PageId (4) | LSN (4) | Checksum (4) | FreeSpace (4) | (free space) | TupleSize2 | TupleData2 | TupleSize1 |
+ * | TupleData1 |
  *
  * We choose this format because DeserializeExpression expects to read Size followed by Data.
  */
 class TmpTuplePage : public Page {
  public:
-  void Init(page_id_t page_id, uint32_t page_size) {}
+  void Init(page_id_t page_id, uint32_t page_size) {
+    memcpy(GetData(), &page_id, sizeof(page_id_t));
+    SetLSN(INVALID_LSN);
+    SetFreeSpacePointer(page_size);
+  }
+
+  page_id_t GetTablePageId() { return *reinterpret_cast<page_id_t *>(GetData()); }
+
+  /** @return the offset of the most recently inserted tuple, or the page size if the page is empty */
+  uint32_t GetFreeSpacePointer() { return *reinterpret_cast<uint32_t *>(GetData() + OFFSET_FREE_SPACE); }
 
-  page_id_t GetTablePageId() { return INVALID_PAGE_ID; }
+  /** @return the number of bytes left for tuples and their sizes */
+  uint32_t GetFreeSpaceRemaining() { return GetFreeSpacePointer() - SIZE_TMP_PAGE_HEADER; }
 
-  bool Insert(const Tuple &tuple, TmpTuple *out) { return false; }
+  /**
+   * Insert a tuple.
+   * @param tuple the tuple to insert
+   * @param[out] out where the tuple was inserted
+   * @return false if the page does not have room for the tuple
+   */
+  bool Insert(const Tuple &tuple, TmpTuple *out) {
+    uint32_t size = sizeof(uint32_t) + tuple.GetLength();
+    if (GetFreeSpaceRemaining() < size) {
+      return false;
+    }
+    uint32_t offset = GetFreeSpacePointer() - size;
+    tuple.SerializeTo(GetData() + offset);
+    SetFreeSpacePointer(offset);
+    *out = TmpTuple(GetTablePageId(), offset);
+    return true;
+  }
+
+  /**
+   * Read the tuple at an offset. Walking the offsets from the free space pointer to the page size visits the tuples
+   * from the most recently inserted one to the first one.
+   * @param offset the offset of the tuple
+   * @param[out] tuple the tuple
+   * @return the offset of the tuple inserted before it
+   */
+  uint32_t Get(uint32_t offset, Tuple *tuple) {
+    tuple->DeserializeFrom(GetData() + offset);
+    return offset + sizeof(uint32_t) + tuple->GetLength();
+  }
+
+  /** @return the offset of the tuple inserted before the one at offset, without reading the tuple */
+  uint32_t NextOffset(uint32_t offset) {
+    uint32_t size;
+    memcpy(&size, GetData() + offset, sizeof(uint32_t));
+    return offset + sizeof(uint32_t) + size;
+  }
 
  private:
+  void SetFreeSpacePointer(uint32_t free_space_pointer) {
+    memcpy(GetData() + OFFSET_FREE_SPACE, &free_space_pointer, sizeof(uint32_t));
+  }
+
   static_assert(sizeof(page_id_t) == 4);
+  static constexpr size_t OFFSET_FREE_SPACE = 12;
+  static constexpr size_t SIZE_TMP_PAGE_HEADER = 16;
 };
 
 }  // namespace bustub
@@ -12,17 +12,31 @@
 
 #pragma once
 
+#include <memory>
+#include <vector>
+
 #include "buffer/buffer_pool_manager.h"
+#include "concurrency/version_store.h"
 #include "recovery/log_manager.h"
 #include "storage/page/table_page.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
+#include "storage/table/zone_map.h"
 
 namespace bustub {
 
 /**
  * TableHeap represents a physical table on disk.
  * This is just a doubly-linked list of pages.
+ *
+ * While logging is enabled, the rows that transactions read and write are locked through LockManager::LockRow() under
+ * the oid of the table, so that table locks conflict with them.
+ *
+ * When snapshot isolation is enabled, every write saves the previous version of the tuple in the version store of the
+ * heap. Transactions running under snapshot isolation read the version visible to their snapshot from there without
+ * taking shared locks.
+ *
+ * A heap may keep a ZoneMap of some of its columns, which its writes maintain and which scans use to skip pages.
  */
 class TableHeap {
   friend class TableIterator;
@@ -36,9 +50,10 @@ class TableHeap {
    * @param lock_manager the lock manager
    * @param log_manager the log manager
    * @param first_page_id the id of the first page
+   * @param oid the oid of the table, under which the rows of the heap are locked
    */
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-            page_id_t first_page_id);
+            page_id_t first_page_id, table_oid_t oid = 0);
 
   /**
    * Create a table heap with a transaction. (create table)
@@ -46,9 +61,10 @@ class TableHeap {
    * @param lock_manager the lock manager
    * @param log_manager the log manager
    * @param txn the creating transaction
+   * @param oid the oid of the table, under which the rows of the heap are locked
    */
   TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-            Transaction *txn);
+            Transaction *txn, table_oid_t oid = 0);
 
   /**
    * Insert a tuple into the table. If the tuple is too large (>= page_size), return false.
@@ -91,7 +107,7 @@ class TableHeap {
   void RollbackDelete(const RID &rid, Transaction *txn);
 
   /**
-   * Read a tuple from the table.
+   * Read a tuple from the table. Under snapshot isolation, this reads the version visible to the snapshot of txn.
    * @param rid rid of the tuple to read
    * @param tuple output variable for the tuple
    * @param txn transaction performing the read
@@ -99,6 +115,28 @@ class TableHeap {
    */
   bool GetTuple(const RID &rid, Tuple *tuple, Transaction *txn);
 
+  /**
+   * Read all the tuples of a page of the table that txn can see, as a table iterator would. Scans that split the table
+   * among threads read it a page at a time this way.
+   * @param page a pinned page of the table
+   * @param txn transaction performing the read
+   * @param[out] tuples the tuples are appended to it
+   */
+  void ReadPage(TablePage *page, Transaction *txn, std::vector<Tuple> *tuples);
+
+  /**
+   * Start keeping the bounds of some columns of the tuples of each page, built from the pages of the table. It must
+   * not run concurrently with writes to the table.
+   * @param schema the schema of the table, which must outlive the heap
+   * @param col_idxs the columns to keep the bounds of
+   * @param txn the transaction building the zone map
+   * @return the zone map, which replaces any previous one
+   */
+  ZoneMap *CreateZoneMap(const Schema *schema, std::vector<uint32_t> col_idxs, Transaction *txn);
+
+  /** @return the zone map of this table, nullptr if it has none */
+  inline ZoneMap *GetZoneMap() { return zone_map_.get(); }
+
   /** @return the begin iterator of this table */
   TableIterator Begin(Transaction *txn);
 
@@ -108,11 +146,44 @@ class TableHeap {
   /** @return the id of the first page of this table */
   inline page_id_t GetFirstPageId() const { return first_page_id_; }
 
+  /** @return the store of the old tuple versions of this table */
+  inline VersionStore *GetVersionStore() { return &version_store_; }
+
  private:
+  /** Read the version of a tuple visible to the snapshot of txn. The page must be latched. */
+  bool GetVisibleTuple(TablePage *page, const RID &rid, Tuple *tuple, Transaction *txn);
+
+  /**
+   * Move a snapshot isolation iterator to the first tuple at or after rid that is visible to the snapshot of txn.
+   * Unlike the locking scan, this also visits deleted slots because their old versions may still be visible.
+   * @param rid the first slot to look at
+   * @param[out] tuple the visible tuple, with an invalid rid if there is none
+   */
+  void SeekVisibleTuple(RID rid, Tuple *tuple, Transaction *txn);
+
+  /**
+   * Rebuild the zone of a page from its tuples in place, if its zone is loose and no old version of any tuple of the
+   * table is kept, which would have to stay in the zone. The page must be latched.
+   * @return true if the zone was rebuilt
+   */
+  bool RebuildZone(TablePage *page, Transaction *txn);
+
+  /**
+   * Take the intention lock on the table that locking its rows in a mode needs, before any page of the table is
+   * latched. Otherwise a transaction waiting for the table lock with a page latched would block the holder of the
+   * table lock on the latch.
+   * @param lock_mode INTENTION_SHARED to read rows, INTENTION_EXCLUSIVE to write them
+   * @return false if the transaction was aborted instead
+   */
+  bool LockTableIntention(Transaction *txn, LockMode lock_mode);
+
   BufferPoolManager *buffer_pool_manager_;
   LockManager *lock_manager_;
   LogManager *log_manager_;
   page_id_t first_page_id_{};
+  table_oid_t oid_;
+  VersionStore version_store_;
+  std::unique_ptr<ZoneMap> zone_map_;
 };
 
 }  // namespace bustub
@@ -0,0 +1,83 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tmp_tuple_list.h
+//
+// Identification: src/include/storage/table/tmp_tuple_list.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "common/macros.h"
+#include "storage/page/tmp_tuple_page.h"
+#include "storage/table/tuple.h"
+
+namespace bustub {
+
+/**
+ * TmpTupleList is an append-only list of tuples on TmpTuplePages, used by operators to spill intermediate results
+ * that do not fit in memory. Only the page being appended to or read is pinned; the buffer pool writes the others out
+ * as it needs the frames. The pages are deleted with the list.
+ *
+ * Tuples are appended first and then read back with Rewind() and Next(), in the order they were appended.
+ */
+class TmpTupleList {
+ public:
+  explicit TmpTupleList(BufferPoolManager *bpm) : bpm_(bpm) {}
+
+  ~TmpTupleList() { Clear(); }
+
+  DISALLOW_COPY_AND_MOVE(TmpTupleList);
+
+  /**
+   * Append a tuple to the list.
+   * @throws Exception if no frame of the buffer pool is free for a new page
+   */
+  void Append(const Tuple &tuple);
+
+  /** Unpin the page being appended to and start reading from the first tuple. */
+  void Rewind();
+
+  /**
+   * Read the next tuple.
+   * @param[out] tuple the next tuple
+   * @return false if all the tuples have been read
+   */
+  bool Next(Tuple *tuple);
+
+  /** Drop all the tuples and delete the pages. */
+  void Clear();
+
+  /** @return the number of tuples */
+  size_t Size() const { return size_; }
+
+  /** @return the number of bytes of tuple data */
+  size_t GetDataSize() const { return data_size_; }
+
+  /** @return the number of pages */
+  size_t GetNumPages() const { return page_ids_.size(); }
+
+ private:
+  /** Unpin the page being appended to or read, if any. */
+  void UnpinCurrent();
+
+  BufferPoolManager *bpm_;
+  std::vector<page_id_t> page_ids_;
+  size_t size_{0};
+  size_t data_size_{0};
+  /** The pinned page being appended to or read, and whether it is being appended to. */
+  TmpTuplePage *current_{nullptr};
+  bool appending_{false};
+  /** The index of the page being read, and the offsets of the tuples on it that are left, the next one last. */
+  size_t read_page_{0};
+  std::vector<uint32_t> read_offsets_;
+};
+
+}  // namespace bustub
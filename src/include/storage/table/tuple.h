@@ -34,6 +34,8 @@ class Tuple {
 
   friend class TableIterator;
 
+  friend class LogRecord;
+
  public:
   // Default constructor (to create a dummy tuple)
   Tuple() = default;
@@ -50,6 +52,12 @@ class Tuple {
   // assign operator, deep copy
   Tuple &operator=(const Tuple &other);
 
+  // move constructor, takes over the data of other
+  Tuple(Tuple &&other) noexcept;
+
+  // move assign operator, takes over the data of other
+  Tuple &operator=(Tuple &&other) noexcept;
+
   ~Tuple() {
     if (allocated_) {
       delete[] data_;
@@ -0,0 +1,133 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// zone_map.h
+//
+// Identification: src/include/storage/table/zone_map.h
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#pragma once
+
+#include <cstddef>
+#include <mutex>  // NOLINT
+#include <unordered_map>
+#include <vector>
+
+#include "catalog/schema.h"
+#include "common/config.h"
+#include "common/macros.h"
+#include "execution/expressions/comparison_expression.h"
+#include "storage/table/tuple.h"
+#include "type/value.h"
+
+namespace bustub {
+
+/** ZoneBound is a comparison of a column of a table with a constant, which the rows a scan looks for satisfy. */
+struct ZoneBound {
+  /** The index of the column in the table schema. */
+  uint32_t col_idx_;
+  /** The comparison, with the column on the left. */
+  ComparisonType type_;
+  Value value_;
+};
+
+/**
+ * ZoneMap keeps, for every page of a TableHeap, the smallest and the largest non-NULL value of some columns of the
+ * tuples on it, so that a scan looking for rows in a range skips the pages whose zone does not overlap it without
+ * fetching them. The zones are in the order of the page list, a scan walks them instead of the pages.
+ *
+ * A zone covers every version of the tuples of its page that a snapshot may still read: writes only widen it. When a
+ * tuple leaves a page, by a delete or an update, the zone is marked loose, and the next scan that reads the page
+ * rebuilds it from the tuples in place, once the version store holds no old version that it would drop.
+ *
+ * Only inlined columns other than VARCHAR can be mapped, for their comparisons to be the ones of the executors.
+ */
+class ZoneMap {
+ public:
+  /**
+   * Create an empty zone map.
+   * @param schema the schema of the table, which must outlive the zone map
+   * @param col_idxs the columns to keep the bounds of
+   */
+  ZoneMap(const Schema *schema, std::vector<uint32_t> col_idxs);
+
+  DISALLOW_COPY_AND_MOVE(ZoneMap);
+
+  /** @return the columns whose bounds are kept */
+  const std::vector<uint32_t> &GetColumns() const { return col_idxs_; }
+
+  /**
+   * Collect the bounds that a predicate puts on the mapped columns.
+   * @param predicate a predicate on the tuples of the table, nullptr for none
+   * @return the comparisons of mapped columns with constants, or with the current values of parameters, that are
+   * conjuncts of the predicate
+   */
+  std::vector<ZoneBound> GetBounds(const AbstractExpression *predicate) const;
+
+  /**
+   * Widen the zone of a page to a tuple written to it, appending a zone for a page the map does not have yet. The
+   * page must be write latched, so that the zones of new pages are appended in the order of the page list.
+   */
+  void Widen(page_id_t page_id, const Tuple &tuple);
+
+  /** Mark the zone of a page as loose, because a tuple left the page. The page must be write latched. */
+  void Loosen(page_id_t page_id);
+
+  /** @return true if the map has a zone for a page and it may be wider than the tuples of the page */
+  bool IsLoose(page_id_t page_id);
+
+  /**
+   * Reset the zone of a page to the bounds of its tuples, appending it if the map does not have the page.
+   * @param page_id the page
+   * @param tuples every version of the tuples of the page that may still be read
+   */
+  void Rebuild(page_id_t page_id, const std::vector<Tuple> &tuples);
+
+  /** Append a zone for a page whose versions are not all known; it never skips the page until it is rebuilt. */
+  void AddUnbounded(page_id_t page_id);
+
+  /**
+   * Find the next page a scan with some bounds must read.
+   * @param[in,out] zone the index of the first zone to look at, moved past the zone of the page found
+   * @param bounds the bounds, from GetBounds()
+   * @param[out] num_skipped incremented for each page skipped
+   * @return the page, INVALID_PAGE_ID past the last zone
+   */
+  page_id_t NextPage(size_t *zone, const std::vector<ZoneBound> &bounds, size_t *num_skipped);
+
+  /** @return the number of zones, which is the number of pages of the table */
+  size_t GetNumZones();
+
+ private:
+  /** The bounds of the tuples of one page. */
+  struct Zone {
+    page_id_t page_id_;
+    /** False if the bounds are unknown, in which case the page is never skipped. */
+    bool bounded_{true};
+    bool loose_{false};
+    /** The bounds of each mapped column, NULL when the column holds no non-NULL value. */
+    std::vector<Value> min_;
+    std::vector<Value> max_;
+  };
+
+  /** @return the zone of a page, appended if the map does not have it. The latch must be held. */
+  Zone *GetZone(page_id_t page_id);
+
+  /** Widen a zone to a tuple. The latch must be held. */
+  void WidenZone(Zone *zone, const Tuple &tuple);
+
+  /** @return false if no row of a zone satisfies a bound */
+  bool MayMatch(const Zone &zone, size_t column, const ZoneBound &bound) const;
+
+  const Schema *schema_;
+  std::vector<uint32_t> col_idxs_;
+  std::mutex latch_;
+  std::vector<Zone> zones_;
+  std::unordered_map<page_id_t, size_t> zone_of_page_;
+};
+
+}  // namespace bustub
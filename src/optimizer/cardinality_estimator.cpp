@@ -0,0 +1,278 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// cardinality_estimator.cpp
+//
+// Identification: src/optimizer/cardinality_estimator.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "optimizer/cardinality_estimator.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/hash_join_plan.h"
+#include "execution/plans/limit_plan.h"
+#include "execution/plans/merge_join_plan.h"
+#include "execution/plans/nested_loop_join_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "execution/plans/topn_plan.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return the comparison with its operands swapped, such that (a comparison b) == (b Flip(comparison) a) */
+ComparisonType Flip(ComparisonType comparison) {
+  switch (comparison) {
+    case ComparisonType::LessThan:
+      return ComparisonType::GreaterThan;
+    case ComparisonType::LessThanOrEqual:
+      return ComparisonType::GreaterThanOrEqual;
+    case ComparisonType::GreaterThan:
+      return ComparisonType::LessThan;
+    case ComparisonType::GreaterThanOrEqual:
+      return ComparisonType::LessThanOrEqual;
+    default:
+      return comparison;
+  }
+}
+
+/** @return the selectivity of a comparison with a constant, without statistics */
+double DefaultSelectivity(ComparisonType comparison) {
+  switch (comparison) {
+    case ComparisonType::Equal:
+      return CardinalityEstimator::DEFAULT_EQUALITY_SELECTIVITY;
+    case ComparisonType::NotEqual:
+      return 1 - CardinalityEstimator::DEFAULT_EQUALITY_SELECTIVITY;
+    default:
+      return CardinalityEstimator::DEFAULT_SELECTIVITY;
+  }
+}
+
+}  // namespace
+
+double CardinalityEstimator::EstimateCardinality(const AbstractPlanNode *plan) const {
+  switch (plan->GetType()) {
+    case PlanType::SeqScan: {
+      auto seq_scan_plan = dynamic_cast<const SeqScanPlanNode *>(plan);
+      const TableStats *stats = GetTableStats(seq_scan_plan->GetTableOid());
+      double rows = stats == nullptr ? DEFAULT_ROW_COUNT : stats->GetRowCount();
+      return rows * EstimateSelectivity(seq_scan_plan->GetPredicate(), plan);
+    }
+
+    case PlanType::NestedLoopJoin: {
+      auto nested_loop_join_plan = dynamic_cast<const NestedLoopJoinPlanNode *>(plan);
+      return EstimateCardinality(plan->GetChildAt(0)) * EstimateCardinality(plan->GetChildAt(1)) *
+             EstimateSelectivity(nested_loop_join_plan->Predicate(), plan);
+    }
+
+    case PlanType::HashJoin:
+    case PlanType::MergeJoin: {
+      auto hash_join_plan = dynamic_cast<const HashJoinPlanNode *>(plan);
+      auto merge_join_plan = dynamic_cast<const MergeJoinPlanNode *>(plan);
+      const auto &left_keys =
+          hash_join_plan != nullptr ? hash_join_plan->GetLeftKeys() : merge_join_plan->GetLeftKeys();
+      const auto &right_keys =
+          hash_join_plan != nullptr ? hash_join_plan->GetRightKeys() : merge_join_plan->GetRightKeys();
+      const AbstractExpression *predicate =
+          hash_join_plan != nullptr ? hash_join_plan->Predicate() : merge_join_plan->Predicate();
+      double selectivity = EstimateSelectivity(predicate, plan);
+      for (size_t i = 0; i < left_keys.size(); i++) {
+        // The keys are evaluated on the tuples of each child, whatever their tuple index says.
+        auto left_key = dynamic_cast<const ColumnValueExpression *>(left_keys[i]);
+        auto right_key = dynamic_cast<const ColumnValueExpression *>(right_keys[i]);
+        selectivity *= EstimateEquality(
+            left_key == nullptr ? nullptr : GetOutputColumnStats(plan->GetChildAt(0), left_key->GetColIdx()),
+            right_key == nullptr ? nullptr : GetOutputColumnStats(plan->GetChildAt(1), right_key->GetColIdx()));
+      }
+      return EstimateCardinality(plan->GetChildAt(0)) * EstimateCardinality(plan->GetChildAt(1)) * selectivity;
+    }
+
+    case PlanType::Aggregation: {
+      auto agg_plan = dynamic_cast<const AggregationPlanNode *>(plan);
+      double input = EstimateCardinality(agg_plan->GetChildPlan());
+      // As many groups as combinations of the distinct values of the group bys, up to one per input row.
+      double groups = 1;
+      for (const auto *group_by : agg_plan->GetGroupBys()) {
+        auto column = dynamic_cast<const ColumnValueExpression *>(group_by);
+        const ColumnStats *stats =
+            column == nullptr ? nullptr : GetOutputColumnStats(agg_plan->GetChildPlan(), column->GetColIdx());
+        groups *= stats == nullptr ? input : stats->GetNumDistinct() + (stats->GetNullFraction() > 0 ? 1 : 0);
+      }
+      groups = std::min(groups, std::max(input, 1.0));
+      return agg_plan->GetHaving() == nullptr ? groups : groups * DEFAULT_SELECTIVITY;
+    }
+
+    case PlanType::Limit: {
+      auto limit_plan = dynamic_cast<const LimitPlanNode *>(plan);
+      return std::min(EstimateCardinality(plan->GetChildAt(0)), static_cast<double>(limit_plan->GetLimit()));
+    }
+
+    case PlanType::TopN: {
+      auto topn_plan = dynamic_cast<const TopNPlanNode *>(plan);
+      return std::min(EstimateCardinality(plan->GetChildAt(0)), static_cast<double>(topn_plan->GetLimit()));
+    }
+
+    case PlanType::Sort:
+    case PlanType::Gather:
+    case PlanType::Exchange:
+      return EstimateCardinality(plan->GetChildAt(0));
+
+    default:
+      return DEFAULT_ROW_COUNT;
+  }
+}
+
+double CardinalityEstimator::EstimateSelectivity(const AbstractExpression *predicate,
+                                                 const AbstractPlanNode *plan) const {
+  auto resolver = [this, plan](const ColumnValueExpression *column) { return GetColumnStats(column, plan); };
+  return EstimateSelectivity(predicate, resolver);
+}
+
+double CardinalityEstimator::EstimateSelectivity(const AbstractExpression *predicate,
+                                                 const ColumnResolver &resolver) const {
+  if (predicate == nullptr) {
+    return 1;
+  }
+  auto logic = dynamic_cast<const LogicExpression *>(predicate);
+  if (logic != nullptr) {
+    double lhs = EstimateSelectivity(logic->GetChildAt(0), resolver);
+    double rhs = EstimateSelectivity(logic->GetChildAt(1), resolver);
+    return logic->GetLogicType() == LogicType::And ? lhs * rhs : lhs + rhs - lhs * rhs;
+  }
+  auto comparison = dynamic_cast<const ComparisonExpression *>(predicate);
+  if (comparison != nullptr) {
+    return EstimateComparison(comparison, resolver);
+  }
+  return DEFAULT_SELECTIVITY;
+}
+
+double CardinalityEstimator::EstimateEquality(const AbstractPlanNode *left_plan, uint32_t left_col_idx,
+                                              const AbstractPlanNode *right_plan, uint32_t right_col_idx) const {
+  return EstimateEquality(GetOutputColumnStats(left_plan, left_col_idx),
+                          GetOutputColumnStats(right_plan, right_col_idx));
+}
+
+const ColumnStats *CardinalityEstimator::GetOutputColumnStats(const AbstractPlanNode *plan, uint32_t col_idx) const {
+  switch (plan->GetType()) {
+    case PlanType::SeqScan: {
+      auto column = dynamic_cast<const ColumnValueExpression *>(plan->OutputSchema()->GetColumn(col_idx).GetExpr());
+      if (column == nullptr) {
+        return nullptr;
+      }
+      const TableStats *stats = GetTableStats(dynamic_cast<const SeqScanPlanNode *>(plan)->GetTableOid());
+      return stats == nullptr ? nullptr : &stats->GetColumnStats(column->GetColIdx());
+    }
+
+    case PlanType::NestedLoopJoin:
+    case PlanType::HashJoin:
+    case PlanType::MergeJoin: {
+      auto column = dynamic_cast<const ColumnValueExpression *>(plan->OutputSchema()->GetColumn(col_idx).GetExpr());
+      return column == nullptr ? nullptr : GetOutputColumnStats(plan->GetChildAt(column->GetTupleIdx()),
+                                                                column->GetColIdx());
+    }
+
+    case PlanType::Limit:
+    case PlanType::Sort:
+    case PlanType::TopN:
+      return GetOutputColumnStats(plan->GetChildAt(0), col_idx);
+
+    default:
+      return nullptr;
+  }
+}
+
+const TableStats *CardinalityEstimator::GetTableStats(table_oid_t table_oid) const {
+  auto it = table_stats_.find(table_oid);
+  if (it != table_stats_.end()) {
+    return it->second.get();
+  }
+  // A table that was never analyzed is looked up again the next time.
+  auto stats = catalog_->GetTable(table_oid)->GetStats();
+  if (stats == nullptr) {
+    return nullptr;
+  }
+  return table_stats_.emplace(table_oid, std::move(stats)).first->second.get();
+}
+
+const ColumnStats *CardinalityEstimator::GetColumnStats(const ColumnValueExpression *column,
+                                                        const AbstractPlanNode *plan) const {
+  switch (plan->GetType()) {
+    case PlanType::SeqScan: {
+      const TableStats *stats = GetTableStats(dynamic_cast<const SeqScanPlanNode *>(plan)->GetTableOid());
+      return stats == nullptr ? nullptr : &stats->GetColumnStats(column->GetColIdx());
+    }
+
+    case PlanType::NestedLoopJoin:
+    case PlanType::HashJoin:
+    case PlanType::MergeJoin:
+      return GetOutputColumnStats(plan->GetChildAt(column->GetTupleIdx()), column->GetColIdx());
+
+    default:
+      return nullptr;
+  }
+}
+
+double CardinalityEstimator::EstimateComparison(const ComparisonExpression *comparison,
+                                                const ColumnResolver &resolver) const {
+  ComparisonType type = comparison->GetComparisonType();
+  auto lhs_column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0));
+  auto rhs_column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1));
+  auto lhs_constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(0));
+  auto rhs_constant = dynamic_cast<const ConstantValueExpression *>(comparison->GetChildAt(1));
+
+  if (lhs_constant != nullptr && rhs_constant != nullptr) {
+    Value matched = comparison->Evaluate(nullptr, nullptr);
+    return !matched.IsNull() && matched.GetAs<bool>() ? 1 : 0;
+  }
+  if (lhs_constant != nullptr && rhs_column != nullptr) {
+    std::swap(lhs_column, rhs_column);
+    std::swap(lhs_constant, rhs_constant);
+    type = Flip(type);
+  }
+  if (lhs_column != nullptr && rhs_constant != nullptr) {
+    const ColumnStats *stats = resolver(lhs_column);
+    if (stats == nullptr) {
+      return rhs_constant->GetValue().IsNull() ? 0 : DefaultSelectivity(type);
+    }
+    return stats->EstimateSelectivity(type, rhs_constant->GetValue());
+  }
+  if (lhs_column != nullptr && rhs_column != nullptr) {
+    if (type == ComparisonType::Equal) {
+      return EstimateEquality(resolver(lhs_column), resolver(rhs_column));
+    }
+    if (type == ComparisonType::NotEqual) {
+      return 1 - EstimateEquality(resolver(lhs_column), resolver(rhs_column));
+    }
+  }
+  return DefaultSelectivity(type);
+}
+
+double CardinalityEstimator::EstimateEquality(const ColumnStats *left, const ColumnStats *right) {
+  if (left == nullptr && right == nullptr) {
+    return DEFAULT_EQUALITY_SELECTIVITY;
+  }
+  // Each value of the side with fewer distinct values is assumed to match one of the other side.
+  double num_distinct = 1;
+  double non_null = 1;
+  for (const ColumnStats *stats : {left, right}) {
+    if (stats != nullptr) {
+      if (stats->IsEmpty()) {
+        return 0;
+      }
+      num_distinct = std::max(num_distinct, stats->GetNumDistinct());
+      non_null *= 1 - stats->GetNullFraction();
+    }
+  }
+  return non_null / num_distinct;
+}
+
+}  // namespace bustub
@@ -0,0 +1,191 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// join_orderer.cpp
+//
+// Identification: src/optimizer/join_orderer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "optimizer/join_orderer.h"
+
+#include <algorithm>
+
+#include "common/config.h"
+#include "common/macros.h"
+
+namespace bustub {
+
+size_t JoinOrderer::AddRelation(double cardinality, double cost, double width) {
+  BUSTUB_ASSERT(nodes_.size() == num_relations_, "Relations must be added before they are joined.");
+  BUSTUB_ASSERT(num_relations_ < 64, "A join orders at most 64 relations.");
+  Node node;
+  node.relations_ = 1ULL << num_relations_;
+  node.cardinality_ = cardinality;
+  node.cost_ = cost;
+  node.width_ = width;
+  nodes_.push_back(node);
+  return num_relations_++;
+}
+
+void JoinOrderer::AddPredicate(uint64_t relations, double selectivity, uint64_t lhs, uint64_t rhs) {
+  predicates_.push_back({relations, selectivity, lhs, rhs});
+  cardinalities_.clear();
+}
+
+size_t JoinOrderer::Join(size_t left, size_t right) {
+  nodes_.push_back(PlanJoin(left, right));
+  return nodes_.size() - 1;
+}
+
+size_t JoinOrderer::OrderExhaustively() {
+  BUSTUB_ASSERT(num_relations_ > 0 && num_relations_ <= 20, "Too many relations to order exhaustively.");
+  uint64_t all = (1ULL << num_relations_) - 1;
+  std::vector<size_t> best(all + 1, INVALID_NODE);
+  // Whether the predicates connect the relations of each subset, which then has a plan without cross products.
+  std::vector<bool> connected(all + 1, false);
+  for (size_t i = 0; i < num_relations_; i++) {
+    best[1ULL << i] = i;
+    connected[1ULL << i] = true;
+  }
+
+  // Every proper subset of a set is a smaller number, so its plan is known by the time the set is planned.
+  for (uint64_t set = 1; set <= all; set++) {
+    if ((set & (set - 1)) == 0) {
+      continue;
+    }
+    // Cross products are only considered for subsets that cannot be split into two connected ones.
+    for (bool cross_products : {false, true}) {
+      Node cheapest;
+      cheapest.cost_ = std::numeric_limits<double>::infinity();
+      for (uint64_t left = (set - 1) & set; left != 0; left = (left - 1) & set) {
+        uint64_t right = set ^ left;
+        if (best[left] == INVALID_NODE || best[right] == INVALID_NODE ||
+            (!cross_products && (!connected[left] || !connected[right] || !IsConnected(left, right)))) {
+          continue;
+        }
+        Node join = PlanJoin(best[left], best[right]);
+        if (join.cost_ < cheapest.cost_) {
+          cheapest = join;
+        }
+      }
+      if (cheapest.cost_ < std::numeric_limits<double>::infinity()) {
+        nodes_.push_back(cheapest);
+        best[set] = nodes_.size() - 1;
+        connected[set] = !cross_products;
+        break;
+      }
+    }
+  }
+  return best[all];
+}
+
+size_t JoinOrderer::OrderGreedily() {
+  BUSTUB_ASSERT(num_relations_ > 0, "There is nothing to order.");
+  std::vector<size_t> trees;
+  for (size_t i = 0; i < num_relations_; i++) {
+    trees.push_back(i);
+  }
+  while (trees.size() > 1) {
+    // The smallest join of two connected trees, or of any two if none is connected; the cheaper one on a tie.
+    bool connected = false;
+    size_t best_left = 0;
+    size_t best_right = 0;
+    Node best;
+    for (size_t left = 0; left < trees.size(); left++) {
+      for (size_t right = 0; right < trees.size(); right++) {
+        if (left == right) {
+          continue;
+        }
+        bool is_connected = IsConnected(nodes_[trees[left]].relations_, nodes_[trees[right]].relations_);
+        if (connected && !is_connected) {
+          continue;
+        }
+        Node join = PlanJoin(trees[left], trees[right]);
+        bool better = (is_connected && !connected) || (left == 0 && right == 1) ||
+                      join.cardinality_ < best.cardinality_ ||
+                      (join.cardinality_ == best.cardinality_ && join.cost_ < best.cost_);
+        if (better) {
+          connected = is_connected;
+          best_left = left;
+          best_right = right;
+          best = join;
+        }
+      }
+    }
+    nodes_.push_back(best);
+    trees[best_left] = nodes_.size() - 1;
+    trees.erase(trees.begin() + best_right);
+  }
+  return trees[0];
+}
+
+bool JoinOrderer::IsConnected(uint64_t left, uint64_t right) const {
+  return std::any_of(predicates_.begin(), predicates_.end(), [left, right](const Predicate &predicate) {
+    return (predicate.relations_ & ~(left | right)) == 0 && (predicate.relations_ & left) != 0 &&
+           (predicate.relations_ & right) != 0;
+  });
+}
+
+double JoinOrderer::Cardinality(uint64_t relations) {
+  auto cached = cardinalities_.find(relations);
+  if (cached != cardinalities_.end()) {
+    return cached->second;
+  }
+  double cardinality = 1;
+  for (size_t i = 0; i < num_relations_; i++) {
+    if ((relations & (1ULL << i)) != 0) {
+      cardinality *= nodes_[i].cardinality_;
+    }
+  }
+  for (const auto &predicate : predicates_) {
+    if (predicate.relations_ != 0 && (predicate.relations_ & ~relations) == 0) {
+      cardinality *= predicate.selectivity_;
+    }
+  }
+  cardinalities_[relations] = cardinality;
+  return cardinality;
+}
+
+JoinOrderer::Node JoinOrderer::PlanJoin(size_t left, size_t right) {
+  const Node &l = nodes_[left];
+  const Node &r = nodes_[right];
+  BUSTUB_ASSERT((l.relations_ & r.relations_) == 0, "The sides of a join must have no relation in common.");
+  Node join;
+  join.relations_ = l.relations_ | r.relations_;
+  join.left_ = left;
+  join.right_ = right;
+  join.cardinality_ = Cardinality(join.relations_);
+  join.width_ = l.width_ + r.width_;
+  double inputs = l.cost_ + r.cost_ + TUPLE_COST * join.cardinality_;
+
+  join.algorithm_ = JoinAlgorithm::NestedLoop;
+  join.cost_ = inputs + TUPLE_COST * (r.cardinality_ + l.cardinality_ * r.cardinality_);
+  if (HasHashKeys(l.relations_, r.relations_)) {
+    double left_bytes = l.cardinality_ * l.width_;
+    double right_bytes = r.cardinality_ * r.width_;
+    double spilled_pages =
+        std::min(left_bytes, right_bytes) > hash_join_memory_budget ? 2 * (left_bytes + right_bytes) / PAGE_SIZE : 0;
+    double cost = inputs + TUPLE_COST * (l.cardinality_ + r.cardinality_) + PAGE_COST * spilled_pages;
+    if (cost < join.cost_) {
+      join.algorithm_ = JoinAlgorithm::Hash;
+      join.cost_ = cost;
+    }
+  }
+  return join;
+}
+
+bool JoinOrderer::HasHashKeys(uint64_t left, uint64_t right) const {
+  return std::any_of(predicates_.begin(), predicates_.end(), [left, right](const Predicate &predicate) {
+    if (predicate.lhs_ == 0 || predicate.rhs_ == 0) {
+      return false;
+    }
+    return ((predicate.lhs_ & ~left) == 0 && (predicate.rhs_ & ~right) == 0) ||
+           ((predicate.lhs_ & ~right) == 0 && (predicate.rhs_ & ~left) == 0);
+  });
+}
+
+}  // namespace bustub
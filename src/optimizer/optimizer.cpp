@@ -0,0 +1,777 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// optimizer.cpp
+//
+// Identification: src/optimizer/optimizer.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "optimizer/optimizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/expressions/parameter_value_expression.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/hash_join_plan.h"
+#include "execution/plans/limit_plan.h"
+#include "execution/plans/merge_join_plan.h"
+#include "execution/plans/nested_loop_join_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/plans/topn_plan.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return true if values of two types that compare equal also hash equal, so that they can be hash join keys */
+bool HashCompatible(TypeId lhs, TypeId rhs) {
+  auto is_integer = [](TypeId type) {
+    return type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER || type == TypeId::BIGINT;
+  };
+  return lhs == rhs || (is_integer(lhs) && is_integer(rhs));
+}
+
+/** @return an equality that can be a hash join key, nullptr if expr is none */
+const ComparisonExpression *AsHashableEquality(const AbstractExpression *expr) {
+  auto comparison = dynamic_cast<const ComparisonExpression *>(expr);
+  if (comparison == nullptr || comparison->GetComparisonType() != ComparisonType::Equal ||
+      !HashCompatible(comparison->GetChildAt(0)->GetReturnType(), comparison->GetChildAt(1)->GetReturnType())) {
+    return nullptr;
+  }
+  return comparison;
+}
+
+/** @return true if a plan is a join whose inputs can be reordered */
+bool IsInnerJoin(const AbstractPlanNode *plan) {
+  return plan->GetType() == PlanType::NestedLoopJoin || plan->GetType() == PlanType::HashJoin;
+}
+
+/** @return the predicate of a sequential scan or a join */
+const AbstractExpression *PredicateOf(const AbstractPlanNode *plan) {
+  switch (plan->GetType()) {
+    case PlanType::SeqScan:
+      return dynamic_cast<const SeqScanPlanNode *>(plan)->GetPredicate();
+    case PlanType::NestedLoopJoin:
+      return dynamic_cast<const NestedLoopJoinPlanNode *>(plan)->Predicate();
+    case PlanType::HashJoin:
+      return dynamic_cast<const HashJoinPlanNode *>(plan)->Predicate();
+    default:
+      UNREACHABLE("Only scans and joins have a predicate.");
+  }
+}
+
+}  // namespace
+
+const AbstractPlanNode *Optimizer::Optimize(const AbstractPlanNode *plan) {
+  plan = PushDownPredicates(plan);
+  plan = SelectJoins(plan);
+  plan = ReorderJoins(plan);
+  return PruneColumns(plan);
+}
+
+const AbstractPlanNode *Optimizer::PushDownPredicates(const AbstractPlanNode *plan) {
+  if (plan->GetType() == PlanType::NestedLoopJoin || plan->GetType() == PlanType::HashJoin) {
+    std::vector<const AbstractExpression *> conjuncts;
+    SplitConjunction(PredicateOf(plan), &conjuncts);
+    std::array<std::vector<const AbstractExpression *>, 2> pushed;
+    std::vector<const AbstractExpression *> kept;
+    for (const auto *conjunct : conjuncts) {
+      // A conjunct that refers to one side only is pushed into it, if that side can evaluate it.
+      uint32_t tuples = ReferencedTuples(conjunct);
+      if (tuples == 1 || tuples == 2) {
+        size_t side = tuples == 1 ? 0 : 1;
+        const AbstractExpression *rewritten = PushablePredicate(plan->GetChildAt(side), conjunct);
+        if (rewritten != nullptr) {
+          pushed[side].push_back(rewritten);
+          continue;
+        }
+      }
+      kept.push_back(conjunct);
+    }
+
+    if (!pushed[0].empty() || !pushed[1].empty()) {
+      std::vector<const AbstractPlanNode *> children{WithPredicates(plan->GetChildAt(0), pushed[0]),
+                                                     WithPredicates(plan->GetChildAt(1), pushed[1])};
+      const AbstractExpression *predicate = MakeConjunction(kept);
+      if (plan->GetType() == PlanType::NestedLoopJoin) {
+        plan = Own(std::make_unique<NestedLoopJoinPlanNode>(plan->OutputSchema(), std::move(children), predicate));
+      } else {
+        auto hash_join_plan = dynamic_cast<const HashJoinPlanNode *>(plan);
+        plan = Own(std::make_unique<HashJoinPlanNode>(
+            plan->OutputSchema(), std::move(children),
+            std::vector<const AbstractExpression *>(hash_join_plan->GetLeftKeys()),
+            std::vector<const AbstractExpression *>(hash_join_plan->GetRightKeys()), predicate));
+      }
+    }
+  }
+  return RewriteChildren(plan, [this](const AbstractPlanNode *child) { return PushDownPredicates(child); });
+}
+
+const AbstractPlanNode *Optimizer::SelectJoins(const AbstractPlanNode *plan) {
+  if (plan->GetType() == PlanType::NestedLoopJoin) {
+    std::vector<const AbstractExpression *> conjuncts;
+    SplitConjunction(PredicateOf(plan), &conjuncts);
+    std::vector<const AbstractExpression *> left_keys;
+    std::vector<const AbstractExpression *> right_keys;
+    std::vector<const AbstractExpression *> rest;
+    for (const auto *conjunct : conjuncts) {
+      const ComparisonExpression *comparison = AsHashableEquality(conjunct);
+      if (comparison != nullptr) {
+        const AbstractExpression *lhs = comparison->GetChildAt(0);
+        const AbstractExpression *rhs = comparison->GetChildAt(1);
+        uint32_t lhs_tuples = ReferencedTuples(lhs);
+        uint32_t rhs_tuples = ReferencedTuples(rhs);
+        if (lhs_tuples == 1 && rhs_tuples == 2) {
+          left_keys.push_back(lhs);
+          right_keys.push_back(rhs);
+          continue;
+        }
+        if (lhs_tuples == 2 && rhs_tuples == 1) {
+          left_keys.push_back(rhs);
+          right_keys.push_back(lhs);
+          continue;
+        }
+      }
+      rest.push_back(conjunct);
+    }
+
+    if (!left_keys.empty()) {
+      plan = Own(std::make_unique<HashJoinPlanNode>(
+          plan->OutputSchema(), std::vector<const AbstractPlanNode *>(plan->GetChildren()), std::move(left_keys),
+          std::move(right_keys), MakeConjunction(rest)));
+    }
+  }
+  return RewriteChildren(plan, [this](const AbstractPlanNode *child) { return SelectJoins(child); });
+}
+
+const AbstractPlanNode *Optimizer::ReorderJoins(const AbstractPlanNode *plan) {
+  auto reorder_children = [this](const AbstractPlanNode *child) { return ReorderJoins(child); };
+  if (estimator_ == nullptr || !IsInnerJoin(plan)) {
+    return RewriteChildren(plan, reorder_children);
+  }
+  JoinGraph graph;
+  std::vector<const AbstractExpression *> outputs;
+  bool flattened = FlattenJoins(plan, &graph);
+  for (uint32_t i = 0; flattened && i < plan->OutputSchema()->GetColumnCount(); i++) {
+    outputs.push_back(ToRelations(plan->OutputSchema()->GetColumn(i).GetExpr(), plan, -1, graph));
+    flattened = outputs.back() != nullptr;
+  }
+  // Tuple indexes, and the bit sets of ReferencedTuples(), number the relations.
+  if (!flattened || graph.relations_.size() < 3 || graph.relations_.size() > 32) {
+    return RewriteChildren(plan, reorder_children);
+  }
+
+  JoinOrderer orderer;
+  std::vector<const AbstractPlanNode *> inputs;
+  for (const auto *relation : graph.relations_) {
+    inputs.push_back(ReorderJoins(relation));
+    double cardinality = estimator_->EstimateCardinality(inputs.back());
+    orderer.AddRelation(cardinality, RelationCost(inputs.back(), cardinality),
+                        inputs.back()->OutputSchema()->GetLength());
+  }
+  auto resolver = [this, &inputs](const ColumnValueExpression *column) {
+    return estimator_->GetOutputColumnStats(inputs[column->GetTupleIdx()], column->GetColIdx());
+  };
+  for (const auto *conjunct : graph.conjuncts_) {
+    uint32_t lhs = 0;
+    uint32_t rhs = 0;
+    const ComparisonExpression *equality = AsHashableEquality(conjunct);
+    if (equality != nullptr) {
+      lhs = ReferencedTuples(equality->GetChildAt(0));
+      rhs = ReferencedTuples(equality->GetChildAt(1));
+      if (lhs == 0 || rhs == 0 || (lhs & rhs) != 0) {
+        lhs = rhs = 0;
+      }
+    }
+    orderer.AddPredicate(ReferencedTuples(conjunct), estimator_->EstimateSelectivity(conjunct, resolver), lhs, rhs);
+  }
+
+  // The written tree is kept unless the chosen one is cheaper, which also keeps it on ties.
+  std::function<size_t(const AbstractPlanNode *)> written = [&](const AbstractPlanNode *node) {
+    auto relation = graph.indexes_.find(node);
+    if (relation != graph.indexes_.end()) {
+      return static_cast<size_t>(relation->second);
+    }
+    return orderer.Join(written(node->GetChildAt(0)), written(node->GetChildAt(1)));
+  };
+  size_t written_root = written(plan);
+  size_t root = orderer.Order();
+  if (orderer.GetNode(root).cost_ >= orderer.GetNode(written_root).cost_ * (1 - 1e-9)) {
+    std::function<const AbstractPlanNode *(const AbstractPlanNode *)> with_inputs = [&](const AbstractPlanNode *node) {
+      auto relation = graph.indexes_.find(node);
+      return relation != graph.indexes_.end() ? inputs[relation->second] : RewriteChildren(node, with_inputs);
+    };
+    return RewriteChildren(plan, with_inputs);
+  }
+  std::vector<uint32_t> offsets(inputs.size());
+  return BuildJoin(orderer, root, inputs, graph.conjuncts_, plan->OutputSchema(), outputs, &offsets);
+}
+
+bool Optimizer::FlattenJoins(const AbstractPlanNode *plan, JoinGraph *graph) {
+  for (const auto *child : plan->GetChildren()) {
+    if (IsInnerJoin(child)) {
+      if (!FlattenJoins(child, graph)) {
+        return false;
+      }
+    } else {
+      // A plan that is joined twice, as in a self-join, could not tell its two relations apart.
+      if (graph->indexes_.count(child) != 0) {
+        return false;
+      }
+      graph->indexes_[child] = graph->relations_.size();
+      graph->relations_.push_back(child);
+    }
+  }
+
+  std::vector<const AbstractExpression *> conjuncts;
+  SplitConjunction(PredicateOf(plan), &conjuncts);
+  for (const auto *conjunct : conjuncts) {
+    graph->conjuncts_.push_back(ToRelations(conjunct, plan, -1, *graph));
+    if (graph->conjuncts_.back() == nullptr) {
+      return false;
+    }
+  }
+  auto hash_join_plan = dynamic_cast<const HashJoinPlanNode *>(plan);
+  if (hash_join_plan != nullptr) {
+    for (size_t i = 0; i < hash_join_plan->GetLeftKeys().size(); i++) {
+      const AbstractExpression *lhs = ToRelations(hash_join_plan->GetLeftKeys()[i], plan, 0, *graph);
+      const AbstractExpression *rhs = ToRelations(hash_join_plan->GetRightKeys()[i], plan, 1, *graph);
+      if (lhs == nullptr || rhs == nullptr) {
+        return false;
+      }
+      graph->conjuncts_.push_back(Own(std::make_unique<ComparisonExpression>(lhs, rhs, ComparisonType::Equal)));
+    }
+  }
+  return true;
+}
+
+const AbstractExpression *Optimizer::ToRelations(const AbstractExpression *expr, const AbstractPlanNode *join,
+                                                 int side, const JoinGraph &graph) {
+  return RewriteColumns(expr, [&](const ColumnValueExpression *column) {
+    uint32_t tuple_idx = side < 0 ? column->GetTupleIdx() : side;
+    return ToRelationColumn(join->GetChildAt(tuple_idx), column->GetColIdx(), column->GetReturnType(), graph);
+  });
+}
+
+const AbstractExpression *Optimizer::ToRelationColumn(const AbstractPlanNode *plan, uint32_t col_idx, TypeId type,
+                                                      const JoinGraph &graph) {
+  auto relation = graph.indexes_.find(plan);
+  if (relation != graph.indexes_.end()) {
+    return MakeColumnValue(relation->second, col_idx, type);
+  }
+  auto column = dynamic_cast<const ColumnValueExpression *>(plan->OutputSchema()->GetColumn(col_idx).GetExpr());
+  if (!IsInnerJoin(plan) || column == nullptr) {
+    return nullptr;
+  }
+  return ToRelationColumn(plan->GetChildAt(column->GetTupleIdx()), column->GetColIdx(), type, graph);
+}
+
+double Optimizer::RelationCost(const AbstractPlanNode *relation, double cardinality) const {
+  if (relation->GetType() != PlanType::SeqScan) {
+    return JoinOrderer::TUPLE_COST * cardinality;
+  }
+  // A scan reads every page of its table and evaluates its predicate on every row.
+  const TableStats *stats = estimator_->GetTableStats(dynamic_cast<const SeqScanPlanNode *>(relation)->GetTableOid());
+  double rows = stats == nullptr ? CardinalityEstimator::DEFAULT_ROW_COUNT : stats->GetRowCount();
+  double pages = stats == nullptr ? std::ceil(rows * relation->OutputSchema()->GetLength() / PAGE_SIZE)
+                                  : static_cast<double>(stats->GetNumPages());
+  return JoinOrderer::PAGE_COST * pages + JoinOrderer::TUPLE_COST * rows;
+}
+
+const AbstractPlanNode *Optimizer::BuildJoin(const JoinOrderer &orderer, size_t node,
+                                             const std::vector<const AbstractPlanNode *> &inputs,
+                                             const std::vector<const AbstractExpression *> &conjuncts,
+                                             const Schema *output_schema,
+                                             const std::vector<const AbstractExpression *> &outputs,
+                                             std::vector<uint32_t> *offsets) {
+  const JoinOrderer::Node &join = orderer.GetNode(node);
+  if (join.left_ == JoinOrderer::INVALID_NODE) {
+    size_t relation = __builtin_ctzll(join.relations_);
+    (*offsets)[relation] = 0;
+    return inputs[relation];
+  }
+
+  const std::array<uint64_t, 2> sides{orderer.GetNode(join.left_).relations_,
+                                      orderer.GetNode(join.right_).relations_};
+  std::array<std::vector<uint32_t>, 2> side_offsets{std::vector<uint32_t>(inputs.size()),
+                                                    std::vector<uint32_t>(inputs.size())};
+  std::vector<const AbstractPlanNode *> children{
+      BuildJoin(orderer, join.left_, inputs, conjuncts, nullptr, {}, &side_offsets[0]),
+      BuildJoin(orderer, join.right_, inputs, conjuncts, nullptr, {}, &side_offsets[1])};
+  // A column of a relation becomes a column of the side that has the relation.
+  auto to_sides = [&](const AbstractExpression *expr) {
+    return RewriteColumns(expr, [&](const ColumnValueExpression *column) {
+      uint32_t relation = column->GetTupleIdx();
+      uint32_t side = ((sides[0] >> relation) & 1) != 0 ? 0 : 1;
+      return MakeColumnValue(side, side_offsets[side][relation] + column->GetColIdx(), column->GetReturnType());
+    });
+  };
+
+  std::vector<Column> columns;
+  if (output_schema == nullptr) {
+    for (uint32_t side = 0; side < 2; side++) {
+      const Schema *schema = children[side]->OutputSchema();
+      for (size_t relation = 0; relation < inputs.size(); relation++) {
+        if (((sides[side] >> relation) & 1) != 0) {
+          (*offsets)[relation] = columns.size() + side_offsets[side][relation];
+        }
+      }
+      for (uint32_t i = 0; i < schema->GetColumnCount(); i++) {
+        columns.push_back(CopyColumn(schema->GetColumn(i), MakeColumnValue(side, i, schema->GetColumn(i).GetType())));
+      }
+    }
+  } else {
+    for (uint32_t i = 0; i < output_schema->GetColumnCount(); i++) {
+      columns.push_back(CopyColumn(output_schema->GetColumn(i), to_sides(outputs[i])));
+    }
+  }
+  schemas_.emplace_back(std::make_unique<Schema>(columns));
+  const Schema *schema = schemas_.back().get();
+
+  // A conjunct is evaluated by the lowest join that has all its columns; one without columns by the root.
+  std::vector<const AbstractExpression *> left_keys;
+  std::vector<const AbstractExpression *> right_keys;
+  std::vector<const AbstractExpression *> rest;
+  for (const auto *conjunct : conjuncts) {
+    uint64_t relations = ReferencedTuples(conjunct);
+    relations = relations == 0 && output_schema != nullptr ? join.relations_ : relations;
+    bool below = std::any_of(sides.begin(), sides.end(), [relations](uint64_t side) {
+      return (side & (side - 1)) != 0 && (relations & ~side) == 0;
+    });
+    if (relations == 0 || (relations & ~join.relations_) != 0 || below) {
+      continue;
+    }
+    const ComparisonExpression *equality = AsHashableEquality(conjunct);
+    if (join.algorithm_ == JoinOrderer::JoinAlgorithm::Hash && equality != nullptr) {
+      uint64_t lhs = ReferencedTuples(equality->GetChildAt(0));
+      uint64_t rhs = ReferencedTuples(equality->GetChildAt(1));
+      if (lhs != 0 && rhs != 0 && (lhs & ~sides[0]) == 0 && (rhs & ~sides[1]) == 0) {
+        left_keys.push_back(to_sides(equality->GetChildAt(0)));
+        right_keys.push_back(to_sides(equality->GetChildAt(1)));
+        continue;
+      }
+      if (lhs != 0 && rhs != 0 && (lhs & ~sides[1]) == 0 && (rhs & ~sides[0]) == 0) {
+        left_keys.push_back(to_sides(equality->GetChildAt(1)));
+        right_keys.push_back(to_sides(equality->GetChildAt(0)));
+        continue;
+      }
+    }
+    rest.push_back(to_sides(conjunct));
+  }
+  if (join.algorithm_ == JoinOrderer::JoinAlgorithm::NestedLoop) {
+    return Own(std::make_unique<NestedLoopJoinPlanNode>(schema, std::move(children), MakeConjunction(rest)));
+  }
+  return Own(std::make_unique<HashJoinPlanNode>(schema, std::move(children), std::move(left_keys),
+                                                std::move(right_keys), MakeConjunction(rest)));
+}
+
+const AbstractPlanNode *Optimizer::PruneColumns(const AbstractPlanNode *plan) {
+  switch (plan->GetType()) {
+    case PlanType::NestedLoopJoin:
+    case PlanType::HashJoin: {
+      // The columns of each side that the output, the predicate or the keys refer to.
+      std::array<std::vector<bool>, 2> used;
+      for (size_t side = 0; side < 2; side++) {
+        used[side].assign(plan->GetChildAt(side)->OutputSchema()->GetColumnCount(), false);
+      }
+      std::vector<const ColumnValueExpression *> columns;
+      for (const auto &column : plan->OutputSchema()->GetColumns()) {
+        CollectColumns(column.GetExpr(), &columns);
+      }
+      CollectColumns(PredicateOf(plan), &columns);
+      for (const auto *column : columns) {
+        used[column->GetTupleIdx()][column->GetColIdx()] = true;
+      }
+      auto hash_join_plan = dynamic_cast<const HashJoinPlanNode *>(plan);
+      if (hash_join_plan != nullptr) {
+        for (size_t side = 0; side < 2; side++) {
+          columns.clear();
+          for (const auto *key : side == 0 ? hash_join_plan->GetLeftKeys() : hash_join_plan->GetRightKeys()) {
+            CollectColumns(key, &columns);
+          }
+          for (const auto *column : columns) {
+            used[side][column->GetColIdx()] = true;
+          }
+        }
+      }
+
+      std::array<std::vector<uint32_t>, 2> mappings;
+      std::vector<const AbstractPlanNode *> children;
+      for (size_t side = 0; side < 2; side++) {
+        children.push_back(WithColumns(plan->GetChildAt(side), used[side], &mappings[side]));
+      }
+      if (children[0] == plan->GetChildAt(0) && children[1] == plan->GetChildAt(1)) {
+        break;
+      }
+
+      // Renumber the references to the pruned children.
+      auto renumber = [&](const AbstractExpression *expr, int side) {
+        const AbstractExpression *rewritten = RewriteColumns(expr, [&](const ColumnValueExpression *column) {
+          uint32_t tuple_idx = side < 0 ? column->GetTupleIdx() : side;
+          return MakeColumnValue(column->GetTupleIdx(), mappings[tuple_idx][column->GetColIdx()],
+                                 column->GetReturnType());
+        });
+        BUSTUB_ASSERT(expr == nullptr || rewritten != nullptr, "Join expressions must be scalar to be renumbered.");
+        return rewritten;
+      };
+      std::vector<uint32_t> col_idxs;
+      std::vector<const AbstractExpression *> exprs;
+      for (uint32_t i = 0; i < plan->OutputSchema()->GetColumnCount(); i++) {
+        col_idxs.push_back(i);
+        exprs.push_back(renumber(plan->OutputSchema()->GetColumn(i).GetExpr(), -1));
+      }
+      const Schema *output_schema = MakeSchema(plan->OutputSchema(), col_idxs, exprs);
+      const AbstractExpression *predicate = renumber(PredicateOf(plan), -1);
+      if (hash_join_plan == nullptr) {
+        plan = Own(std::make_unique<NestedLoopJoinPlanNode>(output_schema, std::move(children), predicate));
+        break;
+      }
+      std::array<std::vector<const AbstractExpression *>, 2> keys;
+      for (size_t side = 0; side < 2; side++) {
+        for (const auto *key : side == 0 ? hash_join_plan->GetLeftKeys() : hash_join_plan->GetRightKeys()) {
+          keys[side].push_back(renumber(key, static_cast<int>(side)));
+        }
+      }
+      plan = Own(std::make_unique<HashJoinPlanNode>(output_schema, std::move(children), std::move(keys[0]),
+                                                    std::move(keys[1]), predicate));
+      break;
+    }
+
+    case PlanType::Aggregation: {
+      // The group bys and the aggregates are evaluated on the child, the having and the output on the aggregates.
+      auto agg_plan = dynamic_cast<const AggregationPlanNode *>(plan);
+      std::vector<bool> used(agg_plan->GetChildPlan()->OutputSchema()->GetColumnCount(), false);
+      std::vector<const ColumnValueExpression *> columns;
+      for (const auto *expr : agg_plan->GetGroupBys()) {
+        CollectColumns(expr, &columns);
+      }
+      for (const auto *expr : agg_plan->GetAggregates()) {
+        CollectColumns(expr, &columns);
+      }
+      for (const auto *column : columns) {
+        used[column->GetColIdx()] = true;
+      }
+      std::vector<uint32_t> mapping;
+      const AbstractPlanNode *child = WithColumns(agg_plan->GetChildPlan(), used, &mapping);
+      if (child == agg_plan->GetChildPlan()) {
+        break;
+      }
+
+      auto renumber = [&](const std::vector<const AbstractExpression *> &exprs) {
+        std::vector<const AbstractExpression *> rewritten;
+        for (const auto *expr : exprs) {
+          rewritten.push_back(RewriteColumns(expr, [&](const ColumnValueExpression *column) {
+            return MakeColumnValue(column->GetTupleIdx(), mapping[column->GetColIdx()], column->GetReturnType());
+          }));
+          BUSTUB_ASSERT(rewritten.back() != nullptr, "Aggregated expressions must be scalar to be renumbered.");
+        }
+        return rewritten;
+      };
+      plan = Own(std::make_unique<AggregationPlanNode>(
+          plan->OutputSchema(), child, agg_plan->GetHaving(), renumber(agg_plan->GetGroupBys()),
+          renumber(agg_plan->GetAggregates()), std::vector<AggregationType>(agg_plan->GetAggregateTypes())));
+      break;
+    }
+
+    default:
+      break;
+  }
+  return RewriteChildren(plan, [this](const AbstractPlanNode *child) { return PruneColumns(child); });
+}
+
+const AbstractPlanNode *Optimizer::RewriteChildren(const AbstractPlanNode *plan, const Rule &rule) {
+  switch (plan->GetType()) {
+    case PlanType::NestedLoopJoin:
+    case PlanType::HashJoin:
+    case PlanType::MergeJoin:
+    case PlanType::Aggregation:
+    case PlanType::Limit:
+    case PlanType::Sort:
+    case PlanType::TopN:
+      break;
+    default:
+      return plan;
+  }
+  std::vector<const AbstractPlanNode *> children;
+  bool changed = false;
+  for (const auto *child : plan->GetChildren()) {
+    children.push_back(rule(child));
+    changed = changed || children.back() != child;
+  }
+  return changed ? WithChildren(plan, std::move(children)) : plan;
+}
+
+const AbstractPlanNode *Optimizer::WithChildren(const AbstractPlanNode *plan,
+                                                std::vector<const AbstractPlanNode *> &&children) {
+  const Schema *schema = plan->OutputSchema();
+  switch (plan->GetType()) {
+    case PlanType::NestedLoopJoin: {
+      auto nested_loop_join_plan = dynamic_cast<const NestedLoopJoinPlanNode *>(plan);
+      return Own(
+          std::make_unique<NestedLoopJoinPlanNode>(schema, std::move(children), nested_loop_join_plan->Predicate()));
+    }
+    case PlanType::HashJoin: {
+      auto hash_join_plan = dynamic_cast<const HashJoinPlanNode *>(plan);
+      return Own(std::make_unique<HashJoinPlanNode>(
+          schema, std::move(children), std::vector<const AbstractExpression *>(hash_join_plan->GetLeftKeys()),
+          std::vector<const AbstractExpression *>(hash_join_plan->GetRightKeys()), hash_join_plan->Predicate()));
+    }
+    case PlanType::MergeJoin: {
+      auto merge_join_plan = dynamic_cast<const MergeJoinPlanNode *>(plan);
+      return Own(std::make_unique<MergeJoinPlanNode>(
+          schema, std::move(children), std::vector<const AbstractExpression *>(merge_join_plan->GetLeftKeys()),
+          std::vector<const AbstractExpression *>(merge_join_plan->GetRightKeys()), merge_join_plan->Predicate()));
+    }
+    case PlanType::Aggregation: {
+      auto agg_plan = dynamic_cast<const AggregationPlanNode *>(plan);
+      return Own(std::make_unique<AggregationPlanNode>(
+          schema, children[0], agg_plan->GetHaving(), std::vector<const AbstractExpression *>(agg_plan->GetGroupBys()),
+          std::vector<const AbstractExpression *>(agg_plan->GetAggregates()),
+          std::vector<AggregationType>(agg_plan->GetAggregateTypes())));
+    }
+    case PlanType::Limit: {
+      auto limit_plan = dynamic_cast<const LimitPlanNode *>(plan);
+      return Own(
+          std::make_unique<LimitPlanNode>(schema, children[0], limit_plan->GetLimit(), limit_plan->GetOffset()));
+    }
+    case PlanType::Sort: {
+      auto sort_plan = dynamic_cast<const SortPlanNode *>(plan);
+      auto order_bys = sort_plan->GetOrderBys();
+      return Own(std::make_unique<SortPlanNode>(schema, children[0], std::move(order_bys)));
+    }
+    case PlanType::TopN: {
+      auto topn_plan = dynamic_cast<const TopNPlanNode *>(plan);
+      auto order_bys = topn_plan->GetOrderBys();
+      return Own(std::make_unique<TopNPlanNode>(schema, children[0], std::move(order_bys), topn_plan->GetLimit(),
+                                                topn_plan->GetOffset()));
+    }
+    default:
+      UNREACHABLE("The optimizer does not look into this type of plan.");
+  }
+}
+
+const AbstractExpression *Optimizer::PushablePredicate(const AbstractPlanNode *plan,
+                                                       const AbstractExpression *predicate) {
+  if (plan->GetType() != PlanType::SeqScan && plan->GetType() != PlanType::NestedLoopJoin &&
+      plan->GetType() != PlanType::HashJoin) {
+    return nullptr;
+  }
+  // A reference to an output column becomes the expression that computes it.
+  const Schema *schema = plan->OutputSchema();
+  return RewriteColumns(predicate, [schema](const ColumnValueExpression *column) -> const AbstractExpression * {
+    const AbstractExpression *expr = schema->GetColumn(column->GetColIdx()).GetExpr();
+    return expr != nullptr && IsScalar(expr) ? expr : nullptr;
+  });
+}
+
+const AbstractPlanNode *Optimizer::WithPredicates(const AbstractPlanNode *plan,
+                                                  const std::vector<const AbstractExpression *> &predicates) {
+  if (predicates.empty()) {
+    return plan;
+  }
+  std::vector<const AbstractExpression *> conjuncts;
+  if (PredicateOf(plan) != nullptr) {
+    conjuncts.push_back(PredicateOf(plan));
+  }
+  conjuncts.insert(conjuncts.end(), predicates.begin(), predicates.end());
+  const AbstractExpression *predicate = MakeConjunction(conjuncts);
+  std::vector<const AbstractPlanNode *> children(plan->GetChildren());
+  switch (plan->GetType()) {
+    case PlanType::SeqScan:
+      return Own(std::make_unique<SeqScanPlanNode>(plan->OutputSchema(), predicate,
+                                                   dynamic_cast<const SeqScanPlanNode *>(plan)->GetTableOid()));
+    case PlanType::NestedLoopJoin:
+      return Own(std::make_unique<NestedLoopJoinPlanNode>(plan->OutputSchema(), std::move(children), predicate));
+    case PlanType::HashJoin: {
+      auto hash_join_plan = dynamic_cast<const HashJoinPlanNode *>(plan);
+      return Own(std::make_unique<HashJoinPlanNode>(
+          plan->OutputSchema(), std::move(children),
+          std::vector<const AbstractExpression *>(hash_join_plan->GetLeftKeys()),
+          std::vector<const AbstractExpression *>(hash_join_plan->GetRightKeys()), predicate));
+    }
+    default:
+      UNREACHABLE("Predicates are only pushed into scans and joins.");
+  }
+}
+
+const AbstractPlanNode *Optimizer::WithColumns(const AbstractPlanNode *plan, const std::vector<bool> &used,
+                                               std::vector<uint32_t> *mapping) {
+  mapping->resize(used.size());
+  for (uint32_t i = 0; i < used.size(); i++) {
+    (*mapping)[i] = i;
+  }
+  if (plan->GetType() != PlanType::SeqScan && plan->GetType() != PlanType::NestedLoopJoin &&
+      plan->GetType() != PlanType::HashJoin) {
+    return plan;
+  }
+  std::vector<uint32_t> col_idxs;
+  std::vector<const AbstractExpression *> exprs;
+  for (uint32_t i = 0; i < used.size(); i++) {
+    if (used[i]) {
+      (*mapping)[i] = col_idxs.size();
+      col_idxs.push_back(i);
+      exprs.push_back(plan->OutputSchema()->GetColumn(i).GetExpr());
+    }
+  }
+  if (col_idxs.size() == used.size()) {
+    return plan;
+  }
+  // A tuple needs a column even when none is used, as by a cross join that only counts rows.
+  if (col_idxs.empty()) {
+    col_idxs.push_back(0);
+    exprs.push_back(plan->OutputSchema()->GetColumn(0).GetExpr());
+  }
+
+  const Schema *schema = MakeSchema(plan->OutputSchema(), col_idxs, exprs);
+  std::vector<const AbstractPlanNode *> children(plan->GetChildren());
+  switch (plan->GetType()) {
+    case PlanType::SeqScan: {
+      auto seq_scan_plan = dynamic_cast<const SeqScanPlanNode *>(plan);
+      return Own(
+          std::make_unique<SeqScanPlanNode>(schema, seq_scan_plan->GetPredicate(), seq_scan_plan->GetTableOid()));
+    }
+    case PlanType::NestedLoopJoin:
+      return Own(std::make_unique<NestedLoopJoinPlanNode>(schema, std::move(children), PredicateOf(plan)));
+    default: {
+      auto hash_join_plan = dynamic_cast<const HashJoinPlanNode *>(plan);
+      return Own(std::make_unique<HashJoinPlanNode>(
+          schema, std::move(children), std::vector<const AbstractExpression *>(hash_join_plan->GetLeftKeys()),
+          std::vector<const AbstractExpression *>(hash_join_plan->GetRightKeys()), hash_join_plan->Predicate()));
+    }
+  }
+}
+
+void Optimizer::SplitConjunction(const AbstractExpression *predicate,
+                                 std::vector<const AbstractExpression *> *conjuncts) {
+  if (predicate == nullptr) {
+    return;
+  }
+  auto logic = dynamic_cast<const LogicExpression *>(predicate);
+  if (logic != nullptr && logic->GetLogicType() == LogicType::And) {
+    SplitConjunction(logic->GetChildAt(0), conjuncts);
+    SplitConjunction(logic->GetChildAt(1), conjuncts);
+    return;
+  }
+  conjuncts->push_back(predicate);
+}
+
+const AbstractExpression *Optimizer::MakeConjunction(const std::vector<const AbstractExpression *> &conjuncts) {
+  if (conjuncts.empty()) {
+    return nullptr;
+  }
+  const AbstractExpression *conjunction = conjuncts[0];
+  for (size_t i = 1; i < conjuncts.size(); i++) {
+    conjunction = Own(std::make_unique<LogicExpression>(conjunction, conjuncts[i], LogicType::And));
+  }
+  return conjunction;
+}
+
+void Optimizer::CollectColumns(const AbstractExpression *expr, std::vector<const ColumnValueExpression *> *columns) {
+  if (expr == nullptr) {
+    return;
+  }
+  auto column = dynamic_cast<const ColumnValueExpression *>(expr);
+  if (column != nullptr) {
+    columns->push_back(column);
+  }
+  for (const auto *child : expr->GetChildren()) {
+    CollectColumns(child, columns);
+  }
+}
+
+uint32_t Optimizer::ReferencedTuples(const AbstractExpression *expr) {
+  std::vector<const ColumnValueExpression *> columns;
+  CollectColumns(expr, &columns);
+  uint32_t tuples = 0;
+  for (const auto *column : columns) {
+    tuples |= 1U << column->GetTupleIdx();
+  }
+  return tuples;
+}
+
+bool Optimizer::IsScalar(const AbstractExpression *expr) {
+  if (dynamic_cast<const ColumnValueExpression *>(expr) != nullptr ||
+      dynamic_cast<const ConstantValueExpression *>(expr) != nullptr ||
+      dynamic_cast<const ParameterValueExpression *>(expr) != nullptr) {
+    return true;
+  }
+  if (dynamic_cast<const ComparisonExpression *>(expr) == nullptr &&
+      dynamic_cast<const LogicExpression *>(expr) == nullptr) {
+    return false;
+  }
+  for (const auto *child : expr->GetChildren()) {
+    if (!IsScalar(child)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+const AbstractExpression *Optimizer::RewriteColumns(const AbstractExpression *expr, const ColumnRewriter &rewriter) {
+  if (expr == nullptr) {
+    return nullptr;
+  }
+  auto column = dynamic_cast<const ColumnValueExpression *>(expr);
+  if (column != nullptr) {
+    return rewriter(column);
+  }
+  // Leaves other than column values, such as constants and aggregate values, do not refer to the columns.
+  if (expr->GetChildren().empty()) {
+    return expr;
+  }
+  auto comparison = dynamic_cast<const ComparisonExpression *>(expr);
+  auto logic = dynamic_cast<const LogicExpression *>(expr);
+  if (comparison == nullptr && logic == nullptr) {
+    return nullptr;
+  }
+  const AbstractExpression *lhs = RewriteColumns(expr->GetChildAt(0), rewriter);
+  const AbstractExpression *rhs = RewriteColumns(expr->GetChildAt(1), rewriter);
+  if (lhs == nullptr || rhs == nullptr) {
+    return nullptr;
+  }
+  if (lhs == expr->GetChildAt(0) && rhs == expr->GetChildAt(1)) {
+    return expr;
+  }
+  if (comparison != nullptr) {
+    return Own(std::make_unique<ComparisonExpression>(lhs, rhs, comparison->GetComparisonType()));
+  }
+  return Own(std::make_unique<LogicExpression>(lhs, rhs, logic->GetLogicType()));
+}
+
+const Schema *Optimizer::MakeSchema(const Schema *schema, const std::vector<uint32_t> &col_idxs,
+                                    const std::vector<const AbstractExpression *> &exprs) {
+  std::vector<Column> columns;
+  columns.reserve(col_idxs.size());
+  for (size_t i = 0; i < col_idxs.size(); i++) {
+    columns.push_back(CopyColumn(schema->GetColumn(col_idxs[i]), exprs[i]));
+  }
+  schemas_.emplace_back(std::make_unique<Schema>(columns));
+  return schemas_.back().get();
+}
+
+Column Optimizer::CopyColumn(const Column &column, const AbstractExpression *expr) {
+  if (column.GetType() == TypeId::VARCHAR) {
+    return Column(column.GetName(), column.GetType(), column.GetLength(), expr);
+  }
+  return Column(column.GetName(), column.GetType(), expr);
+}
+
+const AbstractExpression *Optimizer::MakeColumnValue(uint32_t tuple_idx, uint32_t col_idx, TypeId type) {
+  return Own(std::make_unique<ColumnValueExpression>(tuple_idx, col_idx, type));
+}
+
+}  // namespace bustub
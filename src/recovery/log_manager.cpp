@@ -22,33 +22,147 @@ namespace bustub {
  *
  * This thread runs forever until system shutdown/StopFlushThread
  */
-void LogManager::RunFlushThread() {}
+void LogManager::RunFlushThread() {
+  std::lock_guard<std::mutex> guard(latch_);
+  if (flush_running_) {
+    return;
+  }
+  enable_logging = true;
+  flush_running_ = true;
+  flush_thread_ = new std::thread(&LogManager::FlushLoop, this);
+}
 
 /*
  * Stop and join the flush thread, set enable_logging = false
  */
-void LogManager::StopFlushThread() {}
+void LogManager::StopFlushThread() {
+  {
+    std::lock_guard<std::mutex> guard(latch_);
+    if (!flush_running_) {
+      return;
+    }
+    flush_running_ = false;
+    cv_.notify_one();
+  }
+  flush_thread_->join();
+  delete flush_thread_;
+  flush_thread_ = nullptr;
+  enable_logging = false;
+}
+
+void LogManager::FlushLoop() {
+  std::unique_lock<std::mutex> guard(latch_);
+  while (flush_running_) {
+    cv_.wait_for(guard, log_timeout, [this] { return flush_requested_ || !flush_running_; });
+    // This also writes out the records appended before a shutdown.
+    FlushBuffer(&guard);
+  }
+}
+
+void LogManager::FlushBuffer(std::unique_lock<std::mutex> *guard) {
+  while (flushing_) {
+    flushed_cv_.wait(*guard);
+  }
+  flushing_ = true;
+  flush_requested_ = false;
+  // Seal the buffer in use. Later reservations go to the other buffer, which was written out by the previous flush.
+  uint64_t sealed = reservation_.load();
+  do {
+    // The other buffer continues the log file where the sealed one ends.
+    buffer_start_[1 - BufferOf(sealed)] = buffer_start_[BufferOf(sealed)] + OffsetOf(sealed);
+  } while (!reservation_.compare_exchange_weak(
+      sealed, (static_cast<uint64_t>(LsnOf(sealed)) << LSN_SHIFT) | (BufferOf(sealed) == 0 ? BUFFER_BIT : 0)));
+  int buffer = BufferOf(sealed);
+  uint32_t size = OffsetOf(sealed);
+  // Flushes are serialized, so the sealed buffer continues the records that are already durable.
+  lsn_t first_lsn = persistent_lsn_ + 1;
+  // Appenders waiting for space can go on while the full buffer is written.
+  flushed_cv_.notify_all();
+  guard->unlock();
+
+  // Appenders that reserved space in the sealed buffer may still be copying their records.
+  while (completed_[buffer].load(std::memory_order_acquire) != size) {
+    std::this_thread::yield();
+  }
+  disk_manager_->WriteLog(Buffer(buffer), size, first_lsn);
+  completed_[buffer].store(0, std::memory_order_relaxed);
+
+  guard->lock();
+  persistent_lsn_ = LsnOf(sealed) - 1;
+  flushing_ = false;
+  flushed_cv_.notify_all();
+}
+
+void LogManager::WaitForSwap(uint64_t reservation) {
+  std::unique_lock<std::mutex> guard(latch_);
+  // Buffers are only switched while holding latch_, so the check below cannot miss a swap.
+  while (BufferOf(reservation_.load()) == BufferOf(reservation)) {
+    if (flush_running_) {
+      flush_requested_ = true;
+      cv_.notify_one();
+      flushed_cv_.wait(guard);
+    } else {
+      FlushBuffer(&guard);
+    }
+  }
+}
+
+void LogManager::Flush(lsn_t lsn) {
+  std::unique_lock<std::mutex> guard(latch_);
+  // Pages may carry LSNs of records that were never appended by this log manager.
+  lsn = std::min(lsn, GetNextLSN() - 1);
+  while (persistent_lsn_ < lsn) {
+    if (flush_running_) {
+      flush_requested_ = true;
+      cv_.notify_one();
+      flushed_cv_.wait(guard);
+    } else {
+      FlushBuffer(&guard);
+    }
+  }
+}
+
+void LogManager::SetNextLSN(lsn_t lsn) {
+  std::lock_guard<std::mutex> guard(latch_);
+  BUSTUB_ASSERT(!flush_running_ && OffsetOf(reservation_) == 0, "The log must be idle.");
+  reservation_ = (static_cast<uint64_t>(lsn) << LSN_SHIFT) | (reservation_ & BUFFER_BIT);
+  // The records before lsn were written by a previous run.
+  persistent_lsn_ = lsn - 1;
+}
 
 /*
  * append a log record into log buffer
  * you MUST set the log record's lsn within this method
  * @return: lsn that is assigned to this log record
- *
- *
- * example below
- * // First, serialize the must have fields(20 bytes in total)
- * log_record.lsn_ = next_lsn_++;
- * memcpy(log_buffer_ + offset_, &log_record, 20);
- * int pos = offset_ + 20;
- *
- * if (log_record.log_record_type_ == LogRecordType::INSERT) {
- *    memcpy(log_buffer_ + pos, &log_record.insert_rid_, sizeof(RID));
- *    pos += sizeof(RID);
- *    // we have provided serialize function for tuple class
- *    log_record.insert_tuple_.SerializeTo(log_buffer_ + pos);
- *  }
- *
  */
-lsn_t LogManager::AppendLogRecord(LogRecord *log_record) { return INVALID_LSN; }
+lsn_t LogManager::AppendLogRecord(LogRecord *log_record, int *offset) {
+  BUSTUB_ASSERT(log_record->size_ <= LOG_BUFFER_SIZE, "A log record must fit into the log buffer.");
+  // Reserve the LSN and the space of the record. A compare-and-swap rather than a fetch-and-add makes sure that a
+  // record which does not fit into the buffer any more consumes neither.
+  uint64_t reservation = reservation_.load();
+  while (true) {
+    if (OffsetOf(reservation) + log_record->size_ > static_cast<uint32_t>(LOG_BUFFER_SIZE)) {
+      WaitForSwap(reservation);
+      reservation = reservation_.load();
+      continue;
+    }
+    uint64_t next = reservation + (uint64_t{1} << LSN_SHIFT) + log_record->size_;
+    if (reservation_.compare_exchange_weak(reservation, next)) {
+      break;
+    }
+  }
+
+  log_record->lsn_ = LsnOf(reservation);
+  int buffer = BufferOf(reservation);
+  if (offset != nullptr) {
+    // The buffer cannot be written out and reused before this record is completed, so its start is still valid.
+    *offset = buffer_start_[buffer] + static_cast<int>(OffsetOf(reservation));
+  }
+  SerializeLogRecord(*log_record, Buffer(buffer) + OffsetOf(reservation));
+  completed_[buffer].fetch_add(log_record->size_, std::memory_order_release);
+  return log_record->lsn_;
+}
+
+void LogManager::SerializeLogRecord(const LogRecord &log_record, char *storage) { log_record.SerializeTo(storage); }
 
 }  // namespace bustub
@@ -0,0 +1,321 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// log_record.cpp
+//
+// Identification: src/recovery/log_record.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "recovery/log_record.h"
+
+#include <cstring>
+
+#include "common/util/varint_util.h"
+
+namespace bustub {
+
+namespace {
+
+/** Ids and LSNs are stored plus one, so that the invalid ones, which are -1, are encoded as 0. */
+inline uint32_t EncodeId(int32_t id) { return static_cast<uint32_t>(id + 1); }
+
+inline int32_t DecodeId(uint32_t value) { return static_cast<int32_t>(value) - 1; }
+
+inline size_t RIDSize(const RID &rid) {
+  return VarintUtil::Length(EncodeId(rid.GetPageId())) + VarintUtil::Length(rid.GetSlotNum());
+}
+
+inline char *WriteRID(const RID &rid, char *pos) {
+  pos = VarintUtil::Encode(EncodeId(rid.GetPageId()), pos);
+  return VarintUtil::Encode(rid.GetSlotNum(), pos);
+}
+
+inline size_t BytesSize(uint32_t length) { return VarintUtil::Length(length) + length; }
+
+inline char *WriteBytes(const char *data, uint32_t length, char *pos) {
+  pos = VarintUtil::Encode(length, pos);
+  memcpy(pos, data, length);
+  return pos + length;
+}
+
+/** Reads the fields of an encoded record without running past its end. */
+class Reader {
+ public:
+  Reader(const char *pos, const char *end) : pos_(pos), end_(end) {}
+
+  bool Varint(uint32_t *value) {
+    // A varint at the end of the record may be shorter than MAX_LENGTH.
+    if (pos_ >= end_) {
+      return false;
+    }
+    const char *next = VarintUtil::Decode(pos_, value);
+    if (next == nullptr || next > end_) {
+      return false;
+    }
+    pos_ = next;
+    return true;
+  }
+
+  bool Id(int32_t *id) {
+    uint32_t value;
+    if (!Varint(&value)) {
+      return false;
+    }
+    *id = DecodeId(value);
+    return true;
+  }
+
+  bool Type(LogRecordType *type) {
+    if (pos_ >= end_) {
+      return false;
+    }
+    *type = static_cast<LogRecordType>(*pos_++);
+    return *type > LogRecordType::INVALID && *type <= LogRecordType::END_CHECKPOINT;
+  }
+
+  bool Fixed(void *value, size_t size) {
+    if (end_ - pos_ < static_cast<ptrdiff_t>(size)) {
+      return false;
+    }
+    memcpy(value, pos_, size);
+    pos_ += size;
+    return true;
+  }
+
+  bool Rid(RID *rid) {
+    int32_t page_id;
+    uint32_t slot_num;
+    if (!Id(&page_id) || !Varint(&slot_num)) {
+      return false;
+    }
+    rid->Set(page_id, slot_num);
+    return true;
+  }
+
+  /** Read a length prefixed byte string. */
+  bool Bytes(const char **data, uint32_t *length) {
+    if (!Varint(length) || end_ - pos_ < static_cast<ptrdiff_t>(*length)) {
+      return false;
+    }
+    *data = pos_;
+    pos_ += *length;
+    return true;
+  }
+
+  bool AtEnd() const { return pos_ == end_; }
+
+ private:
+  const char *pos_;
+  const char *end_;
+};
+
+}  // namespace
+
+void LogRecord::ComputeSize() {
+  // Everything but the size: the type byte, the LSN, the transaction id, the previous LSN and the body.
+  size_t rest = 1 + sizeof(lsn_t) + VarintUtil::Length(EncodeId(txn_id_)) + VarintUtil::Length(EncodeId(prev_lsn_)) +
+                GetBodySize();
+  // The size counts its own encoding.
+  size_t size = rest + 1;
+  while (rest + VarintUtil::Length(size) != size) {
+    size = rest + VarintUtil::Length(size);
+  }
+  size_ = static_cast<int32_t>(size);
+}
+
+uint32_t LogRecord::GetBodySize() const {
+  size_t size = 0;
+  switch (log_record_type_) {
+    case LogRecordType::INSERT:
+      size = RIDSize(insert_rid_) + BytesSize(insert_tuple_.GetLength());
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      size = RIDSize(delete_rid_) + BytesSize(delete_tuple_.GetLength());
+      break;
+    case LogRecordType::UPDATE:
+      size = RIDSize(update_rid_) + VarintUtil::Length(update_prefix_) + VarintUtil::Length(update_suffix_) +
+             BytesSize(old_tuple_.GetLength() - update_prefix_ - update_suffix_) +
+             BytesSize(new_tuple_.GetLength() - update_prefix_ - update_suffix_);
+      break;
+    case LogRecordType::NEWPAGE:
+      size = VarintUtil::Length(EncodeId(prev_page_id_)) + VarintUtil::Length(EncodeId(page_id_));
+      break;
+    case LogRecordType::CLR:
+      size = VarintUtil::Length(EncodeId(undo_next_lsn_)) + 1 + RIDSize(clr_rid_) + BytesSize(clr_tuple_.GetLength());
+      break;
+    case LogRecordType::END_CHECKPOINT:
+      size = VarintUtil::Length(active_txns_.size()) + VarintUtil::Length(dirty_pages_.size());
+      for (const auto &entry : active_txns_) {
+        size += VarintUtil::Length(EncodeId(entry.first)) + VarintUtil::Length(EncodeId(entry.second));
+      }
+      for (const auto &entry : dirty_pages_) {
+        size += VarintUtil::Length(EncodeId(entry.first)) + VarintUtil::Length(EncodeId(entry.second));
+      }
+      break;
+    default:
+      break;
+  }
+  return static_cast<uint32_t>(size);
+}
+
+void LogRecord::SerializeTo(char *storage) const {
+  char *pos = VarintUtil::Encode(size_, storage);
+  *pos++ = static_cast<char>(log_record_type_);
+  memcpy(pos, &lsn_, sizeof(lsn_t));
+  pos += sizeof(lsn_t);
+  pos = VarintUtil::Encode(EncodeId(txn_id_), pos);
+  pos = VarintUtil::Encode(EncodeId(prev_lsn_), pos);
+  pos = SerializeBody(pos);
+  assert(pos == storage + size_);
+}
+
+char *LogRecord::SerializeBody(char *pos) const {
+  switch (log_record_type_) {
+    case LogRecordType::INSERT:
+      pos = WriteRID(insert_rid_, pos);
+      return WriteBytes(insert_tuple_.GetData(), insert_tuple_.GetLength(), pos);
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      pos = WriteRID(delete_rid_, pos);
+      return WriteBytes(delete_tuple_.GetData(), delete_tuple_.GetLength(), pos);
+    case LogRecordType::UPDATE:
+      pos = WriteRID(update_rid_, pos);
+      pos = VarintUtil::Encode(update_prefix_, pos);
+      pos = VarintUtil::Encode(update_suffix_, pos);
+      pos = WriteBytes(old_tuple_.GetData() + update_prefix_, old_tuple_.GetLength() - update_prefix_ - update_suffix_,
+                       pos);
+      return WriteBytes(new_tuple_.GetData() + update_prefix_, new_tuple_.GetLength() - update_prefix_ - update_suffix_,
+                        pos);
+    case LogRecordType::NEWPAGE:
+      pos = VarintUtil::Encode(EncodeId(prev_page_id_), pos);
+      return VarintUtil::Encode(EncodeId(page_id_), pos);
+    case LogRecordType::CLR:
+      pos = VarintUtil::Encode(EncodeId(undo_next_lsn_), pos);
+      *pos++ = static_cast<char>(undone_type_);
+      pos = WriteRID(clr_rid_, pos);
+      return WriteBytes(clr_tuple_.GetData(), clr_tuple_.GetLength(), pos);
+    case LogRecordType::END_CHECKPOINT:
+      pos = VarintUtil::Encode(active_txns_.size(), pos);
+      for (const auto &entry : active_txns_) {
+        pos = VarintUtil::Encode(EncodeId(entry.first), pos);
+        pos = VarintUtil::Encode(EncodeId(entry.second), pos);
+      }
+      pos = VarintUtil::Encode(dirty_pages_.size(), pos);
+      for (const auto &entry : dirty_pages_) {
+        pos = VarintUtil::Encode(EncodeId(entry.first), pos);
+        pos = VarintUtil::Encode(EncodeId(entry.second), pos);
+      }
+      return pos;
+    default:
+      return pos;
+  }
+}
+
+int32_t LogRecord::PeekSize(const char *storage) {
+  uint32_t size;
+  if (VarintUtil::Decode(storage, &size) == nullptr || size > static_cast<uint32_t>(LOG_BUFFER_SIZE)) {
+    return 0;
+  }
+  return static_cast<int32_t>(size);
+}
+
+bool LogRecord::DeserializeFrom(const char *storage) {
+  size_ = PeekSize(storage);
+  if (size_ == 0) {
+    return false;
+  }
+  Reader reader(storage + VarintUtil::Length(size_), storage + size_);
+  if (!reader.Type(&log_record_type_) || !reader.Fixed(&lsn_, sizeof(lsn_t)) || lsn_ == INVALID_LSN ||
+      !reader.Id(&txn_id_) || !reader.Id(&prev_lsn_)) {
+    return false;
+  }
+
+  // Copies a length prefixed byte string into a tuple.
+  auto read_tuple = [&reader](Tuple *tuple) {
+    const char *data;
+    uint32_t length;
+    if (!reader.Bytes(&data, &length)) {
+      return false;
+    }
+    if (tuple->allocated_) {
+      delete[] tuple->data_;
+    }
+    tuple->size_ = length;
+    tuple->data_ = new char[length];
+    memcpy(tuple->data_, data, length);
+    tuple->allocated_ = true;
+    return true;
+  };
+
+  bool valid = true;
+  switch (log_record_type_) {
+    case LogRecordType::INSERT:
+      valid = reader.Rid(&insert_rid_) && read_tuple(&insert_tuple_);
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      valid = reader.Rid(&delete_rid_) && read_tuple(&delete_tuple_);
+      break;
+    case LogRecordType::UPDATE:
+      valid = reader.Rid(&update_rid_) && reader.Varint(&update_prefix_) && reader.Varint(&update_suffix_) &&
+              read_tuple(&old_tuple_) && read_tuple(&new_tuple_);
+      break;
+    case LogRecordType::NEWPAGE:
+      valid = reader.Id(&prev_page_id_) && reader.Id(&page_id_);
+      break;
+    case LogRecordType::CLR:
+      valid = reader.Id(&undo_next_lsn_) && reader.Type(&undone_type_) && reader.Rid(&clr_rid_) &&
+              read_tuple(&clr_tuple_);
+      break;
+    case LogRecordType::END_CHECKPOINT: {
+      uint32_t count;
+      valid = reader.Varint(&count);
+      for (uint32_t i = 0; valid && i < count; i++) {
+        txn_id_t txn_id;
+        lsn_t last_lsn;
+        valid = reader.Id(&txn_id) && reader.Id(&last_lsn);
+        if (valid) {
+          active_txns_[txn_id] = last_lsn;
+        }
+      }
+      valid = valid && reader.Varint(&count);
+      for (uint32_t i = 0; valid && i < count; i++) {
+        page_id_t page_id;
+        lsn_t rec_lsn;
+        valid = reader.Id(&page_id) && reader.Id(&rec_lsn);
+        if (valid) {
+          dirty_pages_[page_id] = rec_lsn;
+        }
+      }
+      break;
+    }
+    default:
+      break;
+  }
+  // A record whose fields do not add up to its size is garbage.
+  return valid && reader.AtEnd();
+}
+
+Tuple LogRecord::GetUpdateImage(const Tuple &base, bool new_image) const {
+  const Tuple &middle = new_image ? new_tuple_ : old_tuple_;
+  assert(base.GetLength() >= update_prefix_ + update_suffix_);
+  Tuple image;
+  image.size_ = update_prefix_ + middle.GetLength() + update_suffix_;
+  image.data_ = new char[image.size_];
+  image.allocated_ = true;
+  memcpy(image.data_, base.GetData(), update_prefix_);
+  memcpy(image.data_ + update_prefix_, middle.GetData(), middle.GetLength());
+  memcpy(image.data_ + update_prefix_ + middle.GetLength(), base.GetData() + base.GetLength() - update_suffix_,
+         update_suffix_);
+  return image;
+}
+
+}  // namespace bustub
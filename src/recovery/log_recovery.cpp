@@ -12,7 +12,9 @@
 
 #include "recovery/log_recovery.h"
 
-#include "storage/page/table_page.h"
+#include <queue>
+#include <unordered_set>
+#include <thread>  // NOLINT
 
 namespace bustub {
 /*
@@ -20,21 +22,397 @@ namespace bustub {
  * @return: true means deserialize succeed, otherwise can't deserialize cause
  * incomplete log record
  */
-bool LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record) { return false; }
+bool LogRecovery::DeserializeLogRecord(const char *data, LogRecord *log_record) {
+  return log_record->DeserializeFrom(data);
+}
+
+int LogRecovery::ScanLog(int offset, const std::function<void(LogRecord *, int)> &visit) {
+  // The log buffer holds end bytes of the log from file offset offset on, and pos is the next record in it.
+  buffer_offset_ = INVALID_OFFSET;
+  int pos = 0;
+  int end = 0;
+  while (true) {
+    if (end - pos < LogRecord::HEADER_SIZE || end - pos < LogRecord::PeekSize(log_buffer_ + pos)) {
+      // The next record is not entirely in the buffer, read the log from its start on.
+      if (pos == 0 && end == LOG_BUFFER_SIZE) {
+        break;
+      }
+      offset += pos;
+      pos = 0;
+      if (!disk_manager_->ReadLog(log_buffer_, LOG_BUFFER_SIZE, offset)) {
+        break;
+      }
+      end = LOG_BUFFER_SIZE;
+      continue;
+    }
+    // The end of the log reads as zeros.
+    LogRecord log_record;
+    if (!DeserializeLogRecord(log_buffer_ + pos, &log_record)) {
+      break;
+    }
+    visit(&log_record, offset + pos);
+    pos += log_record.size_;
+  }
+  return offset + pos;
+}
+
+bool LogRecovery::ReadLogRecord(lsn_t lsn, LogRecord *log_record) {
+  auto it = lsn_mapping_.find(lsn);
+  if (it == lsn_mapping_.end() && start_offset_ > disk_manager_->GetLogStart()) {
+    // A transaction to undo started before the checkpoint, map the log before it as well.
+    start_offset_ = disk_manager_->GetLogStart();
+    ScanLog(start_offset_, [this](LogRecord *record, int offset) { lsn_mapping_.emplace(record->lsn_, offset); });
+    it = lsn_mapping_.find(lsn);
+  }
+  return it != lsn_mapping_.end() && ReadLogRecordAt(it->second, log_record);
+}
+
+bool LogRecovery::ReadLogRecordAt(int offset, LogRecord *log_record) {
+  // Undo walks the log backwards, so read the record at the end of the buffer to serve the records before it too.
+  if (offset < buffer_offset_ || offset + LogRecord::HEADER_SIZE > buffer_offset_ + LOG_BUFFER_SIZE ||
+      offset + LogRecord::PeekSize(log_buffer_ + offset - buffer_offset_) > buffer_offset_ + LOG_BUFFER_SIZE) {
+    buffer_offset_ = std::max(disk_manager_->GetLogStart(), offset + LOG_BUFFER_SIZE / 4 - LOG_BUFFER_SIZE);
+    if (!disk_manager_->ReadLog(log_buffer_, LOG_BUFFER_SIZE, buffer_offset_)) {
+      buffer_offset_ = INVALID_OFFSET;
+      return false;
+    }
+    if (offset + LogRecord::PeekSize(log_buffer_ + offset - buffer_offset_) > buffer_offset_ + LOG_BUFFER_SIZE) {
+      // A large record, read it from its start on.
+      buffer_offset_ = offset;
+      if (!disk_manager_->ReadLog(log_buffer_, LOG_BUFFER_SIZE, buffer_offset_)) {
+        buffer_offset_ = INVALID_OFFSET;
+        return false;
+      }
+    }
+  }
+  return DeserializeLogRecord(log_buffer_ + offset - buffer_offset_, log_record);
+}
+
+void LogRecovery::GetPages(LogRecord *log_record, std::vector<page_id_t> *pages) {
+  switch (log_record->log_record_type_) {
+    case LogRecordType::INSERT:
+      pages->push_back(log_record->insert_rid_.GetPageId());
+      break;
+    case LogRecordType::MARKDELETE:
+    case LogRecordType::APPLYDELETE:
+    case LogRecordType::ROLLBACKDELETE:
+      pages->push_back(log_record->delete_rid_.GetPageId());
+      break;
+    case LogRecordType::UPDATE:
+      pages->push_back(log_record->update_rid_.GetPageId());
+      break;
+    case LogRecordType::CLR:
+      pages->push_back(log_record->clr_rid_.GetPageId());
+      break;
+    case LogRecordType::NEWPAGE:
+      pages->push_back(log_record->page_id_);
+      if (log_record->prev_page_id_ != INVALID_PAGE_ID) {
+        pages->push_back(log_record->prev_page_id_);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+/*
+ * analysis phase
+ * scan the log from the last complete checkpoint to the end, build the active
+ * transaction table from the last record of every transaction that did not
+ * commit or abort, and the dirty page table from the first record that touches
+ * every page, merged with the tables saved by the checkpoint
+ */
+void LogRecovery::Analyze() {
+  active_txn_.clear();
+  dirty_page_table_.clear();
+  lsn_mapping_.clear();
+  last_lsn_ = INVALID_LSN;
+
+  // Start from the checkpoint the master record points to, if the log still holds it, and from the oldest segment
+  // of the log otherwise.
+  start_offset_ = disk_manager_->GetLogStart();
+  lsn_t checkpoint_lsn;
+  int checkpoint_offset;
+  LogRecord checkpoint;
+  if (disk_manager_->ReadMasterRecord(&checkpoint_lsn, &checkpoint_offset) &&
+      ReadLogRecordAt(checkpoint_offset, &checkpoint) &&
+      checkpoint.log_record_type_ == LogRecordType::BEGIN_CHECKPOINT && checkpoint.lsn_ == checkpoint_lsn) {
+    start_offset_ = checkpoint_offset;
+  }
+
+  // The transactions that ended after the checkpoint started, their entries in the checkpoint are stale.
+  std::unordered_set<txn_id_t> ended_txns;
+  std::vector<page_id_t> pages;
+  offset_ = ScanLog(start_offset_, [&](LogRecord *log_record, int offset) {
+    lsn_mapping_[log_record->lsn_] = offset;
+    last_lsn_ = log_record->lsn_;
+    switch (log_record->log_record_type_) {
+      case LogRecordType::BEGIN_CHECKPOINT:
+        break;
+      case LogRecordType::END_CHECKPOINT:
+        for (const auto &entry : log_record->active_txns_) {
+          if (ended_txns.count(entry.first) == 0) {
+            auto it = active_txn_.emplace(entry.first, entry.second).first;
+            it->second = std::max(it->second, entry.second);
+          }
+        }
+        for (const auto &entry : log_record->dirty_pages_) {
+          auto it = dirty_page_table_.emplace(entry.first, entry.second).first;
+          it->second = std::min(it->second, entry.second);
+        }
+        break;
+      case LogRecordType::COMMIT:
+      case LogRecordType::ABORT:
+        active_txn_.erase(log_record->txn_id_);
+        ended_txns.insert(log_record->txn_id_);
+        break;
+      default:
+        active_txn_[log_record->txn_id_] = log_record->lsn_;
+        break;
+    }
+    pages.clear();
+    GetPages(log_record, &pages);
+    for (auto page_id : pages) {
+      dirty_page_table_.emplace(page_id, log_record->lsn_);
+    }
+  });
+}
 
 /*
  *redo phase on TABLE PAGE level(table/table_page.h)
- *read log file from the beginning to end (you must prefetch log records into
- *log buffer to reduce unnecessary I/O operations), remember to compare page's
- *LSN with log_record's sequence number, and also build active_txn_ table &
- *lsn_mapping_ table
+ *read log file from the smallest recLSN in the dirty page table to the end, and
+ *redo every record that is newer than its page. Records are partitioned by page
+ *id, each partition is redone by its own thread in LSN order
  */
-void LogRecovery::Redo() {}
+void LogRecovery::Redo() {
+  BUSTUB_ASSERT(!enable_logging, "Recovery must run with logging disabled.");
+  Analyze();
+  if (log_manager_ != nullptr) {
+    log_manager_->SetNextLSN(last_lsn_ + 1);
+  }
+  if (dirty_page_table_.empty()) {
+    return;
+  }
+
+  lsn_t redo_lsn = last_lsn_;
+  for (const auto &entry : dirty_page_table_) {
+    redo_lsn = std::min(redo_lsn, entry.second);
+  }
+  std::vector<LogRecord> batch;
+  batch.reserve(REDO_BATCH_SIZE);
+  std::vector<std::vector<std::pair<page_id_t, size_t>>> parts(redo_threads_);
+  std::vector<page_id_t> pages;
+  // A page written by a checkpoint keeps the recLSN of its image, which may be older than the checkpoint. The log is
+  // kept from the oldest recLSN on, so redo reads it from the start when the recLSN is not a record after analysis.
+  auto start = lsn_mapping_.find(redo_lsn);
+  int redo_offset = start == lsn_mapping_.end() ? disk_manager_->GetLogStart() : start->second;
+  ScanLog(redo_offset, [&](LogRecord *log_record, int /* offset */) {
+    pages.clear();
+    GetPages(log_record, &pages);
+    bool redo = false;
+    for (auto page_id : pages) {
+      auto it = dirty_page_table_.find(page_id);
+      if (it != dirty_page_table_.end() && log_record->lsn_ >= it->second) {
+        parts[static_cast<size_t>(page_id) % redo_threads_].emplace_back(page_id, batch.size());
+        redo = true;
+      }
+    }
+    if (!redo) {
+      return;
+    }
+    batch.push_back(*log_record);
+    if (batch.size() == REDO_BATCH_SIZE) {
+      RedoBatch(&batch, parts);
+      batch.clear();
+      for (auto &part : parts) {
+        part.clear();
+      }
+    }
+  });
+  RedoBatch(&batch, parts);
+}
+
+void LogRecovery::RedoBatch(std::vector<LogRecord> *batch,
+                            const std::vector<std::vector<std::pair<page_id_t, size_t>>> &parts) {
+  auto redo_part = [this, batch](const std::vector<std::pair<page_id_t, size_t>> &part) {
+    for (const auto &task : part) {
+      RedoPage(task.first, &(*batch)[task.second]);
+    }
+  };
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < parts.size(); i++) {
+    if (!parts[i].empty()) {
+      threads.emplace_back(redo_part, std::cref(parts[i]));
+    }
+  }
+  redo_part(parts[0]);
+  for (auto &thread : threads) {
+    thread.join();
+  }
+}
+
+void LogRecovery::RedoPage(page_id_t page_id, LogRecord *log_record) {
+  auto *page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+  BUSTUB_ASSERT(page != nullptr, "Recovery needs one frame per redo thread.");
+  page->WLatch();
+  lsn_t lsn = log_record->lsn_;
+  bool dirty = false;
+  if (log_record->log_record_type_ == LogRecordType::NEWPAGE) {
+    if (page_id == log_record->prev_page_id_) {
+      // Linking the new page is not logged on the previous page, so it is redone whenever the page is not linked.
+      if (page->GetNextPageId() != log_record->page_id_) {
+        page->SetNextPageId(log_record->page_id_);
+        dirty = true;
+      }
+    } else if (page->GetLSN() <= lsn) {
+      // A page whose LSN is the one of its NEWPAGE record holds no tuples yet, and a page that was never written has
+      // LSN 0, so it is initialized again even if the NEWPAGE record is the first record of the log.
+      page->Init(page_id, PAGE_SIZE, log_record->prev_page_id_, nullptr, nullptr);
+      page->SetLSN(lsn);
+      dirty = true;
+    }
+  } else if (page->GetLSN() < lsn) {
+    switch (log_record->log_record_type_) {
+      case LogRecordType::INSERT:
+        page->InsertTupleAt(log_record->insert_tuple_, log_record->insert_rid_);
+        break;
+      case LogRecordType::MARKDELETE:
+        page->MarkDelete(log_record->delete_rid_, nullptr, nullptr, 0, nullptr);
+        break;
+      case LogRecordType::APPLYDELETE:
+        page->ApplyDelete(log_record->delete_rid_, nullptr, 0, nullptr);
+        break;
+      case LogRecordType::ROLLBACKDELETE:
+        page->RollbackDelete(log_record->delete_rid_, nullptr, 0, nullptr);
+        break;
+      case LogRecordType::UPDATE: {
+        // The record only holds the changed bytes, the rest of the new tuple comes from the old one on the page.
+        Tuple old_tuple;
+        page->GetTuple(log_record->update_rid_, &old_tuple, nullptr, nullptr, 0);
+        page->UpdateTuple(log_record->GetUpdateImage(old_tuple, true), &old_tuple, log_record->update_rid_, nullptr,
+                          nullptr, 0, nullptr);
+        break;
+      }
+      case LogRecordType::CLR:
+        ApplyCompensation(page, log_record->undone_type_, log_record->clr_rid_, log_record->clr_tuple_);
+        break;
+      default:
+        break;
+    }
+    page->SetLSN(lsn);
+    dirty = true;
+  }
+  page->WUnlatch();
+  buffer_pool_manager_->UnpinPage(page_id, dirty);
+}
+
+void LogRecovery::ApplyCompensation(TablePage *page, LogRecordType undone_type, const RID &rid, const Tuple &tuple) {
+  switch (undone_type) {
+    case LogRecordType::INSERT:
+      page->ApplyDelete(rid, nullptr, 0, nullptr);
+      break;
+    case LogRecordType::MARKDELETE:
+      page->RollbackDelete(rid, nullptr, 0, nullptr);
+      break;
+    case LogRecordType::APPLYDELETE:
+      page->InsertTupleAt(tuple, rid);
+      break;
+    case LogRecordType::ROLLBACKDELETE:
+      page->MarkDelete(rid, nullptr, nullptr, 0, nullptr);
+      break;
+    case LogRecordType::UPDATE: {
+      Tuple new_tuple;
+      page->UpdateTuple(tuple, &new_tuple, rid, nullptr, nullptr, 0, nullptr);
+      break;
+    }
+    default:
+      break;
+  }
+}
 
 /*
  *undo phase on TABLE PAGE level(table/table_page.h)
- *iterate through active txn map and undo each operation
+ *undo the records of the transactions in the active txn map, always the newest
+ *record of them first, and log a CLR for each undone record
  */
-void LogRecovery::Undo() {}
+void LogRecovery::Undo() {
+  BUSTUB_ASSERT(!enable_logging, "Recovery must run with logging disabled.");
+  std::priority_queue<lsn_t> to_undo;
+  for (const auto &entry : active_txn_) {
+    to_undo.push(entry.second);
+  }
+
+  while (!to_undo.empty()) {
+    LogRecord log_record;
+    if (!ReadLogRecord(to_undo.top(), &log_record)) {
+      UNREACHABLE("The log misses a record of a transaction to undo.");
+    }
+    to_undo.pop();
+    txn_id_t txn_id = log_record.txn_id_;
+    lsn_t undo_next_lsn = log_record.prev_lsn_;
+
+    RID rid;
+    Tuple tuple;
+    switch (log_record.log_record_type_) {
+      case LogRecordType::CLR:
+        // The records up to the one the CLR compensates were undone before the crash.
+        undo_next_lsn = log_record.undo_next_lsn_;
+        break;
+      case LogRecordType::INSERT:
+        rid = log_record.insert_rid_;
+        break;
+      case LogRecordType::MARKDELETE:
+      case LogRecordType::ROLLBACKDELETE:
+        rid = log_record.delete_rid_;
+        break;
+      case LogRecordType::APPLYDELETE:
+        rid = log_record.delete_rid_;
+        tuple = log_record.delete_tuple_;
+        break;
+      case LogRecordType::UPDATE:
+        rid = log_record.update_rid_;
+        break;
+      default:
+        // BEGIN and NEWPAGE records need not be undone, the new page stays in the table.
+        break;
+    }
+
+    if (rid.GetPageId() != INVALID_PAGE_ID) {
+      auto *page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
+      BUSTUB_ASSERT(page != nullptr, "Recovery needs a free frame.");
+      page->WLatch();
+      if (log_record.log_record_type_ == LogRecordType::UPDATE) {
+        // Rebuild the old tuple from the new one on the page, the CLR logs it in full.
+        Tuple new_tuple;
+        page->GetTuple(rid, &new_tuple, nullptr, nullptr, 0);
+        tuple = log_record.GetUpdateImage(new_tuple, false);
+      }
+      ApplyCompensation(page, log_record.log_record_type_, rid, tuple);
+      if (log_manager_ != nullptr) {
+        LogRecord clr(txn_id, active_txn_[txn_id], LogRecordType::CLR, undo_next_lsn, log_record.log_record_type_, rid,
+                      tuple);
+        active_txn_[txn_id] = log_manager_->AppendLogRecord(&clr);
+        page->SetLSN(active_txn_[txn_id]);
+      }
+      page->WUnlatch();
+      buffer_pool_manager_->UnpinPage(rid.GetPageId(), true);
+    }
+
+    if (undo_next_lsn != INVALID_LSN) {
+      to_undo.push(undo_next_lsn);
+      continue;
+    }
+    // The transaction is rolled back entirely.
+    if (log_manager_ != nullptr) {
+      LogRecord abort(txn_id, active_txn_[txn_id], LogRecordType::ABORT);
+      log_manager_->AppendLogRecord(&abort);
+    }
+    active_txn_.erase(txn_id);
+  }
+
+  if (log_manager_ != nullptr) {
+    log_manager_->Flush(log_manager_->GetNextLSN() - 1);
+  }
+}
 
 }  // namespace bustub
@@ -10,7 +10,10 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <dirent.h>
 #include <sys/stat.h>
+#include <algorithm>
+#include <cstdio>
 #include <cassert>
 #include <cstring>
 #include <iostream>
@@ -19,6 +22,8 @@
 
 #include "common/exception.h"
 #include "common/logger.h"
+#include "common/util/compression_util.h"
+#include "common/util/crc32c_util.h"
 #include "storage/disk/disk_manager.h"
 
 namespace bustub {
@@ -26,7 +31,7 @@ namespace bustub {
 static char *buffer_used;
 
 /**
- * Constructor: open/create a single database file & log file
+ * Constructor: open/create a single database file & log file segments
  * @input db_file: database file name
  */
 DiskManager::DiskManager(const std::string &db_file)
@@ -37,20 +42,11 @@ DiskManager::DiskManager(const std::string &db_file)
     return;
   }
   log_name_ = file_name_.substr(0, n) + ".log";
+  master_name_ = file_name_.substr(0, n) + ".master";
+  dwb_name_ = file_name_.substr(0, n) + ".dwb";
 
-  log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-  // directory or file does not exist
-  if (!log_io_.is_open()) {
-    log_io_.clear();
-    // create a new file
-    log_io_.open(log_name_, std::ios::binary | std::ios::trunc | std::ios::app | std::ios::out);
-    log_io_.close();
-    // reopen with original mode
-    log_io_.open(log_name_, std::ios::binary | std::ios::in | std::ios::app | std::ios::out);
-    if (!log_io_.is_open()) {
-      throw Exception("can't open dblog file");
-    }
-  }
+  // The log segment files are opened when they are written or read.
+  LoadLogSegments();
 
   db_io_.open(db_file, std::ios::binary | std::ios::in | std::ios::out);
   // directory or file does not exist
@@ -65,6 +61,7 @@ DiskManager::DiskManager(const std::string &db_file)
       throw Exception("can't open db file");
     }
   }
+  OpenDoubleWriteBuffer();
   buffer_used = nullptr;
 }
 
@@ -72,8 +69,16 @@ DiskManager::DiskManager(const std::string &db_file)
  * Close all file streams
  */
 void DiskManager::ShutDown() {
-  db_io_.close();
+  {
+    std::lock_guard<std::mutex> guard(db_latch_);
+    db_io_.close();
+    dwb_io_.close();
+  }
+  std::lock_guard<std::mutex> guard(log_latch_);
   log_io_.close();
+  read_io_.close();
+  write_segment_ = -1;
+  read_segment_ = -1;
 }
 
 /**
@@ -81,10 +86,20 @@ void DiskManager::ShutDown() {
  */
 void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
   size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
+  char disk_page[PAGE_SIZE];
+  memcpy(disk_page, page_data, PAGE_SIZE);
+  uint32_t checksum = PageChecksum(page_id, page_data);
+  memcpy(disk_page + PAGE_CHECKSUM_OFFSET, &checksum, PAGE_CHECKSUM_SIZE);
+
+  std::lock_guard<std::mutex> guard(db_latch_);
+  // the copy in the double-write buffer must be durable before the page is overwritten
+  if (enable_double_write && !WriteDoubleWrite(page_id, disk_page)) {
+    return;
+  }
   // set write cursor to offset
   num_writes_ += 1;
   db_io_.seekp(offset);
-  db_io_.write(page_data, PAGE_SIZE);
+  db_io_.write(disk_page, PAGE_SIZE);
   // check for I/O error
   if (db_io_.bad()) {
     LOG_DEBUG("I/O error while writing");
@@ -98,35 +113,145 @@ void DiskManager::WritePage(page_id_t page_id, const char *page_data) {
  * Read the contents of the specified page into the given memory area
  */
 void DiskManager::ReadPage(page_id_t page_id, char *page_data) {
-  int offset = page_id * PAGE_SIZE;
+  size_t offset = static_cast<size_t>(page_id) * PAGE_SIZE;
+  std::lock_guard<std::mutex> guard(db_latch_);
   // check if read beyond file length
-  if (offset > GetFileSize(file_name_)) {
+  if (offset > static_cast<size_t>(GetFileSize(file_name_))) {
     LOG_DEBUG("I/O error reading past end of file");
     // std::cerr << "I/O error while reading" << std::endl;
-  } else {
-    // set read cursor to offset
+    return;
+  }
+  // set read cursor to offset
+  db_io_.seekp(offset);
+  db_io_.read(page_data, PAGE_SIZE);
+  if (db_io_.bad()) {
+    LOG_DEBUG("I/O error while reading");
+    return;
+  }
+  // if file ends before reading a whole page
+  int read_count = db_io_.gcount();
+  if (read_count < PAGE_SIZE) {
+    LOG_DEBUG("Read less than a page");
+    db_io_.clear();
+    // std::cerr << "Read less than a page" << std::endl;
+    memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+  }
+
+  if (!VerifyPage(page_id, page_data)) {
+    num_checksum_failures_++;
+    LOG_DEBUG("Checksum mismatch of page %d", page_id);
+    if (!ReadDoubleWrite(page_id, page_data)) {
+      throw Exception("page " + std::to_string(page_id) + " is corrupt and cannot be repaired");
+    }
+    // put the intact copy back in place
     db_io_.seekp(offset);
-    db_io_.read(page_data, PAGE_SIZE);
-    if (db_io_.bad()) {
-      LOG_DEBUG("I/O error while reading");
-      return;
+    db_io_.write(page_data, PAGE_SIZE);
+    db_io_.flush();
+    num_repaired_pages_++;
+  }
+  memset(page_data + PAGE_CHECKSUM_OFFSET, 0, PAGE_CHECKSUM_SIZE);
+}
+
+uint32_t DiskManager::PageChecksum(page_id_t page_id, const char *page_data) {
+  char page[PAGE_SIZE];
+  memcpy(page, page_data, PAGE_SIZE);
+  memcpy(page + PAGE_CHECKSUM_OFFSET, &page_id, PAGE_CHECKSUM_SIZE);
+  return Crc32cUtil::Crc32c(page, PAGE_SIZE);
+}
+
+bool DiskManager::VerifyPage(page_id_t page_id, const char *page_data) {
+  uint32_t checksum;
+  memcpy(&checksum, page_data + PAGE_CHECKSUM_OFFSET, PAGE_CHECKSUM_SIZE);
+  if (checksum == PageChecksum(page_id, page_data)) {
+    return true;
+  }
+  // a page that was allocated but never written reads as zeros, which is a valid empty page
+  return checksum == 0 && std::all_of(page_data, page_data + PAGE_SIZE, [](char c) { return c == 0; });
+}
+
+/**
+ * The double-write buffer is a header block followed by a ring of DOUBLE_WRITE_SLOTS slots of PAGE_SIZE bytes
+ *------------------------------------------------------------------------------
+ * | page_id_0 | sequence_0 | ... | padding | page data of slot 0 | ... |
+ *------------------------------------------------------------------------------
+ * so that the slots stay aligned like the pages of the database file. The header block tells which page every slot
+ * holds, and the checksum of the copy, which covers the page id, tells a slot whose header or data is stale. Sequence
+ * numbers start at 1, so slots that were never written are skipped.
+ */
+static_assert(DiskManager::DOUBLE_WRITE_SLOTS * 2 * sizeof(uint32_t) <= PAGE_SIZE,
+              "the double-write header must fit in a block");
+
+void DiskManager::OpenDoubleWriteBuffer() {
+  dwb_io_.open(dwb_name_, std::ios::binary | std::ios::in | std::ios::out);
+  if (!dwb_io_.is_open()) {
+    dwb_io_.clear();
+    dwb_io_.open(dwb_name_, std::ios::binary | std::ios::trunc | std::ios::out);
+    dwb_io_.close();
+    dwb_io_.open(dwb_name_, std::ios::binary | std::ios::in | std::ios::out);
+    if (!dwb_io_.is_open()) {
+      throw Exception("can't open double-write buffer file");
     }
-    // if file ends before reading PAGE_SIZE
-    int read_count = db_io_.gcount();
-    if (read_count < PAGE_SIZE) {
-      LOG_DEBUG("Read less than a page");
-      db_io_.clear();
-      // std::cerr << "Read less than a page" << std::endl;
-      memset(page_data + read_count, 0, PAGE_SIZE - read_count);
+  }
+  // continue after the latest slot
+  dwb_slots_.assign(DOUBLE_WRITE_SLOTS, {INVALID_PAGE_ID, 0});
+  dwb_io_.seekg(0);
+  dwb_io_.read(reinterpret_cast<char *>(dwb_slots_.data()), DOUBLE_WRITE_SLOTS * sizeof(dwb_slots_[0]));
+  if (dwb_io_.gcount() != static_cast<std::streamsize>(DOUBLE_WRITE_SLOTS * sizeof(dwb_slots_[0]))) {
+    dwb_io_.clear();
+    dwb_slots_.assign(DOUBLE_WRITE_SLOTS, {INVALID_PAGE_ID, 0});
+  }
+  for (int slot = 0; slot < DOUBLE_WRITE_SLOTS; slot++) {
+    if (dwb_slots_[slot].second > dwb_sequence_) {
+      dwb_sequence_ = dwb_slots_[slot].second;
+      dwb_next_slot_ = (slot + 1) % DOUBLE_WRITE_SLOTS;
     }
   }
 }
 
+bool DiskManager::WriteDoubleWrite(page_id_t page_id, const char *page_data) {
+  static_assert(sizeof(std::pair<page_id_t, uint32_t>) == 2 * sizeof(uint32_t));
+  dwb_io_.seekp(static_cast<size_t>(dwb_next_slot_ + 1) * PAGE_SIZE);
+  dwb_io_.write(page_data, PAGE_SIZE);
+  dwb_slots_[dwb_next_slot_] = {page_id, dwb_sequence_ + 1};
+  dwb_io_.seekp(dwb_next_slot_ * sizeof(dwb_slots_[0]));
+  dwb_io_.write(reinterpret_cast<char *>(&dwb_slots_[dwb_next_slot_]), sizeof(dwb_slots_[0]));
+  dwb_io_.flush();
+  if (dwb_io_.bad()) {
+    LOG_DEBUG("I/O error while writing the double-write buffer");
+    return false;
+  }
+  dwb_sequence_++;
+  dwb_next_slot_ = (dwb_next_slot_ + 1) % DOUBLE_WRITE_SLOTS;
+  return true;
+}
+
+bool DiskManager::ReadDoubleWrite(page_id_t page_id, char *page_data) {
+  char copy[PAGE_SIZE];
+  uint32_t best_sequence = 0;
+  for (int slot = 0; slot < DOUBLE_WRITE_SLOTS; slot++) {
+    if (dwb_slots_[slot].first != page_id || dwb_slots_[slot].second <= best_sequence) {
+      continue;
+    }
+    dwb_io_.seekg(static_cast<size_t>(slot + 1) * PAGE_SIZE);
+    dwb_io_.read(copy, PAGE_SIZE);
+    if (dwb_io_.gcount() != PAGE_SIZE) {
+      dwb_io_.clear();
+      continue;
+    }
+    if (!VerifyPage(page_id, copy)) {
+      continue;
+    }
+    best_sequence = dwb_slots_[slot].second;
+    memcpy(page_data, copy, PAGE_SIZE);
+  }
+  return best_sequence != 0;
+}
+
 /**
  * Write the contents of the log into disk file
  * Only return when sync is done, and only perform sequence write
  */
-void DiskManager::WriteLog(char *log_data, int size) {
+void DiskManager::WriteLog(char *log_data, int size, lsn_t first_lsn) {
   // enforce swap log buffer
   assert(log_data != buffer_used);
   buffer_used = log_data;
@@ -143,8 +268,44 @@ void DiskManager::WriteLog(char *log_data, int size) {
   }
 
   num_flushes_ += 1;
+  // The block header holds the raw size and the stored size.
+  int32_t header[2] = {size, size};
+  std::lock_guard<std::mutex> guard(log_latch_);
+  const char *data = log_data;
+  if (enable_log_compression) {
+    scratch_.resize(CompressionUtil::MaxCompressedLength(size));
+    auto compressed = static_cast<int32_t>(CompressionUtil::Compress(log_data, size, scratch_.data()));
+    if (compressed < size) {
+      header[1] = compressed;
+      data = scratch_.data();
+    }
+  }
+
+  if (log_segments_.empty() || log_segments_.back().file_size_ >= log_segment_size || log_tail_torn_) {
+    // Start a new segment.
+    int index = log_segments_.empty() ? 0 : log_segments_.back().index_ + 1;
+    log_segments_.push_back({index, log_size_, first_lsn, 0});
+    log_tail_torn_ = false;
+  }
+  LogSegment &segment = log_segments_.back();
+  if (write_segment_ != segment.index_) {
+    log_io_.close();
+    auto mode = std::ios::binary | std::ios::out | (segment.file_size_ == 0 ? std::ios::trunc : std::ios::app);
+    log_io_.open(GetSegmentName(segment.index_), mode);
+    if (!log_io_.is_open()) {
+      throw Exception("can't open dblog file");
+    }
+    write_segment_ = segment.index_;
+  }
+  if (segment.file_size_ == 0) {
+    int32_t segment_header[2] = {segment.logical_offset_, first_lsn};
+    segment.first_lsn_ = first_lsn;
+    log_io_.write(reinterpret_cast<const char *>(segment_header), sizeof(segment_header));
+    segment.file_size_ = sizeof(segment_header);
+  }
   // sequence write
-  log_io_.write(log_data, size);
+  log_io_.write(reinterpret_cast<const char *>(header), sizeof(header));
+  log_io_.write(data, header[1]);
 
   // check for I/O error
   if (log_io_.bad()) {
@@ -153,6 +314,11 @@ void DiskManager::WriteLog(char *log_data, int size) {
   }
   // needs to flush to keep disk file in sync
   log_io_.flush();
+  log_blocks_.push_back(
+      {log_size_, segment.index_, segment.file_size_ + static_cast<int64_t>(sizeof(header)), header[0], header[1]});
+  log_size_ += header[0];
+  segment.file_size_ += sizeof(header) + header[1];
+  log_bytes_written_ += sizeof(header) + header[1];
   flush_log_ = false;
 }
 
@@ -162,28 +328,212 @@ void DiskManager::WriteLog(char *log_data, int size) {
  * @return: false means already reach the end
  */
 bool DiskManager::ReadLog(char *log_data, int size, int offset) {
-  if (offset >= GetFileSize(log_name_)) {
-    // LOG_DEBUG("end of log file");
-    // LOG_DEBUG("file size is %d", GetFileSize(log_name_));
+  std::lock_guard<std::mutex> guard(log_latch_);
+  if (offset >= log_size_ || log_blocks_.empty() || offset < log_blocks_.front().logical_offset_) {
     return false;
   }
-  log_io_.seekp(offset);
-  log_io_.read(log_data, size);
-
-  if (log_io_.bad()) {
-    LOG_DEBUG("I/O error while reading log");
-    return false;
+  // Find the block holding offset, the last one starting at or before it.
+  auto it = std::upper_bound(log_blocks_.begin(), log_blocks_.end(), offset,
+                             [](int offset, const LogBlock &block) { return offset < block.logical_offset_; });
+  int read_count = 0;
+  for (auto block = static_cast<size_t>(it - log_blocks_.begin() - 1); read_count < size && block < log_blocks_.size();
+       block++) {
+    if (!LoadLogBlock(block)) {
+      LOG_DEBUG("I/O error while reading log");
+      return false;
+    }
+    int start = offset + read_count - log_blocks_[block].logical_offset_;
+    int count = std::min(size - read_count, log_blocks_[block].raw_size_ - start);
+    memcpy(log_data + read_count, block_cache_.data() + start, count);
+    read_count += count;
   }
   // if log file ends before reading "size"
-  int read_count = log_io_.gcount();
-  if (read_count < size) {
-    log_io_.clear();
-    memset(log_data + read_count, 0, size - read_count);
+  memset(log_data + read_count, 0, size - read_count);
+  return true;
+}
+
+int DiskManager::GetLogSize() {
+  std::lock_guard<std::mutex> guard(log_latch_);
+  return log_size_;
+}
+
+int DiskManager::GetLogStart() {
+  std::lock_guard<std::mutex> guard(log_latch_);
+  return log_blocks_.empty() ? log_size_ : log_blocks_.front().logical_offset_;
+}
+
+void DiskManager::TruncateLog(lsn_t lsn) {
+  std::lock_guard<std::mutex> guard(log_latch_);
+  // The records of a segment are older than the first record of the next one.
+  while (log_segments_.size() > 1 && log_segments_[1].first_lsn_ != INVALID_LSN && log_segments_[1].first_lsn_ <= lsn) {
+    int index = log_segments_.front().index_;
+    std::string segment_name = GetSegmentName(index);
+    if (read_segment_ == index) {
+      read_io_.close();
+      read_segment_ = -1;
+    }
+    int rc;
+    if (archive_dir_.empty()) {
+      rc = remove(segment_name.c_str());
+    } else {
+      std::string::size_type slash = segment_name.rfind('/');
+      rc = rename(segment_name.c_str(),
+                  (archive_dir_ + "/" + (slash == std::string::npos ? segment_name : segment_name.substr(slash + 1)))
+                      .c_str());
+    }
+    if (rc != 0) {
+      LOG_DEBUG("I/O error while truncating log segment %s", segment_name.c_str());
+    }
+    while (!log_blocks_.empty() && log_blocks_.front().segment_ == index) {
+      log_blocks_.pop_front();
+    }
+    log_segments_.pop_front();
+    cached_block_ = -1;
   }
+}
+
+void DiskManager::SetLogArchiveDirectory(const std::string &archive_dir) {
+  std::lock_guard<std::mutex> guard(log_latch_);
+  archive_dir_ = archive_dir;
+}
+
+size_t DiskManager::GetNumLogSegments() {
+  std::lock_guard<std::mutex> guard(log_latch_);
+  return log_segments_.size();
+}
+
+int64_t DiskManager::GetLogDiskUsage() {
+  std::lock_guard<std::mutex> guard(log_latch_);
+  int64_t usage = 0;
+  for (const auto &segment : log_segments_) {
+    usage += segment.file_size_;
+  }
+  return usage;
+}
+
+std::string DiskManager::GetSegmentName(int index) const {
+  return index == 0 ? log_name_ : log_name_ + "." + std::to_string(index);
+}
 
+void DiskManager::LoadLogSegments() {
+  // Find the segment files <db>.log and <db>.log.<index>.
+  std::string::size_type slash = log_name_.rfind('/');
+  std::string dir_name = slash == std::string::npos ? "." : log_name_.substr(0, slash);
+  std::string base_name = slash == std::string::npos ? log_name_ : log_name_.substr(slash + 1);
+  std::vector<int> indexes;
+  DIR *dir = opendir(dir_name.c_str());
+  if (dir != nullptr) {
+    while (dirent *entry = readdir(dir)) {
+      std::string name = entry->d_name;
+      if (name == base_name) {
+        indexes.push_back(0);
+      } else if (name.size() > base_name.size() + 1 && name.compare(0, base_name.size() + 1, base_name + ".") == 0 &&
+                 name.find_first_not_of("0123456789", base_name.size() + 1) == std::string::npos) {
+        indexes.push_back(std::stoi(name.substr(base_name.size() + 1)));
+      }
+    }
+    closedir(dir);
+  }
+  std::sort(indexes.begin(), indexes.end());
+
+  for (int index : indexes) {
+    std::ifstream segment_io(GetSegmentName(index), std::ios::binary | std::ios::in);
+    int32_t header[2];
+    segment_io.read(reinterpret_cast<char *>(header), sizeof(header));
+    // A segment without a header was never written to, and the segments must continue each other.
+    if (!segment_io || (!log_segments_.empty() && header[0] != log_size_)) {
+      break;
+    }
+    if (log_segments_.empty()) {
+      log_size_ = header[0];
+    }
+    log_segments_.push_back({index, header[0], header[1], GetFileSize(GetSegmentName(index))});
+    if (!LoadLogBlocks(&segment_io, log_segments_.back())) {
+      log_tail_torn_ = true;
+      break;
+    }
+  }
+}
+
+bool DiskManager::LoadLogBlocks(std::ifstream *segment_io, const LogSegment &segment) {
+  int64_t pos = sizeof(int32_t) * 2;
+  int32_t header[2];
+  while (pos < segment.file_size_) {
+    segment_io->read(reinterpret_cast<char *>(header), sizeof(header));
+    // A block that was torn by a crash ends the log.
+    if (!*segment_io || header[0] <= 0 || header[1] <= 0 || header[1] > header[0] ||
+        pos + static_cast<int64_t>(sizeof(header)) + header[1] > segment.file_size_) {
+      return false;
+    }
+    log_blocks_.push_back({log_size_, segment.index_, pos + static_cast<int64_t>(sizeof(header)), header[0], header[1]});
+    log_size_ += header[0];
+    pos += sizeof(header) + header[1];
+    segment_io->seekg(pos);
+  }
+  return true;
+}
+
+bool DiskManager::LoadLogBlock(size_t block) {
+  if (cached_block_ == static_cast<int>(block)) {
+    return true;
+  }
+  const LogBlock &log_block = log_blocks_[block];
+  cached_block_ = -1;
+  if (read_segment_ != log_block.segment_) {
+    read_io_.close();
+    read_io_.clear();
+    read_io_.open(GetSegmentName(log_block.segment_), std::ios::binary | std::ios::in);
+    read_segment_ = read_io_.is_open() ? log_block.segment_ : -1;
+  }
+  block_cache_.resize(log_block.raw_size_);
+  bool compressed = log_block.stored_size_ < log_block.raw_size_;
+  char *data = block_cache_.data();
+  if (compressed) {
+    scratch_.resize(log_block.stored_size_);
+    data = scratch_.data();
+  }
+  read_io_.clear();
+  read_io_.seekg(log_block.physical_offset_);
+  read_io_.read(data, log_block.stored_size_);
+  if (read_io_.gcount() != log_block.stored_size_) {
+    read_io_.clear();
+    return false;
+  }
+  if (compressed && !CompressionUtil::Decompress(data, log_block.stored_size_, block_cache_.data(),
+                                                 log_block.raw_size_)) {
+    return false;
+  }
+  cached_block_ = static_cast<int>(block);
   return true;
 }
 
+/**
+ * Write the location of the last complete checkpoint into the master record file
+ */
+void DiskManager::WriteMasterRecord(lsn_t lsn, int offset) {
+  std::ofstream master_io(master_name_, std::ios::binary | std::ios::trunc | std::ios::out);
+  master_io.write(reinterpret_cast<const char *>(&lsn), sizeof(lsn_t));
+  master_io.write(reinterpret_cast<const char *>(&offset), sizeof(int));
+  master_io.flush();
+  if (master_io.bad()) {
+    LOG_DEBUG("I/O error while writing master record");
+  }
+}
+
+/**
+ * Read the location of the last complete checkpoint from the master record file
+ * @return: false if there is no master record
+ */
+bool DiskManager::ReadMasterRecord(lsn_t *lsn, int *offset) {
+  std::ifstream master_io(master_name_, std::ios::binary | std::ios::in);
+  if (!master_io.is_open()) {
+    return false;
+  }
+  master_io.read(reinterpret_cast<char *>(lsn), sizeof(lsn_t));
+  master_io.read(reinterpret_cast<char *>(offset), sizeof(int));
+  return static_cast<bool>(master_io);
+}
+
 /**
  * Allocate new page (operations like create index/table)
  * For now just keep an increasing counter
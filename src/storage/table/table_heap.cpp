@@ -11,6 +11,7 @@
 //===----------------------------------------------------------------------===//
 
 #include <cassert>
+#include <utility>
 
 #include "common/logger.h"
 #include "storage/table/table_heap.h"
@@ -18,15 +19,16 @@
 namespace bustub {
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-                     page_id_t first_page_id)
+                     page_id_t first_page_id, table_oid_t oid)
     : buffer_pool_manager_(buffer_pool_manager),
       lock_manager_(lock_manager),
       log_manager_(log_manager),
-      first_page_id_(first_page_id) {}
+      first_page_id_(first_page_id),
+      oid_(oid) {}
 
 TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_manager, LogManager *log_manager,
-                     Transaction *txn)
-    : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager) {
+                     Transaction *txn, table_oid_t oid)
+    : buffer_pool_manager_(buffer_pool_manager), lock_manager_(lock_manager), log_manager_(log_manager), oid_(oid) {
   // Initialize the first table page.
   auto first_page = reinterpret_cast<TablePage *>(buffer_pool_manager_->NewPage(&first_page_id_));
   BUSTUB_ASSERT(first_page != nullptr, "Couldn't create a page for the table heap.");
@@ -37,10 +39,13 @@ TableHeap::TableHeap(BufferPoolManager *buffer_pool_manager, LockManager *lock_m
 }
 
 bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
-  if (tuple.size_ + 32 > PAGE_SIZE) {  // larger than one page size
+  if (tuple.size_ + 36 > PAGE_SIZE) {  // larger than one page size
     txn->SetState(TransactionState::ABORTED);
     return false;
   }
+  if (!LockTableIntention(txn, LockMode::INTENTION_EXCLUSIVE)) {
+    return false;
+  }
 
   auto cur_page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(first_page_id_));
   if (cur_page == nullptr) {
@@ -51,7 +56,7 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
   cur_page->WLatch();
   // Insert into the first page with enough space. If no such page exists, create a new page and insert into that.
   // INVARIANT: cur_page is WLatched if you leave the loop normally.
-  while (!cur_page->InsertTuple(tuple, rid, txn, lock_manager_, log_manager_)) {
+  while (!cur_page->InsertTuple(tuple, rid, txn, lock_manager_, oid_, log_manager_)) {
     auto next_page_id = cur_page->GetNextPageId();
     // If the next page is a valid page,
     if (next_page_id != INVALID_PAGE_ID) {
@@ -81,6 +86,13 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
       cur_page = new_page;
     }
   }
+  if (txn->KeepsVersions()) {
+    // The slot held no tuple before.
+    version_store_.RecordWrite(*rid, txn, nullptr, false);
+  }
+  if (zone_map_ != nullptr) {
+    zone_map_->Widen(cur_page->GetTablePageId(), tuple);
+  }
   // This line has caused most of us to double-take and "whoa double unlatch".
   // We are not, in fact, double unlatching. See the invariant above.
   cur_page->WUnlatch();
@@ -92,6 +104,9 @@ bool TableHeap::InsertTuple(const Tuple &tuple, RID *rid, Transaction *txn) {
 
 bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
   // TODO(Amadou): remove empty page
+  if (!LockTableIntention(txn, LockMode::INTENTION_EXCLUSIVE)) {
+    return false;
+  }
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
@@ -101,7 +116,17 @@ bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
   }
   // Otherwise, mark the tuple as deleted.
   page->WLatch();
-  page->MarkDelete(rid, txn, lock_manager_, log_manager_);
+  if (txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION && !version_store_.CanWrite(rid, txn)) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  Tuple old_tuple;
+  bool has_tuple = txn->KeepsVersions() && page->GetTuple(rid, &old_tuple, txn, nullptr, oid_);
+  if (page->MarkDelete(rid, txn, lock_manager_, oid_, log_manager_) && has_tuple) {
+    version_store_.RecordWrite(rid, txn, &old_tuple, true);
+  }
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
   // Update the transaction's write set.
@@ -110,6 +135,11 @@ bool TableHeap::MarkDelete(const RID &rid, Transaction *txn) {
 }
 
 bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn) {
+  // Updates of aborted transactions roll back their earlier updates, under the locks they took.
+  bool is_rollback = txn->GetState() == TransactionState::ABORTED;
+  if (!is_rollback && !LockTableIntention(txn, LockMode::INTENTION_EXCLUSIVE)) {
+    return false;
+  }
   // Find the page which contains the tuple.
   auto page = reinterpret_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
@@ -120,7 +150,24 @@ bool TableHeap::UpdateTuple(const Tuple &tuple, const RID &rid, Transaction *txn
   // Update the tuple; but first save the old value for rollbacks.
   Tuple old_tuple;
   page->WLatch();
-  bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, log_manager_);
+  if (txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION && !is_rollback &&
+      !version_store_.CanWrite(rid, txn)) {
+    page->WUnlatch();
+    buffer_pool_manager_->UnpinPage(page->GetTablePageId(), false);
+    txn->SetState(TransactionState::ABORTED);
+    return false;
+  }
+  bool is_updated = page->UpdateTuple(tuple, &old_tuple, rid, txn, lock_manager_, oid_, log_manager_);
+  if (txn->KeepsVersions() && is_rollback) {
+    version_store_.Rollback(rid, txn);
+  } else if (txn->KeepsVersions() && is_updated) {
+    version_store_.RecordWrite(rid, txn, &old_tuple, false);
+  }
+  if (is_updated && zone_map_ != nullptr) {
+    // The value the tuple had may have been the only one at a bound of the zone.
+    zone_map_->Widen(rid.GetPageId(), tuple);
+    zone_map_->Loosen(rid.GetPageId());
+  }
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), is_updated);
   // Update the transaction's write set.
@@ -136,8 +183,15 @@ void TableHeap::ApplyDelete(const RID &rid, Transaction *txn) {
   BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
   // Delete the tuple from the page.
   page->WLatch();
-  page->ApplyDelete(rid, txn, log_manager_);
-  lock_manager_->Unlock(txn, rid);
+  page->ApplyDelete(rid, txn, oid_, log_manager_);
+  if (txn->KeepsVersions() && txn->GetState() == TransactionState::ABORTED) {
+    // This is the rollback of an insert.
+    version_store_.Rollback(rid, txn);
+  }
+  if (zone_map_ != nullptr) {
+    zone_map_->Loosen(rid.GetPageId());
+  }
+  lock_manager_->UnlockRow(txn, oid_, rid);
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
@@ -148,12 +202,19 @@ void TableHeap::RollbackDelete(const RID &rid, Transaction *txn) {
   BUSTUB_ASSERT(page != nullptr, "Couldn't find a page containing that RID.");
   // Rollback the delete.
   page->WLatch();
-  page->RollbackDelete(rid, txn, log_manager_);
+  page->RollbackDelete(rid, txn, oid_, log_manager_);
+  if (txn->KeepsVersions()) {
+    version_store_.Rollback(rid, txn);
+  }
   page->WUnlatch();
   buffer_pool_manager_->UnpinPage(page->GetTablePageId(), true);
 }
 
 bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
+  bool is_snapshot = txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION;
+  if (!is_snapshot && !LockTableIntention(txn, LockMode::INTENTION_SHARED)) {
+    return false;
+  }
   // Find the page which contains the tuple.
   auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(rid.GetPageId()));
   // If the page could not be found, then abort the transaction.
@@ -163,13 +224,130 @@ bool TableHeap::GetTuple(const RID &rid, Tuple *tuple, Transaction *txn) {
   }
   // Read the tuple from the page.
   page->RLatch();
-  bool res = page->GetTuple(rid, tuple, txn, lock_manager_);
+  bool res =
+      is_snapshot ? GetVisibleTuple(page, rid, tuple, txn) : page->GetTuple(rid, tuple, txn, lock_manager_, oid_);
   page->RUnlatch();
   buffer_pool_manager_->UnpinPage(rid.GetPageId(), false);
   return res;
 }
 
+void TableHeap::ReadPage(TablePage *page, Transaction *txn, std::vector<Tuple> *tuples) {
+  bool is_snapshot = txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION;
+  if (!is_snapshot && !LockTableIntention(txn, LockMode::INTENTION_SHARED)) {
+    return;
+  }
+  page->RLatch();
+  Tuple tuple;
+  if (is_snapshot) {
+    // Deleted slots may still hold a visible version.
+    for (uint32_t slot_num = 0; slot_num < page->GetSlotCount(); slot_num++) {
+      if (GetVisibleTuple(page, RID(page->GetTablePageId(), slot_num), &tuple, txn)) {
+        tuples->push_back(tuple);
+      }
+    }
+  } else {
+    RID rid;
+    bool found = page->GetFirstTupleRid(&rid);
+    while (found) {
+      if (page->GetTuple(rid, &tuple, txn, lock_manager_, oid_)) {
+        tuples->push_back(tuple);
+      }
+      RID next_rid;
+      found = page->GetNextTupleRid(rid, &next_rid);
+      rid = next_rid;
+    }
+  }
+  // The scan has paid for reading the page already.
+  if (zone_map_ != nullptr && zone_map_->IsLoose(page->GetTablePageId())) {
+    RebuildZone(page, txn);
+  }
+  page->RUnlatch();
+}
+
+ZoneMap *TableHeap::CreateZoneMap(const Schema *schema, std::vector<uint32_t> col_idxs, Transaction *txn) {
+  zone_map_ = std::make_unique<ZoneMap>(schema, std::move(col_idxs));
+  auto page_id = first_page_id_;
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    BUSTUB_ASSERT(page != nullptr, "Couldn't fetch a page of the table heap.");
+    page->RLatch();
+    // The zone stays unbounded until the old versions that it would have to cover are gone.
+    zone_map_->AddUnbounded(page_id);
+    RebuildZone(page, txn);
+    auto next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+  }
+  return zone_map_.get();
+}
+
+bool TableHeap::RebuildZone(TablePage *page, Transaction *txn) {
+  // An uncommitted write always keeps an old version, so the tuples in place are then all committed ones.
+  if (version_store_.GetVersionCount() > 0) {
+    return false;
+  }
+  std::vector<Tuple> tuples;
+  Tuple tuple;
+  for (uint32_t slot_num = 0; slot_num < page->GetSlotCount(); slot_num++) {
+    // Reading without the lock manager neither locks nor aborts.
+    if (page->GetTuple(RID(page->GetTablePageId(), slot_num), &tuple, txn, nullptr, oid_)) {
+      tuples.push_back(tuple);
+    }
+  }
+  zone_map_->Rebuild(page->GetTablePageId(), tuples);
+  return true;
+}
+
+bool TableHeap::LockTableIntention(Transaction *txn, LockMode lock_mode) {
+  // The table pages only lock rows while logging is enabled.
+  if (!enable_logging || lock_manager_ == nullptr) {
+    return true;
+  }
+  return lock_manager_->LockTable(txn, lock_mode, oid_);
+}
+
+bool TableHeap::GetVisibleTuple(TablePage *page, const RID &rid, Tuple *tuple, Transaction *txn) {
+  switch (version_store_.GetVisibleVersion(rid, txn, tuple)) {
+    case VersionStore::Visibility::IN_PLACE:
+      // Snapshot reads do not take shared locks.
+      return page->GetTuple(rid, tuple, txn, nullptr, oid_);
+    case VersionStore::Visibility::UNDO:
+      tuple->rid_ = rid;
+      return true;
+    case VersionStore::Visibility::NONE:
+      break;
+  }
+  return false;
+}
+
+void TableHeap::SeekVisibleTuple(RID rid, Tuple *tuple, Transaction *txn) {
+  auto page_id = rid.GetPageId();
+  auto slot_num = rid.GetSlotNum();
+  while (page_id != INVALID_PAGE_ID) {
+    auto page = static_cast<TablePage *>(buffer_pool_manager_->FetchPage(page_id));
+    page->RLatch();
+    for (; slot_num < page->GetSlotCount(); slot_num++) {
+      if (GetVisibleTuple(page, RID(page_id, slot_num), tuple, txn)) {
+        page->RUnlatch();
+        buffer_pool_manager_->UnpinPage(page_id, false);
+        return;
+      }
+    }
+    auto next_page_id = page->GetNextPageId();
+    page->RUnlatch();
+    buffer_pool_manager_->UnpinPage(page_id, false);
+    page_id = next_page_id;
+    slot_num = 0;
+  }
+  tuple->rid_ = RID(INVALID_PAGE_ID, 0);
+}
+
 TableIterator TableHeap::Begin(Transaction *txn) {
+  if (txn->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION) {
+    // The iterator seeks the first visible tuple itself.
+    return TableIterator(this, RID(first_page_id_, 0), txn);
+  }
   // Start an iterator from the first page.
   // TODO(Wuwen): Hacky fix for now. Removing empty pages is a better way to handle this.
   RID rid;
@@ -18,7 +18,9 @@ namespace bustub {
 
 TableIterator::TableIterator(TableHeap *table_heap, RID rid, Transaction *txn)
     : table_heap_(table_heap), tuple_(new Tuple(rid)), txn_(txn) {
-  if (rid.GetPageId() != INVALID_PAGE_ID) {
+  if (rid.GetPageId() != INVALID_PAGE_ID && txn_->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION) {
+    table_heap_->SeekVisibleTuple(rid, tuple_, txn_);
+  } else if (rid.GetPageId() != INVALID_PAGE_ID) {
     table_heap_->GetTuple(tuple_->rid_, tuple_, txn_);
   }
 }
@@ -34,6 +36,10 @@ Tuple *TableIterator::operator->() {
 }
 
 TableIterator &TableIterator::operator++() {
+  if (txn_->GetIsolationLevel() == IsolationLevel::SNAPSHOT_ISOLATION) {
+    table_heap_->SeekVisibleTuple(RID(tuple_->rid_.GetPageId(), tuple_->rid_.GetSlotNum() + 1), tuple_, txn_);
+    return *this;
+  }
   BufferPoolManager *buffer_pool_manager = table_heap_->buffer_pool_manager_;
   auto cur_page = static_cast<TablePage *>(buffer_pool_manager->FetchPage(tuple_->rid_.GetPageId()));
   cur_page->RLatch();
@@ -0,0 +1,95 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// tmp_tuple_list.cpp
+//
+// Identification: src/storage/table/tmp_tuple_list.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/tmp_tuple_list.h"
+
+#include "common/exception.h"
+
+namespace bustub {
+
+void TmpTupleList::Append(const Tuple &tuple) {
+  TmpTuple location(INVALID_PAGE_ID, 0);
+  if (current_ != nullptr && appending_ && current_->Insert(tuple, &location)) {
+    size_++;
+    data_size_ += tuple.GetLength();
+    return;
+  }
+
+  // The last page is full, or not pinned for appending.
+  UnpinCurrent();
+  page_id_t page_id;
+  auto *page = reinterpret_cast<TmpTuplePage *>(bpm_->NewPage(&page_id));
+  if (page == nullptr) {
+    throw Exception(ExceptionType::OUT_OF_MEMORY, "no free buffer pool frame for a temporary page");
+  }
+  page->Init(page_id, PAGE_SIZE);
+  page_ids_.push_back(page_id);
+  current_ = page;
+  appending_ = true;
+  if (!page->Insert(tuple, &location)) {
+    throw Exception(ExceptionType::OUT_OF_RANGE, "tuple is too large for a temporary page");
+  }
+  size_++;
+  data_size_ += tuple.GetLength();
+}
+
+void TmpTupleList::Rewind() {
+  UnpinCurrent();
+  read_page_ = 0;
+  read_offsets_.clear();
+}
+
+bool TmpTupleList::Next(Tuple *tuple) {
+  BUSTUB_ASSERT(!appending_, "Rewind the list before reading it.");
+  while (current_ == nullptr || read_offsets_.empty()) {
+    if (current_ != nullptr) {
+      UnpinCurrent();
+      read_page_++;
+    }
+    if (read_page_ >= page_ids_.size()) {
+      return false;
+    }
+    current_ = reinterpret_cast<TmpTuplePage *>(bpm_->FetchPage(page_ids_[read_page_]));
+    if (current_ == nullptr) {
+      throw Exception(ExceptionType::OUT_OF_MEMORY, "no free buffer pool frame to read a temporary page");
+    }
+    // A page lists its tuples from the last inserted one, so the offsets are collected and read from the end.
+    for (uint32_t offset = current_->GetFreeSpacePointer(); offset < PAGE_SIZE; offset = current_->NextOffset(offset)) {
+      read_offsets_.push_back(offset);
+    }
+  }
+  current_->Get(read_offsets_.back(), tuple);
+  read_offsets_.pop_back();
+  return true;
+}
+
+void TmpTupleList::Clear() {
+  UnpinCurrent();
+  for (page_id_t page_id : page_ids_) {
+    bpm_->DeletePage(page_id);
+  }
+  page_ids_.clear();
+  size_ = 0;
+  data_size_ = 0;
+  read_page_ = 0;
+  read_offsets_.clear();
+}
+
+void TmpTupleList::UnpinCurrent() {
+  if (current_ != nullptr) {
+    bpm_->UnpinPage(current_->GetPageId(), appending_);
+    current_ = nullptr;
+    appending_ = false;
+  }
+}
+
+}  // namespace bustub
@@ -0,0 +1,239 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// zone_map.cpp
+//
+// Identification: src/storage/table/zone_map.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include "storage/table/zone_map.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/expressions/parameter_value_expression.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return true if values of two types are compared as numbers */
+bool IsNumber(TypeId type) {
+  return type == TypeId::TINYINT || type == TypeId::SMALLINT || type == TypeId::INTEGER || type == TypeId::BIGINT ||
+         type == TypeId::DECIMAL;
+}
+
+/** @return true if the bounds of a column can be compared with a constant of some type */
+bool IsComparable(TypeId column_type, TypeId constant_type) {
+  if (column_type == TypeId::VARCHAR || constant_type == TypeId::VARCHAR) {
+    return false;
+  }
+  return column_type == constant_type || (IsNumber(column_type) && IsNumber(constant_type));
+}
+
+/** @return the comparison with its operands swapped */
+ComparisonType Mirror(ComparisonType type) {
+  switch (type) {
+    case ComparisonType::LessThan:
+      return ComparisonType::GreaterThan;
+    case ComparisonType::LessThanOrEqual:
+      return ComparisonType::GreaterThanOrEqual;
+    case ComparisonType::GreaterThan:
+      return ComparisonType::LessThan;
+    case ComparisonType::GreaterThanOrEqual:
+      return ComparisonType::LessThanOrEqual;
+    default:
+      return type;
+  }
+}
+
+/** @return the value of a constant, or of a parameter as bound when the scan starts; nullptr for other expressions */
+const Value *GetConstant(const AbstractExpression *expr) {
+  if (auto *constant = dynamic_cast<const ConstantValueExpression *>(expr)) {
+    return &constant->GetValue();
+  }
+  if (auto *parameter = dynamic_cast<const ParameterValueExpression *>(expr)) {
+    return &parameter->GetValue();
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+ZoneMap::ZoneMap(const Schema *schema, std::vector<uint32_t> col_idxs)
+    : schema_(schema), col_idxs_(std::move(col_idxs)) {
+  for (uint32_t col_idx : col_idxs_) {
+    [[maybe_unused]] const Column &column = schema_->GetColumn(col_idx);
+    BUSTUB_ASSERT(column.IsInlined() && column.GetType() != TypeId::VARCHAR, "Only inlined columns can be mapped.");
+  }
+}
+
+std::vector<ZoneBound> ZoneMap::GetBounds(const AbstractExpression *predicate) const {
+  std::vector<ZoneBound> bounds;
+  std::vector<const AbstractExpression *> pending;
+  if (predicate != nullptr) {
+    pending.push_back(predicate);
+  }
+  while (!pending.empty()) {
+    const AbstractExpression *expr = pending.back();
+    pending.pop_back();
+    auto logic = dynamic_cast<const LogicExpression *>(expr);
+    if (logic != nullptr && logic->GetLogicType() == LogicType::And) {
+      pending.push_back(logic->GetChildAt(0));
+      pending.push_back(logic->GetChildAt(1));
+      continue;
+    }
+    auto comparison = dynamic_cast<const ComparisonExpression *>(expr);
+    if (comparison == nullptr) {
+      continue;
+    }
+    ComparisonType type = comparison->GetComparisonType();
+    auto column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(0));
+    const Value *constant = GetConstant(comparison->GetChildAt(1));
+    if (column == nullptr || constant == nullptr) {
+      column = dynamic_cast<const ColumnValueExpression *>(comparison->GetChildAt(1));
+      constant = GetConstant(comparison->GetChildAt(0));
+      type = Mirror(type);
+    }
+    if (column == nullptr || constant == nullptr || column->GetTupleIdx() != 0 ||
+        std::find(col_idxs_.begin(), col_idxs_.end(), column->GetColIdx()) == col_idxs_.end() ||
+        !IsComparable(schema_->GetColumn(column->GetColIdx()).GetType(), constant->GetTypeId())) {
+      continue;
+    }
+    bounds.push_back({column->GetColIdx(), type, *constant});
+  }
+  return bounds;
+}
+
+void ZoneMap::Widen(page_id_t page_id, const Tuple &tuple) {
+  std::lock_guard<std::mutex> guard(latch_);
+  WidenZone(GetZone(page_id), tuple);
+}
+
+void ZoneMap::Loosen(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = zone_of_page_.find(page_id);
+  if (it != zone_of_page_.end()) {
+    zones_[it->second].loose_ = true;
+  }
+}
+
+bool ZoneMap::IsLoose(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  auto it = zone_of_page_.find(page_id);
+  return it != zone_of_page_.end() && zones_[it->second].loose_;
+}
+
+void ZoneMap::Rebuild(page_id_t page_id, const std::vector<Tuple> &tuples) {
+  std::lock_guard<std::mutex> guard(latch_);
+  Zone *zone = GetZone(page_id);
+  zone->bounded_ = true;
+  zone->loose_ = false;
+  for (size_t i = 0; i < col_idxs_.size(); i++) {
+    zone->min_[i] = zone->max_[i] = ValueFactory::GetNullValueByType(schema_->GetColumn(col_idxs_[i]).GetType());
+  }
+  for (const auto &tuple : tuples) {
+    WidenZone(zone, tuple);
+  }
+}
+
+void ZoneMap::AddUnbounded(page_id_t page_id) {
+  std::lock_guard<std::mutex> guard(latch_);
+  Zone *zone = GetZone(page_id);
+  zone->bounded_ = false;
+  zone->loose_ = true;
+}
+
+page_id_t ZoneMap::NextPage(size_t *zone, const std::vector<ZoneBound> &bounds, size_t *num_skipped) {
+  std::lock_guard<std::mutex> guard(latch_);
+  for (; *zone < zones_.size(); (*zone)++) {
+    const Zone &current = zones_[*zone];
+    bool may_match = true;
+    for (const auto &bound : bounds) {
+      auto column = std::find(col_idxs_.begin(), col_idxs_.end(), bound.col_idx_) - col_idxs_.begin();
+      if (!MayMatch(current, column, bound)) {
+        may_match = false;
+        break;
+      }
+    }
+    if (may_match) {
+      return zones_[(*zone)++].page_id_;
+    }
+    (*num_skipped)++;
+  }
+  return INVALID_PAGE_ID;
+}
+
+size_t ZoneMap::GetNumZones() {
+  std::lock_guard<std::mutex> guard(latch_);
+  return zones_.size();
+}
+
+ZoneMap::Zone *ZoneMap::GetZone(page_id_t page_id) {
+  auto it = zone_of_page_.find(page_id);
+  if (it != zone_of_page_.end()) {
+    return &zones_[it->second];
+  }
+  zone_of_page_.emplace(page_id, zones_.size());
+  Zone &zone = zones_.emplace_back();
+  zone.page_id_ = page_id;
+  for (uint32_t col_idx : col_idxs_) {
+    zone.min_.emplace_back(ValueFactory::GetNullValueByType(schema_->GetColumn(col_idx).GetType()));
+    zone.max_.emplace_back(zone.min_.back());
+  }
+  return &zone;
+}
+
+void ZoneMap::WidenZone(Zone *zone, const Tuple &tuple) {
+  for (size_t i = 0; i < col_idxs_.size(); i++) {
+    Value value = tuple.GetValue(schema_, col_idxs_[i]);
+    if (value.IsNull()) {
+      continue;
+    }
+    if (zone->min_[i].IsNull() || value.CompareLessThan(zone->min_[i]) == CmpBool::CmpTrue) {
+      zone->min_[i] = value;
+    }
+    if (zone->max_[i].IsNull() || value.CompareGreaterThan(zone->max_[i]) == CmpBool::CmpTrue) {
+      zone->max_[i] = value;
+    }
+  }
+}
+
+bool ZoneMap::MayMatch(const Zone &zone, size_t column, const ZoneBound &bound) const {
+  if (!zone.bounded_) {
+    return true;
+  }
+  // Comparisons with NULL are never true, and a column without a non-NULL value satisfies none.
+  const Value &min = zone.min_[column];
+  const Value &max = zone.max_[column];
+  if (min.IsNull() || bound.value_.IsNull()) {
+    return false;
+  }
+  const Value &value = bound.value_;
+  switch (bound.type_) {
+    case ComparisonType::Equal:
+      return min.CompareLessThanEquals(value) == CmpBool::CmpTrue &&
+             max.CompareGreaterThanEquals(value) == CmpBool::CmpTrue;
+    case ComparisonType::NotEqual:
+      return min.CompareNotEquals(value) == CmpBool::CmpTrue || max.CompareNotEquals(value) == CmpBool::CmpTrue;
+    case ComparisonType::LessThan:
+      return min.CompareLessThan(value) == CmpBool::CmpTrue;
+    case ComparisonType::LessThanOrEqual:
+      return min.CompareLessThanEquals(value) == CmpBool::CmpTrue;
+    case ComparisonType::GreaterThan:
+      return max.CompareGreaterThan(value) == CmpBool::CmpTrue;
+    case ComparisonType::GreaterThanOrEqual:
+      return max.CompareGreaterThanEquals(value) == CmpBool::CmpTrue;
+  }
+  return true;
+}
+
+}  // namespace bustub
@@ -11,9 +11,13 @@
 //===----------------------------------------------------------------------===//
 
 #include "buffer/buffer_pool_manager.h"
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <cstring>
 #include <random>
 #include <string>
+#include <thread>  // NOLINT
 #include "gtest/gtest.h"
 
 namespace bustub {
@@ -47,6 +51,8 @@ TEST(BufferPoolManagerTest, BinaryDataTest) {
   // Insert terminal characters both in the middle and at end
   random_binary_data[PAGE_SIZE / 2] = '\0';
   random_binary_data[PAGE_SIZE - 1] = '\0';
+  // The checksum field of the page header is filled by the disk manager and cleared when the page is read.
+  std::memset(random_binary_data + DiskManager::PAGE_CHECKSUM_OFFSET, 0, DiskManager::PAGE_CHECKSUM_SIZE);
 
   // Scenario: Once we have a page, we should be able to read and write content.
   std::memcpy(page0->GetData(), random_binary_data, PAGE_SIZE);
@@ -141,4 +147,91 @@ TEST(BufferPoolManagerTest, SampleTest) {
   delete disk_manager;
 }
 
+// NOLINTNEXTLINE
+// Check that flushing a pinned page waits for the writer that is changing it
+TEST(BufferPoolManagerTest, FlushPinnedPageTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(10, disk_manager);
+
+  page_id_t page_id;
+  auto *page = bpm->NewPage(&page_id);
+  ASSERT_NE(nullptr, page);
+  // A writer is halfway through changing the page.
+  page->WLatch();
+  snprintf(page->GetData(), PAGE_SIZE, "half");
+  std::atomic<bool> flushed{false};
+  std::thread flusher([&] {
+    EXPECT_TRUE(bpm->FlushPage(page_id));
+    flushed = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(flushed);
+  // The writer may still use the buffer pool while the flush waits for it.
+  EXPECT_NE(nullptr, bpm->FetchPage(page_id));
+  EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+  snprintf(page->GetData(), PAGE_SIZE, "whole");
+  page->WUnlatch();
+  flusher.join();
+
+  // Only the whole change was written.
+  char data[PAGE_SIZE];
+  disk_manager->ReadPage(page_id, data);
+  EXPECT_STREQ("whole", data);
+  EXPECT_TRUE(bpm->UnpinPage(page_id, true));
+
+  // Shutdown the disk manager and remove the temporary files we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.dwb");
+
+  delete bpm;
+  delete disk_manager;
+}
+
+// NOLINTNEXTLINE
+TEST(BufferPoolManagerTest, EvictionWritesWithoutLatchTest) {
+  auto *disk_manager = new DiskManager("test.db");
+  auto *bpm = new BufferPoolManager(2, disk_manager);
+
+  page_id_t victim_id;
+  page_id_t other_id;
+  auto *victim = bpm->NewPage(&victim_id);
+  ASSERT_NE(nullptr, victim);
+  snprintf(victim->GetData() + PAGE_SIZE / 2, PAGE_SIZE / 2, "victim");
+  EXPECT_TRUE(bpm->UnpinPage(victim_id, true));
+  ASSERT_NE(nullptr, bpm->NewPage(&other_id));
+  EXPECT_TRUE(bpm->UnpinPage(other_id, false));
+  ASSERT_NE(nullptr, bpm->FetchPage(other_id));
+
+  // The write of the dirty victim waits for its page latch, as a slow write would take long.
+  victim->WLatch();
+  std::atomic<bool> evicted{false};
+  page_id_t new_id;
+  std::thread evictor([&] {
+    EXPECT_NE(nullptr, bpm->NewPage(&new_id));
+    evicted = true;
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  EXPECT_FALSE(evicted);
+  // Meanwhile, the rest of the buffer pool is not blocked.
+  EXPECT_TRUE(bpm->UnpinPage(other_id, false));
+  ASSERT_NE(nullptr, bpm->FetchPage(other_id));
+  victim->WUnlatch();
+  evictor.join();
+
+  char data[PAGE_SIZE];
+  disk_manager->ReadPage(victim_id, data);
+  EXPECT_STREQ("victim", data + PAGE_SIZE / 2);
+  EXPECT_TRUE(bpm->UnpinPage(new_id, false));
+  EXPECT_TRUE(bpm->UnpinPage(other_id, false));
+
+  // Shutdown the disk manager and remove the temporary files we created.
+  disk_manager->ShutDown();
+  remove("test.db");
+  remove("test.dwb");
+
+  delete bpm;
+  delete disk_manager;
+}
+
 }  // namespace bustub
@@ -0,0 +1,266 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// table_stats_test.cpp
+//
+// Identification: test/catalog/table_stats_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "catalog/catalog.h"
+#include "common/util/hyperloglog.h"
+#include "concurrency/transaction_manager.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/plans/aggregation_plan.h"
+#include "execution/plans/hash_join_plan.h"
+#include "execution/plans/seq_scan_plan.h"
+#include "gtest/gtest.h"
+#include "optimizer/cardinality_estimator.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class TableStatsTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    ::testing::Test::SetUp();
+    disk_manager_ = std::make_unique<DiskManager>("table_stats_test.db");
+    bpm_ = std::make_unique<BufferPoolManager>(32, disk_manager_.get());
+    lock_manager_ = std::make_unique<LockManager>();
+    txn_mgr_ = std::make_unique<TransactionManager>(lock_manager_.get(), nullptr);
+    catalog_ = std::make_unique<Catalog>(bpm_.get(), lock_manager_.get(), nullptr);
+    txn_ = txn_mgr_->Begin();
+  }
+
+  void TearDown() override {
+    txn_mgr_->Commit(txn_);
+    delete txn_;
+    disk_manager_->ShutDown();
+    remove("table_stats_test.db");
+  }
+
+  /** Make a table of size rows: a = i, b = i % 100 and c = NULL for every fourth row, i % 10 otherwise. */
+  TableMetadata *MakeTable(const std::string &name, int32_t size) {
+    Schema schema({Column("a", TypeId::INTEGER), Column("b", TypeId::INTEGER), Column("c", TypeId::INTEGER)});
+    auto table_info = catalog_->CreateTable(txn_, name, schema);
+    for (int32_t i = 0; i < size; i++) {
+      RID rid;
+      std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i % 100),
+                                i % 4 == 0 ? ValueFactory::GetNullValueByType(TypeId::INTEGER)
+                                           : ValueFactory::GetIntegerValue(i % 10)};
+      EXPECT_TRUE(table_info->table_->InsertTuple(Tuple(values, &table_info->schema_), &rid, txn_));
+    }
+    return table_info;
+  }
+
+  /** Analyze a table, reading at most sample_pages of its pages. */
+  const TableStats *Analyze(const std::string &name, size_t sample_pages) {
+    size_t saved = analyze_sample_pages;
+    analyze_sample_pages = sample_pages;
+    auto stats = catalog_->Analyze(txn_, name);
+    analyze_sample_pages = saved;
+    return stats.get();
+  }
+
+  /** @return a scan of all the columns of a table made by MakeTable, keeping the rows for which predicate is true */
+  const AbstractPlanNode *MakeScan(TableMetadata *table_info, const AbstractExpression *predicate = nullptr) {
+    std::vector<Column> columns;
+    for (uint32_t i = 0; i < table_info->schema_.GetColumnCount(); i++) {
+      const Column &column = table_info->schema_.GetColumn(i);
+      columns.emplace_back(column.GetName(), column.GetType(), ColumnRef(0, i));
+    }
+    return Own(std::make_unique<SeqScanPlanNode>(Own(std::make_unique<Schema>(columns)), predicate, table_info->oid_));
+  }
+
+  const AbstractExpression *ColumnRef(uint32_t tuple_idx, uint32_t col_idx) {
+    return Own(std::make_unique<ColumnValueExpression>(tuple_idx, col_idx, TypeId::INTEGER));
+  }
+
+  const AbstractExpression *Compare(const AbstractExpression *lhs, int32_t constant, ComparisonType type) {
+    return Own(std::make_unique<ComparisonExpression>(
+        lhs, Own(std::make_unique<ConstantValueExpression>(ValueFactory::GetIntegerValue(constant))), type));
+  }
+
+  const AbstractExpression *Own(std::unique_ptr<AbstractExpression> &&expr) {
+    exprs_.emplace_back(std::move(expr));
+    return exprs_.back().get();
+  }
+
+  const Schema *Own(std::unique_ptr<Schema> &&schema) {
+    schemas_.emplace_back(std::move(schema));
+    return schemas_.back().get();
+  }
+
+  const AbstractPlanNode *Own(std::unique_ptr<AbstractPlanNode> &&plan) {
+    plans_.emplace_back(std::move(plan));
+    return plans_.back().get();
+  }
+
+  std::unique_ptr<DiskManager> disk_manager_;
+  std::unique_ptr<BufferPoolManager> bpm_;
+  std::unique_ptr<LockManager> lock_manager_;
+  std::unique_ptr<TransactionManager> txn_mgr_;
+  std::unique_ptr<Catalog> catalog_;
+  Transaction *txn_{nullptr};
+
+ private:
+  std::vector<std::unique_ptr<AbstractExpression>> exprs_;
+  std::vector<std::unique_ptr<Schema>> schemas_;
+  std::vector<std::unique_ptr<AbstractPlanNode>> plans_;
+};
+
+// NOLINTNEXTLINE
+TEST_F(TableStatsTest, HyperLogLogTest) {
+  for (int32_t count : {10, 1000, 100000}) {
+    HyperLogLog hll;
+    // Duplicates do not count.
+    for (int repeat = 0; repeat < 3; repeat++) {
+      for (int32_t i = 0; i < count; i++) {
+        hll.Add(static_cast<hash_t>(i));
+      }
+    }
+    EXPECT_NEAR(hll.Estimate(), count, count * 0.05) << count;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableStatsTest, AnalyzeTest) {
+  constexpr int32_t size = 10000;
+  MakeTable("t", size);
+
+  // A table that fits the sample is read whole, so its statistics are exact but for the number of distinct values.
+  const TableStats *stats = Analyze("t", 1000);
+  ASSERT_NE(stats, nullptr);
+  EXPECT_EQ(stats->GetNumSampledPages(), stats->GetNumPages());
+  EXPECT_EQ(stats->GetNumSampledRows(), size);
+  EXPECT_EQ(stats->GetRowCount(), size);
+
+  const ColumnStats &a = stats->GetColumnStats(0);
+  EXPECT_EQ(a.GetMin().GetAs<int32_t>(), 0);
+  EXPECT_EQ(a.GetMax().GetAs<int32_t>(), size - 1);
+  EXPECT_EQ(a.GetNullFraction(), 0);
+  EXPECT_NEAR(a.GetNumDistinct(), size, size * 0.05);
+  ASSERT_EQ(a.GetHistogram().size(), ColumnStats::HISTOGRAM_BUCKETS + 1);
+  for (size_t i = 1; i < a.GetHistogram().size(); i++) {
+    EXPECT_LT(a.GetHistogram()[i - 1].GetAs<int32_t>(), a.GetHistogram()[i].GetAs<int32_t>());
+  }
+  EXPECT_NEAR(stats->GetColumnStats(1).GetNumDistinct(), 100, 5);
+  const ColumnStats &c = stats->GetColumnStats(2);
+  EXPECT_EQ(c.GetNullFraction(), 0.25);
+  EXPECT_NEAR(c.GetNumDistinct(), 10, 1);
+  EXPECT_EQ(c.GetMin().GetAs<int32_t>(), 0);
+  EXPECT_EQ(c.GetMax().GetAs<int32_t>(), 9);
+
+  // Comparisons with constants are estimated from the histograms.
+  EXPECT_NEAR(a.EstimateSelectivity(ComparisonType::LessThan, ValueFactory::GetIntegerValue(2500)), 0.25, 0.01);
+  EXPECT_NEAR(a.EstimateSelectivity(ComparisonType::GreaterThanOrEqual, ValueFactory::GetIntegerValue(9000)), 0.1,
+              0.01);
+  EXPECT_NEAR(a.EstimateSelectivity(ComparisonType::Equal, ValueFactory::GetIntegerValue(42)), 1.0 / size,
+              0.1 / size);
+  EXPECT_EQ(a.EstimateSelectivity(ComparisonType::Equal, ValueFactory::GetIntegerValue(-1)), 0);
+  EXPECT_EQ(a.EstimateSelectivity(ComparisonType::GreaterThan, ValueFactory::GetIntegerValue(size)), 0);
+  EXPECT_EQ(a.EstimateSelectivity(ComparisonType::Equal, ValueFactory::GetNullValueByType(TypeId::INTEGER)), 0);
+  EXPECT_NEAR(stats->GetColumnStats(1).EstimateSelectivity(ComparisonType::Equal, ValueFactory::GetIntegerValue(7)),
+              0.01, 0.002);
+  // NULLs match nothing, so c <> 3 keeps neither them nor the threes.
+  EXPECT_NEAR(c.EstimateSelectivity(ComparisonType::NotEqual, ValueFactory::GetIntegerValue(3)), 0.65, 0.05);
+
+  // An estimator keeps the statistics it read when the table is analyzed again, a new one reads the new statistics.
+  table_oid_t oid = catalog_->GetTable("t")->oid_;
+  CardinalityEstimator estimator(catalog_.get());
+  ASSERT_EQ(estimator.GetTableStats(oid), stats);
+  const TableStats *new_stats = Analyze("t", 1000);
+  ASSERT_NE(new_stats, stats);
+  ASSERT_EQ(estimator.GetTableStats(oid), stats);
+  EXPECT_EQ(estimator.GetTableStats(oid)->GetRowCount(), size);
+  ASSERT_EQ(CardinalityEstimator(catalog_.get()).GetTableStats(oid), new_stats);
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableStatsTest, SampleTest) {
+  constexpr int32_t size = 10000;
+  MakeTable("t", size);
+
+  // Only some pages are read, and the counts are scaled from them.
+  const TableStats *stats = Analyze("t", 16);
+  ASSERT_NE(stats, nullptr);
+  EXPECT_EQ(stats->GetNumSampledPages(), 16);
+  EXPECT_GT(stats->GetNumPages(), 16);
+  EXPECT_LT(stats->GetNumSampledRows(), size / 2);
+  EXPECT_NEAR(stats->GetRowCount(), size, size * 0.1);
+
+  // The values that repeat are all seen, the unique ones are extrapolated.
+  EXPECT_NEAR(stats->GetColumnStats(0).GetNumDistinct(), size, size * 0.15);
+  EXPECT_NEAR(stats->GetColumnStats(1).GetNumDistinct(), 100, 10);
+  EXPECT_NEAR(stats->GetColumnStats(2).GetNullFraction(), 0.25, 0.02);
+  EXPECT_NEAR(stats->GetColumnStats(0).EstimateSelectivity(ComparisonType::LessThanOrEqual,
+                                                           ValueFactory::GetIntegerValue(size / 2)),
+              0.5, 0.2);
+}
+
+// NOLINTNEXTLINE
+TEST_F(TableStatsTest, CardinalityEstimatorTest) {
+  constexpr int32_t size = 5000;
+  TableMetadata *t = MakeTable("t", size);
+  TableMetadata *u = MakeTable("u", size);
+  CardinalityEstimator estimator(catalog_.get());
+
+  // Tables that were never analyzed get the defaults.
+  EXPECT_EQ(estimator.EstimateCardinality(MakeScan(t)), CardinalityEstimator::DEFAULT_ROW_COUNT);
+  EXPECT_NEAR(estimator.EstimateCardinality(MakeScan(t, Compare(ColumnRef(0, 1), 7, ComparisonType::Equal))),
+              CardinalityEstimator::DEFAULT_ROW_COUNT * CardinalityEstimator::DEFAULT_EQUALITY_SELECTIVITY, 1e-9);
+
+  Analyze("t", 1000);
+  Analyze("u", 1000);
+  EXPECT_EQ(estimator.EstimateCardinality(MakeScan(t)), size);
+
+  // WHERE a < 1000 AND b = 7, with the constant on either side, and WHERE a < 1000 OR a >= 4000
+  auto *a_lt = Compare(ColumnRef(0, 0), 1000, ComparisonType::LessThan);
+  auto *b_eq = Own(std::make_unique<ComparisonExpression>(
+      Own(std::make_unique<ConstantValueExpression>(ValueFactory::GetIntegerValue(7))), ColumnRef(0, 1),
+      ComparisonType::Equal));
+  auto *a_ge = Compare(ColumnRef(0, 0), 4000, ComparisonType::GreaterThanOrEqual);
+  EXPECT_NEAR(estimator.EstimateCardinality(MakeScan(t, a_lt)), 1000, 50);
+  EXPECT_NEAR(estimator.EstimateCardinality(MakeScan(t, Own(std::make_unique<LogicExpression>(a_lt, b_eq,
+                                                                                             LogicType::And)))),
+              10, 2);
+  EXPECT_NEAR(
+      estimator.EstimateCardinality(MakeScan(t, Own(std::make_unique<LogicExpression>(a_lt, a_ge, LogicType::Or)))),
+      2000 - 1000 * 1000 / size, 100);
+
+  // t JOIN u ON t.b = u.b: every row of t matches the size / 100 rows of u with its b.
+  auto *scan_t = MakeScan(t, a_lt);
+  auto *scan_u = MakeScan(u);
+  auto *join_schema = Own(std::make_unique<Schema>(std::vector<Column>{
+      Column("t.a", TypeId::INTEGER, ColumnRef(0, 0)), Column("u.c", TypeId::INTEGER, ColumnRef(1, 2))}));
+  auto *join = Own(std::make_unique<HashJoinPlanNode>(
+      join_schema, std::vector<const AbstractPlanNode *>{scan_t, scan_u},
+      std::vector<const AbstractExpression *>{ColumnRef(0, 1)},
+      std::vector<const AbstractExpression *>{ColumnRef(1, 1)}));
+  EXPECT_NEAR(estimator.EstimateCardinality(join), 1000.0 * size / 100, 1000.0 * size / 100 * 0.1);
+
+  // Columns are traced through the output of the join: GROUP BY u.c has the 10 values of c and a NULL group.
+  auto *agg_schema =
+      Own(std::make_unique<Schema>(std::vector<Column>{Column("u.c", TypeId::INTEGER, ColumnRef(0, 1))}));
+  auto *agg = Own(std::make_unique<AggregationPlanNode>(agg_schema, join, nullptr,
+                                                        std::vector<const AbstractExpression *>{ColumnRef(0, 1)},
+                                                        std::vector<const AbstractExpression *>{},
+                                                        std::vector<AggregationType>{}));
+  EXPECT_NEAR(estimator.EstimateCardinality(agg), 11, 1);
+  EXPECT_EQ(estimator.GetOutputColumnStats(join, 1), &u->stats_->GetColumnStats(2));
+}
+
+}  // namespace bustub
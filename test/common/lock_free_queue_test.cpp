@@ -0,0 +1,83 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// lock_free_queue_test.cpp
+//
+// Identification: test/common/lock_free_queue_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <atomic>
+#include <thread>  // NOLINT
+#include <utility>
+#include <vector>
+
+#include "common/lock_free_queue.h"
+#include "gtest/gtest.h"
+
+namespace bustub {
+
+// NOLINTNEXTLINE
+TEST(LockFreeQueueTest, SampleTest) {
+  LockFreeQueue<int> queue(3);
+  EXPECT_EQ(4, queue.Capacity());
+
+  int value;
+  EXPECT_FALSE(queue.TryPop(&value));
+  for (int i = 0; i < 4; i++) {
+    EXPECT_TRUE(queue.TryPush(std::move(i)));
+  }
+  EXPECT_FALSE(queue.TryPush(4));
+
+  // Values come out in order, and the freed cells are reused on the next lap.
+  for (int lap = 0; lap < 3; lap++) {
+    for (int i = 0; i < 4; i++) {
+      EXPECT_TRUE(queue.TryPop(&value));
+      EXPECT_EQ(lap * 4 + i, value);
+      EXPECT_TRUE(queue.TryPush((lap + 1) * 4 + i));
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST(LockFreeQueueTest, ConcurrentTest) {
+  constexpr int num_threads = 4;
+  constexpr int num_values = 10000;
+  LockFreeQueue<int> queue(16);
+  std::atomic<int64_t> sum{0};
+  std::atomic<int> popped{0};
+
+  std::vector<std::thread> threads;
+  for (int tid = 0; tid < num_threads; tid++) {
+    threads.emplace_back([&queue, tid] {
+      for (int i = tid; i < num_values; i += num_threads) {
+        while (!queue.TryPush(std::move(i))) {
+          std::this_thread::yield();
+        }
+      }
+    });
+    threads.emplace_back([&queue, &sum, &popped] {
+      int value;
+      while (popped.load() < num_values) {
+        if (queue.TryPop(&value)) {
+          sum += value;
+          popped++;
+        } else {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+  for (auto &thread : threads) {
+    thread.join();
+  }
+
+  // Every value was popped exactly once.
+  EXPECT_EQ(num_values, popped.load());
+  EXPECT_EQ(static_cast<int64_t>(num_values) * (num_values - 1) / 2, sum.load());
+}
+
+}  // namespace bustub
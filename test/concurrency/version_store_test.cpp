@@ -0,0 +1,165 @@
+/**
+ * version_store_test.cpp
+ */
+
+#include <cstdio>
+#include <memory>
+#include <vector>
+
+#include "buffer/buffer_pool_manager.h"
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "storage/table/table_heap.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class VersionStoreTest : public ::testing::Test {
+ public:
+  void SetUp() override {
+    ::testing::Test::SetUp();
+    disk_manager_ = std::make_unique<DiskManager>("version_store_test.db");
+    bpm_ = std::make_unique<BufferPoolManager>(50, disk_manager_.get());
+    lock_manager_ = std::make_unique<LockManager>();
+    txn_mgr_ = std::make_unique<TransactionManager>(lock_manager_.get(), nullptr, true);
+
+    // Create a table of NUM_ROWS rows holding 0, 1, ...
+    auto *txn = txn_mgr_->Begin();
+    table_ = std::make_unique<TableHeap>(bpm_.get(), lock_manager_.get(), nullptr, txn);
+    for (int i = 0; i < NUM_ROWS; i++) {
+      RID rid;
+      EXPECT_TRUE(table_->InsertTuple(MakeTuple(i), &rid, txn));
+      rids_.push_back(rid);
+    }
+    txn_mgr_->Commit(txn);
+    delete txn;
+  }
+
+  void TearDown() override {
+    table_.reset();
+    disk_manager_->ShutDown();
+    remove("version_store_test.db");
+  }
+
+  Tuple MakeTuple(int32_t value) { return Tuple{{ValueFactory::GetIntegerValue(value)}, &schema_}; }
+
+  int32_t ValueOf(const Tuple &tuple) { return tuple.GetValue(&schema_, 0).GetAs<int32_t>(); }
+
+  /** @return the sum of the values in the table as seen by txn */
+  int32_t Sum(Transaction *txn) {
+    int32_t sum = 0;
+    for (auto it = table_->Begin(txn); it != table_->End(); ++it) {
+      sum += ValueOf(*it);
+    }
+    return sum;
+  }
+
+  static constexpr int NUM_ROWS = 100;
+  Schema schema_{std::vector<Column>{Column{"a", TypeId::INTEGER}}};
+  std::unique_ptr<DiskManager> disk_manager_;
+  std::unique_ptr<BufferPoolManager> bpm_;
+  std::unique_ptr<LockManager> lock_manager_;
+  std::unique_ptr<TransactionManager> txn_mgr_;
+  std::unique_ptr<TableHeap> table_;
+  std::vector<RID> rids_;
+};
+
+// NOLINTNEXTLINE
+TEST_F(VersionStoreTest, SnapshotReadTest) {
+  const int32_t initial_sum = NUM_ROWS * (NUM_ROWS - 1) / 2;
+  auto *reader = txn_mgr_->Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  EXPECT_EQ(initial_sum, Sum(reader));
+
+  // Update row 0, delete row 1 and insert a new row.
+  auto *writer = txn_mgr_->Begin();
+  EXPECT_TRUE(table_->UpdateTuple(MakeTuple(1000), rids_[0], writer));
+  EXPECT_TRUE(table_->MarkDelete(rids_[1], writer));
+  RID new_rid;
+  EXPECT_TRUE(table_->InsertTuple(MakeTuple(2000), &new_rid, writer));
+  const int32_t new_sum = initial_sum + 1000 - 1 + 2000;
+
+  // The reader neither sees uncommitted nor newer committed versions.
+  Tuple tuple;
+  EXPECT_TRUE(table_->GetTuple(rids_[0], &tuple, reader));
+  EXPECT_EQ(0, ValueOf(tuple));
+  EXPECT_EQ(initial_sum, Sum(reader));
+  EXPECT_EQ(new_sum, Sum(writer));
+  txn_mgr_->Commit(writer);
+  EXPECT_TRUE(table_->GetTuple(rids_[1], &tuple, reader));
+  EXPECT_EQ(1, ValueOf(tuple));
+  EXPECT_FALSE(table_->GetTuple(new_rid, &tuple, reader));
+  EXPECT_EQ(initial_sum, Sum(reader));
+  EXPECT_TRUE(reader->GetSharedLockSet()->empty());
+  EXPECT_TRUE(reader->GetRowLockSet()->empty());
+  EXPECT_TRUE(reader->GetTableLockSet()->empty());
+
+  // A new snapshot sees the committed writes.
+  auto *late_reader = txn_mgr_->Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  EXPECT_EQ(new_sum, Sum(late_reader));
+  txn_mgr_->Commit(late_reader);
+
+  // The old versions are kept as long as the first reader runs.
+  txn_mgr_->GarbageCollect();
+  EXPECT_EQ(initial_sum, Sum(reader));
+  EXPECT_LT(0, table_->GetVersionStore()->GetVersionCount());
+  txn_mgr_->Commit(reader);
+  txn_mgr_->GarbageCollect();
+  EXPECT_EQ(0, table_->GetVersionStore()->GetVersionCount());
+
+  delete writer;
+  delete reader;
+  delete late_reader;
+}
+
+// NOLINTNEXTLINE
+TEST_F(VersionStoreTest, WriteConflictTest) {
+  auto *txn0 = txn_mgr_->Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  auto *txn1 = txn_mgr_->Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+
+  // First updater wins while it runs.
+  EXPECT_TRUE(table_->UpdateTuple(MakeTuple(1000), rids_[0], txn0));
+  EXPECT_FALSE(table_->UpdateTuple(MakeTuple(2000), rids_[0], txn1));
+  EXPECT_EQ(TransactionState::ABORTED, txn1->GetState());
+  txn_mgr_->Abort(txn1);
+
+  // ... and after it committed, for transactions whose snapshot does not contain its write.
+  auto *txn2 = txn_mgr_->Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  txn_mgr_->Commit(txn0);
+  EXPECT_FALSE(table_->MarkDelete(rids_[0], txn2));
+  txn_mgr_->Abort(txn2);
+
+  // Rolled back writes restore the previous version.
+  auto *txn3 = txn_mgr_->Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  EXPECT_TRUE(table_->UpdateTuple(MakeTuple(3000), rids_[0], txn3));
+  EXPECT_TRUE(table_->UpdateTuple(MakeTuple(4000), rids_[0], txn3));
+  txn_mgr_->Abort(txn3);
+  auto *txn4 = txn_mgr_->Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  Tuple tuple;
+  EXPECT_TRUE(table_->GetTuple(rids_[0], &tuple, txn4));
+  EXPECT_EQ(1000, ValueOf(tuple));
+  EXPECT_TRUE(table_->UpdateTuple(MakeTuple(5000), rids_[0], txn4));
+  txn_mgr_->Commit(txn4);
+
+  for (auto *txn : {txn0, txn1, txn2, txn3, txn4}) {
+    delete txn;
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(VersionStoreTest, DisabledTest) {
+  txn_mgr_->GarbageCollect();
+  EXPECT_EQ(0, table_->GetVersionStore()->GetVersionCount());
+
+  // The writes of a transaction manager without snapshot isolation are not versioned.
+  TransactionManager txn_mgr(lock_manager_.get());
+  auto *writer = txn_mgr.Begin();
+  EXPECT_TRUE(table_->UpdateTuple(MakeTuple(1000), rids_[0], writer));
+  EXPECT_TRUE(table_->MarkDelete(rids_[1], writer));
+  EXPECT_EQ(0, table_->GetVersionStore()->GetVersionCount());
+  txn_mgr.Commit(writer);
+  EXPECT_EQ(0, table_->GetVersionStore()->GetVersionCount());
+  EXPECT_THROW(txn_mgr.Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION), Exception);
+  delete writer;
+}
+
+}  // namespace bustub
@@ -10,9 +10,15 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
 #include <cstdio>
+#include <functional>
 #include <memory>
+#include <random>
 #include <string>
+#include <thread>  // NOLINT
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -22,18 +28,35 @@
 
 #include "buffer/buffer_pool_manager.h"
 #include "catalog/table_generator.h"
+#include "common/bustub_instance.h"
 #include "concurrency/transaction_manager.h"
 #include "execution/execution_engine.h"
 #include "execution/executor_context.h"
+#include "execution/executor_factory.h"
 #include "execution/executors/aggregation_executor.h"
+#include "execution/executors/hash_join_executor.h"
 #include "execution/executors/insert_executor.h"
+#include "execution/executors/merge_join_executor.h"
 #include "execution/executors/nested_loop_join_executor.h"
+#include "execution/executors/sort_executor.h"
+#include "execution/executors/topn_executor.h"
 #include "execution/expressions/aggregate_value_expression.h"
 #include "execution/expressions/column_value_expression.h"
 #include "execution/expressions/comparison_expression.h"
 #include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/logic_expression.h"
+#include "execution/expressions/parameter_value_expression.h"
+#include "execution/plans/exchange_plan.h"
+#include "execution/plans/gather_plan.h"
+#include "execution/plans/hash_join_plan.h"
+#include "execution/plans/merge_join_plan.h"
 #include "execution/plans/seq_scan_plan.h"
+#include "execution/plans/sort_plan.h"
+#include "execution/plans/topn_plan.h"
+#include "execution/prepared_plan.h"
+#include "execution/result_sink.h"
 #include "gtest/gtest.h"
+#include "optimizer/optimizer.h"
 #include "storage/b_plus_tree_test_util.h"  // NOLINT
 #include "storage/table/tuple.h"
 #include "type/value_factory.h"
@@ -51,7 +74,7 @@ class ExecutorTest : public ::testing::Test {
     page_id_t page_id;
     bpm_->NewPage(&page_id);
     lock_manager_ = std::make_unique<LockManager>();
-    txn_mgr_ = std::make_unique<TransactionManager>(lock_manager_.get(), log_manager_.get());
+    txn_mgr_ = std::make_unique<TransactionManager>(lock_manager_.get(), log_manager_.get(), true);
     catalog_ = std::make_unique<Catalog>(bpm_.get(), lock_manager_.get(), log_manager_.get());
     // Begin a new transaction, along with its executor context.
     txn_ = txn_mgr_->Begin();
@@ -62,6 +85,7 @@ class ExecutorTest : public ::testing::Test {
     gen.GenerateTestTables();
 
     execution_engine_ = std::make_unique<ExecutionEngine>(bpm_.get(), txn_mgr_.get(), catalog_.get());
+    exec_ctx_->SetWorkerPool(execution_engine_->GetWorkerPool());
   }
 
   // This function is called after every test.
@@ -71,6 +95,7 @@ class ExecutorTest : public ::testing::Test {
     // Shut down the disk manager and clean up the transaction.
     disk_manager_->ShutDown();
     remove("executor_test.db");
+    remove("executor_test.dwb");
     delete txn_;
   };
 
@@ -104,6 +129,12 @@ class ExecutorTest : public ::testing::Test {
     return allocated_exprs_.back().get();
   }
 
+  const AbstractExpression *MakeLogicExpression(const AbstractExpression *lhs, const AbstractExpression *rhs,
+                                                LogicType logic_type) {
+    allocated_exprs_.emplace_back(std::make_unique<LogicExpression>(lhs, rhs, logic_type));
+    return allocated_exprs_.back().get();
+  }
+
   const AbstractExpression *MakeAggregateValueExpression(bool is_group_by_term, uint32_t term_idx) {
     allocated_exprs_.emplace_back(
         std::make_unique<AggregateValueExpression>(is_group_by_term, term_idx, TypeId::INTEGER));
@@ -124,6 +155,25 @@ class ExecutorTest : public ::testing::Test {
     return allocated_output_schemas_.back().get();
   }
 
+  /** Create a table of (k INTEGER, v INTEGER) holding (key(i), i) for i in [0, size). */
+  TableMetadata *MakeKeyValueTable(const std::string &name, int32_t size, const std::function<int32_t(int32_t)> &key) {
+    Schema schema({Column("k", TypeId::INTEGER), Column("v", TypeId::INTEGER)});
+    auto table_info = GetCatalog()->CreateTable(GetTxn(), name, schema);
+    for (int32_t i = 0; i < size; i++) {
+      RID rid;
+      std::vector<Value> values{ValueFactory::GetIntegerValue(key(i)), ValueFactory::GetIntegerValue(i)};
+      EXPECT_TRUE(table_info->table_->InsertTuple(Tuple(values, &table_info->schema_), &rid, GetTxn()));
+    }
+    return table_info;
+  }
+
+  /** @return a plan that scans k and v of a table made by MakeKeyValueTable */
+  std::unique_ptr<AbstractPlanNode> MakeKeyValueScan(TableMetadata *table_info) {
+    auto *k = MakeColumnValueExpression(table_info->schema_, 0, "k");
+    auto *v = MakeColumnValueExpression(table_info->schema_, 0, "v");
+    return std::make_unique<SeqScanPlanNode>(MakeOutputSchema({{"k", k}, {"v", v}}), nullptr, table_info->oid_);
+  }
+
  private:
   std::unique_ptr<TransactionManager> txn_mgr_;
   Transaction *txn_{nullptr};
@@ -140,7 +190,7 @@ class ExecutorTest : public ::testing::Test {
 };
 
 // NOLINTNEXTLINE
-TEST_F(ExecutorTest, DISABLED_SimpleSeqScanTest) {
+TEST_F(ExecutorTest, SimpleSeqScanTest) {
   // SELECT colA, colB FROM test_1 WHERE colA < 500
 
   // Construct query plan
@@ -386,7 +436,7 @@ TEST_F(ExecutorTest, DISABLED_SimpleDeleteTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(ExecutorTest, DISABLED_SimpleNestedLoopJoinTest) {
+TEST_F(ExecutorTest, SimpleNestedLoopJoinTest) {
   // SELECT test_1.colA, test_1.colB, test_2.col1, test_2.col3 FROM test_1 JOIN test_2 ON test_1.colA = test_2.col1
   std::unique_ptr<AbstractPlanNode> scan_plan1;
   const Schema *out_schema1;
@@ -436,7 +486,7 @@ TEST_F(ExecutorTest, DISABLED_SimpleNestedLoopJoinTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(ExecutorTest, DISABLED_SimpleAggregationTest) {
+TEST_F(ExecutorTest, SimpleAggregationTest) {
   // SELECT COUNT(colA), SUM(colA), min(colA), max(colA) from test_1;
   std::unique_ptr<AbstractPlanNode> scan_plan;
   const Schema *scan_schema;
@@ -487,7 +537,7 @@ TEST_F(ExecutorTest, DISABLED_SimpleAggregationTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(ExecutorTest, DISABLED_SimpleGroupByAggregation) {
+TEST_F(ExecutorTest, SimpleGroupByAggregation) {
   // SELECT count(colA), colB, sum(colC) FROM test_1 Group By colB HAVING count(colA) > 100
   std::unique_ptr<AbstractPlanNode> scan_plan;
   const Schema *scan_schema;
@@ -546,4 +596,1457 @@ TEST_F(ExecutorTest, DISABLED_SimpleGroupByAggregation) {
   }
 }
 
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, BatchBoundaryTest) {
+  // SELECT v, v % 7 FROM big WHERE v >= 100, over a table that spans several batches
+  constexpr int32_t big_size = 3 * BATCH_SIZE + 17;
+  Schema big_schema({Column("v", TypeId::INTEGER), Column("m", TypeId::INTEGER)});
+  auto table_info = GetCatalog()->CreateTable(GetTxn(), "big", big_schema);
+  for (int32_t i = 0; i < big_size; i++) {
+    RID rid;
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i % 7)};
+    ASSERT_TRUE(table_info->table_->InsertTuple(Tuple(values, &table_info->schema_), &rid, GetTxn()));
+  }
+
+  auto &schema = table_info->schema_;
+  auto *v = MakeColumnValueExpression(schema, 0, "v");
+  auto *m = MakeColumnValueExpression(schema, 0, "m");
+  auto *predicate = MakeComparisonExpression(v, MakeConstantValueExpression(ValueFactory::GetIntegerValue(100)),
+                                             ComparisonType::GreaterThanOrEqual);
+  auto *scan_schema = MakeOutputSchema({{"v", v}, {"m", m}});
+  SeqScanPlanNode scan_plan{scan_schema, predicate, table_info->oid_};
+
+  // Pulled a batch at a time, no batch is empty or larger than BATCH_SIZE.
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &scan_plan);
+  executor->Init();
+  // A parallel scan produces the rows in no particular order.
+  TupleBatch batch;
+  std::vector<bool> seen(big_size, false);
+  size_t batches = 0;
+  while (executor->NextBatch(&batch)) {
+    batches++;
+    ASSERT_GT(batch.NumSelected(), 0);
+    ASSERT_LE(batch.NumRows(), static_cast<uint32_t>(BATCH_SIZE));
+    for (uint32_t row : batch.GetSelection()) {
+      int64_t value = batch.GetColumn(0).GetInteger(row);
+      ASSERT_GE(value, 100);
+      ASSERT_FALSE(seen[value]);
+      ASSERT_EQ(batch.GetColumn(1).GetInteger(row), value % 7);
+      seen[value] = true;
+    }
+  }
+  ASSERT_EQ(std::count(seen.begin(), seen.end(), true), big_size - 100);
+  ASSERT_GE(batches, 4);
+
+  // Pulled a tuple at a time, it produces the same rows.
+  executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &scan_plan);
+  executor->Init();
+  Tuple tuple;
+  RID rid;
+  while (executor->Next(&tuple, &rid)) {
+    int32_t value = tuple.GetValue(scan_schema, 0).GetAs<int32_t>();
+    ASSERT_TRUE(seen[value]);
+    seen[value] = false;
+  }
+  ASSERT_EQ(std::count(seen.begin(), seen.end(), true), 0);
+
+  // SELECT m, count(v), sum(v) FROM big WHERE v >= 100 GROUP BY m
+  auto *group_m = MakeColumnValueExpression(*scan_schema, 0, "m");
+  auto *agg_v = MakeColumnValueExpression(*scan_schema, 0, "v");
+  auto *out_m = MakeAggregateValueExpression(true, 0);
+  auto *count_v = MakeAggregateValueExpression(false, 0);
+  auto *sum_v = MakeAggregateValueExpression(false, 1);
+  auto *agg_schema = MakeOutputSchema({{"m", out_m}, {"countV", count_v}, {"sumV", sum_v}});
+  AggregationPlanNode agg_plan{agg_schema,
+                               &scan_plan,
+                               nullptr,
+                               std::vector<const AbstractExpression *>{group_m},
+                               std::vector<const AbstractExpression *>{agg_v, agg_v},
+                               std::vector<AggregationType>{AggregationType::CountAggregate,
+                                                            AggregationType::SumAggregate}};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&agg_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 7);
+  for (const auto &result : result_set) {
+    int32_t group = result.GetValue(agg_schema, 0).GetAs<int32_t>();
+    int32_t count = 0;
+    int32_t sum = 0;
+    for (int32_t i = 100; i < big_size; i++) {
+      if (i % 7 == group) {
+        count++;
+        sum += i;
+      }
+    }
+    ASSERT_EQ(result.GetValue(agg_schema, 1).GetAs<int32_t>(), count);
+    ASSERT_EQ(result.GetValue(agg_schema, 2).GetAs<int32_t>(), sum);
+  }
+}
+
+/** Produces the integers [0, size) one tuple at a time. */
+class CountingExecutor : public AbstractExecutor {
+ public:
+  CountingExecutor(ExecutorContext *exec_ctx, const Schema *schema, int32_t size)
+      : AbstractExecutor(exec_ctx), schema_(schema), size_(size) {}
+
+  void Init() override { next_ = 0; }
+
+  bool Next(Tuple *tuple, RID *rid) override {
+    if (next_ == size_) {
+      return false;
+    }
+    *tuple = Tuple({ValueFactory::GetIntegerValue(next_++)}, schema_);
+    return true;
+  }
+
+  const Schema *GetOutputSchema() override { return schema_; }
+
+ private:
+  const Schema *schema_;
+  int32_t size_;
+  int32_t next_{0};
+};
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, RowToBatchAdapterTest) {
+  Schema schema({Column("x", TypeId::INTEGER)});
+  constexpr int32_t size = 2 * BATCH_SIZE + 5;
+  CountingExecutor executor(GetExecutorContext(), &schema, size);
+  executor.Init();
+
+  // A tuple-at-a-time executor fills whole batches until it runs dry.
+  TupleBatch batch;
+  std::vector<uint32_t> batch_sizes;
+  int32_t expected = 0;
+  while (executor.NextBatch(&batch)) {
+    batch_sizes.push_back(batch.NumSelected());
+    for (uint32_t row : batch.GetSelection()) {
+      ASSERT_EQ(batch.GetColumn(0).GetInteger(row), expected++);
+    }
+  }
+  ASSERT_EQ(expected, size);
+  ASSERT_EQ(batch_sizes, (std::vector<uint32_t>{BATCH_SIZE, BATCH_SIZE, 5}));
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SimpleHashJoinTest) {
+  // SELECT test_1.colA, test_1.colB, test_2.col1, test_2.col3 FROM test_1 JOIN test_2 ON test_1.colA = test_2.col1
+  std::unique_ptr<AbstractPlanNode> scan_plan1;
+  const Schema *out_schema1;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_1");
+    auto &schema = table_info->schema_;
+    auto colA = MakeColumnValueExpression(schema, 0, "colA");
+    auto colB = MakeColumnValueExpression(schema, 0, "colB");
+    out_schema1 = MakeOutputSchema({{"colA", colA}, {"colB", colB}});
+    scan_plan1 = std::make_unique<SeqScanPlanNode>(out_schema1, nullptr, table_info->oid_);
+  }
+  std::unique_ptr<AbstractPlanNode> scan_plan2;
+  const Schema *out_schema2;
+  {
+    auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+    auto &schema = table_info->schema_;
+    auto col1 = MakeColumnValueExpression(schema, 0, "col1");
+    auto col3 = MakeColumnValueExpression(schema, 0, "col3");
+    out_schema2 = MakeOutputSchema({{"col1", col1}, {"col3", col3}});
+    scan_plan2 = std::make_unique<SeqScanPlanNode>(out_schema2, nullptr, table_info->oid_);
+  }
+  std::unique_ptr<HashJoinPlanNode> join_plan;
+  const Schema *out_final;
+  {
+    auto colA = MakeColumnValueExpression(*out_schema1, 0, "colA");
+    auto colB = MakeColumnValueExpression(*out_schema1, 0, "colB");
+    auto col1 = MakeColumnValueExpression(*out_schema2, 1, "col1");
+    auto col3 = MakeColumnValueExpression(*out_schema2, 1, "col3");
+    out_final = MakeOutputSchema({{"colA", colA}, {"colB", colB}, {"col1", col1}, {"col3", col3}});
+    join_plan = std::make_unique<HashJoinPlanNode>(
+        out_final, std::vector<const AbstractPlanNode *>{scan_plan1.get(), scan_plan2.get()},
+        std::vector<const AbstractExpression *>{colA}, std::vector<const AbstractExpression *>{col1});
+  }
+
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), join_plan.get());
+  executor->Init();
+  // test_2 is the smaller table.
+  ASSERT_FALSE(dynamic_cast<HashJoinExecutor *>(executor.get())->BuildsOnLeft());
+  ASSERT_EQ(dynamic_cast<HashJoinExecutor *>(executor.get())->GetNumSpilledPartitions(), 0);
+  std::unordered_set<int32_t> encountered;
+  Tuple tuple;
+  RID rid;
+  while (executor->Next(&tuple, &rid)) {
+    auto colA = tuple.GetValue(out_final, out_final->GetColIdx("colA")).GetAs<int32_t>();
+    ASSERT_EQ(colA, tuple.GetValue(out_final, out_final->GetColIdx("col1")).GetAs<int16_t>());
+    ASSERT_EQ(encountered.count(colA), 0);
+    encountered.insert(colA);
+  }
+  ASSERT_EQ(encountered.size(), 100);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, HashJoinSpillTest) {
+  // SELECT l.k, l.v, r.k, r.v FROM l JOIN r ON l.k = r.k, where every key of l appears twice
+  constexpr int32_t size = 3000;
+  auto *left_info = MakeKeyValueTable("l", size, [](int32_t i) { return i % (size / 2); });
+  auto *right_info = MakeKeyValueTable("r", size, [](int32_t i) { return i; });
+  auto left_scan = MakeKeyValueScan(left_info);
+  auto right_scan = MakeKeyValueScan(right_info);
+  const Schema *left_schema = left_scan->OutputSchema();
+  const Schema *right_schema = right_scan->OutputSchema();
+  auto *lk = MakeColumnValueExpression(*left_schema, 0, "k");
+  auto *lv = MakeColumnValueExpression(*left_schema, 0, "v");
+  auto *rk = MakeColumnValueExpression(*right_schema, 1, "k");
+  auto *rv = MakeColumnValueExpression(*right_schema, 1, "v");
+  auto *out_schema = MakeOutputSchema({{"lk", lk}, {"lv", lv}, {"rk", rk}, {"rv", rv}});
+
+  // Runs the join and checks that every pair is matched once, and nothing else.
+  auto run_join = [&](const AbstractExpression *predicate, int32_t expected_size, size_t *spilled) {
+    HashJoinPlanNode join_plan{out_schema,
+                               std::vector<const AbstractPlanNode *>{left_scan.get(), right_scan.get()},
+                               std::vector<const AbstractExpression *>{lk}, std::vector<const AbstractExpression *>{rk},
+                               predicate};
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &join_plan);
+    executor->Init();
+    std::unordered_set<int32_t> left_values;
+    Tuple tuple;
+    RID rid;
+    while (executor->Next(&tuple, &rid)) {
+      int32_t left_key = tuple.GetValue(out_schema, 0).GetAs<int32_t>();
+      int32_t left_value = tuple.GetValue(out_schema, 1).GetAs<int32_t>();
+      ASSERT_EQ(left_key, left_value % (size / 2));
+      ASSERT_EQ(left_key, tuple.GetValue(out_schema, 2).GetAs<int32_t>());
+      ASSERT_EQ(left_key, tuple.GetValue(out_schema, 3).GetAs<int32_t>());
+      ASSERT_EQ(left_values.count(left_value), 0);
+      left_values.insert(left_value);
+    }
+    ASSERT_EQ(left_values.size(), expected_size);
+    *spilled = dynamic_cast<HashJoinExecutor *>(executor.get())->GetNumSpilledPartitions();
+  };
+
+  size_t spilled;
+  run_join(nullptr, size, &spilled);
+  ASSERT_EQ(spilled, 0);
+
+  // With a budget of a few kilobytes both sides spill, and the partitions are partitioned again.
+  size_t budget = hash_join_memory_budget;
+  hash_join_memory_budget = 4096;
+  run_join(nullptr, size, &spilled);
+  ASSERT_GT(spilled, 8);
+  auto *predicate = MakeComparisonExpression(lv, MakeConstantValueExpression(ValueFactory::GetIntegerValue(size / 2)),
+                                             ComparisonType::GreaterThanOrEqual);
+  run_join(predicate, size / 2, &spilled);
+  ASSERT_GT(spilled, 8);
+  hash_join_memory_budget = budget;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, HashJoinSkewTest) {
+  // All the keys are equal, so partitioning cannot split the inputs and the join runs in memory at the last depth.
+  constexpr int32_t size = 200;
+  auto *left_info = MakeKeyValueTable("l", size, [](int32_t) { return 7; });
+  auto *right_info = MakeKeyValueTable("r", size, [](int32_t) { return 7; });
+  auto left_scan = MakeKeyValueScan(left_info);
+  auto right_scan = MakeKeyValueScan(right_info);
+  auto *lk = MakeColumnValueExpression(*left_scan->OutputSchema(), 0, "k");
+  auto *rk = MakeColumnValueExpression(*right_scan->OutputSchema(), 1, "k");
+  auto *out_schema = MakeOutputSchema({{"lk", lk}, {"rk", rk}});
+  HashJoinPlanNode join_plan{out_schema, std::vector<const AbstractPlanNode *>{left_scan.get(), right_scan.get()},
+                             std::vector<const AbstractExpression *>{lk}, std::vector<const AbstractExpression *>{rk}};
+
+  size_t budget = hash_join_memory_budget;
+  hash_join_memory_budget = 1024;
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&join_plan, &result_set, GetTxn(), GetExecutorContext());
+  hash_join_memory_budget = budget;
+  ASSERT_EQ(result_set.size(), size * size);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, HashJoinBenchmark) {
+  // SELECT l.k, r.v FROM l JOIN r ON l.k = r.k, as a nested loop join and as a hash join
+  constexpr int32_t size = 2000;
+  auto *left_info = MakeKeyValueTable("l", size, [](int32_t i) { return i; });
+  auto *right_info = MakeKeyValueTable("r", size, [](int32_t i) { return size - 1 - i; });
+  auto left_scan = MakeKeyValueScan(left_info);
+  auto right_scan = MakeKeyValueScan(right_info);
+  auto *lk = MakeColumnValueExpression(*left_scan->OutputSchema(), 0, "k");
+  auto *rk = MakeColumnValueExpression(*right_scan->OutputSchema(), 1, "k");
+  auto *rv = MakeColumnValueExpression(*right_scan->OutputSchema(), 1, "v");
+  auto *out_schema = MakeOutputSchema({{"lk", lk}, {"rv", rv}});
+  NestedLoopJoinPlanNode nested_loop_join_plan{
+      out_schema, std::vector<const AbstractPlanNode *>{left_scan.get(), right_scan.get()},
+      MakeComparisonExpression(lk, rk, ComparisonType::Equal)};
+  HashJoinPlanNode hash_join_plan{out_schema, std::vector<const AbstractPlanNode *>{left_scan.get(), right_scan.get()},
+                                  std::vector<const AbstractExpression *>{lk},
+                                  std::vector<const AbstractExpression *>{rk}};
+
+  auto time_join = [&](const AbstractPlanNode *plan, std::vector<Tuple> *result_set) {
+    // The optimizer would turn the nested loop join into a hash join.
+    bool old_enable_optimizer = enable_optimizer;
+    enable_optimizer = false;
+    auto start = std::chrono::steady_clock::now();
+    GetExecutionEngine()->Execute(plan, result_set, GetTxn(), GetExecutorContext());
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    enable_optimizer = old_enable_optimizer;
+    return std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+  };
+  std::vector<Tuple> nested_loop_result;
+  std::vector<Tuple> hash_result;
+  auto nested_loop_us = time_join(&nested_loop_join_plan, &nested_loop_result);
+  auto hash_us = time_join(&hash_join_plan, &hash_result);
+  std::cout << size << " x " << size << " rows: nested loop join " << nested_loop_us << " us, hash join " << hash_us
+            << " us" << std::endl;
+
+  ASSERT_EQ(nested_loop_result.size(), size);
+  ASSERT_EQ(hash_result.size(), size);
+  int64_t nested_loop_sum = 0;
+  int64_t hash_sum = 0;
+  for (int32_t i = 0; i < size; i++) {
+    ASSERT_EQ(nested_loop_result[i].GetValue(out_schema, 1).GetAs<int32_t>(),
+              size - 1 - nested_loop_result[i].GetValue(out_schema, 0).GetAs<int32_t>());
+    ASSERT_EQ(hash_result[i].GetValue(out_schema, 1).GetAs<int32_t>(),
+              size - 1 - hash_result[i].GetValue(out_schema, 0).GetAs<int32_t>());
+    nested_loop_sum += nested_loop_result[i].GetValue(out_schema, 0).GetAs<int32_t>();
+    hash_sum += hash_result[i].GetValue(out_schema, 0).GetAs<int32_t>();
+  }
+  ASSERT_EQ(nested_loop_sum, hash_sum);
+  ASSERT_LT(hash_us, nested_loop_us);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, ParallelAggregationBenchmark) {
+  // SELECT k, count(v), sum(v), min(v), max(v) FROM t GROUP BY k, on 1 to N threads
+  constexpr int32_t size = 10000;
+  constexpr int32_t num_groups = 5000;
+  auto *table_info = MakeKeyValueTable("t", size, [](int32_t i) { return i % num_groups; });
+  auto scan_plan = MakeKeyValueScan(table_info);
+  auto *k = MakeColumnValueExpression(*scan_plan->OutputSchema(), 0, "k");
+  auto *v = MakeColumnValueExpression(*scan_plan->OutputSchema(), 0, "v");
+  auto *agg_schema = MakeOutputSchema({{"k", MakeAggregateValueExpression(true, 0)},
+                                       {"countV", MakeAggregateValueExpression(false, 0)},
+                                       {"sumV", MakeAggregateValueExpression(false, 1)},
+                                       {"minV", MakeAggregateValueExpression(false, 2)},
+                                       {"maxV", MakeAggregateValueExpression(false, 3)}});
+  AggregationPlanNode agg_plan{agg_schema,
+                               scan_plan.get(),
+                               nullptr,
+                               std::vector<const AbstractExpression *>{k},
+                               std::vector<const AbstractExpression *>{v, v, v, v},
+                               std::vector<AggregationType>{AggregationType::CountAggregate,
+                                                            AggregationType::SumAggregate,
+                                                            AggregationType::MinAggregate,
+                                                            AggregationType::MaxAggregate}};
+
+  size_t threads = execution_threads;
+  size_t max_threads = std::max<size_t>(4, std::thread::hardware_concurrency());
+  for (size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    execution_threads = num_threads;
+    std::vector<Tuple> result_set;
+    auto start = std::chrono::steady_clock::now();
+    GetExecutionEngine()->Execute(&agg_plan, &result_set, GetTxn(), GetExecutorContext());
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << num_threads << " threads: " << elapsed.count() << " us" << std::endl;
+
+    // Every group holds the values key and key + num_groups.
+    ASSERT_EQ(result_set.size(), num_groups);
+    std::unordered_set<int32_t> encountered;
+    for (const auto &tuple : result_set) {
+      int32_t key = tuple.GetValue(agg_schema, 0).GetAs<int32_t>();
+      ASSERT_EQ(encountered.count(key), 0);
+      encountered.insert(key);
+      ASSERT_EQ(tuple.GetValue(agg_schema, 1).GetAs<int32_t>(), 2);
+      ASSERT_EQ(tuple.GetValue(agg_schema, 2).GetAs<int32_t>(), 2 * key + num_groups);
+      ASSERT_EQ(tuple.GetValue(agg_schema, 3).GetAs<int32_t>(), key);
+      ASSERT_EQ(tuple.GetValue(agg_schema, 4).GetAs<int32_t>(), key + num_groups);
+    }
+  }
+  execution_threads = threads;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, ParallelSeqScanBenchmark) {
+  // SELECT k, v FROM t WHERE v >= 2500, over a table larger than the buffer pool, on 1 to N threads
+  constexpr int32_t size = 10000;
+  auto *table_info = MakeKeyValueTable("t", size, [](int32_t i) { return i; });
+  auto *k = MakeColumnValueExpression(table_info->schema_, 0, "k");
+  auto *v = MakeColumnValueExpression(table_info->schema_, 0, "v");
+  auto *predicate = MakeComparisonExpression(v, MakeConstantValueExpression(ValueFactory::GetIntegerValue(2500)),
+                                             ComparisonType::GreaterThanOrEqual);
+  auto *out_schema = MakeOutputSchema({{"k", k}, {"v", v}});
+  SeqScanPlanNode scan_plan{out_schema, predicate, table_info->oid_};
+
+  size_t threads = execution_threads;
+  size_t max_threads = std::max<size_t>(4, std::thread::hardware_concurrency());
+  for (size_t num_threads = 1; num_threads <= max_threads; num_threads *= 2) {
+    execution_threads = num_threads;
+    std::vector<Tuple> result_set;
+    auto start = std::chrono::steady_clock::now();
+    GetExecutionEngine()->Execute(&scan_plan, &result_set, GetTxn(), GetExecutorContext());
+    auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << num_threads << " threads: " << elapsed.count() << " us, "
+              << size * 1000000.0 / std::max<int64_t>(1, elapsed.count()) << " rows/s scanned" << std::endl;
+
+    ASSERT_EQ(result_set.size(), size - 2500);
+    std::vector<bool> seen(size, false);
+    for (const auto &tuple : result_set) {
+      int32_t value = tuple.GetValue(out_schema, 1).GetAs<int32_t>();
+      ASSERT_GE(value, 2500);
+      ASSERT_FALSE(seen[value]);
+      ASSERT_EQ(tuple.GetValue(out_schema, 0).GetAs<int32_t>(), value);
+      seen[value] = true;
+    }
+  }
+
+  // A scan that is abandoned early stops its threads and unpins its pages.
+  auto count_pinned = [this] {
+    size_t pinned = 0;
+    for (size_t i = 0; i < GetBPM()->GetPoolSize(); i++) {
+      pinned += GetBPM()->GetPages()[i].GetPinCount() > 0 ? 1 : 0;
+    }
+    return pinned;
+  };
+  size_t pinned = count_pinned();
+  execution_threads = 4;
+  {
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &scan_plan);
+    executor->Init();
+    TupleBatch batch;
+    ASSERT_TRUE(executor->NextBatch(&batch));
+  }
+  ASSERT_EQ(count_pinned(), pinned);
+
+  // With fewer free frames than the threads have morsels, the threads wait for each other instead of failing.
+  std::vector<page_id_t> held;
+  while (GetBPM()->GetPoolSize() - count_pinned() > 2) {
+    page_id_t page_id;
+    ASSERT_NE(GetBPM()->NewPage(&page_id), nullptr);
+    held.push_back(page_id);
+  }
+  execution_threads = 8;
+  std::vector<Tuple> result_set;
+  ASSERT_TRUE(GetExecutionEngine()->Execute(&scan_plan, &result_set, GetTxn(), GetExecutorContext()));
+  ASSERT_EQ(result_set.size(), size - 2500);
+  for (auto page_id : held) {
+    GetBPM()->UnpinPage(page_id, false);
+  }
+  execution_threads = threads;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, ParallelGatherExchangeTest) {
+  // SELECT k, count(v), sum(v) FROM t GROUP BY k, as a parallel plan fragment: an exchange sends every group to one
+  // instance of the fragment, which aggregates it
+  constexpr int32_t size = 10000;
+  constexpr int32_t num_groups = 100;
+  constexpr size_t num_instances = 4;
+  auto *table_info = MakeKeyValueTable("t", size, [](int32_t i) { return i % num_groups; });
+  auto scan_plan = MakeKeyValueScan(table_info);
+  auto *k = MakeColumnValueExpression(*scan_plan->OutputSchema(), 0, "k");
+  auto *v = MakeColumnValueExpression(*scan_plan->OutputSchema(), 0, "v");
+  ExchangePlanNode exchange_plan{scan_plan->OutputSchema(), scan_plan.get(), {k}};
+  auto *agg_schema = MakeOutputSchema({{"k", MakeAggregateValueExpression(true, 0)},
+                                       {"countV", MakeAggregateValueExpression(false, 0)},
+                                       {"sumV", MakeAggregateValueExpression(false, 1)}});
+  AggregationPlanNode agg_plan{agg_schema,
+                               &exchange_plan,
+                               nullptr,
+                               std::vector<const AbstractExpression *>{k},
+                               std::vector<const AbstractExpression *>{v, v},
+                               std::vector<AggregationType>{AggregationType::CountAggregate,
+                                                            AggregationType::SumAggregate}};
+  GatherPlanNode gather_plan{agg_schema, &agg_plan, num_instances};
+
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&gather_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), num_groups);
+  std::vector<bool> seen(num_groups, false);
+  for (const auto &tuple : result_set) {
+    int32_t key = tuple.GetValue(agg_schema, 0).GetAs<int32_t>();
+    ASSERT_FALSE(seen[key]);
+    seen[key] = true;
+    // A group holds key + j * num_groups for j in [0, size / num_groups).
+    constexpr int32_t group_size = size / num_groups;
+    ASSERT_EQ(tuple.GetValue(agg_schema, 1).GetAs<int32_t>(), group_size);
+    ASSERT_EQ(tuple.GetValue(agg_schema, 2).GetAs<int32_t>(),
+              group_size * key + num_groups * group_size * (group_size - 1) / 2);
+  }
+
+  // SELECT k, v FROM t WHERE v >= 2500, with an exchange that deals out whole batches
+  auto *predicate = MakeComparisonExpression(v, MakeConstantValueExpression(ValueFactory::GetIntegerValue(2500)),
+                                             ComparisonType::GreaterThanOrEqual);
+  SeqScanPlanNode filter_plan{scan_plan->OutputSchema(), predicate, table_info->oid_};
+  ExchangePlanNode deal_plan{filter_plan.OutputSchema(), &filter_plan};
+  GatherPlanNode scan_gather_plan{deal_plan.OutputSchema(), &deal_plan, num_instances};
+  result_set.clear();
+  GetExecutionEngine()->Execute(&scan_gather_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), size - 2500);
+  std::vector<bool> seen_rows(size, false);
+  for (const auto &tuple : result_set) {
+    int32_t value = tuple.GetValue(filter_plan.OutputSchema(), 1).GetAs<int32_t>();
+    ASSERT_GE(value, 2500);
+    ASSERT_FALSE(seen_rows[value]);
+    seen_rows[value] = true;
+  }
+
+  // A gather that is abandoned early stops its instances and unpins its pages.
+  auto count_pinned = [this] {
+    size_t pinned = 0;
+    for (size_t i = 0; i < GetBPM()->GetPoolSize(); i++) {
+      pinned += GetBPM()->GetPages()[i].GetPinCount() > 0 ? 1 : 0;
+    }
+    return pinned;
+  };
+  size_t pinned = count_pinned();
+  {
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &scan_gather_plan);
+    executor->Init();
+    TupleBatch batch;
+    ASSERT_TRUE(executor->NextBatch(&batch));
+  }
+  ASSERT_EQ(count_pinned(), pinned);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, SimpleSortTest) {
+  // SELECT col1, col2, col3 FROM test_2 ORDER BY col2, col3 DESC
+  auto table_info = GetExecutorContext()->GetCatalog()->GetTable("test_2");
+  auto &schema = table_info->schema_;
+  auto *col1 = MakeColumnValueExpression(schema, 0, "col1");
+  auto *col2 = MakeColumnValueExpression(schema, 0, "col2");
+  auto *col3 = MakeColumnValueExpression(schema, 0, "col3");
+  auto *out_schema = MakeOutputSchema({{"col1", col1}, {"col2", col2}, {"col3", col3}});
+  SeqScanPlanNode scan_plan{out_schema, nullptr, table_info->oid_};
+  auto *sort_col2 = MakeColumnValueExpression(*out_schema, 0, "col2");
+  auto *sort_col3 = MakeColumnValueExpression(*out_schema, 0, "col3");
+  SortPlanNode sort_plan{out_schema,
+                         &scan_plan,
+                         {{OrderByType::Ascending, sort_col2}, {OrderByType::Descending, sort_col3}}};
+
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&sort_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(result_set.size(), 100);
+  std::vector<bool> seen(100, false);
+  for (size_t i = 0; i < result_set.size(); i++) {
+    auto id = result_set[i].GetValue(out_schema, 0).GetAs<int16_t>();
+    ASSERT_FALSE(seen[id]);
+    seen[id] = true;
+    if (i == 0) {
+      continue;
+    }
+    Value prev2 = result_set[i - 1].GetValue(out_schema, 1);
+    Value cur2 = result_set[i].GetValue(out_schema, 1);
+    // NULL comes first in ascending order.
+    if (cur2.IsNull()) {
+      ASSERT_TRUE(prev2.IsNull());
+    } else if (!prev2.IsNull()) {
+      ASSERT_LE(prev2.GetAs<int32_t>(), cur2.GetAs<int32_t>());
+    }
+    if (prev2.IsNull() == cur2.IsNull() && (cur2.IsNull() || prev2.GetAs<int32_t>() == cur2.GetAs<int32_t>())) {
+      ASSERT_GE(result_set[i - 1].GetValue(out_schema, 2).GetAs<int64_t>(),
+                result_set[i].GetValue(out_schema, 2).GetAs<int64_t>());
+    }
+  }
+}
+
+/** Produces (k, v, pad) = (a random key, i, a filler string) for i in [0, size). */
+class RandomRowExecutor : public AbstractExecutor {
+ public:
+  RandomRowExecutor(ExecutorContext *exec_ctx, const Schema *schema, int32_t size, int32_t num_keys)
+      : AbstractExecutor(exec_ctx), schema_(schema), size_(size), keys_(0, num_keys - 1) {}
+
+  void Init() override {
+    next_ = 0;
+    random_.seed(15445);
+  }
+
+  bool Next(Tuple *tuple, RID *rid) override {
+    if (next_ == size_) {
+      return false;
+    }
+    std::string pad(48, static_cast<char>('a' + next_ % 26));
+    *tuple = Tuple({ValueFactory::GetIntegerValue(keys_(random_)), ValueFactory::GetIntegerValue(next_++),
+                    ValueFactory::GetVarcharValue(pad)},
+                   schema_);
+    return true;
+  }
+
+  const Schema *GetOutputSchema() override { return schema_; }
+
+ private:
+  const Schema *schema_;
+  int32_t size_;
+  int32_t next_{0};
+  std::mt19937 random_;
+  std::uniform_int_distribution<int32_t> keys_;
+};
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, ExternalSortBenchmark) {
+  // SELECT k, v, pad FROM t ORDER BY k, over about 10 times as many bytes as the buffer pool holds
+  constexpr int32_t size = 25000;
+  Schema schema({Column("k", TypeId::INTEGER), Column("v", TypeId::INTEGER), Column("pad", TypeId::VARCHAR, 48)});
+  auto *k = MakeColumnValueExpression(schema, 0, "k");
+  SortPlanNode sort_plan{&schema, nullptr, {{OrderByType::Ascending, k}}};
+
+  auto sort = [&](size_t budget) {
+    size_t old_budget = sort_memory_budget;
+    sort_memory_budget = budget;
+    SortExecutor executor(GetExecutorContext(), &sort_plan,
+                          std::make_unique<RandomRowExecutor>(GetExecutorContext(), &schema, size, size / 4));
+    auto start = std::chrono::steady_clock::now();
+    executor.Init();
+    std::vector<std::pair<int32_t, int32_t>> rows;
+    TupleBatch batch;
+    while (executor.NextBatch(&batch)) {
+      for (uint32_t row : batch.GetSelection()) {
+        rows.emplace_back(batch.GetColumn(0).GetInteger(row), batch.GetColumn(1).GetInteger(row));
+        EXPECT_EQ(std::string(batch.GetColumn(2).GetVarchar(row).c_str()),
+                  std::string(48, static_cast<char>('a' + rows.back().second % 26)));
+      }
+    }
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << "budget " << budget << ": " << executor.GetNumRuns() << " runs, "
+              << executor.GetNumIntermediateMerges() << " intermediate merges, " << elapsed.count() << " ms"
+              << std::endl;
+    sort_memory_budget = old_budget;
+    return std::make_pair(rows, executor.GetNumRuns());
+  };
+
+  auto in_memory = sort(sort_memory_budget);
+  ASSERT_EQ(in_memory.second, 0);
+  auto external = sort(64 * 1024);
+  ASSERT_GT(external.second, SortExecutor::MAX_MERGE_FANIN);
+
+  // The sort is stable: equal keys keep the order of v.
+  ASSERT_EQ(in_memory.first.size(), size);
+  ASSERT_TRUE(std::is_sorted(in_memory.first.begin(), in_memory.first.end()));
+  ASSERT_EQ(in_memory.first, external.first);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, TopNTest) {
+  // SELECT k, v FROM t ORDER BY k DESC LIMIT 20 OFFSET 5
+  constexpr int32_t size = 5000;
+  auto *table_info = MakeKeyValueTable("t", size, [](int32_t i) { return i * 7919 % 1000; });
+  auto scan_plan = MakeKeyValueScan(table_info);
+  const Schema *out_schema = scan_plan->OutputSchema();
+  auto *k = MakeColumnValueExpression(*out_schema, 0, "k");
+  TopNPlanNode topn_plan{out_schema, scan_plan.get(), {{OrderByType::Descending, k}}, 20, 5};
+
+  // Equal keys keep the order of the table, which is the order of v.
+  std::vector<std::pair<int32_t, int32_t>> expected;
+  for (int32_t i = 0; i < size; i++) {
+    expected.emplace_back(-(i * 7919 % 1000), i);
+  }
+  std::sort(expected.begin(), expected.end());
+  expected = std::vector<std::pair<int32_t, int32_t>>(expected.begin() + 5, expected.begin() + 25);
+
+  auto run_topn = [&](bool serial) {
+    auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &topn_plan);
+    auto *topn = dynamic_cast<TopNExecutor *>(executor.get());
+    EXPECT_NE(topn, nullptr);
+    std::vector<std::pair<int32_t, int32_t>> rows;
+    // Running it twice must not keep the bound of the first run.
+    for (int run = 0; run < 2; run++) {
+      rows.clear();
+      executor->Init();
+      TupleBatch batch;
+      while (executor->NextBatch(&batch)) {
+        for (uint32_t row : batch.GetSelection()) {
+          rows.emplace_back(-batch.GetColumn(0).GetInteger(row), batch.GetColumn(1).GetInteger(row));
+        }
+      }
+    }
+    // Once the heap is full, the scan drops all but the few tuples that still beat its bound. Parallel scans may
+    // well read the whole table before the first bound is published.
+    if (serial) {
+      EXPECT_GT(topn->GetNumFiltered(), size / 2);
+    }
+    return rows;
+  };
+
+  ASSERT_EQ(run_topn(true), expected);
+
+  size_t threads = execution_threads;
+  execution_threads = 4;
+  auto parallel = run_topn(false);
+  execution_threads = threads;
+  // The threads read the table out of order, so only the keys are the same.
+  ASSERT_EQ(parallel.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    ASSERT_EQ(parallel[i].first, expected[i].first);
+  }
+
+  TopNPlanNode empty_plan{out_schema, scan_plan.get(), {{OrderByType::Descending, k}}, 0};
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&empty_plan, &result_set, GetTxn(), GetExecutorContext());
+  ASSERT_TRUE(result_set.empty());
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, MergeJoinTest) {
+  // SELECT l.k, l.v, r.k, r.v FROM l JOIN r ON l.k = r.k, with runs of equal keys on both sides
+  constexpr int32_t size = 600;
+  auto *left_info = MakeKeyValueTable("l", size, [](int32_t i) { return i * 7 % 101; });
+  auto *right_info = MakeKeyValueTable("r", size / 2, [](int32_t i) { return i * 13 % 151; });
+  auto left_scan = MakeKeyValueScan(left_info);
+  auto right_scan = MakeKeyValueScan(right_info);
+  const Schema *left_schema = left_scan->OutputSchema();
+  const Schema *right_schema = right_scan->OutputSchema();
+  auto *lk = MakeColumnValueExpression(*left_schema, 0, "k");
+  auto *lv = MakeColumnValueExpression(*left_schema, 0, "v");
+  auto *rk = MakeColumnValueExpression(*right_schema, 1, "k");
+  auto *rv = MakeColumnValueExpression(*right_schema, 1, "v");
+  auto *out_schema = MakeOutputSchema({{"lk", lk}, {"lv", lv}, {"rk", rk}, {"rv", rv}});
+  SortPlanNode left_sort{left_schema, left_scan.get(), {{OrderByType::Ascending, lk}}};
+  SortPlanNode right_sort{right_schema, right_scan.get(), {{OrderByType::Ascending, rk}}};
+
+  auto rows_of = [&](const std::vector<Tuple> &result_set) {
+    std::vector<std::vector<int32_t>> rows;
+    for (const auto &tuple : result_set) {
+      rows.emplace_back();
+      for (uint32_t i = 0; i < 4; i++) {
+        rows.back().push_back(tuple.GetValue(out_schema, i).GetAs<int32_t>());
+      }
+    }
+    return rows;
+  };
+
+  auto *predicate = MakeComparisonExpression(lv, rv, ComparisonType::LessThan);
+  for (const auto *join_predicate : {static_cast<const AbstractExpression *>(nullptr), predicate}) {
+    MergeJoinPlanNode merge_join_plan{out_schema,
+                                      std::vector<const AbstractPlanNode *>{&left_sort, &right_sort},
+                                      std::vector<const AbstractExpression *>{lk},
+                                      std::vector<const AbstractExpression *>{rk}, join_predicate};
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&merge_join_plan, &result_set, GetTxn(), GetExecutorContext());
+    auto merged = rows_of(result_set);
+    // The output comes in the order of the keys.
+    for (size_t i = 1; i < merged.size(); i++) {
+      ASSERT_LE(merged[i - 1][0], merged[i][0]);
+    }
+
+    HashJoinPlanNode hash_join_plan{out_schema,
+                                    std::vector<const AbstractPlanNode *>{left_scan.get(), right_scan.get()},
+                                    std::vector<const AbstractExpression *>{lk},
+                                    std::vector<const AbstractExpression *>{rk}, join_predicate};
+    result_set.clear();
+    GetExecutionEngine()->Execute(&hash_join_plan, &result_set, GetTxn(), GetExecutorContext());
+    auto hashed = rows_of(result_set);
+    ASSERT_FALSE(hashed.empty());
+    std::sort(merged.begin(), merged.end());
+    std::sort(hashed.begin(), hashed.end());
+    ASSERT_EQ(merged, hashed);
+  }
+
+  // Unsorted inputs are caught rather than silently joined.
+  MergeJoinPlanNode unsorted_plan{out_schema, std::vector<const AbstractPlanNode *>{left_scan.get(), &right_sort},
+                                  std::vector<const AbstractExpression *>{lk},
+                                  std::vector<const AbstractExpression *>{rk}};
+  auto executor = ExecutorFactory::CreateExecutor(GetExecutorContext(), &unsorted_plan);
+  executor->Init();
+  Tuple tuple;
+  RID rid;
+  auto drain = [&] {
+    while (executor->Next(&tuple, &rid)) {
+    }
+  };
+  ASSERT_THROW(drain(), Exception);
+
+  // The engine reports the failure instead of a partial result.
+  std::vector<Tuple> result_set;
+  std::string error;
+  ASSERT_FALSE(GetExecutionEngine()->Execute(&unsorted_plan, &result_set, GetTxn(), GetExecutorContext(), &error));
+  ASSERT_EQ(error, "Merge join input is not sorted on its keys.");
+
+  // ... also when the executors fail while they are initialized, as a sort draining the join does.
+  SortPlanNode failing_sort{out_schema, &unsorted_plan, {{OrderByType::Ascending, lk}}};
+  error.clear();
+  ASSERT_FALSE(GetExecutionEngine()->Execute(&failing_sort, &result_set, GetTxn(), GetExecutorContext(), &error));
+  ASSERT_EQ(error, "Merge join input is not sorted on its keys.");
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, MergeJoinStreamingTest) {
+  // Two large sorted inputs are joined in one pass, buffering no more than a run of equal right keys.
+  constexpr int32_t size = 100000;
+  Schema schema({Column("x", TypeId::INTEGER)});
+  auto *left_x = MakeColumnValueExpression(schema, 0, "x");
+  auto *right_x = MakeColumnValueExpression(schema, 1, "x");
+  auto *out_schema = MakeOutputSchema({{"lx", left_x}, {"rx", right_x}});
+  MergeJoinPlanNode join_plan{out_schema, {}, {left_x}, {right_x}};
+  MergeJoinExecutor executor(GetExecutorContext(), &join_plan,
+                             std::make_unique<CountingExecutor>(GetExecutorContext(), &schema, size),
+                             std::make_unique<CountingExecutor>(GetExecutorContext(), &schema, size / 2));
+  executor.Init();
+  int32_t expected = 0;
+  Tuple tuple;
+  RID rid;
+  while (executor.Next(&tuple, &rid)) {
+    ASSERT_EQ(tuple.GetValue(out_schema, 0).GetAs<int32_t>(), expected);
+    ASSERT_EQ(tuple.GetValue(out_schema, 1).GetAs<int32_t>(), expected++);
+  }
+  ASSERT_EQ(expected, size / 2);
+  ASSERT_EQ(executor.GetMaxRunSize(), 1);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, OptimizerTest) {
+  // SELECT l.k, r.v FROM l, r WHERE l.k = r.k AND l.v < 1500 AND r.v < 1500 AND l.v < r.v
+  constexpr int32_t size = 2000;
+  auto *left_info = MakeKeyValueTable("l", size, [](int32_t i) { return i; });
+  auto *right_info = MakeKeyValueTable("r", size, [](int32_t i) { return size - 1 - i; });
+  auto left_scan = MakeKeyValueScan(left_info);
+  auto right_scan = MakeKeyValueScan(right_info);
+  auto *lk = MakeColumnValueExpression(*left_scan->OutputSchema(), 0, "k");
+  auto *lv = MakeColumnValueExpression(*left_scan->OutputSchema(), 0, "v");
+  auto *rk = MakeColumnValueExpression(*right_scan->OutputSchema(), 1, "k");
+  auto *rv = MakeColumnValueExpression(*right_scan->OutputSchema(), 1, "v");
+  auto *out_schema = MakeOutputSchema({{"lk", lk}, {"rv", rv}});
+  auto *predicate = MakeComparisonExpression(lk, rk, ComparisonType::Equal);
+  predicate = MakeLogicExpression(
+      predicate,
+      MakeComparisonExpression(lv, MakeConstantValueExpression(ValueFactory::GetIntegerValue(1500)),
+                               ComparisonType::LessThan),
+      LogicType::And);
+  predicate = MakeLogicExpression(
+      predicate,
+      MakeComparisonExpression(rv, MakeConstantValueExpression(ValueFactory::GetIntegerValue(1500)),
+                               ComparisonType::LessThan),
+      LogicType::And);
+  predicate = MakeLogicExpression(predicate, MakeComparisonExpression(lv, rv, ComparisonType::LessThan),
+                                  LogicType::And);
+  NestedLoopJoinPlanNode join_plan{out_schema, std::vector<const AbstractPlanNode *>{left_scan.get(), right_scan.get()},
+                                   predicate};
+
+  // The join becomes a hash join on k, the single-side conjuncts move into the scans, and l.v is no longer needed
+  // once its predicate is in the scan.
+  Optimizer optimizer;
+  const AbstractPlanNode *optimized = optimizer.Optimize(&join_plan);
+  ASSERT_EQ(optimized->GetType(), PlanType::HashJoin);
+  auto *hash_join = dynamic_cast<const HashJoinPlanNode *>(optimized);
+  ASSERT_EQ(hash_join->GetLeftKeys().size(), 1);
+  ASSERT_NE(hash_join->Predicate(), nullptr);
+  ASSERT_EQ(hash_join->GetLeftPlan()->GetType(), PlanType::SeqScan);
+  ASSERT_EQ(hash_join->GetRightPlan()->GetType(), PlanType::SeqScan);
+  auto *left = dynamic_cast<const SeqScanPlanNode *>(hash_join->GetLeftPlan());
+  auto *right = dynamic_cast<const SeqScanPlanNode *>(hash_join->GetRightPlan());
+  ASSERT_NE(left->GetPredicate(), nullptr);
+  ASSERT_NE(right->GetPredicate(), nullptr);
+  ASSERT_EQ(left->OutputSchema()->GetColumnCount(), 2);
+  ASSERT_EQ(right->OutputSchema()->GetColumnCount(), 2);
+  ASSERT_EQ(optimized->OutputSchema()->GetColumnCount(), 2);
+  // The original plan is left as it was.
+  ASSERT_EQ(join_plan.GetLeftPlan(), left_scan.get());
+
+  auto run = [&](bool optimize) {
+    bool old_enable_optimizer = enable_optimizer;
+    enable_optimizer = optimize;
+    std::vector<Tuple> result_set;
+    auto start = std::chrono::steady_clock::now();
+    GetExecutionEngine()->Execute(&join_plan, &result_set, GetTxn(), GetExecutorContext());
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << (optimize ? "optimized" : "as written") << ": " << elapsed.count() << " ms" << std::endl;
+    enable_optimizer = old_enable_optimizer;
+    std::vector<std::pair<int32_t, int32_t>> rows;
+    for (const auto &tuple : result_set) {
+      rows.emplace_back(tuple.GetValue(out_schema, 0).GetAs<int32_t>(), tuple.GetValue(out_schema, 1).GetAs<int32_t>());
+    }
+    std::sort(rows.begin(), rows.end());
+    return rows;
+  };
+  auto expected = run(false);
+  // l.k = r.k holds for r.v = size - 1 - l.v, so l.v is in [500, 1500), and below r.v up to 999.
+  ASSERT_EQ(expected.size(), 500);
+  ASSERT_EQ(run(true), expected);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, OptimizerThreeWayJoinTest) {
+  // SELECT a.v, c.v FROM a, b, c WHERE a.k = b.k AND b.v = c.k AND a.v < 50, written as a cross join of a and b
+  // joined with c on the whole predicate
+  constexpr int32_t size = 200;
+  auto *a_info = MakeKeyValueTable("a", size, [](int32_t i) { return i % 100; });
+  auto *b_info = MakeKeyValueTable("b", size, [](int32_t i) { return i % 50; });
+  auto *c_info = MakeKeyValueTable("c", size / 2, [](int32_t i) { return i / 2; });
+  auto a_scan = MakeKeyValueScan(a_info);
+  auto b_scan = MakeKeyValueScan(b_info);
+  auto c_scan = MakeKeyValueScan(c_info);
+  const Schema *scan_schema = a_scan->OutputSchema();
+  auto *ak = MakeColumnValueExpression(*scan_schema, 0, "k");
+  auto *av = MakeColumnValueExpression(*scan_schema, 0, "v");
+  auto *bk = MakeColumnValueExpression(*scan_schema, 1, "k");
+  auto *bv = MakeColumnValueExpression(*scan_schema, 1, "v");
+  auto *ab_schema = MakeOutputSchema({{"ak", ak}, {"av", av}, {"bk", bk}, {"bv", bv}});
+  NestedLoopJoinPlanNode ab_plan{ab_schema, std::vector<const AbstractPlanNode *>{a_scan.get(), b_scan.get()},
+                                 nullptr};
+
+  auto *ab_ak = MakeColumnValueExpression(*ab_schema, 0, "ak");
+  auto *ab_av = MakeColumnValueExpression(*ab_schema, 0, "av");
+  auto *ab_bk = MakeColumnValueExpression(*ab_schema, 0, "bk");
+  auto *ab_bv = MakeColumnValueExpression(*ab_schema, 0, "bv");
+  auto *ck = MakeColumnValueExpression(*scan_schema, 1, "k");
+  auto *cv = MakeColumnValueExpression(*scan_schema, 1, "v");
+  auto *out_schema = MakeOutputSchema({{"av", ab_av}, {"cv", cv}});
+  auto *predicate = MakeLogicExpression(
+      MakeLogicExpression(MakeComparisonExpression(ab_ak, ab_bk, ComparisonType::Equal),
+                          MakeComparisonExpression(ab_bv, ck, ComparisonType::Equal), LogicType::And),
+      MakeComparisonExpression(ab_av, MakeConstantValueExpression(ValueFactory::GetIntegerValue(50)),
+                               ComparisonType::LessThan),
+      LogicType::And);
+  NestedLoopJoinPlanNode abc_plan{out_schema, std::vector<const AbstractPlanNode *>{&ab_plan, c_scan.get()},
+                                  predicate};
+
+  // a.k = b.k moves into the inner join, which becomes a hash join too, and a.v < 50 on into the scan of a.
+  Optimizer optimizer;
+  const AbstractPlanNode *optimized = optimizer.Optimize(&abc_plan);
+  ASSERT_EQ(optimized->GetType(), PlanType::HashJoin);
+  auto *outer = dynamic_cast<const HashJoinPlanNode *>(optimized);
+  ASSERT_EQ(outer->Predicate(), nullptr);
+  ASSERT_EQ(outer->GetLeftPlan()->GetType(), PlanType::HashJoin);
+  auto *inner = dynamic_cast<const HashJoinPlanNode *>(outer->GetLeftPlan());
+  ASSERT_EQ(inner->Predicate(), nullptr);
+  // The inner join only passes on a.v and b.v.
+  ASSERT_EQ(inner->OutputSchema()->GetColumnCount(), 2);
+  ASSERT_NE(dynamic_cast<const SeqScanPlanNode *>(inner->GetLeftPlan())->GetPredicate(), nullptr);
+  ASSERT_EQ(dynamic_cast<const SeqScanPlanNode *>(inner->GetRightPlan())->GetPredicate(), nullptr);
+
+  auto run = [&](bool optimize) {
+    bool old_enable_optimizer = enable_optimizer;
+    enable_optimizer = optimize;
+    std::vector<Tuple> result_set;
+    auto start = std::chrono::steady_clock::now();
+    GetExecutionEngine()->Execute(&abc_plan, &result_set, GetTxn(), GetExecutorContext());
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << (optimize ? "optimized" : "as written") << ": " << elapsed.count() << " ms" << std::endl;
+    enable_optimizer = old_enable_optimizer;
+    std::vector<std::pair<int32_t, int32_t>> rows;
+    for (const auto &tuple : result_set) {
+      rows.emplace_back(tuple.GetValue(out_schema, 0).GetAs<int32_t>(), tuple.GetValue(out_schema, 1).GetAs<int32_t>());
+    }
+    std::sort(rows.begin(), rows.end());
+    return rows;
+  };
+  auto expected = run(false);
+  // Each a.v < 50 matches the 4 rows of b with its key, 1 of which has a v that matches 2 rows of c.
+  ASSERT_EQ(expected.size(), 50 * 2);
+  ASSERT_EQ(run(true), expected);
+}
+
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, JoinOrderTest) {
+  // SELECT d1.k, f.v FROM d1, d2, f WHERE d1.k = f.k AND d2.k = f.v AND d2.v < 100, written as a cross join of d1
+  // and d2 joined with f on the whole predicate
+  auto *d1_info = MakeKeyValueTable("d1", 200, [](int32_t i) { return i; });
+  auto *d2_info = MakeKeyValueTable("d2", 1000, [](int32_t i) { return i; });
+  auto *f_info = MakeKeyValueTable("f", 2000, [](int32_t i) { return i % 200; });
+  for (const char *table : {"d1", "d2", "f"}) {
+    ASSERT_NE(GetCatalog()->Analyze(GetTxn(), table), nullptr);
+  }
+  auto d1_scan = MakeKeyValueScan(d1_info);
+  auto d2_scan = MakeKeyValueScan(d2_info);
+  auto f_scan = MakeKeyValueScan(f_info);
+  const Schema *scan_schema = f_scan->OutputSchema();
+  auto *d12_schema = MakeOutputSchema({{"d1k", MakeColumnValueExpression(*scan_schema, 0, "k")},
+                                       {"d2k", MakeColumnValueExpression(*scan_schema, 1, "k")},
+                                       {"d2v", MakeColumnValueExpression(*scan_schema, 1, "v")}});
+  NestedLoopJoinPlanNode d12_plan{d12_schema, std::vector<const AbstractPlanNode *>{d1_scan.get(), d2_scan.get()},
+                                  nullptr};
+  auto *d1k = MakeColumnValueExpression(*d12_schema, 0, "d1k");
+  auto *d2k = MakeColumnValueExpression(*d12_schema, 0, "d2k");
+  auto *d2v = MakeColumnValueExpression(*d12_schema, 0, "d2v");
+  auto *fk = MakeColumnValueExpression(*scan_schema, 1, "k");
+  auto *fv = MakeColumnValueExpression(*scan_schema, 1, "v");
+  auto *out_schema = MakeOutputSchema({{"d1k", d1k}, {"fv", fv}});
+  auto *predicate = MakeLogicExpression(
+      MakeLogicExpression(MakeComparisonExpression(d1k, fk, ComparisonType::Equal),
+                          MakeComparisonExpression(d2k, fv, ComparisonType::Equal), LogicType::And),
+      MakeComparisonExpression(d2v, MakeConstantValueExpression(ValueFactory::GetIntegerValue(100)),
+                               ComparisonType::LessThan),
+      LogicType::And);
+  NestedLoopJoinPlanNode plan{out_schema, std::vector<const AbstractPlanNode *>{&d12_plan, f_scan.get()}, predicate};
+
+  // Without statistics the cross join stays; with them, f is joined with each dimension on its key instead.
+  Optimizer rule_optimizer;
+  const AbstractPlanNode *written = rule_optimizer.Optimize(&plan);
+  ASSERT_EQ(written->GetChildAt(0)->GetType(), PlanType::NestedLoopJoin);
+  Optimizer cost_optimizer(GetCatalog());
+  const AbstractPlanNode *ordered = cost_optimizer.Optimize(&plan);
+  ASSERT_EQ(ordered->GetType(), PlanType::HashJoin);
+  std::function<size_t(const AbstractPlanNode *)> count_cross_joins = [&](const AbstractPlanNode *node) {
+    size_t count = node->GetType() == PlanType::NestedLoopJoin ? 1 : 0;
+    for (const auto *child : node->GetChildren()) {
+      count += count_cross_joins(child);
+    }
+    return count;
+  };
+  ASSERT_EQ(count_cross_joins(ordered), 0);
+  ASSERT_EQ(ordered->OutputSchema()->GetColumnCount(), 2);
+
+  auto run = [&](const AbstractPlanNode *optimized, const char *name, int64_t *elapsed_us) {
+    bool old_enable_optimizer = enable_optimizer;
+    enable_optimizer = false;
+    std::vector<Tuple> result_set;
+    auto start = std::chrono::steady_clock::now();
+    GetExecutionEngine()->Execute(optimized, &result_set, GetTxn(), GetExecutorContext());
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    *elapsed_us = std::chrono::duration_cast<std::chrono::microseconds>(elapsed).count();
+    std::cout << name << ": " << *elapsed_us << " us" << std::endl;
+    enable_optimizer = old_enable_optimizer;
+    std::vector<std::pair<int32_t, int32_t>> rows;
+    for (const auto &tuple : result_set) {
+      rows.emplace_back(tuple.GetValue(out_schema, 0).GetAs<int32_t>(), tuple.GetValue(out_schema, 1).GetAs<int32_t>());
+    }
+    std::sort(rows.begin(), rows.end());
+    return rows;
+  };
+  int64_t written_us;
+  int64_t ordered_us;
+  auto expected = run(written, "written order", &written_us);
+  // The rows of f whose v is below 100.
+  ASSERT_EQ(expected.size(), 100);
+  ASSERT_EQ(run(ordered, "cost-based order", &ordered_us), expected);
+  ASSERT_LT(ordered_us, written_us);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, ZoneMapTest) {
+  // A table of (k, v) = (i, i) loaded in order, with a zone map of k kept from its creation on
+  Schema schema({Column("k", TypeId::INTEGER), Column("v", TypeId::INTEGER)});
+  auto *load = GetTxnManager()->Begin();
+  auto *table_info = GetCatalog()->CreateTable(load, "z", schema);
+  ZoneMap *zone_map = GetCatalog()->CreateZoneMap(load, "z", {0});
+  for (int32_t i = 0; i < 2000; i++) {
+    RID rid;
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i)};
+    ASSERT_TRUE(table_info->table_->InsertTuple(Tuple(values, &table_info->schema_), &rid, load));
+  }
+  GetTxnManager()->Commit(load);
+  delete load;
+  GetTxnManager()->GarbageCollect();
+  size_t num_pages = zone_map->GetNumZones();
+  ASSERT_GT(num_pages, 4);
+
+  // SELECT k FROM z WHERE k >= 1900, in a transaction, on several threads and then on one, which counts the pages
+  // skipped after the first run has rebuilt the loose zones it read
+  auto *k = MakeColumnValueExpression(table_info->schema_, 0, "k");
+  auto *predicate = MakeComparisonExpression(k, MakeConstantValueExpression(ValueFactory::GetIntegerValue(1900)),
+                                             ComparisonType::GreaterThanOrEqual);
+  SeqScanPlanNode plan{MakeOutputSchema({{"k", k}}), predicate, table_info->oid_};
+  auto run = [&](Transaction *txn, size_t *num_skipped) {
+    size_t count = 0;
+    size_t threads = execution_threads;
+    for (size_t num_threads : {4, 1}) {
+      execution_threads = num_threads;
+      ExecutorContext exec_ctx(txn, GetCatalog(), GetBPM(), GetTxnManager(), GetLockManager());
+      std::vector<Tuple> result_set;
+      GetExecutionEngine()->Execute(&plan, &result_set, txn, &exec_ctx);
+      for (const auto &tuple : result_set) {
+        EXPECT_GE(tuple.GetValue(plan.OutputSchema(), 0).GetAs<int32_t>(), 1900);
+      }
+      if (num_threads == 4) {
+        count = result_set.size();
+      }
+      EXPECT_EQ(count, result_set.size());
+      *num_skipped = exec_ctx.GetNumSkippedPages();
+    }
+    execution_threads = threads;
+    return count;
+  };
+  auto delete_where = [&](Transaction *txn, const std::function<bool(int32_t)> &matches) {
+    std::vector<RID> rids;
+    for (auto it = table_info->table_->Begin(txn); it != table_info->table_->End(); ++it) {
+      if (matches(it->GetValue(&table_info->schema_, 0).GetAs<int32_t>())) {
+        rids.push_back(it->GetRid());
+      }
+    }
+    for (const auto &rid : rids) {
+      ASSERT_TRUE(table_info->table_->MarkDelete(rid, txn));
+    }
+  };
+
+  // Only the pages holding the last keys are read.
+  size_t num_skipped;
+  ASSERT_EQ(run(GetTxn(), &num_skipped), 100);
+  ASSERT_GE(num_skipped, num_pages - 2);
+  size_t all_skipped = num_skipped;
+
+  // An update widens the zone of its page.
+  auto *writer = GetTxnManager()->Begin();
+  RID first_rid = table_info->table_->Begin(writer)->GetRid();
+  std::vector<Value> updated{ValueFactory::GetIntegerValue(1950), ValueFactory::GetIntegerValue(0)};
+  ASSERT_TRUE(table_info->table_->UpdateTuple(Tuple(updated, &table_info->schema_), first_rid, writer));
+  GetTxnManager()->Commit(writer);
+  delete writer;
+  ASSERT_EQ(run(GetTxn(), &num_skipped), 101);
+  ASSERT_EQ(num_skipped, all_skipped - 1);
+
+  // A delete leaves the zone loose, and the scan that reads the page next rebuilds it once no old version is kept.
+  writer = GetTxnManager()->Begin();
+  ASSERT_TRUE(table_info->table_->MarkDelete(first_rid, writer));
+  GetTxnManager()->Commit(writer);
+  delete writer;
+  ASSERT_EQ(run(GetTxn(), &num_skipped), 100);
+  ASSERT_EQ(num_skipped, all_skipped - 1);
+  GetTxnManager()->GarbageCollect();
+  ASSERT_EQ(table_info->table_->GetVersionStore()->GetVersionCount(), 0);
+  ASSERT_EQ(run(GetTxn(), &num_skipped), 100);
+  ASSERT_EQ(num_skipped, all_skipped);
+
+  // The zones keep covering the versions that a snapshot still reads.
+  auto *reader = GetTxnManager()->Begin(nullptr, IsolationLevel::SNAPSHOT_ISOLATION);
+  writer = GetTxnManager()->Begin();
+  delete_where(writer, [](int32_t key) { return key >= 1900; });
+  GetTxnManager()->Commit(writer);
+  delete writer;
+  GetTxnManager()->GarbageCollect();
+  ASSERT_EQ(run(GetTxn(), &num_skipped), 0);
+  ASSERT_EQ(run(reader, &num_skipped), 100);
+  GetTxnManager()->Commit(reader);
+  delete reader;
+  GetTxnManager()->GarbageCollect();
+  ASSERT_EQ(run(GetTxn(), &num_skipped), 0);
+  ASSERT_EQ(num_skipped, num_pages);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, ResultSinkTest) {
+  // SELECT k, v FROM r WHERE v >= 0, over 10000 rows
+  auto *table_info = MakeKeyValueTable("r", 10000, [](int32_t i) { return i; });
+  auto *k = MakeColumnValueExpression(table_info->schema_, 0, "k");
+  auto *v = MakeColumnValueExpression(table_info->schema_, 0, "v");
+  auto *predicate = MakeComparisonExpression(v, MakeConstantValueExpression(ValueFactory::GetIntegerValue(0)),
+                                             ComparisonType::GreaterThanOrEqual);
+  SeqScanPlanNode plan{MakeOutputSchema({{"k", k}, {"v", v}}), predicate, table_info->oid_};
+  size_t threads = execution_threads;
+
+  // A sink that stops early closes the executors, down to the threads of a parallel scan.
+  execution_threads = 4;
+  std::vector<Tuple> first_rows;
+  TupleResultSink first_ten([&](Tuple &&tuple) {
+    first_rows.emplace_back(std::move(tuple));
+    return first_rows.size() < 10;
+  });
+  GetExecutionEngine()->Stream(&plan, &first_ten, GetTxn(), GetExecutorContext());
+  ASSERT_EQ(first_rows.size(), 10);
+  for (const auto &tuple : first_rows) {
+    ASSERT_EQ(tuple.GetValue(plan.OutputSchema(), 0).GetAs<int32_t>(),
+              tuple.GetValue(plan.OutputSchema(), 1).GetAs<int32_t>());
+  }
+
+  // Time to first row and the bytes of the result held at once, materialized and streamed
+  execution_threads = 1;
+  auto bytes_of = [](const Tuple &tuple) { return sizeof(Tuple) + tuple.GetLength(); };
+  auto start = std::chrono::steady_clock::now();
+  std::vector<Tuple> result_set;
+  GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+  auto materialized_us =
+      std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+  size_t materialized_bytes = 0;
+  for (const auto &tuple : result_set) {
+    materialized_bytes += bytes_of(tuple);
+  }
+  ASSERT_EQ(result_set.size(), 10000);
+  result_set.clear();
+
+  class MeasuringSink : public ResultSink {
+   public:
+    bool Consume(const TupleBatch &batch) override {
+      if (num_rows_ == 0) {
+        first_row_ = std::chrono::steady_clock::now();
+      }
+      size_t bytes = 0;
+      for (uint32_t row : batch.GetSelection()) {
+        Tuple tuple = batch.GetTuple(row);
+        bytes += sizeof(Tuple) + tuple.GetLength();
+      }
+      peak_bytes_ = std::max(peak_bytes_, bytes);
+      num_rows_ += batch.NumSelected();
+      return true;
+    }
+
+    std::chrono::steady_clock::time_point first_row_;
+    size_t peak_bytes_{0};
+    size_t num_rows_{0};
+  };
+  MeasuringSink sink;
+  start = std::chrono::steady_clock::now();
+  GetExecutionEngine()->Stream(&plan, &sink, GetTxn(), GetExecutorContext());
+  auto streamed_us = std::chrono::duration_cast<std::chrono::microseconds>(sink.first_row_ - start).count();
+  execution_threads = threads;
+  ASSERT_EQ(sink.num_rows_, 10000);
+  std::cout << "materialized: first row after " << materialized_us << " us, " << materialized_bytes
+            << " bytes held" << std::endl;
+  std::cout << "streamed: first row after " << streamed_us << " us, " << sink.peak_bytes_ << " bytes held"
+            << std::endl;
+  ASSERT_LT(streamed_us, materialized_us);
+  ASSERT_LE(sink.peak_bytes_ * 4, materialized_bytes);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, PreparedPlanTest) {
+  // SELECT k, v FROM p WHERE k = ?, over 2000 committed rows (k, v) = (i, i) with a zone map of k
+  Schema table_schema({Column("k", TypeId::INTEGER), Column("v", TypeId::INTEGER)});
+  auto *load = GetTxnManager()->Begin();
+  auto *table_info = GetCatalog()->CreateTable(load, "p", table_schema);
+  for (int32_t i = 0; i < 2000; i++) {
+    RID rid;
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i)};
+    ASSERT_TRUE(table_info->table_->InsertTuple(Tuple(values, &table_info->schema_), &rid, load));
+  }
+  GetTxnManager()->Commit(load);
+  delete load;
+  GetTxnManager()->GarbageCollect();
+  GetCatalog()->CreateZoneMap(GetTxn(), "p", {0});
+  const std::string shape = "SELECT k, v FROM p WHERE k = ?";
+  auto make_prepared = [&] {
+    auto prepared = std::make_unique<PreparedPlan>();
+    auto *k = prepared->Own(std::make_unique<ColumnValueExpression>(0, 0, TypeId::INTEGER));
+    auto *v = prepared->Own(std::make_unique<ColumnValueExpression>(0, 1, TypeId::INTEGER));
+    auto *predicate = prepared->Own(
+        std::make_unique<ComparisonExpression>(k, prepared->MakeParameter(TypeId::INTEGER), ComparisonType::Equal));
+    auto *schema = prepared->Own(std::make_unique<Schema>(
+        std::vector<Column>{Column("k", TypeId::INTEGER, k), Column("v", TypeId::INTEGER, v)}));
+    auto *plan = prepared->Own(std::make_unique<SeqScanPlanNode>(schema, predicate, table_info->oid_));
+    return std::make_pair(std::move(prepared), plan);
+  };
+  size_t threads = execution_threads;
+  execution_threads = 1;
+
+  // The plan is prepared once and found in the cache by the shape of the query.
+  ASSERT_EQ(GetExecutionEngine()->GetPreparedPlan(shape), nullptr);
+  auto [owned, root] = make_prepared();
+  auto prepared = GetExecutionEngine()->Prepare(shape, std::move(owned), root, GetExecutorContext());
+  ASSERT_EQ(GetExecutionEngine()->GetPreparedPlan(shape), prepared);
+  ASSERT_EQ(prepared->GetNumParameters(), 1);
+
+  // Every execution sees the values bound to it, cast to the type of the parameter, and skips pages by them.
+  auto run = [&](const Value &key) {
+    std::vector<Tuple> result_set;
+    VectorResultSink sink(&result_set);
+    GetExecutionEngine()->ExecutePrepared(prepared.get(), {key}, &sink, GetExecutorContext());
+    return result_set;
+  };
+  for (int32_t key : {0, 1234, 1999, 1234}) {
+    auto result_set = run(ValueFactory::GetIntegerValue(key));
+    ASSERT_EQ(result_set.size(), 1);
+    ASSERT_EQ(result_set[0].GetValue(prepared->GetOutputSchema(), 0).GetAs<int32_t>(), key);
+    ASSERT_EQ(result_set[0].GetValue(prepared->GetOutputSchema(), 1).GetAs<int32_t>(), key);
+    ASSERT_GT(GetExecutorContext()->GetNumSkippedPages(), 0);
+  }
+  auto result_set = run(ValueFactory::GetBigIntValue(42));
+  ASSERT_EQ(result_set.size(), 1);
+  ASSERT_EQ(result_set[0].GetValue(prepared->GetOutputSchema(), 0).GetAs<int32_t>(), 42);
+  ASSERT_TRUE(run(ValueFactory::GetIntegerValue(5000)).empty());
+  ASSERT_TRUE(run(ValueFactory::GetNullValueByType(TypeId::INTEGER)).empty());
+  ASSERT_THROW(GetExecutionEngine()->ExecutePrepared(prepared.get(), {}, nullptr, GetExecutorContext()), Exception);
+
+  // Concurrent executions of the plan each see their own values, serially and in parallel.
+  for (size_t num_threads : {1, 4}) {
+    execution_threads = num_threads;
+    std::vector<std::thread> threads;
+    for (int32_t t = 0; t < 4; t++) {
+      threads.emplace_back([&, t] {
+        auto *txn = GetTxnManager()->Begin();
+        ExecutorContext exec_ctx(txn, GetCatalog(), GetBPM(), GetTxnManager(), GetLockManager());
+        for (int32_t i = 0; i < 50; i++) {
+          int32_t key = (t * 50 + i) * 7 % 2000;
+          std::vector<Tuple> result_set;
+          VectorResultSink sink(&result_set);
+          EXPECT_TRUE(GetExecutionEngine()->ExecutePrepared(prepared.get(), {ValueFactory::GetIntegerValue(key)}, &sink,
+                                                            &exec_ctx));
+          EXPECT_EQ(result_set.size(), 1);
+          if (!result_set.empty()) {
+            EXPECT_EQ(result_set[0].GetValue(prepared->GetOutputSchema(), 0).GetAs<int32_t>(), key);
+          }
+        }
+        GetTxnManager()->Commit(txn);
+        delete txn;
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+  }
+  execution_threads = 1;
+
+  // A second prepare of the same shape keeps the cached plan.
+  auto [other, other_root] = make_prepared();
+  ASSERT_EQ(GetExecutionEngine()->Prepare(shape, std::move(other), other_root, GetExecutorContext()), prepared);
+
+  // Point queries built from scratch and run through the optimizer and the executor factory, against the prepared plan
+  constexpr int32_t queries = 2000;
+  auto time = [](const std::function<void(int32_t)> &query) {
+    auto start = std::chrono::steady_clock::now();
+    for (int32_t i = 0; i < queries; i++) {
+      query(i * 7 % 2000);
+    }
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count() /
+           queries;
+  };
+  size_t fresh_rows = 0;
+  auto fresh_ns = time([&](int32_t key) {
+    auto *k = MakeColumnValueExpression(table_info->schema_, 0, "k");
+    auto *v = MakeColumnValueExpression(table_info->schema_, 0, "v");
+    auto *constant = MakeConstantValueExpression(ValueFactory::GetIntegerValue(key));
+    auto *predicate = MakeComparisonExpression(k, constant, ComparisonType::Equal);
+    SeqScanPlanNode plan{MakeOutputSchema({{"k", k}, {"v", v}}), predicate, table_info->oid_};
+    std::vector<Tuple> result_set;
+    GetExecutionEngine()->Execute(&plan, &result_set, GetTxn(), GetExecutorContext());
+    fresh_rows += result_set.size();
+  });
+  size_t prepared_rows = 0;
+  auto prepared_ns = time([&](int32_t key) { prepared_rows += run(ValueFactory::GetIntegerValue(key)).size(); });
+  execution_threads = threads;
+  ASSERT_EQ(fresh_rows, queries);
+  ASSERT_EQ(prepared_rows, queries);
+  std::cout << "fresh plan: " << fresh_ns << " ns per query" << std::endl;
+  std::cout << "prepared plan: " << prepared_ns << " ns per query" << std::endl;
+  ASSERT_LT(prepared_ns, fresh_ns);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, PlanCacheTest) {
+  // SELECT v FROM c WHERE k = ?, over 100 committed rows (k, v) = (i, 2 * i), cached under a shape per name
+  Schema table_schema({Column("k", TypeId::INTEGER), Column("v", TypeId::INTEGER)});
+  auto *load = GetTxnManager()->Begin();
+  auto *table_info = GetCatalog()->CreateTable(load, "c", table_schema);
+  for (int32_t i = 0; i < 100; i++) {
+    RID rid;
+    std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(2 * i)};
+    ASSERT_TRUE(table_info->table_->InsertTuple(Tuple(values, &table_info->schema_), &rid, load));
+  }
+  GetTxnManager()->Commit(load);
+  delete load;
+  auto prepare = [&](const std::string &shape) {
+    auto prepared = std::make_unique<PreparedPlan>();
+    auto *k = prepared->Own(std::make_unique<ColumnValueExpression>(0, 0, TypeId::INTEGER));
+    auto *v = prepared->Own(std::make_unique<ColumnValueExpression>(0, 1, TypeId::INTEGER));
+    auto *predicate = prepared->Own(
+        std::make_unique<ComparisonExpression>(k, prepared->MakeParameter(TypeId::INTEGER), ComparisonType::Equal));
+    auto *schema = prepared->Own(std::make_unique<Schema>(std::vector<Column>{Column("v", TypeId::INTEGER, v)}));
+    auto *plan = prepared->Own(std::make_unique<SeqScanPlanNode>(schema, predicate, table_info->oid_));
+    return GetExecutionEngine()->Prepare(shape, std::move(prepared), plan, GetExecutorContext());
+  };
+  auto run = [&](PreparedPlan *prepared, int32_t key) {
+    std::vector<Tuple> result_set;
+    VectorResultSink sink(&result_set);
+    EXPECT_TRUE(GetExecutionEngine()->ExecutePrepared(prepared, {ValueFactory::GetIntegerValue(key)}, &sink,
+                                                      GetExecutorContext()));
+    EXPECT_EQ(result_set.size(), 1);
+    return result_set.empty() ? -1 : result_set[0].GetValue(prepared->GetOutputSchema(), 0).GetAs<int32_t>();
+  };
+  size_t cache_size = plan_cache_size;
+  plan_cache_size = 2;
+
+  // The least recently used plan is evicted, but lives on while it is held.
+  auto a = prepare("a");
+  auto b = prepare("b");
+  ASSERT_EQ(GetExecutionEngine()->GetPreparedPlan("a"), a);
+  auto c = prepare("c");
+  ASSERT_EQ(GetExecutionEngine()->GetPreparedPlan("b"), nullptr);
+  ASSERT_EQ(GetExecutionEngine()->GetPreparedPlan("a"), a);
+  ASSERT_EQ(GetExecutionEngine()->GetPreparedPlan("c"), c);
+  ASSERT_EQ(run(b.get(), 7), 14);
+
+  // ANALYZE makes the cached plans stale, so the query is planned again with the new statistics.
+  ASSERT_EQ(table_info->stats_, nullptr);
+  GetCatalog()->Analyze(GetTxn(), "c");
+  ASSERT_EQ(GetExecutionEngine()->GetPreparedPlan("a"), nullptr);
+  auto replanned = prepare("a");
+  ASSERT_NE(replanned, a);
+  ASSERT_EQ(replanned->GetCatalogVersion(), GetCatalog()->GetVersion());
+  ASSERT_EQ(GetExecutionEngine()->GetPreparedPlan("a"), replanned);
+  ASSERT_EQ(run(replanned.get(), 42), 84);
+  ASSERT_EQ(run(a.get(), 42), 84);
+
+  // A stale plan is replaced by a new prepare of its shape even if it was not looked up.
+  ASSERT_NE(prepare("c"), c);
+  plan_cache_size = cache_size;
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExecutorTest, TableLockBlocksWritersTest) {
+  // Rows are only locked while logging is enabled, which the fixture runs without.
+  {
+    BustubInstance instance("executor_lock_test.db");
+    Catalog catalog(instance.buffer_pool_manager_, instance.lock_manager_, instance.log_manager_);
+    ExecutionEngine engine(instance.buffer_pool_manager_, instance.transaction_manager_, &catalog);
+    auto *txn_mgr = instance.transaction_manager_;
+    instance.log_manager_->RunFlushThread();
+
+    Schema schema({Column("k", TypeId::INTEGER), Column("v", TypeId::INTEGER)});
+    auto *loader = txn_mgr->Begin();
+    auto *table_info = catalog.CreateTable(loader, "locked", schema);
+    std::vector<RID> rids(2);
+    for (int32_t i = 0; i < 2; i++) {
+      std::vector<Value> values{ValueFactory::GetIntegerValue(i), ValueFactory::GetIntegerValue(i)};
+      ASSERT_TRUE(table_info->table_->InsertTuple(Tuple(values, &table_info->schema_), &rids[i], loader));
+    }
+    txn_mgr->Commit(loader);
+    delete loader;
+    auto scan_plan = MakeKeyValueScan(table_info);
+    auto scan = [&](Transaction *txn) {
+      ExecutorContext exec_ctx(txn, &catalog, instance.buffer_pool_manager_, txn_mgr, instance.lock_manager_);
+      std::vector<Tuple> result_set;
+      EXPECT_TRUE(engine.Execute(scan_plan.get(), &result_set, txn, &exec_ctx));
+      std::vector<int32_t> keys;
+      for (const auto &tuple : result_set) {
+        keys.push_back(tuple.GetValue(scan_plan->OutputSchema(), 0).GetAs<int32_t>());
+      }
+      std::sort(keys.begin(), keys.end());
+      return keys;
+    };
+
+    // The reader locks the whole table, so its scan takes no row locks.
+    auto *reader = txn_mgr->Begin();
+    ASSERT_TRUE(instance.lock_manager_->LockTable(reader, LockMode::SHARED, table_info->oid_));
+    EXPECT_EQ((std::vector<int32_t>{0, 1}), scan(reader));
+    EXPECT_TRUE((*reader->GetRowLockSet())[table_info->oid_].empty());
+
+    // An insert, an update and a delete by other transactions all wait for the table lock.
+    std::atomic<int> num_written{0};
+    std::vector<std::thread> writers;
+    writers.emplace_back([&] {
+      auto *writer = txn_mgr->Begin();
+      std::vector<Value> values{ValueFactory::GetIntegerValue(2), ValueFactory::GetIntegerValue(2)};
+      RID rid;
+      EXPECT_TRUE(table_info->table_->InsertTuple(Tuple(values, &table_info->schema_), &rid, writer));
+      num_written++;
+      txn_mgr->Commit(writer);
+      delete writer;
+    });
+    writers.emplace_back([&] {
+      auto *writer = txn_mgr->Begin();
+      std::vector<Value> values{ValueFactory::GetIntegerValue(10), ValueFactory::GetIntegerValue(0)};
+      EXPECT_TRUE(table_info->table_->UpdateTuple(Tuple(values, &table_info->schema_), rids[0], writer));
+      num_written++;
+      txn_mgr->Commit(writer);
+      delete writer;
+    });
+    writers.emplace_back([&] {
+      auto *writer = txn_mgr->Begin();
+      EXPECT_TRUE(table_info->table_->MarkDelete(rids[1], writer));
+      num_written++;
+      txn_mgr->Commit(writer);
+      delete writer;
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    EXPECT_EQ(0, num_written);
+    EXPECT_EQ((std::vector<int32_t>{0, 1}), scan(reader));
+
+    txn_mgr->Commit(reader);
+    delete reader;
+    for (auto &writer : writers) {
+      writer.join();
+    }
+    EXPECT_EQ(3, num_written);
+    auto *late_reader = txn_mgr->Begin();
+    EXPECT_EQ((std::vector<int32_t>{2, 10}), scan(late_reader));
+    txn_mgr->Commit(late_reader);
+    delete late_reader;
+  }
+  EXPECT_FALSE(enable_logging);
+  remove("executor_lock_test.db");
+  remove("executor_lock_test.log");
+  remove("executor_lock_test.dwb");
+}
 }  // namespace bustub
@@ -0,0 +1,279 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// expression_program_test.cpp
+//
+// Identification: test/execution/expression_program_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <chrono>  // NOLINT
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "execution/expression_program.h"
+#include "execution/expressions/aggregate_value_expression.h"
+#include "execution/expressions/column_value_expression.h"
+#include "execution/expressions/comparison_expression.h"
+#include "execution/expressions/constant_value_expression.h"
+#include "execution/expressions/parameter_value_expression.h"
+#include "gtest/gtest.h"
+#include "type/value_factory.h"
+
+namespace bustub {
+
+class ExpressionProgramTest : public ::testing::Test {
+ protected:
+  ExpressionProgramTest()
+      : schema_({Column("a", TypeId::TINYINT), Column("b", TypeId::SMALLINT), Column("c", TypeId::INTEGER),
+                 Column("d", TypeId::BIGINT), Column("e", TypeId::DECIMAL), Column("s", TypeId::VARCHAR, 16),
+                 Column("t", TypeId::VARCHAR, 16)}) {}
+
+  /** @return random tuples of schema_ over a few values each, so that comparisons are often equal, with NULLs */
+  std::vector<Tuple> MakeTuples(size_t count) {
+    std::mt19937 random(15445);
+    std::uniform_int_distribution<int> pick(0, 5);
+    const std::vector<std::string> strings{"", "a", "ab", "abc", "b"};
+    std::vector<Tuple> tuples;
+    for (size_t i = 0; i < count; i++) {
+      std::vector<Value> values;
+      for (uint32_t col = 0; col < schema_.GetColumnCount(); col++) {
+        TypeId type = schema_.GetColumn(col).GetType();
+        int v = pick(random);
+        if (v == 5) {
+          values.emplace_back(ValueFactory::GetNullValueByType(type));
+        } else if (type == TypeId::VARCHAR) {
+          values.emplace_back(ValueFactory::GetVarcharValue(strings[v]));
+        } else if (type == TypeId::DECIMAL) {
+          values.emplace_back(ValueFactory::GetDecimalValue(v - 2.5 + (v % 2) * 0.5));
+        } else {
+          values.emplace_back(ValueFactory::GetIntegerValue(v - 2).CastAs(type));
+        }
+      }
+      tuples.emplace_back(values, &schema_);
+    }
+    return tuples;
+  }
+
+  const AbstractExpression *ColumnRef(uint32_t col_idx) {
+    return Own(std::make_unique<ColumnValueExpression>(0, col_idx, schema_.GetColumn(col_idx).GetType()));
+  }
+
+  const AbstractExpression *Constant(const Value &value) {
+    return Own(std::make_unique<ConstantValueExpression>(value));
+  }
+
+  const AbstractExpression *Compare(const AbstractExpression *lhs, const AbstractExpression *rhs,
+                                    ComparisonType type) {
+    return Own(std::make_unique<ComparisonExpression>(lhs, rhs, type));
+  }
+
+  /** Check that a predicate gives the same results compiled as interpreted, on tuples and on a batch. */
+  void CheckPredicate(const AbstractExpression *predicate, const std::vector<Tuple> &tuples) {
+    auto program = ExpressionProgram::Compile(predicate, &schema_);
+    ASSERT_NE(program, nullptr);
+
+    TupleBatch batch;
+    batch.Reset(&schema_);
+    std::vector<uint32_t> expected;
+    for (uint32_t i = 0; i < tuples.size(); i++) {
+      Value value = predicate->Evaluate(&tuples[i], &schema_);
+      bool matched = !value.IsNull() && value.GetAs<bool>();
+      ASSERT_EQ(matched, program->Evaluate(tuples[i])) << tuples[i].ToString(&schema_) << "\n" << program->ToString();
+      if (matched) {
+        expected.push_back(i);
+      }
+      batch.AppendTuple(tuples[i], RID());
+    }
+
+    // Rows that are not selected must stay out.
+    batch.GetMutableSelection()->erase(batch.GetMutableSelection()->begin());
+    if (!expected.empty() && expected[0] == 0) {
+      expected.erase(expected.begin());
+    }
+    program->Filter(&batch);
+    ASSERT_EQ(expected, batch.GetSelection()) << program->ToString();
+  }
+
+  Schema schema_;
+
+ private:
+  const AbstractExpression *Own(std::unique_ptr<AbstractExpression> &&expr) {
+    exprs_.emplace_back(std::move(expr));
+    return exprs_.back().get();
+  }
+
+  std::vector<std::unique_ptr<AbstractExpression>> exprs_;
+};
+
+// NOLINTNEXTLINE
+TEST_F(ExpressionProgramTest, CompileTest) {
+  auto *c = ColumnRef(2);
+  auto *e = ColumnRef(4);
+  auto *s = ColumnRef(5);
+
+  // Comparisons are specialized for the types they compare, converting integers compared with decimals.
+  auto *one = Constant(ValueFactory::GetIntegerValue(1));
+  auto program = ExpressionProgram::Compile(Compare(c, one, ComparisonType::LessThan), &schema_);
+  ASSERT_NE(program, nullptr);
+  EXPECT_EQ(program->ToString(), "LoadInteger r0, tuple 0 column 2\nLtInteger r2, r0, r1\n");
+  program = ExpressionProgram::Compile(Compare(c, e, ComparisonType::GreaterThanOrEqual), &schema_);
+  ASSERT_NE(program, nullptr);
+  EXPECT_EQ(program->ToString(),
+            "LoadInteger r0, tuple 0 column 2\nLoadDecimal r1, tuple 0 column 4\nIntegerToDecimal r2, r0\n"
+            "GeDecimal r3, r2, r1\n");
+
+  // The right tuple of a join comes after the left one in a batch.
+  Schema right({Column("x", TypeId::VARCHAR, 8)});
+  ColumnValueExpression x(1, 0, TypeId::VARCHAR);
+  program = ExpressionProgram::Compile(Compare(s, &x, ComparisonType::Equal), &schema_, &right);
+  ASSERT_NE(program, nullptr);
+  EXPECT_EQ(program->ToString(),
+            "LoadVarchar r0, tuple 0 column 5\nLoadVarchar r1, tuple 1 column 7\nEqVarchar r2, r0, r1\n");
+
+  // What does not compile is left to the expression tree.
+  EXPECT_EQ(ExpressionProgram::Compile(Compare(s, c, ComparisonType::Equal), &schema_), nullptr);
+  EXPECT_EQ(ExpressionProgram::Compile(c, &schema_), nullptr);
+  AggregateValueExpression aggregate(false, 0, TypeId::INTEGER);
+  EXPECT_EQ(ExpressionProgram::Compile(Compare(&aggregate, c, ComparisonType::Equal), &schema_), nullptr);
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExpressionProgramTest, EvaluateTest) {
+  auto tuples = MakeTuples(500);
+  std::vector<const AbstractExpression *> numbers;
+  for (uint32_t col = 0; col < 5; col++) {
+    numbers.push_back(ColumnRef(col));
+  }
+  numbers.push_back(Constant(ValueFactory::GetIntegerValue(0)));
+  numbers.push_back(Constant(ValueFactory::GetDecimalValue(-0.5)));
+  numbers.push_back(Constant(ValueFactory::GetNullValueByType(TypeId::INTEGER)));
+  std::vector<const AbstractExpression *> strings{ColumnRef(5), ColumnRef(6),
+                                                  Constant(ValueFactory::GetVarcharValue("ab"))};
+
+  const std::vector<ComparisonType> comparisons{ComparisonType::Equal,       ComparisonType::NotEqual,
+                                                ComparisonType::LessThan,    ComparisonType::LessThanOrEqual,
+                                                ComparisonType::GreaterThan, ComparisonType::GreaterThanOrEqual};
+  for (auto comparison : comparisons) {
+    for (const auto &operands : {numbers, strings}) {
+      for (auto *lhs : operands) {
+        for (auto *rhs : operands) {
+          CheckPredicate(Compare(lhs, rhs, comparison), tuples);
+        }
+      }
+    }
+    // Comparisons of comparisons.
+    CheckPredicate(Compare(Compare(numbers[0], numbers[1], ComparisonType::LessThan),
+                           Compare(strings[0], strings[1], comparison), ComparisonType::Equal),
+                   tuples);
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExpressionProgramTest, ParameterTest) {
+  auto tuples = MakeTuples(500);
+  std::vector<Value> parameters{ValueFactory::GetIntegerValue(0), ValueFactory::GetVarcharValue("ab")};
+  ParameterValueExpression::Binding binding(&parameters);
+  ParameterValueExpression number(0, TypeId::INTEGER);
+  ParameterValueExpression string(1, TypeId::VARCHAR);
+  auto *c = Compare(ColumnRef(4), &number, ComparisonType::LessThan);
+  auto *s = Compare(&string, ColumnRef(5), ComparisonType::Equal);
+  auto c_program = ExpressionProgram::Compile(c, &schema_);
+  auto s_program = ExpressionProgram::Compile(s, &schema_);
+  ASSERT_NE(c_program, nullptr);
+  ASSERT_NE(s_program, nullptr);
+
+  // The registers of the parameters follow the values bound to them once reloaded.
+  const std::vector<std::vector<Value>> bindings{
+      {ValueFactory::GetIntegerValue(1), ValueFactory::GetVarcharValue("")},
+      {ValueFactory::GetIntegerValue(-2), ValueFactory::GetVarcharValue("abc")},
+      {ValueFactory::GetNullValueByType(TypeId::INTEGER), ValueFactory::GetNullValueByType(TypeId::VARCHAR)},
+      {ValueFactory::GetIntegerValue(2), ValueFactory::GetVarcharValue("b")}};
+  for (const auto &values : bindings) {
+    parameters = values;
+    c_program->LoadParameters();
+    s_program->LoadParameters();
+    for (const auto &tuple : tuples) {
+      for (auto [predicate, program] : {std::make_pair(c, c_program.get()), std::make_pair(s, s_program.get())}) {
+        Value value = predicate->Evaluate(&tuple, &schema_);
+        ASSERT_EQ(!value.IsNull() && value.GetAs<bool>(), program->Evaluate(tuple)) << program->ToString();
+      }
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(ExpressionProgramTest, Benchmark) {
+  // WHERE c < 1, on tuples and on batches
+  auto tuples = MakeTuples(BATCH_SIZE);
+  auto *predicate = Compare(ColumnRef(2), Constant(ValueFactory::GetIntegerValue(1)), ComparisonType::LessThan);
+  auto program = ExpressionProgram::Compile(predicate, &schema_);
+  ASSERT_NE(program, nullptr);
+  constexpr int rounds = 200;
+
+  auto time = [](const char *name, const std::function<size_t()> &run) {
+    auto start = std::chrono::steady_clock::now();
+    size_t matched = run();
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    std::cout << name << ": " << elapsed.count() / (rounds * BATCH_SIZE) << " ns per row" << std::endl;
+    return matched;
+  };
+
+  size_t tree = time("tree, per tuple", [&] {
+    size_t matched = 0;
+    for (int round = 0; round < rounds; round++) {
+      for (const auto &tuple : tuples) {
+        Value value = predicate->Evaluate(&tuple, &schema_);
+        matched += static_cast<size_t>(!value.IsNull() && value.GetAs<bool>());
+      }
+    }
+    return matched;
+  });
+  size_t compiled = time("bytecode, per tuple", [&] {
+    size_t matched = 0;
+    for (int round = 0; round < rounds; round++) {
+      for (const auto &tuple : tuples) {
+        matched += static_cast<size_t>(program->Evaluate(tuple));
+      }
+    }
+    return matched;
+  });
+  EXPECT_EQ(tree, compiled);
+
+  TupleBatch batch;
+  batch.Reset(&schema_);
+  for (const auto &tuple : tuples) {
+    batch.AppendTuple(tuple, RID());
+  }
+  std::vector<uint32_t> all_rows = batch.GetSelection();
+  ColumnVector result;
+  size_t tree_batch = time("tree, per batch", [&] {
+    size_t matched = 0;
+    for (int round = 0; round < rounds; round++) {
+      *batch.GetMutableSelection() = all_rows;
+      batch.Select(predicate->EvaluateBatch(batch, &result));
+      matched += batch.NumSelected();
+    }
+    return matched;
+  });
+  size_t compiled_batch = time("bytecode, per batch", [&] {
+    size_t matched = 0;
+    for (int round = 0; round < rounds; round++) {
+      *batch.GetMutableSelection() = all_rows;
+      program->Filter(&batch);
+      matched += batch.NumSelected();
+    }
+    return matched;
+  });
+  EXPECT_EQ(tree, tree_batch);
+  EXPECT_EQ(tree, compiled_batch);
+}
+
+}  // namespace bustub
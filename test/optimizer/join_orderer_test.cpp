@@ -0,0 +1,129 @@
+//===----------------------------------------------------------------------===//
+//
+//                         BusTub
+//
+// join_orderer_test.cpp
+//
+// Identification: test/optimizer/join_orderer_test.cpp
+//
+// Copyright (c) 2015-2019, Carnegie Mellon University Database Group
+//
+//===----------------------------------------------------------------------===//
+
+#include <algorithm>
+#include <functional>
+#include <numeric>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "optimizer/join_orderer.h"
+
+namespace bustub {
+
+namespace {
+
+/** @return the number of joins under a node, checking that each one is connected if connected is true */
+size_t CountJoins(const JoinOrderer &orderer, size_t node, bool connected) {
+  const JoinOrderer::Node &join = orderer.GetNode(node);
+  if (join.left_ == JoinOrderer::INVALID_NODE) {
+    return 0;
+  }
+  uint64_t left = orderer.GetNode(join.left_).relations_;
+  uint64_t right = orderer.GetNode(join.right_).relations_;
+  EXPECT_EQ(left & right, 0);
+  EXPECT_EQ(left | right, join.relations_);
+  if (connected) {
+    EXPECT_TRUE(orderer.IsConnected(left, right));
+  }
+  return 1 + CountJoins(orderer, join.left_, connected) + CountJoins(orderer, join.right_, connected);
+}
+
+/** Add a star: a fact of fact_rows rows with an equality on the key of each of the dimensions of dimension_rows. */
+void AddStar(JoinOrderer *orderer, double fact_rows, const std::vector<double> &dimension_rows) {
+  orderer->AddRelation(fact_rows, fact_rows * JoinOrderer::TUPLE_COST, 16);
+  for (size_t i = 0; i < dimension_rows.size(); i++) {
+    size_t dimension = orderer->AddRelation(dimension_rows[i], dimension_rows[i] * JoinOrderer::TUPLE_COST, 8);
+    // Each row of the fact matches one row of the dimension, which may have been filtered.
+    uint64_t fact = 1;
+    uint64_t key = 1ULL << dimension;
+    orderer->AddPredicate(fact | key, 1 / std::max(dimension_rows[i], 100.0), fact, key);
+  }
+}
+
+}  // namespace
+
+// NOLINTNEXTLINE
+TEST(JoinOrdererTest, ExhaustiveTest) {
+  // A chain a - b - c - d, with a small b and d
+  const std::vector<double> rows{1000, 10, 1000, 10};
+  JoinOrderer orderer;
+  for (double cardinality : rows) {
+    orderer.AddRelation(cardinality, cardinality * JoinOrderer::TUPLE_COST, 8);
+  }
+  for (uint64_t i = 0; i + 1 < rows.size(); i++) {
+    uint64_t lhs = 1ULL << i;
+    uint64_t rhs = 1ULL << (i + 1);
+    orderer.AddPredicate(lhs | rhs, 1 / std::max(rows[i], rows[i + 1]), lhs, rhs);
+  }
+  size_t root = orderer.OrderExhaustively();
+  EXPECT_EQ(orderer.GetNode(root).relations_, 0xF);
+  EXPECT_EQ(CountJoins(orderer, root, true), 3);
+  EXPECT_NEAR(orderer.GetNode(root).cardinality_, 1000.0 * 10 * 1000 * 10 / 1000 / 1000 / 1000, 1e-9);
+
+  // No left-deep order, cross products included, is cheaper.
+  std::vector<size_t> order(rows.size());
+  std::iota(order.begin(), order.end(), 0);
+  do {
+    size_t node = order[0];
+    for (size_t i = 1; i < order.size(); i++) {
+      node = orderer.Join(node, order[i]);
+    }
+    EXPECT_LE(orderer.GetNode(root).cost_, orderer.GetNode(node).cost_ * (1 + 1e-9));
+  } while (std::next_permutation(order.begin(), order.end()));
+}
+
+// NOLINTNEXTLINE
+TEST(JoinOrdererTest, CrossProductTest) {
+  // Relations that no predicate connects are still joined, with nested loops.
+  JoinOrderer orderer;
+  for (double cardinality : {1000.0, 1000.0, 10.0}) {
+    orderer.AddRelation(cardinality, cardinality * JoinOrderer::TUPLE_COST, 8);
+  }
+  orderer.AddPredicate(0x3, 0.001, 0x1, 0x2);
+  size_t root = orderer.OrderExhaustively();
+  EXPECT_EQ(CountJoins(orderer, root, false), 2);
+  EXPECT_EQ(orderer.GetNode(root).algorithm_, JoinOrderer::JoinAlgorithm::NestedLoop);
+  EXPECT_NEAR(orderer.GetNode(root).cardinality_, 1000 * 1000 * 10 * 0.001, 1e-9);
+  // The connected pair is joined first, on its keys.
+  const JoinOrderer::Node &root_node = orderer.GetNode(root);
+  size_t pair = orderer.GetNode(root_node.left_).relations_ == 0x3 ? root_node.left_ : root_node.right_;
+  EXPECT_EQ(orderer.GetNode(pair).relations_, 0x3);
+  EXPECT_EQ(orderer.GetNode(pair).algorithm_, JoinOrderer::JoinAlgorithm::Hash);
+}
+
+// NOLINTNEXTLINE
+TEST(JoinOrdererTest, GreedyTest) {
+  // The greedy tree is no cheaper than the exhaustive one, and not much dearer on a star.
+  const std::vector<double> dimensions{100, 5, 100, 20, 1};
+  JoinOrderer exhaustive;
+  AddStar(&exhaustive, 100000, dimensions);
+  JoinOrderer greedy;
+  AddStar(&greedy, 100000, dimensions);
+  double best = exhaustive.GetNode(exhaustive.OrderExhaustively()).cost_;
+  double greedy_cost = greedy.GetNode(greedy.OrderGreedily()).cost_;
+  EXPECT_LE(best, greedy_cost * (1 + 1e-9));
+  EXPECT_LE(greedy_cost, best * 2);
+
+  // Past MAX_DP_RELATIONS the tree is built greedily, without cross products.
+  std::vector<double> many_dimensions(JoinOrderer::MAX_DP_RELATIONS + 5);
+  for (size_t i = 0; i < many_dimensions.size(); i++) {
+    many_dimensions[i] = 10.0 * (i + 1);
+  }
+  JoinOrderer large;
+  AddStar(&large, 100000, many_dimensions);
+  size_t root = large.Order();
+  EXPECT_EQ(large.GetNode(root).relations_, (1ULL << (many_dimensions.size() + 1)) - 1);
+  EXPECT_EQ(CountJoins(large, root, true), many_dimensions.size());
+}
+
+}  // namespace bustub
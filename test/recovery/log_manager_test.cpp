@@ -0,0 +1,163 @@
+/**
+ * log_manager_test.cpp
+ */
+
+#include <algorithm>
+#include <chrono>  // NOLINT
+#include <cstdio>
+#include <memory>
+#include <set>
+#include <thread>  // NOLINT
+#include <vector>
+
+#include "concurrency/transaction_manager.h"
+#include "gtest/gtest.h"
+#include "recovery/log_manager.h"
+#include "storage/disk/disk_manager.h"
+
+namespace bustub {
+
+class LogManagerTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    remove("log_manager_test.db");
+    remove("log_manager_test.log");
+  }
+
+  void TearDown() override {
+    remove("log_manager_test.db");
+    remove("log_manager_test.log");
+  }
+};
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, AppendAndFlushTest) {
+  DiskManager disk_manager("log_manager_test.db");
+  LogManager log_manager(&disk_manager);
+
+  // Without the flush thread, Flush() writes the buffer in the calling thread.
+  LogRecord begin(0, INVALID_LSN, LogRecordType::BEGIN);
+  EXPECT_EQ(0, log_manager.AppendLogRecord(&begin));
+  LogRecord commit(0, 0, LogRecordType::COMMIT);
+  EXPECT_EQ(1, log_manager.AppendLogRecord(&commit));
+  EXPECT_EQ(INVALID_LSN, log_manager.GetPersistentLSN());
+  log_manager.Flush(1);
+  EXPECT_EQ(1, log_manager.GetPersistentLSN());
+
+  // With the flush thread, records become durable on their own after log_timeout.
+  log_manager.RunFlushThread();
+  EXPECT_TRUE(enable_logging);
+  LogRecord abort(1, INVALID_LSN, LogRecordType::ABORT);
+  EXPECT_EQ(2, log_manager.AppendLogRecord(&abort));
+  std::this_thread::sleep_for(log_timeout * 2);
+  EXPECT_EQ(2, log_manager.GetPersistentLSN());
+  log_manager.StopFlushThread();
+  EXPECT_FALSE(enable_logging);
+
+  // The records are laid out back to back on disk.
+  char data[LOG_BUFFER_SIZE];
+  EXPECT_TRUE(disk_manager.ReadLog(data, sizeof(data), begin.GetSize()));
+  LogRecord record;
+  EXPECT_TRUE(record.DeserializeFrom(data));
+  EXPECT_EQ(commit.GetSize(), record.GetSize());
+  EXPECT_EQ(1, record.GetLSN());
+  EXPECT_EQ(LogRecordType::COMMIT, record.GetLogRecordType());
+  disk_manager.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, GroupCommitTest) {
+  const int commits_per_thread = 200;
+  for (int num_threads : {1, 2, 4, 8}) {
+    DiskManager disk_manager("log_manager_test.db");
+    LogManager log_manager(&disk_manager);
+    LockManager lock_manager;
+    TransactionManager txn_mgr(&lock_manager, &log_manager);
+    log_manager.RunFlushThread();
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; i++) {
+      threads.emplace_back([&] {
+        for (int j = 0; j < commits_per_thread; j++) {
+          auto *txn = txn_mgr.Begin();
+          txn_mgr.Commit(txn);
+          // A commit returns once its commit record is durable.
+          EXPECT_GE(log_manager.GetPersistentLSN(), txn->GetPrevLSN());
+          delete txn;
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    log_manager.StopFlushThread();
+
+    int commits = num_threads * commits_per_thread;
+    EXPECT_LE(disk_manager.GetNumFlushes(), commits);
+    LOG_INFO("%d committers: %.0f commits/sec, %.2f commits per log flush", num_threads, commits / elapsed.count(),
+             static_cast<double>(commits) / disk_manager.GetNumFlushes());
+    disk_manager.ShutDown();
+    remove("log_manager_test.db");
+    remove("log_manager_test.log");
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(LogManagerTest, ConcurrentAppendTest) {
+  const int appends_per_thread = 20000;
+  for (int num_threads : {1, 2, 4, 8}) {
+    DiskManager disk_manager("log_manager_test.db");
+    LogManager log_manager(&disk_manager);
+    log_manager.RunFlushThread();
+
+    std::vector<std::vector<lsn_t>> lsns(num_threads);
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> threads;
+    for (int i = 0; i < num_threads; i++) {
+      threads.emplace_back([&, i] {
+        for (int j = 0; j < appends_per_thread; j++) {
+          LogRecord log_record(i, INVALID_LSN, LogRecordType::NEWPAGE, j, j + 1);
+          lsns[i].push_back(log_manager.AppendLogRecord(&log_record));
+        }
+      });
+    }
+    for (auto &thread : threads) {
+      thread.join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    int appends = num_threads * appends_per_thread;
+    log_manager.Flush(appends - 1);
+    EXPECT_EQ(appends - 1, log_manager.GetPersistentLSN());
+    log_manager.StopFlushThread();
+    LOG_INFO("%d appenders: %.0f appends/sec", num_threads, appends / elapsed.count());
+
+    // Every LSN is handed out exactly once, in order within a thread.
+    std::set<lsn_t> all;
+    for (const auto &thread_lsns : lsns) {
+      EXPECT_TRUE(std::is_sorted(thread_lsns.begin(), thread_lsns.end()));
+      all.insert(thread_lsns.begin(), thread_lsns.end());
+    }
+    EXPECT_EQ(appends, all.size());
+    EXPECT_EQ(appends - 1, *all.rbegin());
+
+    // The log on disk holds every record in LSN order without holes.
+    std::vector<char> log(disk_manager.GetLogSize() + LogRecord::HEADER_SIZE);
+    EXPECT_TRUE(disk_manager.ReadLog(log.data(), static_cast<int>(log.size()), 0));
+    int offset = 0;
+    for (int lsn = 0; lsn < appends; lsn++) {
+      LogRecord record;
+      ASSERT_TRUE(record.DeserializeFrom(log.data() + offset));
+      EXPECT_EQ(lsn, record.GetLSN());
+      EXPECT_EQ(LogRecordType::NEWPAGE, record.GetLogRecordType());
+      offset += record.GetSize();
+    }
+    EXPECT_EQ(disk_manager.GetLogSize(), offset);
+    disk_manager.ShutDown();
+    remove("log_manager_test.db");
+    remove("log_manager_test.log");
+  }
+}
+
+}  // namespace bustub
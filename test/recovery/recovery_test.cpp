@@ -10,7 +10,16 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>  // NOLINT
+#include <random>
 #include <string>
+#include <thread>  // NOLINT
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "common/bustub_instance.h"
@@ -23,6 +32,7 @@
 #include "storage/table/table_heap.h"
 #include "storage/table/table_iterator.h"
 #include "storage/table/tuple.h"
+#include "type/value_factory.h"
 
 namespace bustub {
 
@@ -32,6 +42,8 @@ class RecoveryTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.master");
+    remove("test.dwb");
   }
 
   // This function is called after every test.
@@ -39,11 +51,13 @@ class RecoveryTest : public ::testing::Test {
     LOG_INFO("Tearing down the system..");
     remove("test.db");
     remove("test.log");
+    remove("test.master");
+    remove("test.dwb");
   };
 };
 
 // NOLINTNEXTLINE
-TEST_F(RecoveryTest, DISABLED_RedoTest) {
+TEST_F(RecoveryTest, RedoTest) {
   BustubInstance *bustub_instance = new BustubInstance("test.db");
 
   ASSERT_FALSE(enable_logging);
@@ -132,7 +146,7 @@ TEST_F(RecoveryTest, DISABLED_RedoTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(RecoveryTest, DISABLED_UndoTest) {
+TEST_F(RecoveryTest, UndoTest) {
   BustubInstance *bustub_instance = new BustubInstance("test.db");
 
   ASSERT_FALSE(enable_logging);
@@ -211,7 +225,446 @@ TEST_F(RecoveryTest, DISABLED_UndoTest) {
 }
 
 // NOLINTNEXTLINE
-TEST_F(RecoveryTest, DISABLED_CheckpointTest) {
+TEST_F(RecoveryTest, ParallelRedoTest) {
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}}};
+  auto make_tuple = [&](int32_t value) { return Tuple{{ValueFactory::GetIntegerValue(value)}, &schema}; };
+  const int tuples_per_txn = 100;
+
+  for (int num_tuples : {2000, 8000}) {
+    for (size_t redo_threads : {1, 2, 4}) {
+      remove("test.db");
+      remove("test.log");
+
+      // Commit num_tuples tuples, then crash while a loser transaction has updated, deleted and inserted tuples.
+      auto *bustub_instance = new BustubInstance("test.db");
+      bustub_instance->log_manager_->RunFlushThread();
+      Transaction *txn = bustub_instance->transaction_manager_->Begin();
+      auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                       bustub_instance->log_manager_, txn);
+      page_id_t first_page_id = test_table->GetFirstPageId();
+      std::vector<RID> rids(num_tuples);
+      for (int i = 0; i < num_tuples; i++) {
+        ASSERT_TRUE(test_table->InsertTuple(make_tuple(i), &rids[i], txn));
+        if ((i + 1) % tuples_per_txn == 0) {
+          bustub_instance->transaction_manager_->Commit(txn);
+          delete txn;
+          txn = bustub_instance->transaction_manager_->Begin();
+        }
+      }
+      bustub_instance->transaction_manager_->Commit(txn);
+      delete txn;
+
+      txn = bustub_instance->transaction_manager_->Begin();
+      for (int i = 0; i < 20; i++) {
+        ASSERT_TRUE(test_table->UpdateTuple(make_tuple(-1), rids[i], txn));
+        ASSERT_TRUE(test_table->MarkDelete(rids[num_tuples - 1 - i], txn));
+        RID rid;
+        ASSERT_TRUE(test_table->InsertTuple(make_tuple(-1), &rid, txn));
+      }
+      delete txn;
+      delete test_table;
+      delete bustub_instance;
+
+      bustub_instance = new BustubInstance("test.db");
+      auto start = std::chrono::steady_clock::now();
+      LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_,
+                               bustub_instance->log_manager_, redo_threads);
+      log_recovery.Redo();
+      log_recovery.Undo();
+      std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+      LOG_INFO("%d log records, %zu redo threads: recovered in %.1f ms", bustub_instance->log_manager_->GetNextLSN(),
+               redo_threads, elapsed.count());
+
+      // Only the committed tuples are left, with their committed values.
+      txn = bustub_instance->transaction_manager_->Begin();
+      test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                 bustub_instance->log_manager_, first_page_id);
+      int64_t count = 0;
+      int64_t sum = 0;
+      for (auto it = test_table->Begin(txn); it != test_table->End(); ++it) {
+        count++;
+        sum += it->GetValue(&schema, 0).GetAs<int32_t>();
+      }
+      EXPECT_EQ(num_tuples, count);
+      EXPECT_EQ(static_cast<int64_t>(num_tuples) * (num_tuples - 1) / 2, sum);
+      bustub_instance->transaction_manager_->Commit(txn);
+      delete txn;
+      delete test_table;
+      delete bustub_instance;
+    }
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, FuzzyCheckpointTest) {
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}}};
+  auto make_tuple = [&](int32_t value) { return Tuple{{ValueFactory::GetIntegerValue(value)}, &schema}; };
+
+  auto *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+  auto *txn_mgr = bustub_instance->transaction_manager_;
+  Transaction *txn = txn_mgr->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  txn_mgr->Commit(txn);
+  delete txn;
+
+  // A loser transaction starts before the checkpoint and writes before and after it.
+  Transaction *loser = txn_mgr->Begin();
+  RID rid;
+  for (int i = 0; i < 50; i++) {
+    ASSERT_TRUE(test_table->InsertTuple(make_tuple(-1), &rid, loser));
+  }
+
+  // Writers keep committing while the checkpoint is taken.
+  std::atomic<bool> running{true};
+  std::atomic<int> committed{0};
+  std::thread writer([&] {
+    while (running || committed < 1000) {
+      Transaction *writer_txn = txn_mgr->Begin();
+      for (int i = 0; i < 10; i++) {
+        RID writer_rid;
+        EXPECT_TRUE(test_table->InsertTuple(make_tuple(1), &writer_rid, writer_txn));
+      }
+      txn_mgr->Commit(writer_txn);
+      delete writer_txn;
+      committed += 10;
+    }
+  });
+  bustub_instance->checkpoint_manager_->BeginCheckpoint();
+  bustub_instance->checkpoint_manager_->EndCheckpoint();
+  running = false;
+  writer.join();
+  for (int i = 0; i < 50; i++) {
+    ASSERT_TRUE(test_table->InsertTuple(make_tuple(-1), &rid, loser));
+  }
+
+  lsn_t checkpoint_lsn;
+  int checkpoint_offset;
+  EXPECT_TRUE(bustub_instance->disk_manager_->ReadMasterRecord(&checkpoint_lsn, &checkpoint_offset));
+  EXPECT_LT(0, checkpoint_offset);
+  delete loser;
+  delete test_table;
+  delete bustub_instance;
+
+  // Recovery starts at the checkpoint, yet undoes the loser back to its first record.
+  bustub_instance = new BustubInstance("test.db");
+  LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_,
+                           bustub_instance->log_manager_);
+  log_recovery.Redo();
+  log_recovery.Undo();
+  txn = bustub_instance->transaction_manager_->Begin();
+  test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                             bustub_instance->log_manager_, first_page_id);
+  int count = 0;
+  for (auto it = test_table->Begin(txn); it != test_table->End(); ++it) {
+    EXPECT_EQ(1, it->GetValue(&schema, 0).GetAs<int32_t>());
+    count++;
+  }
+  EXPECT_EQ(committed, count);
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+  delete test_table;
+  delete bustub_instance;
+}
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, CompactLogTest) {
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}, Column{"b", TypeId::VARCHAR, 64}}};
+  auto make_tuple = [&](int32_t a, const std::string &b) {
+    return Tuple{{ValueFactory::GetIntegerValue(a), ValueFactory::GetVarcharValue(b)}, &schema};
+  };
+  const int num_txns = 200;
+
+  for (bool compression : {false, true}) {
+    remove("test.db");
+    remove("test.log");
+    enable_log_compression = compression;
+
+    // A mixed workload: every transaction inserts, updates one column of and deletes tuples.
+    auto *bustub_instance = new BustubInstance("test.db");
+    bustub_instance->log_manager_->RunFlushThread();
+    auto *txn_mgr = bustub_instance->transaction_manager_;
+    Transaction *txn = txn_mgr->Begin();
+    auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                     bustub_instance->log_manager_, txn);
+    page_id_t first_page_id = test_table->GetFirstPageId();
+    txn_mgr->Commit(txn);
+    delete txn;
+
+    std::mt19937 rng(15445);
+    std::vector<RID> rids;
+    std::unordered_map<RID, std::pair<int32_t, std::string>> expected;
+    for (int i = 0; i < num_txns; i++) {
+      txn = txn_mgr->Begin();
+      for (int j = 0; j < 4; j++) {
+        std::string b = "customer-" + std::to_string(i * 4 + j) + "-address-line-with-some-padding";
+        RID rid;
+        ASSERT_TRUE(test_table->InsertTuple(make_tuple(i, b), &rid, txn));
+        rids.push_back(rid);
+        expected[rid] = {i, b};
+      }
+      for (int j = 0; j < 2; j++) {
+        RID rid = rids[rng() % rids.size()];
+        if (expected.count(rid) != 0) {
+          expected[rid].first += 1000;
+          ASSERT_TRUE(test_table->UpdateTuple(make_tuple(expected[rid].first, expected[rid].second), rid, txn));
+        }
+      }
+      RID rid = rids[rng() % rids.size()];
+      if (expected.erase(rid) != 0) {
+        ASSERT_TRUE(test_table->MarkDelete(rid, txn));
+      }
+      txn_mgr->Commit(txn);
+      delete txn;
+    }
+    int log_size = bustub_instance->disk_manager_->GetLogSize();
+    uint64_t bytes_written = bustub_instance->disk_manager_->GetLogBytesWritten();
+    LOG_INFO("compression %s: %.1f log record bytes per txn, %.1f log file bytes per txn", compression ? "on" : "off",
+             static_cast<double>(log_size) / num_txns, static_cast<double>(bytes_written) / num_txns);
+    if (compression) {
+      EXPECT_LT(bytes_written, static_cast<uint64_t>(log_size));
+    }
+
+    // Crash while a loser transaction has updated, deleted and inserted tuples.
+    Transaction *loser = txn_mgr->Begin();
+    for (const auto &entry : expected) {
+      if (entry.first.GetSlotNum() % 3 == 0) {
+        ASSERT_TRUE(test_table->UpdateTuple(make_tuple(-1, entry.second.second), entry.first, loser));
+      } else if (entry.first.GetSlotNum() % 3 == 1) {
+        ASSERT_TRUE(test_table->MarkDelete(entry.first, loser));
+      }
+    }
+    RID rid;
+    ASSERT_TRUE(test_table->InsertTuple(make_tuple(-1, "loser"), &rid, loser));
+    bustub_instance->log_manager_->Flush(loser->GetPrevLSN());
+    delete loser;
+    delete test_table;
+    delete bustub_instance;
+
+    // Recovery replays the compact records and rebuilds the updated tuples from their deltas.
+    bustub_instance = new BustubInstance("test.db");
+    LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_,
+                             bustub_instance->log_manager_);
+    log_recovery.Redo();
+    log_recovery.Undo();
+    txn = bustub_instance->transaction_manager_->Begin();
+    test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                               bustub_instance->log_manager_, first_page_id);
+    size_t count = 0;
+    for (auto it = test_table->Begin(txn); it != test_table->End(); ++it) {
+      auto expected_it = expected.find(it->GetRid());
+      ASSERT_NE(expected.end(), expected_it);
+      EXPECT_EQ(expected_it->second.first, it->GetValue(&schema, 0).GetAs<int32_t>());
+      EXPECT_EQ(expected_it->second.second, it->GetValue(&schema, 1).ToString());
+      count++;
+    }
+    EXPECT_EQ(expected.size(), count);
+    bustub_instance->transaction_manager_->Commit(txn);
+    delete txn;
+    delete test_table;
+    delete bustub_instance;
+  }
+  enable_log_compression = false;
+}
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, LogTruncationTest) {
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}}};
+  auto make_tuple = [&](int32_t value) { return Tuple{{ValueFactory::GetIntegerValue(value)}, &schema}; };
+  auto remove_log = [] {
+    for (int i = 0; i < 100; i++) {
+      remove(("test.log." + std::to_string(i)).c_str());
+      remove(("test_archive/test.log" + (i == 0 ? "" : "." + std::to_string(i))).c_str());
+    }
+    rmdir("test_archive");
+  };
+  remove_log();
+  mkdir("test_archive", 0755);
+  int default_segment_size = log_segment_size;
+  log_segment_size = 32 * 1024;
+
+  auto *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->disk_manager_->SetLogArchiveDirectory("test_archive");
+  bustub_instance->log_manager_->RunFlushThread();
+  auto *txn_mgr = bustub_instance->transaction_manager_;
+  Transaction *txn = txn_mgr->Begin();
+  auto *test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                                   bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  txn_mgr->Commit(txn);
+  delete txn;
+
+  // Continuous load with a checkpoint after every round. A loser transaction starts in the middle of it.
+  const int rounds = 12;
+  const int tuples_per_round = 1500;
+  Transaction *loser = nullptr;
+  size_t max_segments = 0;
+  int64_t max_disk_usage = 0;
+  for (int round = 0; round < rounds; round++) {
+    if (round == rounds / 2) {
+      loser = txn_mgr->Begin();
+      RID rid;
+      ASSERT_TRUE(test_table->InsertTuple(make_tuple(-1), &rid, loser));
+    }
+    for (int i = 0; i < tuples_per_round; i += 10) {
+      txn = txn_mgr->Begin();
+      for (int j = 0; j < 10; j++) {
+        RID rid;
+        ASSERT_TRUE(test_table->InsertTuple(make_tuple(1), &rid, txn));
+      }
+      txn_mgr->Commit(txn);
+      delete txn;
+    }
+    bustub_instance->checkpoint_manager_->BeginCheckpoint();
+    bustub_instance->checkpoint_manager_->EndCheckpoint();
+    if (loser == nullptr) {
+      max_segments = std::max(max_segments, bustub_instance->disk_manager_->GetNumLogSegments());
+      max_disk_usage = std::max(max_disk_usage, bustub_instance->disk_manager_->GetLogDiskUsage());
+    }
+  }
+  LOG_INFO("without a long running transaction: at most %zu log segments, %ld log bytes on disk", max_segments,
+           static_cast<int64_t>(max_disk_usage));
+  LOG_INFO("with a long running transaction: %zu log segments, %ld log bytes on disk",
+           bustub_instance->disk_manager_->GetNumLogSegments(),
+           static_cast<int64_t>(bustub_instance->disk_manager_->GetLogDiskUsage()));
+  // The log only keeps the segments from the last checkpoint on, unless the loser pins older ones.
+  EXPECT_LE(max_segments, 2);
+  EXPECT_LE(max_disk_usage, 2 * (log_segment_size + LOG_BUFFER_SIZE + 64));
+  EXPECT_LT(2, bustub_instance->disk_manager_->GetNumLogSegments());
+  EXPECT_LT(0, bustub_instance->disk_manager_->GetLogStart());
+  struct stat stat_buf;
+  EXPECT_EQ(0, stat("test_archive/test.log", &stat_buf));
+  delete loser;
+  delete test_table;
+  delete bustub_instance;
+
+  // Recovery reads the remaining segments only, yet undoes the loser back to its BEGIN record.
+  bustub_instance = new BustubInstance("test.db");
+  LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_,
+                           bustub_instance->log_manager_);
+  log_recovery.Redo();
+  log_recovery.Undo();
+  txn = bustub_instance->transaction_manager_->Begin();
+  test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                             bustub_instance->log_manager_, first_page_id);
+  int count = 0;
+  for (auto it = test_table->Begin(txn); it != test_table->End(); ++it) {
+    EXPECT_EQ(1, it->GetValue(&schema, 0).GetAs<int32_t>());
+    count++;
+  }
+  EXPECT_EQ(rounds * tuples_per_round, count);
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+  delete test_table;
+  delete bustub_instance;
+
+  log_segment_size = default_segment_size;
+  remove_log();
+}
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, TruncationKeepsDirtyPagesTest) {
+  Schema schema{std::vector<Column>{Column{"a", TypeId::INTEGER}}};
+  auto make_tuple = [&](int32_t value) { return Tuple{{ValueFactory::GetIntegerValue(value)}, &schema}; };
+  auto remove_log = [] {
+    for (int i = 0; i < 100; i++) {
+      remove(("test.log." + std::to_string(i)).c_str());
+    }
+  };
+  remove_log();
+  int default_segment_size = log_segment_size;
+  log_segment_size = 32 * 1024;
+
+  auto *bustub_instance = new BustubInstance("test.db");
+  bustub_instance->log_manager_->RunFlushThread();
+  auto *txn_mgr = bustub_instance->transaction_manager_;
+  auto *bpm = bustub_instance->buffer_pool_manager_;
+  Transaction *txn = txn_mgr->Begin();
+  auto *test_table = new TableHeap(bpm, bustub_instance->lock_manager_, bustub_instance->log_manager_, txn);
+  page_id_t first_page_id = test_table->GetFirstPageId();
+  txn_mgr->Commit(txn);
+  delete txn;
+  auto load = [&](int num_tuples, RID *first_rid) {
+    for (int i = 0; i < num_tuples; i += 10) {
+      Transaction *load_txn = txn_mgr->Begin();
+      for (int j = 0; j < 10; j++) {
+        RID rid;
+        ASSERT_TRUE(test_table->InsertTuple(make_tuple(1), &rid, load_txn));
+        if (i + j == 0 && first_rid != nullptr) {
+          *first_rid = rid;
+        }
+      }
+      txn_mgr->Commit(load_txn);
+      delete load_txn;
+    }
+  };
+  auto update = [&](const RID &rid, int32_t value) {
+    Transaction *update_txn = txn_mgr->Begin();
+    ASSERT_TRUE(test_table->UpdateTuple(make_tuple(value), rid, update_txn));
+    txn_mgr->Commit(update_txn);
+    delete update_txn;
+  };
+
+  // The first page is full once the load moved on to the next pages, and its last change is its update. It stays
+  // pinned, so that it is still in the dirty page table after the checkpoint wrote it out.
+  RID first_rid;
+  load(2000, &first_rid);
+  ASSERT_EQ(first_page_id, first_rid.GetPageId());
+  Page *pinned = bpm->FetchPage(first_page_id);
+  update(first_rid, 2);
+  load(3000, nullptr);
+  bustub_instance->checkpoint_manager_->BeginCheckpoint();
+  bustub_instance->checkpoint_manager_->EndCheckpoint();
+  lsn_t rec_lsn = bpm->GetDirtyPageTable().at(first_page_id);
+  update(first_rid, 3);
+  bpm->UnpinPage(pinned->GetPageId(), false);
+
+  // The log was truncated, but not past the recLSN of the page, which is older than the checkpoint.
+  lsn_t checkpoint_lsn;
+  int checkpoint_offset;
+  ASSERT_TRUE(bustub_instance->disk_manager_->ReadMasterRecord(&checkpoint_lsn, &checkpoint_offset));
+  EXPECT_LT(rec_lsn, checkpoint_lsn);
+  EXPECT_LT(0, bustub_instance->disk_manager_->GetLogStart());
+  std::vector<char> buffer(LOG_BUFFER_SIZE);
+  ASSERT_TRUE(bustub_instance->disk_manager_->ReadLog(buffer.data(), LOG_BUFFER_SIZE,
+                                                      bustub_instance->disk_manager_->GetLogStart()));
+  LogRecord oldest_record;
+  ASSERT_TRUE(oldest_record.DeserializeFrom(buffer.data()));
+  EXPECT_LE(oldest_record.GetLSN(), rec_lsn);
+
+  // Crash with the last update only in the log.
+  delete test_table;
+  delete bustub_instance;
+
+  bustub_instance = new BustubInstance("test.db");
+  LogRecovery log_recovery(bustub_instance->disk_manager_, bustub_instance->buffer_pool_manager_,
+                           bustub_instance->log_manager_);
+  log_recovery.Redo();
+  log_recovery.Undo();
+  txn = bustub_instance->transaction_manager_->Begin();
+  test_table = new TableHeap(bustub_instance->buffer_pool_manager_, bustub_instance->lock_manager_,
+                             bustub_instance->log_manager_, first_page_id);
+  Tuple tuple;
+  ASSERT_TRUE(test_table->GetTuple(first_rid, &tuple, txn));
+  EXPECT_EQ(3, tuple.GetValue(&schema, 0).GetAs<int32_t>());
+  int count = 0;
+  for (auto it = test_table->Begin(txn); it != test_table->End(); ++it) {
+    count++;
+  }
+  EXPECT_EQ(5000, count);
+  bustub_instance->transaction_manager_->Commit(txn);
+  delete txn;
+  delete test_table;
+  delete bustub_instance;
+
+  log_segment_size = default_segment_size;
+  remove_log();
+}
+
+// NOLINTNEXTLINE
+TEST_F(RecoveryTest, CheckpointTest) {
   BustubInstance *bustub_instance = new BustubInstance("test.db");
 
   EXPECT_FALSE(enable_logging);
@@ -247,9 +700,12 @@ TEST_F(RecoveryTest, DISABLED_CheckpointTest) {
   }
   bustub_instance->transaction_manager_->Commit(txn1);
 
-  // Do checkpoint
-  bustub_instance->checkpoint_manager_->BeginCheckpoint();
-  bustub_instance->checkpoint_manager_->EndCheckpoint();
+  // Do checkpoint, one at a time
+  EXPECT_FALSE(bustub_instance->checkpoint_manager_->EndCheckpoint());
+  EXPECT_TRUE(bustub_instance->checkpoint_manager_->BeginCheckpoint());
+  EXPECT_FALSE(bustub_instance->checkpoint_manager_->BeginCheckpoint());
+  EXPECT_TRUE(bustub_instance->checkpoint_manager_->EndCheckpoint());
+  EXPECT_FALSE(bustub_instance->checkpoint_manager_->EndCheckpoint());
 
   Page *pages = bustub_instance->buffer_pool_manager_->GetPages();
   size_t pool_size = bustub_instance->buffer_pool_manager_->GetPoolSize();
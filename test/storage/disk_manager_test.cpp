@@ -10,9 +10,15 @@
 //
 //===----------------------------------------------------------------------===//
 
+#include <chrono>  // NOLINT
 #include <cstring>
+#include <fstream>
+#include <random>
+#include <vector>
 
 #include "common/exception.h"
+#include "common/logger.h"
+#include "common/util/crc32c_util.h"
 #include "gtest/gtest.h"
 #include "storage/disk/disk_manager.h"
 
@@ -24,13 +30,27 @@ class DiskManagerTest : public ::testing::Test {
   void SetUp() override {
     remove("test.db");
     remove("test.log");
+    remove("test.dwb");
   }
 
   // This function is called after every test.
   void TearDown() override {
     remove("test.db");
     remove("test.log");
+    remove("test.dwb");
+    enable_double_write = true;
   };
+
+  /** The offset of the data of a page after its header, whose checksum field the disk manager fills. */
+  static constexpr int DATA_OFFSET = DiskManager::PAGE_CHECKSUM_OFFSET + DiskManager::PAGE_CHECKSUM_SIZE;
+
+  /** Overwrite the second half of a page in the database file, as a write torn by a crash would. */
+  static void TearPage(page_id_t page_id) {
+    std::fstream db_io("test.db", std::ios::binary | std::ios::in | std::ios::out);
+    std::vector<char> garbage(PAGE_SIZE / 2, 'x');
+    db_io.seekp(static_cast<size_t>(page_id) * PAGE_SIZE + garbage.size());
+    db_io.write(garbage.data(), garbage.size());
+  }
 };
 
 // NOLINTNEXTLINE
@@ -39,7 +59,7 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   char data[PAGE_SIZE] = {0};
   std::string db_file("test.db");
   auto dm = DiskManager(db_file);
-  std::strncpy(data, "A test string.", sizeof(data));
+  std::strncpy(data + DATA_OFFSET, "A test string.", sizeof(data) - DATA_OFFSET);
 
   dm.ReadPage(0, buf);  // tolerate empty read
 
@@ -52,6 +72,15 @@ TEST_F(DiskManagerTest, ReadWritePageTest) {
   dm.ReadPage(5, buf);
   EXPECT_EQ(std::memcmp(buf, data, sizeof(buf)), 0);
 
+  // every page takes PAGE_SIZE bytes at an offset aligned to PAGE_SIZE, with its checksum in its header
+  std::ifstream db_io("test.db", std::ios::binary);
+  db_io.seekg(5 * PAGE_SIZE);
+  db_io.read(buf, sizeof(buf));
+  EXPECT_EQ(std::memcmp(buf + DATA_OFFSET, data + DATA_OFFSET, sizeof(buf) - DATA_OFFSET), 0);
+  EXPECT_NE(std::memcmp(buf, data, DATA_OFFSET), 0);
+  db_io.seekg(0, std::ios::end);
+  EXPECT_EQ(6 * PAGE_SIZE, db_io.tellg());
+
   dm.ShutDown();
 }
 
@@ -72,6 +101,125 @@ TEST_F(DiskManagerTest, ReadWriteLogTest) {
   dm.ShutDown();
 }
 
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, Crc32cTest) {
+  const char *check = "123456789";
+  EXPECT_EQ(0xE3069283, Crc32cUtil::Crc32cSoftware(check, 9));
+  EXPECT_EQ(0xE3069283, Crc32cUtil::Crc32cHardware(check, 9));
+  EXPECT_EQ(0xE3069283, Crc32cUtil::Crc32c(check, 9));
+
+  std::mt19937 generator(15445);
+  char data[PAGE_SIZE];
+  for (char &c : data) {
+    c = static_cast<char>(generator());
+  }
+  for (size_t size : {0, 1, 7, 8, 13, 100, PAGE_SIZE}) {
+    EXPECT_EQ(Crc32cUtil::Crc32cSoftware(data, size), Crc32cUtil::Crc32c(data, size));
+  }
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, TornPageRepairTest) {
+  char buf[PAGE_SIZE] = {0};
+  char old_data[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  std::strncpy(old_data + DATA_OFFSET, "The old page.", sizeof(old_data) - DATA_OFFSET);
+  std::strncpy(data + DATA_OFFSET, "The new page.", sizeof(data) - DATA_OFFSET);
+  data[PAGE_SIZE - 1] = 'z';
+  {
+    DiskManager dm("test.db");
+    dm.WritePage(2, old_data);
+    dm.WritePage(3, old_data);
+    dm.WritePage(3, data);
+    dm.ShutDown();
+  }
+  TearPage(3);
+
+  // The page is repaired from the latest copy in the double-write buffer, also after a restart.
+  DiskManager dm("test.db");
+  dm.ReadPage(3, buf);
+  EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf)));
+  EXPECT_EQ(1, dm.GetNumChecksumFailures());
+  EXPECT_EQ(1, dm.GetNumRepairedPages());
+
+  // The repaired page was written back in place.
+  dm.ReadPage(3, buf);
+  EXPECT_EQ(0, std::memcmp(buf, data, sizeof(buf)));
+  EXPECT_EQ(1, dm.GetNumChecksumFailures());
+
+  // Pages that were never written read as zeros.
+  dm.ReadPage(1, buf);
+  EXPECT_EQ(0, buf[0]);
+  EXPECT_EQ(1, dm.GetNumChecksumFailures());
+
+  // Writes continue after the latest slot of the double-write buffer, so the copy of page 2 in the first slot survives.
+  for (int i = 0; i < DiskManager::DOUBLE_WRITE_SLOTS - 3; i++) {
+    dm.WritePage(4 + i, old_data);
+  }
+  TearPage(2);
+  dm.ReadPage(2, buf);
+  EXPECT_EQ(0, std::memcmp(buf, old_data, sizeof(buf)));
+  EXPECT_EQ(2, dm.GetNumRepairedPages());
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, TornPageWithoutDoubleWriteTest) {
+  enable_double_write = false;
+  char buf[PAGE_SIZE] = {0};
+  char data[PAGE_SIZE] = {0};
+  std::strncpy(data + DATA_OFFSET, "A test string.", sizeof(data) - DATA_OFFSET);
+  DiskManager dm("test.db");
+  dm.WritePage(0, data);
+  TearPage(0);
+
+  // The torn page is detected, but there is no copy to repair it from.
+  EXPECT_THROW(dm.ReadPage(0, buf), Exception);
+  EXPECT_EQ(1, dm.GetNumChecksumFailures());
+  EXPECT_EQ(0, dm.GetNumRepairedPages());
+  dm.ShutDown();
+}
+
+// NOLINTNEXTLINE
+TEST_F(DiskManagerTest, ChecksumCostTest) {
+  const int num_pages = 20000;
+  char data[PAGE_SIZE];
+  std::mt19937 generator(15445);
+  for (char &c : data) {
+    c = static_cast<char>(generator());
+  }
+
+  // The cost of checksumming a page, with and without the crc32 instruction.
+  for (bool hardware : {false, true}) {
+    if (hardware && !Crc32cUtil::HasHardwareSupport()) {
+      continue;
+    }
+    uint32_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_pages; i++) {
+      data[0] = static_cast<char>(i);
+      sum += hardware ? Crc32cUtil::Crc32cHardware(data, PAGE_SIZE) : Crc32cUtil::Crc32cSoftware(data, PAGE_SIZE);
+    }
+    std::chrono::duration<double, std::nano> elapsed = std::chrono::steady_clock::now() - start;
+    LOG_INFO("%s crc32c: %.0f ns/page (%u)", hardware ? "hardware" : "software", elapsed.count() / num_pages, sum);
+  }
+
+  // The cost of a page write, with and without the double-write buffer.
+  const int num_writes = 2000;
+  for (bool double_write : {false, true}) {
+    enable_double_write = double_write;
+    DiskManager dm("test.db");
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < num_writes; i++) {
+      dm.WritePage(i % 64, data);
+    }
+    std::chrono::duration<double, std::micro> elapsed = std::chrono::steady_clock::now() - start;
+    LOG_INFO("page write %s double-write buffer: %.1f us/page", double_write ? "with" : "without",
+             elapsed.count() / num_writes);
+    dm.ShutDown();
+  }
+}
+
 // NOLINTNEXTLINE
 TEST_F(DiskManagerTest, ThrowBadFileTest) { EXPECT_THROW(DiskManager("dev/null\\/foo/bar/baz/test.db"), Exception); }
 